@@ -641,6 +641,36 @@ char assert_aligned[(sizeof(struct mystruct)==16)*2-1];
       self.addDefine('HAVE_BUILTIN_EXPECT', 1)
     self.popLanguage()
 
+  def configureCPUDispatch(self):
+    '''Sees if functions can be compiled for a given x86 instruction set with __attribute((target)) and the instruction set
+       of the running CPU queried with __builtin_cpu_supports(), so that SIMD kernels can be selected at runtime'''
+    code = '''\
+#include <immintrin.h>
+__attribute((target("avx512f"))) static double sum512(const double *a,const int *idx)
+{
+  __m512d v = _mm512_i32gather_pd(_mm256_loadu_si256((__m256i const*)idx),a,8);
+  return _mm512_reduce_add_pd(v);
+}
+__attribute((target("avx2,fma"))) static double sum256(const double *a,const int *idx)
+{
+  double  s[4];
+  __m256d v = _mm256_i32gather_pd(a,_mm_loadu_si128((__m128i const*)idx),8);
+  _mm256_storeu_pd(s,_mm256_fmadd_pd(v,v,v));
+  return s[0]+s[1]+s[2]+s[3];
+}
+'''
+    body = '''\
+double a[8] = {0,0,0,0,0,0,0,0};
+int    idx[8] = {0,1,2,3,4,5,6,7};
+__builtin_cpu_init();
+if (__builtin_cpu_supports("avx512f")) return (int)sum512(a,idx);
+if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) return (int)sum256(a,idx);
+'''
+    self.pushLanguage(self.languages.clanguage)
+    if self.checkLink(code,body):
+      self.addDefine('HAVE_X86_CPU_DISPATCH', 1)
+    self.popLanguage()
+
   def configureFunctionName(self):
     '''Sees if the compiler supports __func__ or a variant.'''
     def getFunctionName(lang):
@@ -921,6 +951,7 @@ char assert_aligned[(sizeof(struct mystruct)==16)*2-1];
     self.executeTest(self.configureIsatty)
     self.executeTest(self.configureExpect);
     self.executeTest(self.configureAlign);
+    self.executeTest(self.configureCPUDispatch);
     self.executeTest(self.configureFunctionName);
     self.executeTest(self.configureIntptrt);
     self.executeTest(self.configureSolaris)
@@ -30,6 +30,7 @@
 #define KSPPIPECG 'pipecg'
 #define KSPPIPECGRR 'pipecgrr'
 #define KSPPIPELCG 'pipelcg'
+#define KSPSCG 'scg'
 #define KSPCGNE 'cgne'
 #define KSPNASH 'nash'
 #define KSPSTCG 'stcg'
@@ -42,6 +43,7 @@
 #define KSPLGMRES 'lgmres'
 #define KSPDGMRES 'dgmres'
 #define KSPPGMRES 'pgmres'
+#define KSPSGMRES 'sgmres'
 #define KSPTCQMR 'tcqmr'
 #define KSPBCGS 'bcgs'
 #define KSPIBCGS 'ibcgs'
@@ -67,6 +69,8 @@
 #define KSPCGLS 'cgls'
 #define KSPFETIDP 'fetidp'
 #define KSPHPDDM 'hpddm'
+#define KSPIR 'ir'
+#define KSPGCRODR 'gcrodr'
 !
 !  Various Initial guesses for Krylov subspace methods
 !
@@ -98,6 +98,9 @@
 #define MATAIJSELL         'aijsell'
 #define MATSEQAIJSELL      'seqaijsell'
 #define MATMPIAIJSELL      'mpiaijsell'
+#define MATAIJSINGLE       'aijsingle'
+#define MATSEQAIJSINGLE    'seqaijsingle'
+#define MATMPIAIJSINGLE    'mpiaijsingle'
 #define MATAIJMKL          'aijmkl'
 #define MATSEQAIJMKL       'seqaijmkl'
 #define MATMPIAIJMKL       'mpiaijmkl'
@@ -179,6 +182,7 @@
 #define MATSOLVERMATLAB          'matlab'
 #define MATSOLVERPETSC           'petsc'
 #define MATSOLVERBAS             'bas'
+#define MATSOLVERCHOWILU         'chowilu'
 #define MATSOLVERCUSPARSE        'cusparse'
 #define MATSOLVERCUDA            'cuda'
 
@@ -346,6 +346,22 @@ struct _MatStash {
   MPI_Datatype   blocktype;
   size_t         blocktype_size;
   InsertMode     *insertmode;   /* Pointer to check mat->insertmode and set upon message arrival in case no local values have been set. */
+
+  /* The following variables are used for streaming communication (-matstash_stream) */
+  PetscInt       stream;          /* Flush the stash to its owners once it holds this many blocks */
+  PetscMPIInt    tag_stream;
+  PetscMPIInt    *streamsent;     /* [size] number of segments sent to each rank since the last assembly */
+  PetscMPIInt    *streamrecvd;    /* [size] number of segments already merged from each rank */
+  PetscInt       nstreamreqs,maxstreamreqs;
+  MPI_Request    *streamreqs;     /* Pending segment sends */
+  PetscInt       nstreambufs,maxstreambufs;
+  char           **streambufs;    /* Send buffers, one per flush, freed in MatStashScatterEnd_Private() */
+  char           *streamrecvbuf;  /* Receive buffer for one segment */
+  PetscMPIInt    streamrecvmax;   /* Capacity of streamrecvbuf in blocks */
+  PetscMPIInt    nstreamfrom;     /* Number of ranks that still owe us segments during MatStashScatterGetMesg_Private() */
+  PetscMPIInt    *streamfrom;
+  PetscMPIInt    *streamleft;     /* Number of segments still owed by each of streamfrom[] */
+  PetscMPIInt    streamfrom_i;
 };
 
 #if !defined(PETSC_HAVE_MPIUNI)
@@ -362,6 +378,7 @@ PETSC_INTERN PetscErrorCode MatStashValuesRowBlocked_Private(MatStash*,PetscInt,
 PETSC_INTERN PetscErrorCode MatStashValuesColBlocked_Private(MatStash*,PetscInt,PetscInt,const PetscInt[],const PetscScalar[],PetscInt,PetscInt,PetscInt);
 PETSC_INTERN PetscErrorCode MatStashScatterBegin_Private(Mat,MatStash*,PetscInt*);
 PETSC_INTERN PetscErrorCode MatStashScatterGetMesg_Private(MatStash*,PetscMPIInt*,PetscInt**,PetscInt**,PetscScalar**,PetscInt*);
+PETSC_INTERN PetscErrorCode MatStashStreamFlush_Private(Mat,MatStash*,PetscInt*);
 PETSC_INTERN PetscErrorCode MatGetInfo_External(Mat,MatInfoType,MatInfo*);
 
 typedef struct {
@@ -1750,6 +1767,7 @@ PETSC_EXTERN PetscLogEvent MAT_DenseCopyFromGPU;
 PETSC_EXTERN PetscLogEvent MAT_Merge;
 PETSC_EXTERN PetscLogEvent MAT_Residual;
 PETSC_EXTERN PetscLogEvent MAT_SetRandom;
+PETSC_EXTERN PetscLogEvent MAT_Autotune;
 PETSC_EXTERN PetscLogEvent MAT_FactorFactS;
 PETSC_EXTERN PetscLogEvent MAT_FactorInvS;
 PETSC_EXTERN PetscLogEvent MATCOLORING_Apply;
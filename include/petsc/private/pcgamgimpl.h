@@ -51,6 +51,8 @@ typedef struct gamg_TAG {
   PetscInt   esteig_max_it;
   PetscInt   use_sa_esteig;
   PetscReal  emin,emax;
+  PetscInt   esteig_refresh_its;                   /* power iterations to update the Chebyshev bounds when reusing the interpolation */
+  Vec        esteig_vec[PETSC_MG_MAXLEVELS];       /* approximate eigenvectors of the smoothers from the previous update */
 } PC_GAMG;
 
 PetscErrorCode PCReset_MG(PC);
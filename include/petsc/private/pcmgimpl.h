@@ -17,6 +17,9 @@ typedef struct {
   Vec      b;                                  /* Right hand side */
   Vec      x;                                  /* Solution */
   Vec      r;                                  /* Residual */
+  Mat      sinterpolate;                       /* smoothed interpolation (I - D^{-1} A) P of the mult-additive cycle */
+  Vec      dinv;                               /* D^{-1}, when the mult-additive cycle applies P followed by the Jacobi step */
+  Vec      z;                                  /* work vector of that Jacobi step */
 
   PetscErrorCode (*residual)(Mat,Vec,Vec,Vec);
 
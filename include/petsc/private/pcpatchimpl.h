@@ -98,8 +98,15 @@ typedef struct {
   IS                   iterationSet;       /* Index set specifying how we iterate over patches */
   PetscInt             currentPatch;       /* The current patch number when iterating */
   PetscObject         *solver;             /* Solvers for each patch TODO Do we need a new KSP for each patch? */
-  PetscBool            denseinverse;       /* Should the patch inverse by applied by computing the inverse and a matmult? (Skips KSP/PC etc...) */
-  PetscErrorCode      (*densesolve)(Mat, Vec, Vec); /* Matmult for dense solve (used with denseinverse) */
+  PetscBool            denseinverse;       /* Should the patch inverse be formed explicitly and applied directly? (Skips KSP/PC etc...) */
+  PetscInt             ndensebatch;        /* Number of batches of equally sized patches (used with denseinverse) */
+  PetscInt            *densebatchDim;      /* [batch] Number of dofs of each patch in the batch */
+  PetscInt            *densebatchStart;    /* [batch] Start of the batch in densebatchPatches, densebatchStart[ndensebatch] is the end */
+  PetscInt            *densebatchPatches;  /* Patch numbers sorted by size */
+  PetscInt            *denseInvOffset;     /* [patch] Offset of the patch inverse in denseInv (-1 for empty patches) */
+  PetscInt            *denseVecOffset;     /* [patch] Offset of the patch vector in denseRHS and denseUpdate */
+  PetscScalar         *denseInv;           /* Packed column-major patch operators, inverted in place; patches of the same size are contiguous */
+  PetscScalar         *denseRHS, *denseUpdate; /* Packed right hand sides and updates for all patches */
   PetscErrorCode     (*setupsolver)(PC);
   PetscErrorCode     (*applysolver)(PC, PetscInt, Vec, Vec);
   PetscErrorCode     (*resetsolver)(PC);
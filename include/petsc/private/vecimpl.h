@@ -96,6 +96,7 @@ struct _VecOps {
   PetscErrorCode (*bindtocpu)(Vec,PetscBool);
   PetscErrorCode (*getarraywrite)(Vec,PetscScalar**);
   PetscErrorCode (*restorearraywrite)(Vec,PetscScalar**);
+  PetscErrorCode (*axpydotnorm2)(Vec,PetscScalar,Vec,Vec,PetscScalar*,PetscReal*); /* y = y + alpha * x, dp = z^H y, nm = y^H y */
 };
 
 /*
@@ -179,6 +180,7 @@ PETSC_EXTERN PetscLogEvent VEC_ReduceEnd;
 PETSC_EXTERN PetscLogEvent VEC_Swap;
 PETSC_EXTERN PetscLogEvent VEC_AssemblyBegin;
 PETSC_EXTERN PetscLogEvent VEC_DotNorm2;
+PETSC_EXTERN PetscLogEvent VEC_AXPYDotNorm2;
 PETSC_EXTERN PetscLogEvent VEC_AXPBYPCZ;
 PETSC_EXTERN PetscLogEvent VEC_Ops;
 PETSC_EXTERN PetscLogEvent VEC_ViennaCLCopyToGPU;
@@ -253,13 +253,17 @@ typedef const char *PCGAMGClassicalType;
             to the next, performs a cycle etc. This is much like the F-cycle presented in "Multigrid" by Trottenberg, Oosterlee, Schuller page 49, but that
             algorithm supports smoothing on before the restriction on each level in the initial restriction to the coarsest stage. In addition that algorithm
             calls the V-cycle only on the coarser level and has a post-smoother instead.
--  PC_MG_KASKADE - like full multigrid except one never goes back to a coarser level
+.  PC_MG_KASKADE - like full multigrid except one never goes back to a coarser level
                from a finer
+-  PC_MG_MULTADD - the additive form of the multiplicative V cycle, the right hand side is restricted and the
+               corrections are interpolated with the smoothed interpolation Pbar = (I - D^{-1} A) P, D being
+               the l1 row sums of A, and each level is pre and post smoothed without waiting for the others;
+               it usually needs more iterations than PC_MG_MULTIPLICATIVE
 
 .seealso: PCMGSetType(), PCMGSetCycleType(), PCMGSetCycleTypeOnLevel()
 
 E*/
-typedef enum { PC_MG_MULTIPLICATIVE,PC_MG_ADDITIVE,PC_MG_FULL,PC_MG_KASKADE } PCMGType;
+typedef enum { PC_MG_MULTIPLICATIVE,PC_MG_ADDITIVE,PC_MG_FULL,PC_MG_KASKADE,PC_MG_MULTADD } PCMGType;
 #define PC_MG_CASCADE PC_MG_KASKADE;
 
 /*E
@@ -85,6 +85,7 @@
       PetscEnum, parameter :: PC_MG_ADDITIVE=1
       PetscEnum, parameter :: PC_MG_FULL=2
       PetscEnum, parameter :: PC_MG_KASKADE=3
+      PetscEnum, parameter :: PC_MG_MULTADD=4
       PetscEnum, parameter :: PC_MG_CASCADE=3
 
 ! PCMGCycleType
@@ -3,10 +3,16 @@
 
 PetscErrorCode KSPSetFromOptions_BCGS(PetscOptionItems *PetscOptionsObject,KSP ksp)
 {
+  KSP_BCGS       *bcgs = (KSP_BCGS*)ksp->data;
   PetscErrorCode ierr;
+  PetscBool      isbcgs;
 
   PetscFunctionBegin;
   ierr = PetscOptionsHead(PetscOptionsObject,"KSP BCGS Options");CHKERRQ(ierr);
+  ierr = PetscObjectTypeCompare((PetscObject)ksp,KSPBCGS,&isbcgs);CHKERRQ(ierr);
+  if (isbcgs) {
+    ierr = PetscOptionsBool("-ksp_bcgs_fused","Merge the residual update with its norm and the next inner product into a single sweep","None",bcgs->fused,&bcgs->fused,NULL);CHKERRQ(ierr);
+  }
   ierr = PetscOptionsTail();CHKERRQ(ierr);
   PetscFunctionReturn(0);
 }
@@ -25,8 +31,8 @@ PetscErrorCode KSPSolve_BCGS(KSP ksp)
 {
   PetscErrorCode ierr;
   PetscInt       i;
-  PetscScalar    rho,rhoold,alpha,beta,omega,omegaold,d1;
-  Vec            X,B,V,P,R,RP,T,S;
+  PetscScalar    rho,rhoold,rhonext = 0.0,alpha,beta,omega,omegaold,d1;
+  Vec            X,B,V,P,R,RP,T,S,tmp;
   PetscReal      dp    = 0.0,d2;
   KSP_BCGS       *bcgs = (KSP_BCGS*)ksp->data;
 
@@ -82,7 +88,10 @@ PetscErrorCode KSPSolve_BCGS(KSP ksp)
 
   i=0;
   do {
-    ierr = VecDot(R,RP,&rho);CHKERRQ(ierr);       /*   rho <- (r,rp)      */
+    if (bcgs->fused && i) rho = rhonext;           /*   rho <- (r,rp) was computed with r */
+    else {
+      ierr = VecDot(R,RP,&rho);CHKERRQ(ierr);     /*   rho <- (r,rp)      */
+    }
     beta = (rho/rhoold) * (alpha/omegaold);
     ierr = VecAXPBYPCZ(P,1.0,-omegaold*beta,beta,R,V);CHKERRQ(ierr);  /* p <- r - omega * beta* v + beta * p */
     ierr = KSP_PCApplyBAorAB(ksp,P,V,T);CHKERRQ(ierr);  /*   v <- K p           */
@@ -119,10 +128,20 @@ PetscErrorCode KSPSolve_BCGS(KSP ksp)
     }
     omega = d1 / d2;                               /*   w <- (t's) / (t't) */
     ierr  = VecAXPBYPCZ(X,alpha,omega,1.0,P,S);CHKERRQ(ierr); /* x <- alpha * p + omega * s + x */
-    ierr  = VecWAXPY(R,-omega,T,S);CHKERRQ(ierr);     /*   r <- s - w t       */
-    if (ksp->normtype != KSP_NORM_NONE && ksp->chknorm < i+2) {
-      ierr = VecNorm(R,NORM_2,&dp);CHKERRQ(ierr);
-      KSPCheckNorm(ksp,dp);
+    if (bcgs->fused) {
+      /* update s in place and let it be the new r, the old r is the next s */
+      ierr = VecAXPYDotNorm2(S,-omega,T,RP,&rhonext,&d2);CHKERRQ(ierr); /* r <- s - w t, (r,rp), r'r */
+      tmp  = R; R = S; S = tmp;
+      if (ksp->normtype != KSP_NORM_NONE && ksp->chknorm < i+2) {
+        dp = PetscSqrtReal(d2);
+        KSPCheckNorm(ksp,dp);
+      }
+    } else {
+      ierr = VecWAXPY(R,-omega,T,S);CHKERRQ(ierr);    /*   r <- s - w t       */
+      if (ksp->normtype != KSP_NORM_NONE && ksp->chknorm < i+2) {
+        ierr = VecNorm(R,NORM_2,&dp);CHKERRQ(ierr);
+        KSPCheckNorm(ksp,dp);
+      }
     }
 
     rhoold   = rho;
@@ -198,7 +217,7 @@ PetscErrorCode KSPDestroy_BCGS(KSP ksp)
      KSPBCGS - Implements the BiCGStab (Stabilized version of BiConjugate Gradient) method.
 
    Options Database Keys:
-.   see KSPSolve()
+.   -ksp_bcgs_fused - computes the new residual, its norm and the next inner product (r,rp) in a single sweep with VecAXPYDotNorm2()
 
    Level: beginner
 
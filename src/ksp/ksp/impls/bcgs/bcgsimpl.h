@@ -10,6 +10,7 @@
 
 typedef struct {
   Vec guess;   /* if using right preconditioning with nonzero initial guess must keep that around to "fix" solution */
+  PetscBool fused;  /* KSPBCGS only: merge the residual update with its norm and the next inner product */
 } KSP_BCGS;
 
 PETSC_INTERN PetscErrorCode KSPSetFromOptions_BCGS(PetscOptionItems *PetscOptionsObject,KSP);
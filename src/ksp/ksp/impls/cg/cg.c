@@ -42,6 +42,7 @@
     data used during the optional Lanczo process used to compute eigenvalues
 */
 #include <../src/ksp/ksp/impls/cg/cgimpl.h>       /*I "petscksp.h" I*/
+#include <petscblaslapack.h>
 extern PetscErrorCode KSPComputeExtremeSingularValues_CG(KSP,PetscReal*,PetscReal*);
 extern PetscErrorCode KSPComputeEigenvalues_CG(KSP,PetscInt,PetscReal*,PetscReal*,PetscInt*);
 
@@ -97,11 +98,11 @@ static PetscErrorCode KSPSolve_CG(KSP ksp)
   PetscErrorCode ierr;
   PetscInt       i,stored_max_it,eigs;
   PetscScalar    dpi = 0.0,a = 1.0,beta,betaold = 1.0,b = 0,*e = 0,*d = 0,dpiold;
-  PetscReal      dp  = 0.0;
+  PetscReal      dp  = 0.0,dp2;
   Vec            X,B,Z,R,P,W;
   KSP_CG         *cg;
   Mat            Amat,Pmat;
-  PetscBool      diagonalscale;
+  PetscBool      diagonalscale,fusedot,havebeta = PETSC_FALSE;
 
   PetscFunctionBegin;
   ierr = PCGetDiagonalScale(ksp->pc,&diagonalscale);CHKERRQ(ierr);
@@ -116,6 +117,12 @@ static PetscErrorCode KSPSolve_CG(KSP ksp)
   Z             = ksp->work[1];
   P             = ksp->work[2];
   W             = Z;
+  /* with -ksp_cg_fused beta <- z'*r is computed with ||z|| by VecDotNorm2(), which conjugates as the Hermitian inner product does */
+#if defined(PETSC_USE_COMPLEX)
+  fusedot       = (PetscBool)(cg->fused && cg->type == KSP_CG_HERMITIAN);
+#else
+  fusedot       = cg->fused;
+#endif
 
   if (eigs) {e = cg->e; d = cg->d; e[0] = 0.0; }
   ierr = PCGetOperators(ksp->pc,&Amat,&Pmat);CHKERRQ(ierr);
@@ -131,7 +138,14 @@ static PetscErrorCode KSPSolve_CG(KSP ksp)
   switch (ksp->normtype) {
     case KSP_NORM_PRECONDITIONED:
       ierr = KSP_PCApply(ksp,R,Z);CHKERRQ(ierr);               /*    z <- Br                           */
-      ierr = VecNorm(Z,NORM_2,&dp);CHKERRQ(ierr);              /*    dp <- z'*z = e'*A'*B'*B*A*e       */
+      if (fusedot) {
+        ierr     = VecDotNorm2(R,Z,&beta,&dp2);CHKERRQ(ierr);  /*    beta <- z'*r, dp <- z'*z          */
+        beta     = PetscConj(beta);
+        dp       = PetscSqrtReal(dp2);
+        havebeta = PETSC_TRUE;
+      } else {
+        ierr = VecNorm(Z,NORM_2,&dp);CHKERRQ(ierr);            /*    dp <- z'*z = e'*A'*B'*B*A*e       */
+      }
       KSPCheckNorm(ksp,dp);
       break;
     case KSP_NORM_UNPRECONDITIONED:
@@ -160,7 +174,9 @@ static PetscErrorCode KSPSolve_CG(KSP ksp)
     ierr = KSP_PCApply(ksp,R,Z);CHKERRQ(ierr);                /*     z <- Br                           */
   }
   if (ksp->normtype != KSP_NORM_NATURAL) {
-    ierr = VecXDot(Z,R,&beta);CHKERRQ(ierr);                  /*     beta <- z'*r                      */
+    if (!havebeta) {
+      ierr = VecXDot(Z,R,&beta);CHKERRQ(ierr);                /*     beta <- z'*r                      */
+    }
     KSPCheckDot(ksp,beta);
   }
 
@@ -205,14 +221,30 @@ static PetscErrorCode KSPSolve_CG(KSP ksp)
     a = beta/dpi;                                              /*     a = beta/p'w                     */
     if (eigs) d[i] = PetscSqrtReal(PetscAbsScalar(b))*e[i] + 1.0/a;
     ierr = VecAXPY(X,a,P);CHKERRQ(ierr);                       /*     x <- x + ap                      */
-    ierr = VecAXPY(R,-a,W);CHKERRQ(ierr);                      /*     r <- r - aw                      */
+    havebeta = PETSC_FALSE;
+    if (cg->fused && ksp->normtype == KSP_NORM_UNPRECONDITIONED && ksp->chknorm < i+2) {
+      ierr = VecAXPYDotNorm2(R,-a,W,NULL,NULL,&dp2);CHKERRQ(ierr); /* r <- r - aw, dp <- r'*r            */
+      dp   = PetscSqrtReal(dp2);
+      KSPCheckNorm(ksp,dp);
+    } else {
+      ierr = VecAXPY(R,-a,W);CHKERRQ(ierr);                    /*     r <- r - aw                      */
+    }
     if (ksp->normtype == KSP_NORM_PRECONDITIONED && ksp->chknorm < i+2) {
       ierr = KSP_PCApply(ksp,R,Z);CHKERRQ(ierr);               /*     z <- Br                          */
-      ierr = VecNorm(Z,NORM_2,&dp);CHKERRQ(ierr);              /*     dp <- z'*z                       */
+      if (fusedot) {
+        ierr     = VecDotNorm2(R,Z,&beta,&dp2);CHKERRQ(ierr);  /*     beta <- z'*r, dp <- z'*z         */
+        beta     = PetscConj(beta);
+        dp       = PetscSqrtReal(dp2);
+        havebeta = PETSC_TRUE;
+      } else {
+        ierr = VecNorm(Z,NORM_2,&dp);CHKERRQ(ierr);            /*     dp <- z'*z                       */
+      }
       KSPCheckNorm(ksp,dp);
     } else if (ksp->normtype == KSP_NORM_UNPRECONDITIONED && ksp->chknorm < i+2) {
-      ierr = VecNorm(R,NORM_2,&dp);CHKERRQ(ierr);              /*     dp <- r'*r                       */
-      KSPCheckNorm(ksp,dp);
+      if (!cg->fused) {
+        ierr = VecNorm(R,NORM_2,&dp);CHKERRQ(ierr);            /*     dp <- r'*r                       */
+        KSPCheckNorm(ksp,dp);
+      }
     } else if (ksp->normtype == KSP_NORM_NATURAL) {
       ierr = KSP_PCApply(ksp,R,Z);CHKERRQ(ierr);               /*     z <- Br                          */
       ierr = VecXDot(Z,R,&beta);CHKERRQ(ierr);                 /*     beta <- r'*z                     */
@@ -232,7 +264,9 @@ static PetscErrorCode KSPSolve_CG(KSP ksp)
       ierr = KSP_PCApply(ksp,R,Z);CHKERRQ(ierr);               /*     z <- Br                          */
     }
     if ((ksp->normtype != KSP_NORM_NATURAL) || (ksp->chknorm >= i+2)) {
-      ierr = VecXDot(Z,R,&beta);CHKERRQ(ierr);                 /*     beta <- z'*r                     */
+      if (!havebeta) {
+        ierr = VecXDot(Z,R,&beta);CHKERRQ(ierr);               /*     beta <- z'*r                     */
+      }
       KSPCheckDot(ksp,beta);
     }
 
@@ -419,6 +453,169 @@ static PetscErrorCode KSPSolve_CG_SingleReduction(KSP ksp)
   PetscFunctionReturn(0);
 }
 
+/*
+   KSPMatSolve_CG - Block conjugate gradient for the right hand sides stored as the columns of B (O'Leary, 1980).
+
+   The search directions are made A-orthonormal at each iteration through the eigendecomposition of P^H A P, dropping the
+   directions that are numerically dependent, so the iteration does not break down when some columns converge before the
+   others (breakdown-free block CG, Ji and Li, 2017). Each iteration needs one product of the operator with the block,
+   one PCMatApply() and two reductions, whatever the number of columns.
+*/
+static PetscErrorCode KSPMatSolve_CG(KSP ksp,Mat B,Mat X)
+{
+  PetscErrorCode ierr;
+  Mat            Amat,Pmat,R,Z,P,Q = NULL;
+  PetscInt       m,N,i,j,nd,f,ldr,ldz,ldp,ldq,ldx;
+  PetscScalar    *r,*z,*p,*q,*x,*buf,*red,*S,*tmp,*work,one = 1.0,zero = 0.0,mone = -1.0;
+  PetscReal      *nrm0,*nrm,*ev;
+  PetscBLASInt   bm,bN,bnd,bk,blr,blz,blp,blq,blx,bmt,lwork,info;
+#if defined(PETSC_USE_COMPLEX)
+  KSP_CG         *cg = (KSP_CG*)ksp->data;
+  PetscReal      *rwork;
+
+  PetscFunctionBegin;
+  if (cg->type != KSP_CG_HERMITIAN) SETERRQ(PetscObjectComm((PetscObject)ksp),PETSC_ERR_SUP,"Block CG is only available for KSP_CG_HERMITIAN");
+#else
+  PetscFunctionBegin;
+#endif
+  ierr = PCGetOperators(ksp->pc,&Amat,&Pmat);CHKERRQ(ierr);
+  ierr = MatGetLocalSize(B,&m,NULL);CHKERRQ(ierr);
+  ierr = MatGetSize(B,NULL,&N);CHKERRQ(ierr);
+  ierr = PetscBLASIntCast(m,&bm);CHKERRQ(ierr);
+  ierr = PetscBLASIntCast(PetscMax(m,1),&bmt);CHKERRQ(ierr);
+  ierr = PetscBLASIntCast(N,&bN);CHKERRQ(ierr);
+  ierr = PetscBLASIntCast(PetscMax(3*N,1),&lwork);CHKERRQ(ierr);
+  ierr = PetscMalloc6(2*N*N+N,&buf,2*N*N+N,&red,N*N,&S,m*N,&tmp,lwork,&work,3*N,&nrm0);CHKERRQ(ierr);
+  nrm = nrm0 + N;
+  ev  = nrm0 + 2*N;
+#if defined(PETSC_USE_COMPLEX)
+  ierr = PetscMalloc1(PetscMax(3*N,1),&rwork);CHKERRQ(ierr);
+#endif
+
+  ierr = MatDuplicate(B,MAT_COPY_VALUES,&R);CHKERRQ(ierr);                   /*   R <- B - A X   */
+  if (!ksp->guess_zero) {
+    ierr = KSPMatMatMult_Private(ksp,Amat,X,&Q);CHKERRQ(ierr);
+    ierr = MatAXPY(R,-1.0,Q,SAME_NONZERO_PATTERN);CHKERRQ(ierr);
+  }
+  ierr = MatGetColumnNorms(R,NORM_2,nrm0);CHKERRQ(ierr);
+  ierr = PetscObjectSAWsTakeAccess((PetscObject)ksp);CHKERRQ(ierr);
+  ksp->its = 0;
+  ierr = PetscObjectSAWsGrantAccess((PetscObject)ksp);CHKERRQ(ierr);
+  ierr = KSPMatSolveConverged_Private(ksp,N,nrm0,nrm0);CHKERRQ(ierr);
+  if (ksp->reason) {
+    ierr = MatDestroy(&R);CHKERRQ(ierr);
+    ierr = MatDestroy(&Q);CHKERRQ(ierr);
+    goto cleanup;
+  }
+  ierr = MatDuplicate(B,MAT_DO_NOT_COPY_VALUES,&Z);CHKERRQ(ierr);
+  ierr = MatDuplicate(B,MAT_DO_NOT_COPY_VALUES,&P);CHKERRQ(ierr);
+  ierr = PCMatApply(ksp->pc,R,Z);CHKERRQ(ierr);                                /*   Z <- M R       */
+  ierr = MatCopy(Z,P,SAME_NONZERO_PATTERN);CHKERRQ(ierr);                      /*   P <- Z         */
+  ierr = MatDenseGetLDA(R,&ldr);CHKERRQ(ierr);
+  ierr = MatDenseGetLDA(Z,&ldz);CHKERRQ(ierr);
+  ierr = MatDenseGetLDA(P,&ldp);CHKERRQ(ierr);
+  ierr = MatDenseGetLDA(X,&ldx);CHKERRQ(ierr);
+  ierr = PetscBLASIntCast(PetscMax(ldr,1),&blr);CHKERRQ(ierr);
+  ierr = PetscBLASIntCast(PetscMax(ldz,1),&blz);CHKERRQ(ierr);
+  ierr = PetscBLASIntCast(PetscMax(ldp,1),&blp);CHKERRQ(ierr);
+  ierr = PetscBLASIntCast(PetscMax(ldx,1),&blx);CHKERRQ(ierr);
+  nd   = N;
+
+  while (!ksp->reason) {
+    ierr = KSPMatMatMult_Private(ksp,Amat,P,&Q);CHKERRQ(ierr);                 /*   Q <- A P       */
+    ierr = MatDenseGetLDA(Q,&ldq);CHKERRQ(ierr);
+    ierr = PetscBLASIntCast(PetscMax(ldq,1),&blq);CHKERRQ(ierr);
+    ierr = PetscBLASIntCast(nd,&bnd);CHKERRQ(ierr);
+    ierr = MatDenseGetArray(R,&r);CHKERRQ(ierr);
+    ierr = MatDenseGetArray(P,&p);CHKERRQ(ierr);
+    ierr = MatDenseGetArray(Q,&q);CHKERRQ(ierr);
+    /* P^H Q and P^H R with a single reduction */
+    PetscStackCallBLAS("BLASgemm",BLASgemm_("C","N",&bnd,&bnd,&bm,&one,p,&blp,q,&blq,&zero,buf,&bnd));
+    PetscStackCallBLAS("BLASgemm",BLASgemm_("C","N",&bnd,&bN,&bm,&one,p,&blp,r,&blr,&zero,buf+nd*nd,&bnd));
+    ierr = PetscLogFlops(2.0*m*nd*(nd+N));CHKERRQ(ierr);
+    ierr = MPIU_Allreduce(buf,red,nd*(nd+N),MPIU_SCALAR,MPIU_SUM,PetscObjectComm((PetscObject)ksp));CHKERRQ(ierr);
+
+    /* P^H A P = W diag(ev) W^H, keep the directions T = W diag(ev)^{-1/2} of the eigenvalues that are not negligible */
+    ierr = PetscFPTrapPush(PETSC_FP_TRAP_OFF);CHKERRQ(ierr);
+#if defined(PETSC_USE_COMPLEX)
+    PetscStackCallBLAS("LAPACKsyev",LAPACKsyev_("V","U",&bnd,red,&bnd,ev,work,&lwork,rwork,&info));
+#else
+    PetscStackCallBLAS("LAPACKsyev",LAPACKsyev_("V","U",&bnd,red,&bnd,ev,work,&lwork,&info));
+#endif
+    ierr = PetscFPTrapPop();CHKERRQ(ierr);
+    if (info) SETERRQ1(PETSC_COMM_SELF,PETSC_ERR_LIB,"Error in LAPACK routine syev %d",(int)info);
+    if (ev[nd-1] <= 0.0) {
+      ierr = PetscInfo(ksp,"Block of search directions with no positive curvature\n");CHKERRQ(ierr);
+      ksp->reason = ev[nd-1] < 0.0 ? KSP_DIVERGED_INDEFINITE_MAT : KSP_DIVERGED_BREAKDOWN;
+      ierr = MatDenseRestoreArray(Q,&q);CHKERRQ(ierr);
+      ierr = MatDenseRestoreArray(P,&p);CHKERRQ(ierr);
+      ierr = MatDenseRestoreArray(R,&r);CHKERRQ(ierr);
+      break;
+    }
+    for (f=0; f<nd && ev[f] <= N*PETSC_MACHINE_EPSILON*ev[nd-1]; f++) ;
+    if (f) {ierr = PetscInfo2(ksp,"Dropping %D of %D search directions\n",f,nd);CHKERRQ(ierr);}
+    for (j=f; j<nd; j++) {
+      for (i=0; i<nd; i++) red[i+j*nd] /= PetscSqrtReal(ev[j]);
+    }
+    ierr = PetscBLASIntCast(nd-f,&bk);CHKERRQ(ierr);
+    /* S = T^H P^H R */
+    PetscStackCallBLAS("BLASgemm",BLASgemm_("C","N",&bk,&bN,&bnd,&one,red+f*nd,&bnd,red+nd*nd,&bnd,&zero,S,&bk));
+    /* P <- P T and Q <- Q T */
+    PetscStackCallBLAS("BLASgemm",BLASgemm_("N","N",&bm,&bk,&bnd,&one,p,&blp,red+f*nd,&bnd,&zero,tmp,&bmt));
+    for (j=0; j<nd-f; j++) {ierr = PetscArraycpy(p+j*ldp,tmp+j*m,m);CHKERRQ(ierr);}
+    PetscStackCallBLAS("BLASgemm",BLASgemm_("N","N",&bm,&bk,&bnd,&one,q,&blq,red+f*nd,&bnd,&zero,tmp,&bmt));
+    for (j=0; j<nd-f; j++) {ierr = PetscArraycpy(q+j*ldq,tmp+j*m,m);CHKERRQ(ierr);}
+    nd   = nd-f;
+    /* X <- X + P S and R <- R - Q S */
+    ierr = MatDenseGetArray(X,&x);CHKERRQ(ierr);
+    PetscStackCallBLAS("BLASgemm",BLASgemm_("N","N",&bm,&bN,&bk,&one,p,&blp,S,&bk,&one,x,&blx));
+    PetscStackCallBLAS("BLASgemm",BLASgemm_("N","N",&bm,&bN,&bk,&mone,q,&blq,S,&bk,&one,r,&blr));
+    ierr = PetscLogFlops(4.0*m*nd*(nd+f)+4.0*m*nd*N);CHKERRQ(ierr);
+    ierr = MatDenseRestoreArray(X,&x);CHKERRQ(ierr);
+    ierr = MatDenseRestoreArray(R,&r);CHKERRQ(ierr);
+    ierr = PetscObjectSAWsTakeAccess((PetscObject)ksp);CHKERRQ(ierr);
+    ksp->its++;
+    ierr = PetscObjectSAWsGrantAccess((PetscObject)ksp);CHKERRQ(ierr);
+
+    ierr = PCMatApply(ksp->pc,R,Z);CHKERRQ(ierr);                              /*   Z <- M R       */
+    /* the column norms of R and Q^H Z with a single reduction */
+    ierr = MatDenseGetArrayRead(R,(const PetscScalar**)&r);CHKERRQ(ierr);
+    ierr = MatDenseGetArray(Z,&z);CHKERRQ(ierr);
+    for (j=0; j<N; j++) {
+      buf[j] = 0.0;
+      for (i=0; i<m; i++) buf[j] += PetscConj(r[i+j*ldr])*r[i+j*ldr];
+    }
+    PetscStackCallBLAS("BLASgemm",BLASgemm_("C","N",&bk,&bN,&bm,&one,q,&blq,z,&blz,&zero,buf+N,&bk));
+    ierr = PetscLogFlops(2.0*m*N*(nd+1));CHKERRQ(ierr);
+    ierr = MatDenseRestoreArrayRead(R,(const PetscScalar**)&r);CHKERRQ(ierr);
+    ierr = MPIU_Allreduce(buf,red,N*(nd+1),MPIU_SCALAR,MPIU_SUM,PetscObjectComm((PetscObject)ksp));CHKERRQ(ierr);
+    for (j=0; j<N; j++) nrm[j] = PetscSqrtReal(PetscRealPart(red[j]));
+    ierr = KSPMatSolveConverged_Private(ksp,N,nrm0,nrm);CHKERRQ(ierr);
+    if (!ksp->reason) {
+      /* P <- Z - P Q^H Z, A-orthogonal to the previous directions */
+      for (j=0; j<N; j++) {ierr = PetscArraycpy(tmp+j*m,z+j*ldz,m);CHKERRQ(ierr);}
+      PetscStackCallBLAS("BLASgemm",BLASgemm_("N","N",&bm,&bN,&bk,&mone,p,&blp,red+N,&bk,&one,tmp,&bmt));
+      ierr = PetscLogFlops(2.0*m*N*nd);CHKERRQ(ierr);
+      for (j=0; j<N; j++) {ierr = PetscArraycpy(p+j*ldp,tmp+j*m,m);CHKERRQ(ierr);}
+      nd   = N;
+    }
+    ierr = MatDenseRestoreArray(Z,&z);CHKERRQ(ierr);
+    ierr = MatDenseRestoreArray(Q,&q);CHKERRQ(ierr);
+    ierr = MatDenseRestoreArray(P,&p);CHKERRQ(ierr);
+  }
+  ierr = MatDestroy(&R);CHKERRQ(ierr);
+  ierr = MatDestroy(&Z);CHKERRQ(ierr);
+  ierr = MatDestroy(&P);CHKERRQ(ierr);
+  ierr = MatDestroy(&Q);CHKERRQ(ierr);
+
+cleanup:
+  ierr = PetscFree6(buf,red,S,tmp,work,nrm0);CHKERRQ(ierr);
+#if defined(PETSC_USE_COMPLEX)
+  ierr = PetscFree(rwork);CHKERRQ(ierr);
+#endif
+  PetscFunctionReturn(0);
+}
+
 /*
      KSPDestroy_CG - Frees resources allocated in KSPSetup_CG and clears function
                      compositions from KSPCreate_CG. If adding your own KSP implementation,
@@ -460,6 +657,8 @@ PetscErrorCode KSPView_CG(KSP ksp,PetscViewer viewer)
 #endif
     if (cg->singlereduction) {
       ierr = PetscViewerASCIIPrintf(viewer,"  using single-reduction variant\n");CHKERRQ(ierr);
+    } else if (cg->fused) {
+      ierr = PetscViewerASCIIPrintf(viewer,"  using fused vector updates and inner products\n");CHKERRQ(ierr);
     }
   }
   PetscFunctionReturn(0);
@@ -485,6 +684,7 @@ PetscErrorCode KSPSetFromOptions_CG(PetscOptionItems *PetscOptionsObject,KSP ksp
   if (flg) {
     ierr = KSPCGUseSingleReduction(ksp,cg->singlereduction);CHKERRQ(ierr);
   }
+  ierr = PetscOptionsBool("-ksp_cg_fused","Merge the residual update and the norm, and the norm and the inner product, into single sweeps","None",cg->fused,&cg->fused,NULL);CHKERRQ(ierr);
   ierr = PetscOptionsTail();CHKERRQ(ierr);
   PetscFunctionReturn(0);
 }
@@ -536,7 +736,8 @@ static PetscErrorCode  KSPCGUseSingleReduction_CG(KSP ksp,PetscBool flg)
    Options Database Keys:
 +   -ksp_cg_type Hermitian - (for complex matrices only) indicates the matrix is Hermitian, see KSPCGSetType()
 .   -ksp_cg_type symmetric - (for complex matrices only) indicates the matrix is symmetric
--   -ksp_cg_single_reduction - performs both inner products needed in the algorithm with a single MPIU_Allreduce() call, see KSPCGUseSingleReduction()
+.   -ksp_cg_single_reduction - performs both inner products needed in the algorithm with a single MPIU_Allreduce() call, see KSPCGUseSingleReduction()
+-   -ksp_cg_fused - merges the residual update with the residual norm (VecAXPYDotNorm2()) or the preconditioned residual norm with the next inner product (VecDotNorm2()), so each vector is swept once for them
 
    Level: beginner
 
@@ -554,6 +755,9 @@ static PetscErrorCode  KSPCGUseSingleReduction_CG(KSP ksp,PetscBool flg)
    For complex numbers there are two different CG methods, one for Hermitian symmetric matrices and one for non-Hermitian symmetric matrices. Use
    KSPCGSetType() to indicate which type you are using.
 
+   KSPMatSolve() uses a block CG that shares the Krylov subspace between all the right hand sides; the convergence is monitored
+   with the largest unpreconditioned residual norm among the columns.
+
    Developer Notes:
     KSPSolve_CG() should actually query the matrix to determine if it is Hermitian symmetric or not and NOT require the user to
    indicate it to the KSP object.
@@ -593,6 +797,7 @@ PETSC_EXTERN PetscErrorCode KSPCreate_CG(KSP ksp)
   */
   ksp->ops->setup          = KSPSetUp_CG;
   ksp->ops->solve          = KSPSolve_CG;
+  ksp->ops->matsolve       = KSPMatSolve_CG;
   ksp->ops->destroy        = KSPDestroy_CG;
   ksp->ops->view           = KSPView_CG;
   ksp->ops->setfromoptions = KSPSetFromOptions_CG;
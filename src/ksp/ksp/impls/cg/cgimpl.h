@@ -34,6 +34,7 @@ typedef struct {
   PetscReal   *ee,*dd;             /* work space for Lanczos algorithm */
 
   PetscBool singlereduction;          /* use variant of CG that combines both inner products */
+  PetscBool fused;                    /* merge vector updates with the following norms and inner products */
 } KSP_CG;
 
 #endif
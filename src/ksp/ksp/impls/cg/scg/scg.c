@@ -0,0 +1,472 @@
+/*
+    s-step (communication avoiding) preconditioned conjugate gradient.
+
+    Each outer step builds 2s+1 basis vectors of the preconditioned Krylov space with s+1 columns
+    generated from the search direction and s from the preconditioned residual, together with their
+    unpreconditioned counterparts. A single block reduction computes the Gram matrix of the basis and
+    the following s CG iterations are then carried out on coordinate vectors of length 2s+1.
+*/
+#include <../src/ksp/ksp/impls/cg/cgimpl.h>       /*I "petscksp.h" I*/
+extern PetscErrorCode KSPComputeExtremeSingularValues_CG(KSP,PetscReal*,PetscReal*);
+extern PetscErrorCode KSPComputeEigenvalues_CG(KSP,PetscInt,PetscReal*,PetscReal*,PetscInt*);
+
+typedef enum {KSP_SCG_BASIS_MONOMIAL,KSP_SCG_BASIS_CHEBYSHEV} KSPSCGBasisType;
+static const char *const KSPSCGBasisTypes[] = {"monomial","chebyshev","KSPSCGBasisType","KSP_SCG_BASIS_",0};
+
+typedef struct {
+  KSP_CG          cg;            /* must be first, the Lanczos tridiagonal is shared with KSPComputeExtremeSingularValues_CG() */
+  PetscInt        s;             /* number of CG iterations per block reduction */
+  KSPSCGBasisType basis;
+  PetscReal       lmin,lmax;     /* interval used for the Chebyshev basis */
+  PetscBool       estimate;      /* interval is estimated from a warm-up phase of standard CG iterations */
+  PetscInt        nwarmup,nwarm;  /* requested and actual (default 2s) number of warm-up iterations */
+  PetscInt        nlanczos;      /* length of the Lanczos arrays in cg */
+  Vec             *Y,*Yt;        /* the basis and its unpreconditioned counterpart, Y = B Yt */
+  PetscScalar     *G,*N;         /* Gram matrices Yt'Y and (for the residual norm) Y'Y or Yt'Yt */
+  PetscScalar     *xc,*pc,*zc,*wc;
+  PetscReal       *gamma,*theta,*sigma;
+} KSP_SCG;
+
+static PetscErrorCode KSPSetUp_SCG(KSP ksp)
+{
+  KSP_SCG        *scg = (KSP_SCG*)ksp->data;
+  PetscErrorCode ierr;
+  PetscInt       s = scg->s,n = 2*s+1,nl;
+
+  PetscFunctionBegin;
+  if (s < 1) SETERRQ1(PetscObjectComm((PetscObject)ksp),PETSC_ERR_ARG_OUTOFRANGE,"Number of steps %D must be positive",s);
+  /* p, pt, z, r, four temporaries and the 2(2s-1) remaining basis vectors */
+  ierr = KSPSetWorkVecs(ksp,8+2*(n-2));CHKERRQ(ierr);
+  ierr = PetscMalloc2(n,&scg->Y,n,&scg->Yt);CHKERRQ(ierr);
+  ierr = PetscMalloc6(n*n,&scg->G,n*n,&scg->N,n,&scg->xc,n,&scg->pc,n,&scg->zc,n,&scg->wc);CHKERRQ(ierr);
+  ierr = PetscMalloc3(s,&scg->gamma,s,&scg->theta,s,&scg->sigma);CHKERRQ(ierr);
+  ierr = PetscLogObjectMemory((PetscObject)ksp,2*n*(n+2)*sizeof(PetscScalar)+3*s*sizeof(PetscReal));CHKERRQ(ierr);
+
+  scg->estimate = (PetscBool)(scg->basis == KSP_SCG_BASIS_CHEBYSHEV && scg->lmax <= scg->lmin);
+  scg->nwarm    = scg->nwarmup < 1 ? 2*s : scg->nwarmup;
+  nl = ksp->calc_sings ? ksp->max_it : (scg->estimate ? scg->nwarm : 0);
+  if (nl) {
+    /* space to store the tridiagonal matrix of the Lanczos process */
+    scg->nlanczos = nl+1;
+    ierr = PetscMalloc4(nl+1,&scg->cg.e,nl+1,&scg->cg.d,nl+1,&scg->cg.ee,nl+1,&scg->cg.dd);CHKERRQ(ierr);
+    ierr = PetscLogObjectMemory((PetscObject)ksp,2*(nl+1)*(sizeof(PetscScalar)+sizeof(PetscReal)));CHKERRQ(ierr);
+  }
+  if (ksp->calc_sings) {
+    ksp->ops->computeextremesingularvalues = KSPComputeExtremeSingularValues_CG;
+    ksp->ops->computeeigenvalues           = KSPComputeEigenvalues_CG;
+  }
+  PetscFunctionReturn(0);
+}
+
+/*
+   Coefficients of the three term recurrence A y_i = gamma_i y_{i+1} + theta_i y_i + sigma_i y_{i-1} generating the basis
+*/
+static PetscErrorCode KSPSCGSetBasisCoefficients(KSP ksp,PetscInt s)
+{
+  KSP_SCG   *scg = (KSP_SCG*)ksp->data;
+  PetscReal c,h;
+  PetscInt  i;
+
+  PetscFunctionBegin;
+  c = 0.5*(scg->lmax+scg->lmin);
+  h = 0.5*(scg->lmax-scg->lmin);
+  for (i=0; i<s; i++) {
+    if (scg->basis == KSP_SCG_BASIS_MONOMIAL || h <= 0.0) {
+      scg->gamma[i] = 1.0; scg->theta[i] = 0.0; scg->sigma[i] = 0.0;
+    } else {
+      /* scaled and shifted Chebyshev polynomials T_i((x-c)/h) */
+      scg->gamma[i] = i ? 0.5*h : h;
+      scg->theta[i] = c;
+      scg->sigma[i] = i ? 0.5*h : 0.0;
+    }
+  }
+  PetscFunctionReturn(0);
+}
+
+/*
+   Fills Y[1..m-1] and Yt[1..m-1] from Y[0] and Yt[0] = B^{-1} Y[0] with the basis recurrence
+*/
+static PetscErrorCode KSPSCGBuildChain(KSP ksp,Mat Amat,PetscInt m,Vec *Y,Vec *Yt)
+{
+  KSP_SCG        *scg = (KSP_SCG*)ksp->data;
+  PetscErrorCode ierr;
+  PetscInt       i;
+
+  PetscFunctionBegin;
+  for (i=0; i<m-1; i++) {
+    ierr = KSP_MatMult(ksp,Amat,Y[i],Yt[i+1]);CHKERRQ(ierr);
+    if (i) {
+      ierr = VecAXPBYPCZ(Yt[i+1],-scg->theta[i],-scg->sigma[i],1.0,Yt[i],Yt[i-1]);CHKERRQ(ierr);
+    } else if (scg->theta[i] != 0.0) {
+      ierr = VecAXPY(Yt[i+1],-scg->theta[i],Yt[i]);CHKERRQ(ierr);
+    }
+    if (scg->gamma[i] != 1.0) {
+      ierr = VecScale(Yt[i+1],1.0/scg->gamma[i]);CHKERRQ(ierr);
+    }
+    ierr = KSP_PCApply(ksp,Yt[i+1],Y[i+1]);CHKERRQ(ierr);
+  }
+  PetscFunctionReturn(0);
+}
+
+/* u' G v for a Hermitian n by n matrix G stored by columns */
+PETSC_STATIC_INLINE PetscScalar KSPSCGForm(PetscInt n,const PetscScalar *G,const PetscScalar *u,const PetscScalar *v)
+{
+  PetscScalar sum = 0.0,t;
+  PetscInt    a,b;
+
+  for (b=0; b<n; b++) {
+    if (v[b] == 0.0) continue;
+    t = 0.0;
+    for (a=0; a<n; a++) t += PetscConj(u[a])*G[a+b*n];
+    sum += t*v[b];
+  }
+  return sum;
+}
+
+static PetscErrorCode KSPSolve_SCG(KSP ksp)
+{
+  KSP_SCG        *scg = (KSP_SCG*)ksp->data;
+  KSP_CG         *cg = &scg->cg;
+  PetscErrorCode ierr;
+  PetscInt       i,j,k,s,n,ns,stored_max_it = ksp->max_it;
+  PetscScalar    beta,betaold = 1.0,dpi = 0.0,dpiold = 0.0,a = 1.0,b = 0.0,*e = NULL,*d = NULL;
+  PetscScalar    *G = scg->G,*N = scg->N,*xc = scg->xc,*pc = scg->pc,*zc = scg->zc,*wc = scg->wc;
+  PetscReal      dp = 0.0,emax,emin;
+  Vec            X,B,R,Z,P,Pt,*T,*W,tmp,*Y = scg->Y,*Yt = scg->Yt,*Gv;
+  Mat            Amat,Pmat;
+  PetscBool      diagonalscale,eigs,lanczos;
+
+  PetscFunctionBegin;
+  ierr = PCGetDiagonalScale(ksp->pc,&diagonalscale);CHKERRQ(ierr);
+  if (diagonalscale) SETERRQ1(PetscObjectComm((PetscObject)ksp),PETSC_ERR_SUP,"Krylov method %s does not support diagonal scaling",((PetscObject)ksp)->type_name);
+
+  eigs = ksp->calc_sings;
+  X    = ksp->vec_sol;
+  B    = ksp->vec_rhs;
+  P    = ksp->work[0];
+  Pt   = ksp->work[1];
+  Z    = ksp->work[2];
+  R    = ksp->work[3];
+  T    = ksp->work+4;
+  W    = ksp->work+8;
+  if (scg->nlanczos) {e = cg->e; d = cg->d; e[0] = 0.0; cg->ned = 0;}
+  ierr = PCGetOperators(ksp->pc,&Amat,&Pmat);CHKERRQ(ierr);
+
+  ksp->its = 0;
+  if (!ksp->guess_zero) {
+    ierr = KSP_MatMult(ksp,Amat,X,R);CHKERRQ(ierr);            /*    r <- b - Ax                       */
+    ierr = VecAYPX(R,-1.0,B);CHKERRQ(ierr);
+  } else {
+    ierr = VecCopy(B,R);CHKERRQ(ierr);                         /*    r <- b (x is 0)                   */
+  }
+  ierr = KSP_PCApply(ksp,R,Z);CHKERRQ(ierr);                   /*    z <- Br                           */
+  switch (ksp->normtype) {
+    case KSP_NORM_PRECONDITIONED:
+      ierr = VecNormBegin(Z,NORM_2,&dp);CHKERRQ(ierr);
+      ierr = VecDotBegin(Z,R,&beta);CHKERRQ(ierr);
+      ierr = VecNormEnd(Z,NORM_2,&dp);CHKERRQ(ierr);
+      ierr = VecDotEnd(Z,R,&beta);CHKERRQ(ierr);
+      break;
+    case KSP_NORM_UNPRECONDITIONED:
+      ierr = VecNormBegin(R,NORM_2,&dp);CHKERRQ(ierr);
+      ierr = VecDotBegin(Z,R,&beta);CHKERRQ(ierr);
+      ierr = VecNormEnd(R,NORM_2,&dp);CHKERRQ(ierr);
+      ierr = VecDotEnd(Z,R,&beta);CHKERRQ(ierr);
+      break;
+    case KSP_NORM_NATURAL:
+      ierr = VecDot(Z,R,&beta);CHKERRQ(ierr);
+      dp   = PetscSqrtReal(PetscAbsScalar(beta));
+      break;
+    case KSP_NORM_NONE:
+      ierr = VecDot(Z,R,&beta);CHKERRQ(ierr);
+      dp   = 0.0;
+      break;
+    default: SETERRQ1(PetscObjectComm((PetscObject)ksp),PETSC_ERR_SUP,"%s",KSPNormTypes[ksp->normtype]);
+  }
+  KSPCheckNorm(ksp,dp);
+  KSPCheckDot(ksp,beta);
+  ierr       = KSPLogResidualHistory(ksp,dp);CHKERRQ(ierr);
+  ierr       = KSPMonitor(ksp,0,dp);CHKERRQ(ierr);
+  ksp->rnorm = dp;
+  ierr = (*ksp->converged)(ksp,0,dp,&ksp->reason,ksp->cnvP);CHKERRQ(ierr);
+  if (ksp->reason) PetscFunctionReturn(0);
+  if (beta == 0.0) {
+    ksp->reason = KSP_CONVERGED_ATOL;
+    ierr        = PetscInfo(ksp,"converged due to beta = 0\n");CHKERRQ(ierr);
+    PetscFunctionReturn(0);
+  }
+  ierr = VecCopy(Z,P);CHKERRQ(ierr);                           /*    p <- z, pt <- r                   */
+  ierr = VecCopy(R,Pt);CHKERRQ(ierr);
+
+  lanczos = (PetscBool)(scg->estimate || eigs);
+  ierr = KSPSCGSetBasisCoefficients(ksp,scg->s);CHKERRQ(ierr);
+  i = 0;
+  while (!ksp->reason) {
+    /* a warm-up phase of standard CG iterations provides the interval for the Chebyshev basis */
+    s = (scg->estimate && i < scg->nwarm) ? 1 : scg->s;
+    s = PetscMin(s,ksp->max_it-i);
+    n = 2*s+1;
+    ns = s+1;
+
+    /* basis [P_0 .. P_s, Z_0 .. Z_{s-1}] with P_0 = p and Z_0 = z */
+    Y[0] = P; Yt[0] = Pt; Y[ns] = Z; Yt[ns] = R;
+    for (k=1; k<ns; k++) {Y[k] = W[2*(k-1)]; Yt[k] = W[2*(k-1)+1];}
+    for (k=ns+1; k<n; k++) {Y[k] = W[2*(k-2)]; Yt[k] = W[2*(k-2)+1];}
+    ierr = KSPSCGBuildChain(ksp,Amat,ns,Y,Yt);CHKERRQ(ierr);
+    ierr = KSPSCGBuildChain(ksp,Amat,s,Y+ns,Yt+ns);CHKERRQ(ierr);
+
+    /* the single block reduction of this outer step: upper triangles of Yt'Y and, if needed, Y'Y or Yt'Yt */
+    Gv = (ksp->normtype == KSP_NORM_UNPRECONDITIONED) ? Yt : Y;
+    for (k=0; k<n; k++) {
+      ierr = VecMDotBegin(Y[k],k+1,Yt,G+k*n);CHKERRQ(ierr);
+      if (ksp->normtype == KSP_NORM_PRECONDITIONED || ksp->normtype == KSP_NORM_UNPRECONDITIONED) {
+        ierr = VecMDotBegin(Gv[k],k+1,Gv,N+k*n);CHKERRQ(ierr);
+      }
+    }
+    for (k=0; k<n; k++) {
+      ierr = VecMDotEnd(Y[k],k+1,Yt,G+k*n);CHKERRQ(ierr);
+      if (ksp->normtype == KSP_NORM_PRECONDITIONED || ksp->normtype == KSP_NORM_UNPRECONDITIONED) {
+        ierr = VecMDotEnd(Gv[k],k+1,Gv,N+k*n);CHKERRQ(ierr);
+      }
+    }
+    for (k=0; k<n; k++) {
+      for (j=0; j<k; j++) G[k+j*n] = PetscConj(G[j+k*n]);
+    }
+    if (ksp->normtype == KSP_NORM_PRECONDITIONED || ksp->normtype == KSP_NORM_UNPRECONDITIONED) {
+      for (k=0; k<n; k++) {
+        for (j=0; j<k; j++) N[k+j*n] = PetscConj(N[j+k*n]);
+      }
+    }
+
+    /* s CG iterations on the coordinates x <- x + Y xc, p = Y pc, pt = Yt pc, z = Y zc, r = Yt zc */
+    ierr  = PetscArrayzero(xc,n);CHKERRQ(ierr);
+    ierr  = PetscArrayzero(pc,n);CHKERRQ(ierr);
+    ierr  = PetscArrayzero(zc,n);CHKERRQ(ierr);
+    pc[0] = 1.0; zc[ns] = 1.0;
+    beta  = G[ns+ns*n];
+    for (j=0; j<s; j++) {
+      ierr = PetscArrayzero(wc,n);CHKERRQ(ierr);               /*     wc <- coordinates of Ap          */
+      for (k=0; k<s; k++) {
+        wc[k+1] += scg->gamma[k]*pc[k];
+        wc[k]   += scg->theta[k]*pc[k];
+        if (k) wc[k-1] += scg->sigma[k]*pc[k];
+      }
+      for (k=0; k<s-1; k++) {
+        wc[ns+k+1] += scg->gamma[k]*pc[ns+k];
+        wc[ns+k]   += scg->theta[k]*pc[ns+k];
+        if (k) wc[ns+k-1] += scg->sigma[k]*pc[ns+k];
+      }
+      dpiold = dpi;
+      dpi    = KSPSCGForm(n,G,pc,wc);                          /*     dpi <- p'Ap                      */
+      KSPCheckDot(ksp,dpi);
+      betaold = beta;
+      if ((dpi == 0.0) || ((i > 0) && ((PetscSign(PetscRealPart(dpi))*PetscSign(PetscRealPart(dpiold))) < 0.0))) {
+        if (ksp->errorifnotconverged) SETERRQ2(PetscObjectComm((PetscObject)ksp),PETSC_ERR_NOT_CONVERGED,"Diverged due to indefinite matrix, dpi %g, dpiold %g",(double)PetscRealPart(dpi),(double)PetscRealPart(dpiold));
+        ksp->reason = KSP_DIVERGED_INDEFINITE_MAT;
+        ierr        = PetscInfo(ksp,"diverging due to indefinite or negative definite matrix\n");CHKERRQ(ierr);
+        break;
+      }
+      a = beta/dpi;                                            /*     a = beta/p'Ap                    */
+      if (lanczos && i < scg->nlanczos) d[i] = PetscSqrtReal(PetscAbsScalar(b))*e[i] + 1.0/a;
+      for (k=0; k<n; k++) {
+        xc[k] += a*pc[k];                                      /*     x <- x + ap                      */
+        zc[k] -= a*wc[k];                                      /*     z <- z - aBAp, r <- r - aAp      */
+      }
+      ksp->its = ++i;
+      beta     = KSPSCGForm(n,G,zc,zc);                        /*     beta <- z'r                      */
+      KSPCheckDot(ksp,beta);
+      switch (ksp->normtype) {
+        case KSP_NORM_PRECONDITIONED:
+        case KSP_NORM_UNPRECONDITIONED:
+          dp = PetscSqrtReal(PetscAbsScalar(KSPSCGForm(n,N,zc,zc)));
+          break;
+        case KSP_NORM_NATURAL:
+          dp = PetscSqrtReal(PetscAbsScalar(beta));
+          break;
+        default:
+          dp = 0.0;
+      }
+      ksp->rnorm = dp;
+      ierr = KSPLogResidualHistory(ksp,dp);CHKERRQ(ierr);
+      if (lanczos && i < scg->nlanczos) cg->ned = i;
+      ierr = KSPMonitor(ksp,i,dp);CHKERRQ(ierr);
+      ierr = (*ksp->converged)(ksp,i,dp,&ksp->reason,ksp->cnvP);CHKERRQ(ierr);
+      if (ksp->reason) break;
+      if (i >= ksp->max_it) {
+        ksp->reason = KSP_DIVERGED_ITS;
+        break;
+      }
+      if (beta == 0.0) {
+        ksp->reason = KSP_CONVERGED_ATOL;
+        ierr        = PetscInfo(ksp,"converged due to beta = 0\n");CHKERRQ(ierr);
+        break;
+#if !defined(PETSC_USE_COMPLEX)
+      } else if (beta*betaold < 0.0) {
+        if (ksp->errorifnotconverged) SETERRQ2(PetscObjectComm((PetscObject)ksp),PETSC_ERR_NOT_CONVERGED,"Diverged due to indefinite preconditioner, beta %g, betaold %g",(double)beta,(double)betaold);
+        ksp->reason = KSP_DIVERGED_INDEFINITE_PC;
+        ierr        = PetscInfo(ksp,"diverging due to indefinite preconditioner\n");CHKERRQ(ierr);
+        break;
+#endif
+      }
+      b = beta/betaold;
+      if (lanczos && i < scg->nlanczos) {
+        if (eigs && ksp->max_it != stored_max_it) SETERRQ(PetscObjectComm((PetscObject)ksp),PETSC_ERR_SUP,"Can not change maxit AND calculate eigenvalues");
+        e[i] = PetscSqrtReal(PetscAbsScalar(b))/a;
+      }
+      for (k=0; k<n; k++) pc[k] = zc[k] + b*pc[k];             /*     p <- z + b* p                    */
+    }
+
+    /* recover the vectors from their coordinates, swapping the results into place */
+    ierr = VecMAXPY(X,n,xc,Y);CHKERRQ(ierr);
+    if (ksp->reason) break;
+    ierr = VecSet(T[0],0.0);CHKERRQ(ierr);
+    ierr = VecSet(T[1],0.0);CHKERRQ(ierr);
+    ierr = VecSet(T[2],0.0);CHKERRQ(ierr);
+    ierr = VecSet(T[3],0.0);CHKERRQ(ierr);
+    ierr = VecMAXPY(T[0],n,pc,Y);CHKERRQ(ierr);
+    ierr = VecMAXPY(T[1],n,pc,Yt);CHKERRQ(ierr);
+    ierr = VecMAXPY(T[2],n,zc,Y);CHKERRQ(ierr);
+    ierr = VecMAXPY(T[3],n,zc,Yt);CHKERRQ(ierr);
+    tmp = P;  P  = T[0]; T[0] = tmp;
+    tmp = Pt; Pt = T[1]; T[1] = tmp;
+    tmp = Z;  Z  = T[2]; T[2] = tmp;
+    tmp = R;  R  = T[3]; T[3] = tmp;
+    ksp->work[0] = P; ksp->work[1] = Pt; ksp->work[2] = Z; ksp->work[3] = R;
+
+    if (scg->estimate && i == scg->nwarm) {
+      ierr = KSPComputeExtremeSingularValues_CG(ksp,&emax,&emin);CHKERRQ(ierr);
+      scg->lmin = emin;
+      scg->lmax = 1.1*emax;
+      ierr = PetscInfo2(ksp,"Chebyshev basis on estimated interval [%g, %g]\n",(double)scg->lmin,(double)scg->lmax);CHKERRQ(ierr);
+      ierr = KSPSCGSetBasisCoefficients(ksp,scg->s);CHKERRQ(ierr);
+      lanczos = eigs;
+    }
+  }
+  if (scg->estimate) {
+    /* the estimate is redone for every solve */
+    scg->lmin = scg->lmax = 0.0;
+  }
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode KSPReset_SCG(KSP ksp)
+{
+  KSP_SCG        *scg = (KSP_SCG*)ksp->data;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  if (scg->nlanczos) {
+    ierr = PetscFree4(scg->cg.e,scg->cg.d,scg->cg.ee,scg->cg.dd);CHKERRQ(ierr);
+    scg->nlanczos = 0;
+  }
+  ierr = PetscFree2(scg->Y,scg->Yt);CHKERRQ(ierr);
+  ierr = PetscFree6(scg->G,scg->N,scg->xc,scg->pc,scg->zc,scg->wc);CHKERRQ(ierr);
+  ierr = PetscFree3(scg->gamma,scg->theta,scg->sigma);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode KSPDestroy_SCG(KSP ksp)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = KSPReset_SCG(ksp);CHKERRQ(ierr);
+  ierr = KSPDestroyDefault(ksp);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode KSPView_SCG(KSP ksp,PetscViewer viewer)
+{
+  KSP_SCG        *scg = (KSP_SCG*)ksp->data;
+  PetscErrorCode ierr;
+  PetscBool      iascii;
+
+  PetscFunctionBegin;
+  ierr = PetscObjectTypeCompare((PetscObject)viewer,PETSCVIEWERASCII,&iascii);CHKERRQ(ierr);
+  if (iascii) {
+    ierr = PetscViewerASCIIPrintf(viewer,"  steps per reduction %D, %s basis\n",scg->s,KSPSCGBasisTypes[scg->basis]);CHKERRQ(ierr);
+    if (scg->basis == KSP_SCG_BASIS_CHEBYSHEV) {
+      if (scg->lmax > scg->lmin) {
+        ierr = PetscViewerASCIIPrintf(viewer,"  Chebyshev interval [%g, %g]\n",(double)scg->lmin,(double)scg->lmax);CHKERRQ(ierr);
+      } else {
+        ierr = PetscViewerASCIIPrintf(viewer,"  Chebyshev interval estimated from %D warm-up iterations\n",scg->nwarmup < 1 ? 2*scg->s : scg->nwarmup);CHKERRQ(ierr);
+      }
+    }
+  }
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode KSPSetFromOptions_SCG(PetscOptionItems *PetscOptionsObject,KSP ksp)
+{
+  KSP_SCG        *scg = (KSP_SCG*)ksp->data;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscOptionsHead(PetscOptionsObject,"KSP SCG options");CHKERRQ(ierr);
+  ierr = PetscOptionsInt("-ksp_scg_steps","Number of iterations per block reduction","KSPSCG",scg->s,&scg->s,NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsEnum("-ksp_scg_basis","Polynomial basis of the s-step Krylov space","KSPSCG",KSPSCGBasisTypes,(PetscEnum)scg->basis,(PetscEnum*)&scg->basis,NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsReal("-ksp_scg_lmin","Estimate for smallest eigenvalue","KSPSCG",scg->lmin,&scg->lmin,NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsReal("-ksp_scg_lmax","Estimate for largest eigenvalue","KSPSCG",scg->lmax,&scg->lmax,NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsInt("-ksp_scg_warmup","Number of CG iterations used to estimate the eigenvalue interval","KSPSCG",scg->nwarmup,&scg->nwarmup,NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsTail();CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/*MC
+     KSPSCG - s-step (communication avoiding) preconditioned conjugate gradient method.
+
+   Each block of s iterations builds 2s+1 vectors of the preconditioned Krylov space (2s-1 matrix-vector products and
+   preconditioner applications) and computes all the inner products it needs with a single block reduction; the s
+   iterations themselves only involve small dense operations. The number of global reductions is thus reduced by a factor
+   s compared to KSPCG at the price of roughly twice the number of matrix-vector products.
+
+   Options Database Keys:
++   -ksp_scg_steps <s> - number of iterations per block reduction (default 4)
+.   -ksp_scg_basis <monomial,chebyshev> - polynomial basis of the Krylov space (default chebyshev)
+.   -ksp_scg_lmin - approximation to the smallest eigenvalue of the preconditioned operator
+.   -ksp_scg_lmax - approximation to the largest eigenvalue of the preconditioned operator
+-   -ksp_scg_warmup <n> - number of standard CG iterations used to estimate lmin and lmax when they are not given (default 2s)
+
+   Level: intermediate
+
+   Notes:
+   The Chebyshev basis keeps the basis well conditioned for larger s; the monomial basis should only be used with small s.
+   The KSP_NORM_NATURAL norm is the default, the KSP_NORM_PRECONDITIONED and KSP_NORM_UNPRECONDITIONED norms require an
+   additional Gram matrix in the same reduction. Only left preconditioning is supported and the operator and
+   preconditioner must be symmetric (Hermitian) positive definite.
+
+   References:
++   1. - A. T. Chronopoulos and C. W. Gear, "s-step iterative methods for symmetric linear systems",
+   J. Comput. Appl. Math. 25, 1989.
+-   2. - E. Carson, "Communication-avoiding Krylov subspace methods in theory and practice", PhD thesis, UC Berkeley, 2015.
+
+.seealso:  KSPCreate(), KSPSetType(), KSPType (for list of available types), KSPCG, KSPPIPECG, KSPPIPELCG, KSPSGMRES
+M*/
+PETSC_EXTERN PetscErrorCode KSPCreate_SCG(KSP ksp)
+{
+  PetscErrorCode ierr;
+  KSP_SCG        *scg;
+
+  PetscFunctionBegin;
+  ierr = PetscNewLog(ksp,&scg);CHKERRQ(ierr);
+  scg->cg.type = KSP_CG_HERMITIAN;
+  scg->s       = 4;
+  scg->basis   = KSP_SCG_BASIS_CHEBYSHEV;
+  scg->nwarmup = -1;
+  ksp->data    = (void*)scg;
+
+  ierr = KSPSetSupportedNorm(ksp,KSP_NORM_NATURAL,PC_LEFT,3);CHKERRQ(ierr);
+  ierr = KSPSetSupportedNorm(ksp,KSP_NORM_PRECONDITIONED,PC_LEFT,2);CHKERRQ(ierr);
+  ierr = KSPSetSupportedNorm(ksp,KSP_NORM_UNPRECONDITIONED,PC_LEFT,2);CHKERRQ(ierr);
+  ierr = KSPSetSupportedNorm(ksp,KSP_NORM_NONE,PC_LEFT,1);CHKERRQ(ierr);
+
+  ksp->ops->setup          = KSPSetUp_SCG;
+  ksp->ops->solve          = KSPSolve_SCG;
+  ksp->ops->reset          = KSPReset_SCG;
+  ksp->ops->destroy        = KSPDestroy_SCG;
+  ksp->ops->view           = KSPView_SCG;
+  ksp->ops->setfromoptions = KSPSetFromOptions_SCG;
+  ksp->ops->buildsolution  = KSPBuildSolutionDefault;
+  ksp->ops->buildresidual  = KSPBuildResidualDefault;
+  PetscFunctionReturn(0);
+}
@@ -1,6 +1,10 @@
 
 #include <petsc/private/kspimpl.h>
 
+typedef struct {
+  PetscBool fused;     /* compute (RT,ART) and ||RT|| in one sweep with VecDotNorm2() */
+} KSP_CR;
+
 static PetscErrorCode KSPSetUp_CR(KSP ksp)
 {
   PetscErrorCode ierr;
@@ -21,6 +25,8 @@ static PetscErrorCode  KSPSolve_CR(KSP ksp)
   PetscScalar    apq,btop, bbot;
   Vec            X,B,R,RT,P,AP,ART,Q;
   Mat            Amat, Pmat;
+  KSP_CR         *cr = (KSP_CR*)ksp->data;
+  PetscBool      fused;
 
   PetscFunctionBegin;
   X   = ksp->vec_sol;
@@ -33,6 +39,7 @@ static PetscErrorCode  KSPSolve_CR(KSP ksp)
   Q   = ksp->work[5];
 
   /* R is the true residual norm, RT is the preconditioned residual norm */
+  fused = (PetscBool)(cr->fused && ksp->normtype == KSP_NORM_PRECONDITIONED);
   ierr = PCGetOperators(ksp->pc,&Amat,&Pmat);CHKERRQ(ierr);
   if (!ksp->guess_zero) {
     ierr = KSP_MatMult(ksp,Amat,X,R);CHKERRQ(ierr);     /*   R <- A*X           */
@@ -44,12 +51,20 @@ static PetscErrorCode  KSPSolve_CR(KSP ksp)
   ierr = KSP_MatMult(ksp,Amat,P,AP);CHKERRQ(ierr);      /*   AP  <- A*P         */
   ierr = VecCopy(P,RT);CHKERRQ(ierr);                   /*   RT  <- P           */
   ierr = VecCopy(AP,ART);CHKERRQ(ierr);                 /*   ART <- AP          */
-  ierr = VecDotBegin(RT,ART,&btop);CHKERRQ(ierr);          /*   (RT,ART)           */
+  if (!fused) {
+    ierr = VecDotBegin(RT,ART,&btop);CHKERRQ(ierr);        /*   (RT,ART)           */
+  }
 
   if (ksp->normtype == KSP_NORM_PRECONDITIONED) {
-    ierr = VecNormBegin(RT,NORM_2,&dp);CHKERRQ(ierr);        /*   dp <- RT'*RT       */
-    ierr = VecDotEnd   (RT,ART,&btop);CHKERRQ(ierr);           /*   (RT,ART)           */
-    ierr = VecNormEnd  (RT,NORM_2,&dp);CHKERRQ(ierr);        /*   dp <- RT'*RT       */
+    if (fused) {
+      ierr = VecDotNorm2(ART,RT,&btop,&dp);CHKERRQ(ierr);    /*   (RT,ART), dp <- RT'*RT */
+      btop = PetscConj(btop);
+      dp   = PetscSqrtReal(dp);
+    } else {
+      ierr = VecNormBegin(RT,NORM_2,&dp);CHKERRQ(ierr);      /*   dp <- RT'*RT       */
+      ierr = VecDotEnd   (RT,ART,&btop);CHKERRQ(ierr);         /*   (RT,ART)           */
+      ierr = VecNormEnd  (RT,NORM_2,&dp);CHKERRQ(ierr);      /*   dp <- RT'*RT       */
+    }
     KSPCheckNorm(ksp,dp);
   } else if (ksp->normtype == KSP_NORM_NONE) {
       dp   = 0.0; /* meaningless value that is passed to monitor and convergence test */
@@ -94,12 +109,20 @@ static PetscErrorCode  KSPSolve_CR(KSP ksp)
     ierr = VecAXPY(RT,-ai,Q);CHKERRQ(ierr);             /*   RT  <- RT - ai*Q    */
     ierr = KSP_MatMult(ksp,Amat,RT,ART);CHKERRQ(ierr);  /*   ART <-   A*RT       */
     bbot = btop;
-    ierr = VecDotBegin(RT,ART,&btop);CHKERRQ(ierr);
+    if (!fused) {
+      ierr = VecDotBegin(RT,ART,&btop);CHKERRQ(ierr);
+    }
 
     if (ksp->normtype == KSP_NORM_PRECONDITIONED) {
-      ierr = VecNormBegin(RT,NORM_2,&dp);CHKERRQ(ierr);      /*   dp <- || RT ||      */
-      ierr = VecDotEnd   (RT,ART,&btop);CHKERRQ(ierr);
-      ierr = VecNormEnd  (RT,NORM_2,&dp);CHKERRQ(ierr);      /*   dp <- || RT ||      */
+      if (fused) {
+        ierr = VecDotNorm2(ART,RT,&btop,&dp);CHKERRQ(ierr);  /*   (RT,ART), dp <- RT'*RT */
+        btop = PetscConj(btop);
+        dp   = PetscSqrtReal(dp);
+      } else {
+        ierr = VecNormBegin(RT,NORM_2,&dp);CHKERRQ(ierr);    /*   dp <- || RT ||      */
+        ierr = VecDotEnd   (RT,ART,&btop);CHKERRQ(ierr);
+        ierr = VecNormEnd  (RT,NORM_2,&dp);CHKERRQ(ierr);    /*   dp <- || RT ||      */
+      }
       KSPCheckNorm(ksp,dp);
     } else if (ksp->normtype == KSP_NORM_NATURAL) {
       ierr = VecDotEnd(RT,ART,&btop);CHKERRQ(ierr);
@@ -140,11 +163,23 @@ static PetscErrorCode  KSPSolve_CR(KSP ksp)
 }
 
 
+static PetscErrorCode KSPSetFromOptions_CR(PetscOptionItems *PetscOptionsObject,KSP ksp)
+{
+  KSP_CR         *cr = (KSP_CR*)ksp->data;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscOptionsHead(PetscOptionsObject,"KSP CR options");CHKERRQ(ierr);
+  ierr = PetscOptionsBool("-ksp_cr_fused","Compute the preconditioned residual norm and (RT,ART) in a single sweep","None",cr->fused,&cr->fused,NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsTail();CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
 /*MC
      KSPCR - This code implements the (preconditioned) conjugate residuals method
 
    Options Database Keys:
-.   see KSPSolve()
+.   -ksp_cr_fused - with the preconditioned norm, computes ||RT|| and (RT,ART) in one sweep over both vectors with VecDotNorm2()
 
    Level: beginner
 
@@ -162,8 +197,12 @@ M*/
 PETSC_EXTERN PetscErrorCode KSPCreate_CR(KSP ksp)
 {
   PetscErrorCode ierr;
+  KSP_CR         *cr;
 
   PetscFunctionBegin;
+  ierr      = PetscNewLog(ksp,&cr);CHKERRQ(ierr);
+  ksp->data = (void*)cr;
+
   ierr = KSPSetSupportedNorm(ksp,KSP_NORM_PRECONDITIONED,PC_LEFT,3);CHKERRQ(ierr);
   ierr = KSPSetSupportedNorm(ksp,KSP_NORM_UNPRECONDITIONED,PC_LEFT,2);CHKERRQ(ierr);
   ierr = KSPSetSupportedNorm(ksp,KSP_NORM_NATURAL,PC_LEFT,2);CHKERRQ(ierr);
@@ -174,7 +213,7 @@ PETSC_EXTERN PetscErrorCode KSPCreate_CR(KSP ksp)
   ksp->ops->destroy        = KSPDestroyDefault;
   ksp->ops->buildsolution  = KSPBuildSolutionDefault;
   ksp->ops->buildresidual  = KSPBuildResidualDefault;
-  ksp->ops->setfromoptions = 0;
+  ksp->ops->setfromoptions = KSPSetFromOptions_CR;
   ksp->ops->view           = 0;
   PetscFunctionReturn(0);
 }
@@ -0,0 +1,677 @@
+/*
+    GCRO-DR: GMRES with deflated restarting, the recycled subspace is kept between successive solves
+*/
+#include <petsc/private/kspimpl.h>     /*I "petscksp.h" I*/
+#include <petscblaslapack.h>
+
+typedef struct {
+  PetscInt         m;                 /* dimension of the augmented subspace of each cycle */
+  PetscInt         k;                 /* requested dimension of the recycled subspace */
+  PetscInt         nrec;              /* current dimension of the recycled subspace */
+  Vec              *V,*Z;             /* Arnoldi basis of (I - C C^H) A M^{-1} and the preconditioned basis, Z = M^{-1} V */
+  Vec              *U,*C;             /* recycled subspace: A U = C and C^H C = I */
+  Vec              *Unew,*Cnew;       /* space for the next recycled subspace */
+  Vec              *Y,*W;             /* pointers to [U Z] and [C V] */
+  PetscScalar      *H;                /* Hessenberg matrix of the cycle, (m+1) x m */
+  PetscScalar      *Hr;               /* H reduced to triangular form by the Givens rotations */
+  PetscScalar      *B;                /* C^H A Z, k x m */
+  PetscScalar      *rs,*cs,*sn,*y,*dots;
+  PetscReal        haptol;
+  Mat              Amat;              /* operator C was computed with */
+  PetscObjectState Astate;
+  PetscInt         it;                /* number of Arnoldi steps of the current cycle */
+  Vec              sol_temp;          /* used by KSPBuildSolution() when no vector is given */
+} KSP_GCRODR;
+
+#define GH(a,i,j)  ((a)[(i) + (j)*(gcrodr->m+1)])
+
+static PetscErrorCode KSPSetUp_GCRODR(KSP ksp)
+{
+  KSP_GCRODR     *gcrodr = (KSP_GCRODR*)ksp->data;
+  PetscErrorCode ierr;
+  PetscInt       m = gcrodr->m,k = gcrodr->k;
+
+  PetscFunctionBegin;
+  if (ksp->pc_side == PC_LEFT) SETERRQ(PetscObjectComm((PetscObject)ksp),PETSC_ERR_SUP,"No left preconditioning for KSPGCRODR");
+  else if (ksp->pc_side == PC_SYMMETRIC) SETERRQ(PetscObjectComm((PetscObject)ksp),PETSC_ERR_SUP,"No symmetric preconditioning for KSPGCRODR");
+  if (k >= m) SETERRQ2(PetscObjectComm((PetscObject)ksp),PETSC_ERR_ARG_OUTOFRANGE,"Recycled subspace dimension %D must be smaller than the restart %D",k,m);
+  ierr = KSPSetWorkVecs(ksp,1);CHKERRQ(ierr);
+  ierr = KSPCreateVecs(ksp,m+1,&gcrodr->V,0,NULL);CHKERRQ(ierr);
+  ierr = KSPCreateVecs(ksp,m,&gcrodr->Z,0,NULL);CHKERRQ(ierr);
+  ierr = KSPCreateVecs(ksp,k,&gcrodr->U,0,NULL);CHKERRQ(ierr);
+  ierr = KSPCreateVecs(ksp,k,&gcrodr->C,0,NULL);CHKERRQ(ierr);
+  ierr = KSPCreateVecs(ksp,k,&gcrodr->Unew,0,NULL);CHKERRQ(ierr);
+  ierr = KSPCreateVecs(ksp,k,&gcrodr->Cnew,0,NULL);CHKERRQ(ierr);
+  ierr = PetscLogObjectParents(ksp,m+1,gcrodr->V);CHKERRQ(ierr);
+  ierr = PetscLogObjectParents(ksp,m,gcrodr->Z);CHKERRQ(ierr);
+  ierr = PetscLogObjectParents(ksp,k,gcrodr->U);CHKERRQ(ierr);
+  ierr = PetscLogObjectParents(ksp,k,gcrodr->C);CHKERRQ(ierr);
+  ierr = PetscLogObjectParents(ksp,k,gcrodr->Unew);CHKERRQ(ierr);
+  ierr = PetscLogObjectParents(ksp,k,gcrodr->Cnew);CHKERRQ(ierr);
+  ierr = PetscMalloc2(k+m,&gcrodr->Y,k+m+1,&gcrodr->W);CHKERRQ(ierr);
+  ierr = PetscCalloc5((m+1)*m,&gcrodr->H,(m+1)*m,&gcrodr->Hr,k*m,&gcrodr->B,m+1,&gcrodr->rs,m,&gcrodr->cs);CHKERRQ(ierr);
+  ierr = PetscCalloc3(m,&gcrodr->sn,m,&gcrodr->y,k,&gcrodr->dots);CHKERRQ(ierr);
+  ierr = PetscLogObjectMemory((PetscObject)ksp,(2*(m+1)*m+k*m+4*m+1+k)*sizeof(PetscScalar));CHKERRQ(ierr);
+  gcrodr->nrec = 0;
+  PetscFunctionReturn(0);
+}
+
+/*
+   Makes C = A U orthonormal again after the operator changed, applying the same transformation to U so that A U = C holds.
+   Vectors whose image is numerically dependent on the others are dropped.
+*/
+static PetscErrorCode KSPGCRODRRefreshRecycle_Private(KSP ksp,Mat Amat)
+{
+  KSP_GCRODR       *gcrodr = (KSP_GCRODR*)ksp->data;
+  PetscErrorCode   ierr;
+  PetscObjectState state;
+  PetscInt         i,j,pass,n = 0;
+  PetscReal        nrm;
+  Vec              t;
+
+  PetscFunctionBegin;
+  ierr = PetscObjectStateGet((PetscObject)Amat,&state);CHKERRQ(ierr);
+  if (gcrodr->Amat == Amat && gcrodr->Astate == state) PetscFunctionReturn(0);
+  if (gcrodr->nrec) {
+    for (j=0; j<gcrodr->nrec; j++) {
+      ierr = KSP_MatMult(ksp,Amat,gcrodr->U[j],gcrodr->C[j]);CHKERRQ(ierr);
+    }
+    for (j=0; j<gcrodr->nrec; j++) {
+      if (n != j) {
+        t = gcrodr->U[n]; gcrodr->U[n] = gcrodr->U[j]; gcrodr->U[j] = t;
+        t = gcrodr->C[n]; gcrodr->C[n] = gcrodr->C[j]; gcrodr->C[j] = t;
+      }
+      /* classical Gram-Schmidt with one reorthogonalization */
+      for (pass=0; pass<2 && n; pass++) {
+        ierr = VecMDot(gcrodr->C[n],n,gcrodr->C,gcrodr->dots);CHKERRQ(ierr);
+        for (i=0; i<n; i++) gcrodr->dots[i] = -gcrodr->dots[i];
+        ierr = VecMAXPY(gcrodr->C[n],n,gcrodr->dots,gcrodr->C);CHKERRQ(ierr);
+        ierr = VecMAXPY(gcrodr->U[n],n,gcrodr->dots,gcrodr->U);CHKERRQ(ierr);
+      }
+      ierr = VecNorm(gcrodr->C[n],NORM_2,&nrm);CHKERRQ(ierr);
+      if (nrm <= PETSC_SQRT_MACHINE_EPSILON) continue;
+      ierr = VecScale(gcrodr->C[n],1.0/nrm);CHKERRQ(ierr);
+      ierr = VecScale(gcrodr->U[n],1.0/nrm);CHKERRQ(ierr);
+      n++;
+    }
+    ierr = PetscInfo2(ksp,"Operator changed, %D of %D recycled vectors kept\n",n,gcrodr->nrec);CHKERRQ(ierr);
+    gcrodr->nrec = n;
+  }
+  ierr = PetscObjectReference((PetscObject)Amat);CHKERRQ(ierr);
+  ierr = MatDestroy(&gcrodr->Amat);CHKERRQ(ierr);
+  gcrodr->Amat   = Amat;
+  gcrodr->Astate = state;
+  PetscFunctionReturn(0);
+}
+
+/*
+   Replaces the recycled subspace by the k harmonic Ritz vectors of smallest harmonic Ritz values of the augmented subspace
+   Y = [U Z] of the last cycle. With A Y = W G, W = [C V] orthonormal and G = [I B; 0 H], these solve
+
+       G^H G p = theta G^H W^H [U V] p,   W^H [U V] = [C^H U 0; V^H U I]
+
+   (Parks, de Sturler, Mackey, Johnson and Maiti, 2006), where U stands for the preconditioned M U when a preconditioner is
+   used. The new space is U = Y P R^{-1}, C = W Q for the QR factorization G P = Q R.
+*/
+static PetscErrorCode KSPGCRODRUpdateRecycle_Private(KSP ksp,PetscInt steps)
+{
+  KSP_GCRODR     *gcrodr = (KSP_GCRODR*)ksp->data;
+  PetscErrorCode ierr;
+  PetscInt       nrec = gcrodr->nrec,n = nrec + steps,rows = n + 1,i,j,l,kk = 0,*perm;
+  PetscScalar    *G,*M,*Gt,*WU,*VR,*P,*T,*R,*tau,*work,sdummy = 0;
+  PetscReal      *modul,rmax;
+  PetscBLASInt   bn,brows,bkk,lwork,info,*ipiv,one = 1;
+  PetscBool      *used;
+  Vec            *t;
+#if defined(PETSC_USE_COMPLEX)
+  PetscScalar    *w;
+  PetscReal      *rwork;
+#else
+  PetscReal      *wr,*wi;
+#endif
+
+  PetscFunctionBegin;
+  if (!n) PetscFunctionReturn(0);
+  ierr = PetscBLASIntCast(n,&bn);CHKERRQ(ierr);
+  ierr = PetscBLASIntCast(rows,&brows);CHKERRQ(ierr);
+  ierr = PetscBLASIntCast(5*rows,&lwork);CHKERRQ(ierr);
+  ierr = PetscCalloc5(rows*n,&G,n*n,&M,n*n,&Gt,n*n,&VR,lwork,&work);CHKERRQ(ierr);
+  ierr = PetscCalloc5(n*gcrodr->k,&P,n*gcrodr->k,&T,rows*gcrodr->k,&R,rows,&tau,n,&ipiv);CHKERRQ(ierr);
+  ierr = PetscMalloc3(n,&modul,n,&perm,n,&used);CHKERRQ(ierr);
+  ierr = PetscCalloc1(rows*n,&WU);CHKERRQ(ierr);
+#if defined(PETSC_USE_COMPLEX)
+  ierr = PetscMalloc2(n,&w,2*n,&rwork);CHKERRQ(ierr);
+#else
+  ierr = PetscMalloc2(n,&wr,n,&wi);CHKERRQ(ierr);
+#endif
+
+  for (i=0; i<nrec; i++) {
+    gcrodr->Y[i] = gcrodr->U[i];
+    gcrodr->W[i] = gcrodr->C[i];
+  }
+  for (i=0; i<steps; i++) gcrodr->Y[nrec+i] = gcrodr->Z[i];
+  for (i=0; i<=steps; i++) gcrodr->W[nrec+i] = gcrodr->V[i];
+
+  /* WU = W^H [U V], the inner products with the columns of U in a single reduction */
+  for (j=0; j<nrec; j++) {
+    ierr = VecMDotBegin(gcrodr->U[j],rows,gcrodr->W,WU+j*rows);CHKERRQ(ierr);
+  }
+  for (j=0; j<nrec; j++) {
+    ierr = VecMDotEnd(gcrodr->U[j],rows,gcrodr->W,WU+j*rows);CHKERRQ(ierr);
+  }
+  for (j=0; j<steps; j++) WU[nrec+j+(nrec+j)*rows] = 1.0;
+
+  /* G = [I B; 0 H] */
+  for (j=0; j<nrec; j++) G[j+j*rows] = 1.0;
+  for (j=0; j<steps; j++) {
+    for (i=0; i<nrec; i++) G[i+(nrec+j)*rows] = gcrodr->B[i+j*gcrodr->k];
+    for (i=0; i<=j+1; i++) G[nrec+i+(nrec+j)*rows] = GH(gcrodr->H,i,j);
+  }
+  /* M = G^H G and Gt = G^H WU */
+  for (j=0; j<n; j++) {
+    for (i=0; i<n; i++) {
+      for (l=0; l<rows; l++) {
+        M[i+j*n]  += PetscConj(G[l+i*rows])*G[l+j*rows];
+        Gt[i+j*n] += PetscConj(G[l+i*rows])*WU[l+j*rows];
+      }
+    }
+  }
+  ierr = PetscFPTrapPush(PETSC_FP_TRAP_OFF);CHKERRQ(ierr);
+  PetscStackCallBLAS("LAPACKgesv",LAPACKgesv_(&bn,&bn,Gt,&bn,ipiv,M,&bn,&info));
+  if (info) {
+    ierr = PetscFPTrapPop();CHKERRQ(ierr);
+    ierr = PetscInfo1(ksp,"Singular projected operator (LAPACK gesv info %d), recycled subspace not updated\n",(int)info);CHKERRQ(ierr);
+    goto cleanup;
+  }
+#if defined(PETSC_USE_COMPLEX)
+  PetscStackCallBLAS("LAPACKgeev",LAPACKgeev_("N","V",&bn,M,&bn,w,&sdummy,&one,VR,&bn,work,&lwork,rwork,&info));
+#else
+  PetscStackCallBLAS("LAPACKgeev",LAPACKgeev_("N","V",&bn,M,&bn,wr,wi,&sdummy,&one,VR,&bn,work,&lwork,&info));
+#endif
+  ierr = PetscFPTrapPop();CHKERRQ(ierr);
+  if (info) SETERRQ1(PETSC_COMM_SELF,PETSC_ERR_LIB,"Error in LAPACK routine geev %d",(int)info);
+
+  /* the eigenvectors of the smallest harmonic Ritz values, a complex pair contributes its real and imaginary parts */
+  for (i=0; i<n; i++) {
+#if defined(PETSC_USE_COMPLEX)
+    modul[i] = PetscAbsScalar(w[i]);
+#else
+    modul[i] = PetscSqrtReal(wr[i]*wr[i]+wi[i]*wi[i]);
+#endif
+    perm[i] = i;
+    used[i] = PETSC_FALSE;
+  }
+  ierr = PetscSortRealWithPermutation(n,modul,perm);CHKERRQ(ierr);
+  for (l=0; l<n && kk<gcrodr->k; l++) {
+    j = perm[l];
+#if !defined(PETSC_USE_COMPLEX)
+    if (wi[j] != 0.0 && wi[j] < 0.0) j--;
+#endif
+    if (used[j]) continue;
+    used[j] = PETSC_TRUE;
+    ierr    = PetscArraycpy(P+kk*n,VR+j*n,n);CHKERRQ(ierr);
+    kk++;
+#if !defined(PETSC_USE_COMPLEX)
+    if (wi[j] != 0.0 && kk < gcrodr->k) {
+      ierr = PetscArraycpy(P+kk*n,VR+(j+1)*n,n);CHKERRQ(ierr);
+      kk++;
+    }
+#endif
+  }
+
+  /* G P = Q R */
+  for (j=0; j<kk; j++) {
+    for (i=0; i<rows; i++) {
+      for (l=0; l<n; l++) R[i+j*rows] += G[i+l*rows]*P[l+j*n];
+    }
+  }
+  ierr = PetscBLASIntCast(kk,&bkk);CHKERRQ(ierr);
+  ierr = PetscFPTrapPush(PETSC_FP_TRAP_OFF);CHKERRQ(ierr);
+  PetscStackCallBLAS("LAPACKgeqrf",LAPACKgeqrf_(&brows,&bkk,R,&brows,tau,work,&lwork,&info));
+  if (info) SETERRQ1(PETSC_COMM_SELF,PETSC_ERR_LIB,"Error in LAPACK routine geqrf %d",(int)info);
+  /* T = P R^{-1}, dropping the directions that G P does not resolve */
+  rmax = kk ? PetscAbsScalar(R[0]) : 0.0;
+  for (j=0; j<kk; j++) {
+    if (PetscAbsScalar(R[j+j*rows]) <= PETSC_SQRT_MACHINE_EPSILON*rmax) break;
+    for (l=0; l<n; l++) {
+      T[l+j*n] = P[l+j*n];
+      for (i=0; i<j; i++) T[l+j*n] -= T[l+i*n]*R[i+j*rows];
+      T[l+j*n] /= R[j+j*rows];
+    }
+  }
+  kk   = j;
+  ierr = PetscBLASIntCast(kk,&bkk);CHKERRQ(ierr);
+  PetscStackCallBLAS("LAPACKorgqr",LAPACKorgqr_(&brows,&bkk,&bkk,R,&brows,tau,work,&lwork,&info));
+  ierr = PetscFPTrapPop();CHKERRQ(ierr);
+  if (info) SETERRQ1(PETSC_COMM_SELF,PETSC_ERR_LIB,"Error in LAPACK routine orgqr %d",(int)info);
+
+  /* U = [U Z] T and C = [C V] Q */
+  for (j=0; j<kk; j++) {
+    ierr = VecSet(gcrodr->Unew[j],0.0);CHKERRQ(ierr);
+    ierr = VecMAXPY(gcrodr->Unew[j],n,T+j*n,gcrodr->Y);CHKERRQ(ierr);
+    ierr = VecSet(gcrodr->Cnew[j],0.0);CHKERRQ(ierr);
+    ierr = VecMAXPY(gcrodr->Cnew[j],rows,R+j*rows,gcrodr->W);CHKERRQ(ierr);
+  }
+  t = gcrodr->U; gcrodr->U = gcrodr->Unew; gcrodr->Unew = t;
+  t = gcrodr->C; gcrodr->C = gcrodr->Cnew; gcrodr->Cnew = t;
+  gcrodr->nrec = kk;
+
+cleanup:
+  ierr = PetscFree5(G,M,Gt,VR,work);CHKERRQ(ierr);
+  ierr = PetscFree5(P,T,R,tau,ipiv);CHKERRQ(ierr);
+  ierr = PetscFree3(modul,perm,used);CHKERRQ(ierr);
+  ierr = PetscFree(WU);CHKERRQ(ierr);
+#if defined(PETSC_USE_COMPLEX)
+  ierr = PetscFree2(w,rwork);CHKERRQ(ierr);
+#else
+  ierr = PetscFree2(wr,wi);CHKERRQ(ierr);
+#endif
+  PetscFunctionReturn(0);
+}
+
+/*
+   vdest = vs + Z y - U B y with y = Hr^{-1} rs the least squares solution after the given number of steps of the current cycle
+*/
+static PetscErrorCode KSPGCRODRBuildSoln_Private(KSP ksp,Vec vs,Vec vdest,PetscInt steps)
+{
+  KSP_GCRODR     *gcrodr = (KSP_GCRODR*)ksp->data;
+  PetscErrorCode ierr;
+  PetscInt       i,j,nrec = gcrodr->nrec;
+  PetscScalar    *Hr = gcrodr->Hr,*B = gcrodr->B,*y = gcrodr->y;
+
+  PetscFunctionBegin;
+  if (vdest != vs) {
+    ierr = VecCopy(vs,vdest);CHKERRQ(ierr);
+  }
+  if (!steps) PetscFunctionReturn(0);
+  for (i=steps-1; i>=0; i--) {
+    if (GH(Hr,i,i) == 0.0) SETERRQ1(PetscObjectComm((PetscObject)ksp),PETSC_ERR_CONV_FAILED,"Singular triangular factor in column %D",i);
+    y[i] = gcrodr->rs[i];
+    for (j=i+1; j<steps; j++) y[i] -= GH(Hr,i,j)*y[j];
+    y[i] /= GH(Hr,i,i);
+  }
+  ierr = VecMAXPY(vdest,steps,y,gcrodr->Z);CHKERRQ(ierr);
+  if (nrec) {
+    for (i=0; i<nrec; i++) {
+      gcrodr->dots[i] = 0.0;
+      for (j=0; j<steps; j++) gcrodr->dots[i] -= B[i+j*gcrodr->k]*y[j];
+    }
+    ierr = VecMAXPY(vdest,nrec,gcrodr->dots,gcrodr->U);CHKERRQ(ierr);
+  }
+  PetscFunctionReturn(0);
+}
+
+/*
+   One cycle: Arnoldi with (I - C C^H) A M^{-1} started from the residual r, which is orthogonal to C, followed by the
+   minimal residual update x <- x + Z y - U B y and the update of the recycled subspace. Convergence is only tested after
+   the iterations, the initial residual was tested by KSPSolve_GCRODR() before the projection onto C.
+*/
+static PetscErrorCode KSPGCRODRCycle_Private(KSP ksp,Mat Amat,Vec r)
+{
+  KSP_GCRODR     *gcrodr = (KSP_GCRODR*)ksp->data;
+  PetscErrorCode ierr;
+  PetscInt       nrec = gcrodr->nrec,s = gcrodr->m - nrec,i,j,steps = 0;
+  PetscScalar    *H = gcrodr->H,*Hr = gcrodr->Hr,*B = gcrodr->B,*rs = gcrodr->rs,*cs = gcrodr->cs,*sn = gcrodr->sn,tt;
+  PetscReal      beta,hnext,res;
+  PetscBool      happy = PETSC_FALSE;
+  Vec            *V = gcrodr->V,*Z = gcrodr->Z;
+
+  PetscFunctionBegin;
+  ierr = VecNorm(r,NORM_2,&beta);CHKERRQ(ierr);
+  KSPCheckNorm(ksp,beta);
+  if (beta == 0.0) {
+    /* the projection onto C gave the exact solution */
+    ksp->rnorm  = 0.0;
+    ksp->reason = KSP_CONVERGED_HAPPY_BREAKDOWN;
+    PetscFunctionReturn(0);
+  }
+  ierr  = VecCopy(r,V[0]);CHKERRQ(ierr);
+  ierr  = VecScale(V[0],1.0/beta);CHKERRQ(ierr);
+  ierr  = PetscArrayzero(rs,gcrodr->m+1);CHKERRQ(ierr);
+  rs[0] = beta;
+  gcrodr->it = 0;
+
+  for (j=0; j<s; j++) {
+    ierr = KSP_PCApply(ksp,V[j],Z[j]);CHKERRQ(ierr);
+    ierr = KSP_MatMult(ksp,Amat,Z[j],V[j+1]);CHKERRQ(ierr);
+    if (nrec) {
+      ierr = VecMDot(V[j+1],nrec,gcrodr->C,B+j*gcrodr->k);CHKERRQ(ierr);
+      for (i=0; i<nrec; i++) gcrodr->dots[i] = -B[i+j*gcrodr->k];
+      ierr = VecMAXPY(V[j+1],nrec,gcrodr->dots,gcrodr->C);CHKERRQ(ierr);
+    }
+    ierr = VecMDot(V[j+1],j+1,V,&GH(H,0,j));CHKERRQ(ierr);
+    for (i=0; i<=j; i++) GH(Hr,i,j) = -GH(H,i,j);
+    ierr = VecMAXPY(V[j+1],j+1,&GH(Hr,0,j),V);CHKERRQ(ierr);
+    ierr = VecNorm(V[j+1],NORM_2,&hnext);CHKERRQ(ierr);
+    GH(H,j+1,j) = hnext;
+    if (hnext <= gcrodr->haptol*beta) happy = PETSC_TRUE;
+    else {
+      ierr = VecScale(V[j+1],1.0/hnext);CHKERRQ(ierr);
+    }
+
+    /* reduce the new column with the previous rotations and a new one */
+    for (i=0; i<=j+1; i++) GH(Hr,i,j) = GH(H,i,j);
+    for (i=0; i<j; i++) {
+      tt            = GH(Hr,i,j);
+      GH(Hr,i,j)    = PetscConj(cs[i])*tt + sn[i]*GH(Hr,i+1,j);
+      GH(Hr,i+1,j)  = cs[i]*GH(Hr,i+1,j) - sn[i]*tt;
+    }
+    if (!happy) {
+      tt          = PetscSqrtScalar(PetscConj(GH(Hr,j,j))*GH(Hr,j,j) + PetscConj(GH(Hr,j+1,j))*GH(Hr,j+1,j));
+      cs[j]       = GH(Hr,j,j)/tt;
+      sn[j]       = GH(Hr,j+1,j)/tt;
+      rs[j+1]     = -sn[j]*rs[j];
+      rs[j]       = PetscConj(cs[j])*rs[j];
+      GH(Hr,j,j)  = tt;
+      GH(Hr,j+1,j) = 0.0;
+      res         = PetscAbsScalar(rs[j+1]);
+    } else res = 0.0;
+
+    steps      = j+1;
+    gcrodr->it = steps;
+    ierr  = PetscObjectSAWsTakeAccess((PetscObject)ksp);CHKERRQ(ierr);
+    ksp->its++;
+    ksp->rnorm = res;
+    ierr  = PetscObjectSAWsGrantAccess((PetscObject)ksp);CHKERRQ(ierr);
+    ierr  = KSPLogResidualHistory(ksp,res);CHKERRQ(ierr);
+    ierr  = KSPMonitor(ksp,ksp->its,res);CHKERRQ(ierr);
+    ierr  = (*ksp->converged)(ksp,ksp->its,res,&ksp->reason,ksp->cnvP);CHKERRQ(ierr);
+    if (ksp->reason || happy || ksp->its >= ksp->max_it) break;
+  }
+
+  ierr = KSPGCRODRBuildSoln_Private(ksp,ksp->vec_sol,ksp->vec_sol,steps);CHKERRQ(ierr);
+  gcrodr->it = 0;
+  ierr = KSPGCRODRUpdateRecycle_Private(ksp,steps);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode KSPBuildSolution_GCRODR(KSP ksp,Vec ptr,Vec *result)
+{
+  KSP_GCRODR     *gcrodr = (KSP_GCRODR*)ksp->data;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  if (!ptr) {
+    if (!gcrodr->sol_temp) {
+      ierr = VecDuplicate(ksp->vec_sol,&gcrodr->sol_temp);CHKERRQ(ierr);
+      ierr = PetscLogObjectParent((PetscObject)ksp,(PetscObject)gcrodr->sol_temp);CHKERRQ(ierr);
+    }
+    ptr = gcrodr->sol_temp;
+  }
+  ierr = KSPGCRODRBuildSoln_Private(ksp,ksp->vec_sol,ptr,gcrodr->it);CHKERRQ(ierr);
+  if (result) *result = ptr;
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode KSPSolve_GCRODR(KSP ksp)
+{
+  KSP_GCRODR     *gcrodr = (KSP_GCRODR*)ksp->data;
+  PetscErrorCode ierr;
+  PetscInt       i;
+  PetscReal      rnorm;
+  Mat            Amat,Pmat;
+  Vec            x = ksp->vec_sol,b = ksp->vec_rhs,r = ksp->work[0];
+
+  PetscFunctionBegin;
+  if (ksp->transpose_solve) SETERRQ(PetscObjectComm((PetscObject)ksp),PETSC_ERR_SUP,"No transpose solve for KSPGCRODR");
+  ierr = PCGetOperators(ksp->pc,&Amat,&Pmat);CHKERRQ(ierr);
+  ierr = KSPGCRODRRefreshRecycle_Private(ksp,Amat);CHKERRQ(ierr);
+
+  ierr = PetscObjectSAWsTakeAccess((PetscObject)ksp);CHKERRQ(ierr);
+  ksp->its = 0;
+  ierr = PetscObjectSAWsGrantAccess((PetscObject)ksp);CHKERRQ(ierr);
+  if (!ksp->guess_zero) {
+    ierr = KSP_MatMult(ksp,Amat,x,r);CHKERRQ(ierr);                /*   r <- b - A x    */
+    ierr = VecAYPX(r,-1.0,b);CHKERRQ(ierr);
+  } else {
+    ierr = VecCopy(b,r);CHKERRQ(ierr);
+  }
+  ierr = VecNorm(r,NORM_2,&rnorm);CHKERRQ(ierr);
+  KSPCheckNorm(ksp,rnorm);
+  ierr = PetscObjectSAWsTakeAccess((PetscObject)ksp);CHKERRQ(ierr);
+  ksp->rnorm = rnorm;
+  ierr = PetscObjectSAWsGrantAccess((PetscObject)ksp);CHKERRQ(ierr);
+  ierr = KSPLogResidualHistory(ksp,rnorm);CHKERRQ(ierr);
+  ierr = KSPMonitor(ksp,0,rnorm);CHKERRQ(ierr);
+  ierr = (*ksp->converged)(ksp,0,rnorm,&ksp->reason,ksp->cnvP);CHKERRQ(ierr);
+
+  while (!ksp->reason) {
+    if (gcrodr->nrec) {                                               /*   x <- x + U C^H r, r <- r - C C^H r */
+      ierr = VecMDot(r,gcrodr->nrec,gcrodr->C,gcrodr->dots);CHKERRQ(ierr);
+      ierr = VecMAXPY(x,gcrodr->nrec,gcrodr->dots,gcrodr->U);CHKERRQ(ierr);
+      for (i=0; i<gcrodr->nrec; i++) gcrodr->dots[i] = -gcrodr->dots[i];
+      ierr = VecMAXPY(r,gcrodr->nrec,gcrodr->dots,gcrodr->C);CHKERRQ(ierr);
+    }
+    ierr = KSPGCRODRCycle_Private(ksp,Amat,r);CHKERRQ(ierr);
+    if (ksp->reason) break;
+    if (ksp->its >= ksp->max_it) {
+      ksp->reason = KSP_DIVERGED_ITS;
+      break;
+    }
+    ierr = KSP_MatMult(ksp,Amat,x,r);CHKERRQ(ierr);
+    ierr = VecAYPX(r,-1.0,b);CHKERRQ(ierr);
+  }
+  ierr = PetscInfo2(ksp,"%D iterations, recycled subspace of dimension %D\n",ksp->its,gcrodr->nrec);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode KSPReset_GCRODR(KSP ksp)
+{
+  KSP_GCRODR     *gcrodr = (KSP_GCRODR*)ksp->data;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  if (gcrodr->V) {
+    ierr = VecDestroyVecs(gcrodr->m+1,&gcrodr->V);CHKERRQ(ierr);
+    ierr = VecDestroyVecs(gcrodr->m,&gcrodr->Z);CHKERRQ(ierr);
+    ierr = VecDestroyVecs(gcrodr->k,&gcrodr->U);CHKERRQ(ierr);
+    ierr = VecDestroyVecs(gcrodr->k,&gcrodr->C);CHKERRQ(ierr);
+    ierr = VecDestroyVecs(gcrodr->k,&gcrodr->Unew);CHKERRQ(ierr);
+    ierr = VecDestroyVecs(gcrodr->k,&gcrodr->Cnew);CHKERRQ(ierr);
+  }
+  ierr = PetscFree2(gcrodr->Y,gcrodr->W);CHKERRQ(ierr);
+  ierr = PetscFree5(gcrodr->H,gcrodr->Hr,gcrodr->B,gcrodr->rs,gcrodr->cs);CHKERRQ(ierr);
+  ierr = PetscFree3(gcrodr->sn,gcrodr->y,gcrodr->dots);CHKERRQ(ierr);
+  ierr = VecDestroy(&gcrodr->sol_temp);CHKERRQ(ierr);
+  ierr = MatDestroy(&gcrodr->Amat);CHKERRQ(ierr);
+  gcrodr->nrec = 0;
+  gcrodr->it   = 0;
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode KSPDestroy_GCRODR(KSP ksp)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = KSPReset_GCRODR(ksp);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)ksp,"KSPGCRODRSetRestart_C",NULL);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)ksp,"KSPGCRODRSetRecycle_C",NULL);CHKERRQ(ierr);
+  ierr = KSPDestroyDefault(ksp);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode KSPView_GCRODR(KSP ksp,PetscViewer viewer)
+{
+  KSP_GCRODR     *gcrodr = (KSP_GCRODR*)ksp->data;
+  PetscErrorCode ierr;
+  PetscBool      iascii;
+
+  PetscFunctionBegin;
+  ierr = PetscObjectTypeCompare((PetscObject)viewer,PETSCVIEWERASCII,&iascii);CHKERRQ(ierr);
+  if (iascii) {
+    ierr = PetscViewerASCIIPrintf(viewer,"  restart=%D, recycled subspace dimension=%D (currently %D)\n",gcrodr->m,gcrodr->k,gcrodr->nrec);CHKERRQ(ierr);
+  }
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode KSPSetFromOptions_GCRODR(PetscOptionItems *PetscOptionsObject,KSP ksp)
+{
+  KSP_GCRODR     *gcrodr = (KSP_GCRODR*)ksp->data;
+  PetscErrorCode ierr;
+  PetscInt       m,k;
+  PetscBool      flg;
+
+  PetscFunctionBegin;
+  ierr = PetscOptionsHead(PetscOptionsObject,"KSP GCRODR Options");CHKERRQ(ierr);
+  ierr = PetscOptionsInt("-ksp_gcrodr_restart","Dimension of the augmented subspace of each cycle","KSPGCRODRSetRestart",gcrodr->m,&m,&flg);CHKERRQ(ierr);
+  if (flg) {ierr = KSPGCRODRSetRestart(ksp,m);CHKERRQ(ierr);}
+  ierr = PetscOptionsInt("-ksp_gcrodr_recycle","Dimension of the subspace recycled between cycles and solves","KSPGCRODRSetRecycle",gcrodr->k,&k,&flg);CHKERRQ(ierr);
+  if (flg) {ierr = KSPGCRODRSetRecycle(ksp,k);CHKERRQ(ierr);}
+  ierr = PetscOptionsTail();CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode KSPGCRODRSetRestart_GCRODR(KSP ksp,PetscInt m)
+{
+  KSP_GCRODR     *gcrodr = (KSP_GCRODR*)ksp->data;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  if (m < 2) SETERRQ1(PetscObjectComm((PetscObject)ksp),PETSC_ERR_ARG_OUTOFRANGE,"Restart %D must be at least 2",m);
+  if (m != gcrodr->m) {
+    if (ksp->setupstage) {
+      ierr = KSPReset_GCRODR(ksp);CHKERRQ(ierr);
+      ksp->setupstage = KSP_SETUP_NEW;
+    }
+    gcrodr->m = m;
+  }
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode KSPGCRODRSetRecycle_GCRODR(KSP ksp,PetscInt k)
+{
+  KSP_GCRODR     *gcrodr = (KSP_GCRODR*)ksp->data;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  if (k < 1) SETERRQ1(PetscObjectComm((PetscObject)ksp),PETSC_ERR_ARG_OUTOFRANGE,"Recycled subspace dimension %D must be positive",k);
+  if (k != gcrodr->k) {
+    if (ksp->setupstage) {
+      ierr = KSPReset_GCRODR(ksp);CHKERRQ(ierr);
+      ksp->setupstage = KSP_SETUP_NEW;
+    }
+    gcrodr->k = k;
+  }
+  PetscFunctionReturn(0);
+}
+
+/*@
+   KSPGCRODRSetRestart - Sets the dimension of the augmented subspace of each KSPGCRODR cycle, the recycled vectors included
+
+   Logically Collective on ksp
+
+   Input Parameters:
++  ksp - the KSPGCRODR solver
+-  m - the restart, larger than the recycled subspace dimension (default 30)
+
+   Options Database Key:
+.  -ksp_gcrodr_restart <m> - the restart
+
+   Level: intermediate
+
+   Notes:
+    Changing the restart of a solver that was set up discards the recycled subspace.
+
+.seealso: KSPGCRODR, KSPGCRODRSetRecycle(), KSPGMRESSetRestart()
+@*/
+PetscErrorCode KSPGCRODRSetRestart(KSP ksp,PetscInt m)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  PetscValidHeaderSpecific(ksp,KSP_CLASSID,1);
+  PetscValidLogicalCollectiveInt(ksp,m,2);
+  ierr = PetscTryMethod(ksp,"KSPGCRODRSetRestart_C",(KSP,PetscInt),(ksp,m));CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/*@
+   KSPGCRODRSetRecycle - Sets the dimension of the subspace that KSPGCRODR carries from one cycle, and one KSPSolve(), to the next
+
+   Logically Collective on ksp
+
+   Input Parameters:
++  ksp - the KSPGCRODR solver
+-  k - the recycled subspace dimension, smaller than the restart (default 10)
+
+   Options Database Key:
+.  -ksp_gcrodr_recycle <k> - the recycled subspace dimension
+
+   Level: intermediate
+
+   Notes:
+    Changing the dimension of a solver that was set up discards the recycled subspace.
+
+.seealso: KSPGCRODR, KSPGCRODRSetRestart()
+@*/
+PetscErrorCode KSPGCRODRSetRecycle(KSP ksp,PetscInt k)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  PetscValidHeaderSpecific(ksp,KSP_CLASSID,1);
+  PetscValidLogicalCollectiveInt(ksp,k,2);
+  ierr = PetscTryMethod(ksp,"KSPGCRODRSetRecycle_C",(KSP,PetscInt),(ksp,k));CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/*MC
+     KSPGCRODR - GCRO-DR, GMRES with deflated restarting that recycles an approximate invariant subspace between successive
+                 linear solves.
+
+   Options Database Keys:
++   -ksp_gcrodr_restart <m> - dimension of the augmented subspace of each cycle (default 30)
+-   -ksp_gcrodr_recycle <k> - dimension of the recycled subspace (default 10)
+
+   Level: intermediate
+
+   Notes:
+    At the end of each cycle the k harmonic Ritz vectors of smallest harmonic Ritz values of the augmented subspace are kept as
+    U, with C = A U orthonormal. Each following cycle, within the same solve or in the next KSPSolve(), first projects the
+    residual onto C, then runs m - k Arnoldi steps with (I - C C^H) A M^{-1}, so the smallest eigenvalues that slow GMRES(m)
+    are deflated. This helps sequences of slowly varying systems, for example those of time stepping or Newton iterations.
+
+    When the operator given with KSPSetOperators() changes, C = A U is recomputed with the new operator and orthonormalized at
+    the start of the next solve, which costs k products with the operator; the harmonic Ritz vectors of the following cycles
+    then adapt the subspace to the new operator. The recycled vectors are kept in the solution space, so they stay valid
+    when the preconditioner changes, and the preconditioner may vary between iterations as with KSPFGMRES.
+
+    Only right preconditioning and the unpreconditioned residual norm are supported. KSPReset() discards the recycled subspace.
+
+   References:
+.   1. - M. L. Parks, E. de Sturler, G. Mackey, D. D. Johnson and S. Maiti, Recycling Krylov Subspaces for Sequences of Linear
+    Systems, SIAM J. Sci. Comput. 28(5), 2006.
+
+.seealso:  KSPCreate(), KSPSetType(), KSPType (for list of available types), KSP, KSPGCRODRSetRestart(), KSPGCRODRSetRecycle(),
+           KSPGMRES, KSPFGMRES, KSPDGMRES, KSPGCR, KSPGUESSFISCHER, PCDEFLATION
+
+M*/
+PETSC_EXTERN PetscErrorCode KSPCreate_GCRODR(KSP ksp)
+{
+  PetscErrorCode ierr;
+  KSP_GCRODR     *gcrodr;
+
+  PetscFunctionBegin;
+  ierr           = PetscNewLog(ksp,&gcrodr);CHKERRQ(ierr);
+  ksp->data      = (void*)gcrodr;
+  gcrodr->m      = 30;
+  gcrodr->k      = 10;
+  gcrodr->haptol = 1.0e-30;
+
+  ierr = KSPSetSupportedNorm(ksp,KSP_NORM_UNPRECONDITIONED,PC_RIGHT,3);CHKERRQ(ierr);
+  ierr = KSPSetSupportedNorm(ksp,KSP_NORM_NONE,PC_RIGHT,1);CHKERRQ(ierr);
+
+  ksp->ops->setup          = KSPSetUp_GCRODR;
+  ksp->ops->solve          = KSPSolve_GCRODR;
+  ksp->ops->reset          = KSPReset_GCRODR;
+  ksp->ops->destroy        = KSPDestroy_GCRODR;
+  ksp->ops->view           = KSPView_GCRODR;
+  ksp->ops->setfromoptions = KSPSetFromOptions_GCRODR;
+  ksp->ops->buildsolution  = KSPBuildSolution_GCRODR;
+  ksp->ops->buildresidual  = KSPBuildResidualDefault;
+
+  ierr = PetscObjectComposeFunction((PetscObject)ksp,"KSPGCRODRSetRestart_C",KSPGCRODRSetRestart_GCRODR);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)ksp,"KSPGCRODRSetRecycle_C",KSPGCRODRSetRecycle_GCRODR);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
@@ -46,6 +46,7 @@ PetscErrorCode  KSPGMRESModifiedGramSchmidtOrthogonalization(KSP ksp,PetscInt it
     /* vv(it+1) <- vv(it+1) - hh[it+1][j] vv(j) */
     ierr = VecAXPY(VEC_VV(it+1),-(*hh++),VEC_VV(j));CHKERRQ(ierr);
   }
+  ierr = VecNorm(VEC_VV(it+1),NORM_2,&gmres->orthognorm);CHKERRQ(ierr);
   ierr = PetscLogEventEnd(KSP_GMRESOrthogonalization,ksp,0,0,0);CHKERRQ(ierr);
   PetscFunctionReturn(0);
 }
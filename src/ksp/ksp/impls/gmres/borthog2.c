@@ -105,14 +105,171 @@ PetscErrorCode  KSPGMRESClassicalGramSchmidtOrthogonalization(KSP ksp,PetscInt i
       hes[j] -= lhh[j];     /* hes += <v,vnew> */
     }
   }
+
+  /* the norm of the new direction is computed here so that all the reductions of the iteration are logged in this event */
+  if (gmres->cgstype == KSP_GMRES_CGS_REFINE_IFNEEDED && !refine) gmres->orthognorm = wnrm;
+  else {
+    ierr = VecNorm(VEC_VV(it+1),NORM_2,&gmres->orthognorm);CHKERRQ(ierr);
+  }
   ierr = PetscLogEventEnd(KSP_GMRESOrthogonalization,ksp,0,0,0);CHKERRQ(ierr);
   PetscFunctionReturn(0);
 }
 
+/*@C
+     KSPGMRESLowSyncGramSchmidtOrthogonalization - Classical Gram-Schmidt orthogonalization that uses a single global
+                reduction per iteration, including the one for the norm of the new direction
+
+     Collective on ksp
+
+  Input Parameters:
++   ksp - KSP object, must be associated with GMRES, FGMRES, or DGMRES Krylov method
+-   its - one less then the current GMRES restart iteration, i.e. the size of the Krylov space
+
+   Options Database Keys:
+.   -ksp_gmres_lowsyncgramschmidt - Activates KSPGMRESLowSyncGramSchmidtOrthogonalization()
+
+    Notes:
+    This is classical Gram-Schmidt with one step of iterative refinement (CGS2) where the refinement and normalization of
+    each basis vector are delayed by one iteration (DCGS2): their inner products are computed, with VecMDotBegin() and
+    VecNormBegin(), in the same reduction as the inner products and the norm of the next direction, after which the
+    previous column of the Hessenberg matrix and its plane rotation are corrected. Norms after the projections follow
+    from the Pythagorean theorem. The KSPGMRESCGSRefinementType is ignored.
 
+    See Swirydowicz, Langou, Ananthan, Yang and Thomas, Low synchronization Gram-Schmidt and generalized minimal residual
+    algorithms, Numer. Linear Algebra Appl., 2021, and Bielich, Langou, Thomas, Swirydowicz, Yamazaki and Boman, Low-synch
+    Gram-Schmidt with delayed reorthogonalization for Krylov solvers, Parallel Comput., 2022.
 
+    All the global reductions of a GMRES iteration are logged in the KSPGMRESOrthog event, so with an optimized build
+    (debug builds add reductions to check arguments) its Reduct column in -log_view divided by the number of processes
+    and by its Count column is the number of reductions per iteration.
 
+    Not available with KSPLGMRES.
 
+   Level: intermediate
 
+.seealso:  KSPGMRESSetOrthogonalization(), KSPGMRESClassicalGramSchmidtOrthogonalization(), KSPGMRESModifiedGramSchmidtOrthogonalization(),
+           KSPGMRESGetOrthogonalization()
 
+@*/
+PetscErrorCode  KSPGMRESLowSyncGramSchmidtOrthogonalization(KSP ksp,PetscInt it)
+{
+  KSP_GMRES      *gmres = (KSP_GMRES*)(ksp->data);
+  PetscErrorCode ierr;
+  PetscInt       j,k;
+  PetscScalar    *hh,*hes,*lhh,*hprev,*cc,*ss,pre,tt;
+  PetscReal      wnrm,anrm,dnrm,rho = 1.0,nrm,hsub;
+  PetscBool      delayed = (PetscBool)(it > 0),flexible,islgmres;
+  Vec            q = VEC_VV(it),w = VEC_VV(it+1);
 
+  PetscFunctionBegin;
+  ierr = PetscObjectTypeCompare((PetscObject)ksp,KSPLGMRES,&islgmres);CHKERRQ(ierr);
+  if (islgmres) SETERRQ(PetscObjectComm((PetscObject)ksp),PETSC_ERR_SUP,"Low-synchronization Gram-Schmidt is not available with KSPLGMRES");
+  /* with FGMRES the new direction is A times the preconditioned vector, not a function of VEC_VV(it) */
+  ierr = PetscObjectTypeCompare((PetscObject)ksp,KSPFGMRES,&flexible);CHKERRQ(ierr);
+  ierr = PetscLogEventBegin(KSP_GMRESOrthogonalization,ksp,0,0,0);CHKERRQ(ierr);
+  if (!gmres->orthogwork) {
+    ierr = PetscMalloc1(gmres->max_k + 2,&gmres->orthogwork);CHKERRQ(ierr);
+  }
+  lhh = gmres->orthogwork;
+  hh  = HH(0,it);
+  hes = HES(0,it);
+
+  /* the only reduction: <v,q> for the delayed pass over q = vv(it), <v,vnew> and ||vnew|| */
+  if (delayed) {ierr = VecMDotBegin(q,it+1,&VEC_VV(0),lhh);CHKERRQ(ierr);}
+  ierr = VecMDotBegin(w,it+1,&VEC_VV(0),hh);CHKERRQ(ierr);
+  ierr = VecNormBegin(w,NORM_2,&wnrm);CHKERRQ(ierr);
+  if (delayed) {ierr = VecMDotEnd(q,it+1,&VEC_VV(0),lhh);CHKERRQ(ierr);}
+  ierr = VecMDotEnd(w,it+1,&VEC_VV(0),hh);CHKERRQ(ierr);
+  ierr = VecNormEnd(w,NORM_2,&wnrm);CHKERRQ(ierr);
+  for (j=0; j<=it; j++) KSPCheckDot(ksp,hh[j]);
+  KSPCheckNorm(ksp,wnrm);
+
+  if (delayed) {
+    /* second pass over q: q = sum_j a_j v_j + rho q' with a_j = <v_j,q>, j < it */
+    anrm = 0.0;
+    for (j=0; j<it; j++) {
+      KSPCheckDot(ksp,lhh[j]);
+      anrm += PetscRealPart(lhh[j]*PetscConj(lhh[j]));
+    }
+    rho = PetscRealPart(lhh[it]) - anrm;
+    if (rho > PETSC_SQRT_MACHINE_EPSILON*PetscRealPart(lhh[it])) rho = PetscSqrtReal(rho);
+    else rho = -1.0;
+
+    /* express the previous column in the corrected basis: A v(it-1) = sum_j (h_j + h_it a_j) v_j + h_it rho q' */
+    hsub = PetscRealPart(*HES(it,it-1));
+    for (j=0; j<it; j++) *HES(j,it-1) += hsub*lhh[j];
+
+    /* new direction in terms of q': <v_j,vnew> is unchanged for j < it, <q',vnew> = (<q,vnew> - sum_j conj(a_j) <v_j,vnew>)/rho */
+    for (j=0; j<it; j++) hh[it] -= PetscConj(lhh[j])*hh[j];
+
+    for (j=0; j<it; j++) lhh[j] = -lhh[j];
+    ierr = VecMAXPY(q,it,lhh,&VEC_VV(0));CHKERRQ(ierr);
+    for (j=0; j<it; j++) lhh[j] = -lhh[j];
+    if (rho < 0.0) {
+      ierr = VecNorm(q,NORM_2,&rho);CHKERRQ(ierr);
+      ierr = PetscInfo1(ksp,"Computing the norm of the reorthogonalized direction %g explicitly\n",(double)rho);CHKERRQ(ierr);
+      if (rho == 0.0) {
+        if (ksp->errorifnotconverged) SETERRQ(PetscObjectComm((PetscObject)ksp),PETSC_ERR_NOT_CONVERGED,"Breakdown in low-synchronization Gram-Schmidt");
+        ksp->reason = KSP_DIVERGED_BREAKDOWN;
+        ierr = PetscLogEventEnd(KSP_GMRESOrthogonalization,ksp,0,0,0);CHKERRQ(ierr);
+        PetscFunctionReturn(0);
+      }
+    }
+    ierr = VecScale(q,1.0/rho);CHKERRQ(ierr);
+    *HES(it,it-1) = hsub*rho;
+    hh[it]       /= rho;
+
+    /* redo the plane rotation of the previous column, recovering the right-hand side it was applied to */
+    hprev = HH(0,it-1);
+    cc    = CC(0);
+    ss    = SS(0);
+    for (j=0; j<=it; j++) hprev[j] = *HES(j,it-1);
+    for (j=0; j<it-1; j++) {
+      tt         = hprev[j];
+      hprev[j]   = PetscConj(cc[j])*tt + ss[j]*hprev[j+1];
+      hprev[j+1] = cc[j]*hprev[j+1] - ss[j]*tt;
+    }
+    pre         = cc[it-1]*(*GRS(it-1)) - PetscConj(ss[it-1])*(*GRS(it));
+    tt          = PetscSqrtScalar(PetscConj(hprev[it-1])*hprev[it-1] + PetscConj(hprev[it])*hprev[it]);
+    cc[it-1]    = hprev[it-1]/tt;
+    ss[it-1]    = hprev[it]/tt;
+    *GRS(it)    = -(ss[it-1]*pre);
+    *GRS(it-1)  = PetscConj(cc[it-1])*pre;
+    hprev[it-1] = PetscConj(cc[it-1])*hprev[it-1] + ss[it-1]*hprev[it];
+
+    /* A q' = (vnew - sum_j a_j A v_j)/rho, where A v_j = sum_k HES(k,j) v_k in the corrected basis */
+    for (k=0; k<=it; k++) {
+      hes[k] = 0.0;
+      if (!flexible) {
+        for (j=PetscMax(k-1,0); j<it; j++) hes[k] += *HES(k,j)*lhh[j];
+      }
+    }
+  } else {
+    for (k=0; k<=it; k++) hes[k] = 0.0;
+  }
+
+  /* vnew <- vnew - sum_j <v_j,vnew> v_j, whose norm follows from ||vnew||^2 = sum_j |<v_j,vnew>|^2 + ||vnew - sum_j <v_j,vnew> v_j||^2 */
+  dnrm = 0.0;
+  for (j=0; j<=it; j++) {
+    dnrm  += PetscRealPart(hh[j]*PetscConj(hh[j]));
+    lhh[j] = -hh[j];
+  }
+  ierr = VecMAXPY(w,it+1,lhh,&VEC_VV(0));CHKERRQ(ierr);
+  nrm  = wnrm*wnrm - dnrm;
+  if (!flexible && rho != 1.0) {
+    ierr = VecScale(w,1.0/rho);CHKERRQ(ierr);
+    nrm  = nrm/(rho*rho);
+    wnrm = wnrm/rho;
+  }
+  for (j=0; j<=it; j++) {
+    if (!flexible) hh[j] = (hh[j] - hes[j])/rho;
+    hes[j] = hh[j];
+  }
+  if (nrm > PETSC_SQRT_MACHINE_EPSILON*wnrm*wnrm) gmres->orthognorm = PetscSqrtReal(nrm);
+  else {
+    ierr = VecNorm(w,NORM_2,&gmres->orthognorm);CHKERRQ(ierr);
+    ierr = PetscInfo2(ksp,"Computing the norm of the new direction %g explicitly, projection removed all but %g of it\n",(double)gmres->orthognorm,(double)(nrm > 0.0 ? PetscSqrtReal(nrm) : 0.0));CHKERRQ(ierr);
+  }
+  ierr = PetscLogEventEnd(KSP_GMRESOrthogonalization,ksp,0,0,0);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
@@ -191,10 +191,17 @@ PetscErrorCode KSPDGMRESCycle(PetscInt *itcount,KSP ksp)
     }
     dgmres->matvecs += 1;
     /* update hessenberg matrix and do Gram-Schmidt */
+    dgmres->orthognorm = -1.0;
     ierr = (*dgmres->orthog)(ksp,it);CHKERRQ(ierr);
+    if (ksp->reason) break;
 
-    /* vv(i+1) . vv(i+1) */
-    ierr = VecNormalize(VEC_VV(it+1),&tt);CHKERRQ(ierr);
+    /* vv(i+1) . vv(i+1), unless the orthogonalization already computed it */
+    if (dgmres->orthognorm < 0.0) {
+      ierr = VecNormalize(VEC_VV(it+1),&tt);CHKERRQ(ierr);
+    } else {
+      tt = dgmres->orthognorm;
+      if (tt != 0.0) {ierr = VecScale(VEC_VV(it+1),1.0/tt);CHKERRQ(ierr);}
+    }
     /* save the magnitude */
     *HH(it+1,it)  = tt;
     *HES(it+1,it) = tt;
@@ -1114,6 +1121,7 @@ static PetscErrorCode  KSPDGMRESImproveEig_DGMRES(KSP ksp, PetscInt neig)
                              vectors are allocated as needed)
 .   -ksp_gmres_classicalgramschmidt - use classical (unmodified) Gram-Schmidt to orthogonalize against the Krylov space (fast) (the default)
 .   -ksp_gmres_modifiedgramschmidt - use modified Gram-Schmidt in the orthogonalization (more stable, but slower)
+.   -ksp_gmres_lowsyncgramschmidt - use classical Gram-Schmidt with a single global reduction per iteration, see KSPGMRESLowSyncGramSchmidtOrthogonalization()
 .   -ksp_gmres_cgs_refinement_type <refine_never,refine_ifneeded,refine_always> - determine if iterative refinement is used to increase the
                                    stability of the classical Gram-Schmidt  orthogonalization.
 -   -ksp_gmres_krylov_monitor - plot the Krylov space generated
@@ -1201,6 +1209,7 @@ PETSC_EXTERN PetscErrorCode KSPCreate_DGMRES(KSP ksp)
   dgmres->Rsvd           = 0;
   dgmres->cgstype        = KSP_GMRES_CGS_REFINE_NEVER;
   dgmres->orthogwork     = 0;
+  dgmres->orthognorm     = -1.0;
 
   /* Default values for the deflation */
   dgmres->r           = 0;
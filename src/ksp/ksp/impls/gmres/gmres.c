@@ -29,6 +29,7 @@
  */
 
 #include <../src/ksp/ksp/impls/gmres/gmresimpl.h>       /*I  "petscksp.h"  I*/
+#include <petscblaslapack.h>
 #define GMRES_DELTA_DIRECTIONS 10
 #define GMRES_DEFAULT_MAXK     30
 static PetscErrorCode KSPGMRESUpdateHessenberg(KSP,PetscInt,PetscBool,PetscReal*);
@@ -152,11 +153,17 @@ PetscErrorCode KSPGMRESCycle(PetscInt *itcount,KSP ksp)
     ierr = KSP_PCApplyBAorAB(ksp,VEC_VV(it),VEC_VV(1+it),VEC_TEMP_MATOP);CHKERRQ(ierr);
 
     /* update hessenberg matrix and do Gram-Schmidt */
+    gmres->orthognorm = -1.0;
     ierr = (*gmres->orthog)(ksp,it);CHKERRQ(ierr);
     if (ksp->reason) break;
 
-    /* vv(i+1) . vv(i+1) */
-    ierr = VecNormalize(VEC_VV(it+1),&tt);CHKERRQ(ierr);
+    /* vv(i+1) . vv(i+1), unless the orthogonalization already computed it */
+    if (gmres->orthognorm < 0.0) {
+      ierr = VecNormalize(VEC_VV(it+1),&tt);CHKERRQ(ierr);
+    } else {
+      tt = gmres->orthognorm;
+      if (tt != 0.0) {ierr = VecScale(VEC_VV(it+1),1.0/tt);CHKERRQ(ierr);}
+    }
     KSPCheckNorm(ksp,tt);
 
     /* save the magnitude */
@@ -516,6 +523,8 @@ PetscErrorCode KSPView_GMRES(KSP ksp,PetscViewer viewer)
     }
   } else if (gmres->orthog == KSPGMRESModifiedGramSchmidtOrthogonalization) {
     cstr = "Modified Gram-Schmidt Orthogonalization";
+  } else if (gmres->orthog == KSPGMRESLowSyncGramSchmidtOrthogonalization) {
+    cstr = "Low-synchronization Classical Gram-Schmidt Orthogonalization with delayed refinement (one reduction per iteration)";
   } else {
     cstr = "unknown orthogonalization";
   }
@@ -588,6 +597,8 @@ PetscErrorCode KSPSetFromOptions_GMRES(PetscOptionItems *PetscOptionsObject,KSP
   if (flg) {ierr = KSPGMRESSetPreAllocateVectors(ksp);CHKERRQ(ierr);}
   ierr = PetscOptionsBoolGroupBegin("-ksp_gmres_classicalgramschmidt","Classical (unmodified) Gram-Schmidt (fast)","KSPGMRESSetOrthogonalization",&flg);CHKERRQ(ierr);
   if (flg) {ierr = KSPGMRESSetOrthogonalization(ksp,KSPGMRESClassicalGramSchmidtOrthogonalization);CHKERRQ(ierr);}
+  ierr = PetscOptionsBoolGroup("-ksp_gmres_lowsyncgramschmidt","Classical Gram-Schmidt with one reduction per iteration","KSPGMRESSetOrthogonalization",&flg);CHKERRQ(ierr);
+  if (flg) {ierr = KSPGMRESSetOrthogonalization(ksp,KSPGMRESLowSyncGramSchmidtOrthogonalization);CHKERRQ(ierr);}
   ierr = PetscOptionsBoolGroupEnd("-ksp_gmres_modifiedgramschmidt","Modified Gram-Schmidt (slow,more stable)","KSPGMRESSetOrthogonalization",&flg);CHKERRQ(ierr);
   if (flg) {ierr = KSPGMRESSetOrthogonalization(ksp,KSPGMRESModifiedGramSchmidtOrthogonalization);CHKERRQ(ierr);}
   ierr = PetscOptionsEnum("-ksp_gmres_cgs_refinement_type","Type of iterative refinement for classical (unmodified) Gram-Schmidt","KSPGMRESSetCGSRefinementType",
@@ -827,6 +838,293 @@ PetscErrorCode  KSPGMRESSetHapTol(KSP ksp,PetscReal tol)
   PetscFunctionReturn(0);
 }
 
+/*
+   KSPGMRESBlockProject_Private - Removes from the column wc its components along the k columns of V and the c columns of W,
+   both stored with leading dimension ld, with a single reduction. The coefficients are added to coef[0:k+c] when coef is not NULL.
+*/
+static PetscErrorCode KSPGMRESBlockProject_Private(MPI_Comm comm,PetscInt m,PetscInt k,const PetscScalar *V,PetscInt c,const PetscScalar *W,PetscScalar *wc,PetscScalar *coef,PetscScalar *buf,PetscScalar *red)
+{
+  PetscErrorCode ierr;
+  PetscInt       i;
+  PetscScalar    one = 1.0,zero = 0.0,mone = -1.0;
+  PetscBLASInt   bm,bld,bk,bc,bone = 1;
+
+  PetscFunctionBegin;
+  if (!k && !c) PetscFunctionReturn(0);
+  ierr = PetscBLASIntCast(m,&bm);CHKERRQ(ierr);
+  ierr = PetscBLASIntCast(PetscMax(m,1),&bld);CHKERRQ(ierr);
+  ierr = PetscBLASIntCast(k,&bk);CHKERRQ(ierr);
+  ierr = PetscBLASIntCast(c,&bc);CHKERRQ(ierr);
+  if (k) PetscStackCallBLAS("BLASgemv",BLASgemv_("C",&bm,&bk,&one,V,&bld,wc,&bone,&zero,buf,&bone));
+  if (c) PetscStackCallBLAS("BLASgemv",BLASgemv_("C",&bm,&bc,&one,W,&bld,wc,&bone,&zero,buf+k,&bone));
+  ierr = MPIU_Allreduce(buf,red,k+c,MPIU_SCALAR,MPIU_SUM,comm);CHKERRQ(ierr);
+  if (k) PetscStackCallBLAS("BLASgemv",BLASgemv_("N",&bm,&bk,&mone,V,&bld,red,&bone,&one,wc,&bone));
+  if (c) PetscStackCallBLAS("BLASgemv",BLASgemv_("N",&bm,&bc,&mone,W,&bld,red+k,&bone,&one,wc,&bone));
+  ierr = PetscLogFlops(4.0*m*(k+c));CHKERRQ(ierr);
+  if (coef) for (i=0; i<k+c; i++) coef[i] += red[i];
+  PetscFunctionReturn(0);
+}
+
+/*
+   KSPGMRESBlockOrthogonalize_Private - Makes the N columns of W orthonormal to the first k columns of the basis V and to each
+   other, so that W_in = V h + W_out r with h the first k rows and r the next N rows (upper triangular) of h.
+
+   Classical Gram-Schmidt with one reorthogonalization against V is followed by two passes of Cholesky QR, each pass being a single
+   reduction. When W is numerically rank deficient, the columns are orthogonalized one at a time and the dependent ones are
+   replaced by random vectors, so the basis keeps its full block size.
+*/
+static PetscErrorCode KSPGMRESBlockOrthogonalize_Private(KSP ksp,PetscRandom rnd,PetscInt m,PetscInt N,PetscInt k,const PetscScalar *V,PetscScalar *w,PetscScalar *h,PetscInt ldh,PetscScalar *buf,PetscScalar *red)
+{
+  PetscErrorCode ierr;
+  MPI_Comm       comm = PetscObjectComm((PetscObject)ksp);
+  PetscInt       i,j,c,pass;
+  PetscScalar    *rtot,*rtmp,*hv,*wc,one = 1.0,zero = 0.0,mone = -1.0;
+  PetscReal      dmin,dmax,lnrm,nrm0,nrm;
+  PetscBLASInt   bm,bld,bN,bk,bh,info;
+  PetscBool      chol = PETSC_TRUE;
+
+  PetscFunctionBegin;
+  ierr = PetscBLASIntCast(m,&bm);CHKERRQ(ierr);
+  ierr = PetscBLASIntCast(PetscMax(m,1),&bld);CHKERRQ(ierr);
+  ierr = PetscBLASIntCast(N,&bN);CHKERRQ(ierr);
+  ierr = PetscBLASIntCast(k,&bk);CHKERRQ(ierr);
+  ierr = PetscBLASIntCast(ldh,&bh);CHKERRQ(ierr);
+  for (j=0; j<N; j++) {ierr = PetscArrayzero(h+j*ldh,k+N);CHKERRQ(ierr);}
+  for (pass=0; k && pass<2; pass++) {
+    PetscStackCallBLAS("BLASgemm",BLASgemm_("C","N",&bk,&bN,&bm,&one,V,&bld,w,&bld,&zero,buf,&bk));
+    ierr = MPIU_Allreduce(buf,red,k*N,MPIU_SCALAR,MPIU_SUM,comm);CHKERRQ(ierr);
+    PetscStackCallBLAS("BLASgemm",BLASgemm_("N","N",&bm,&bN,&bk,&mone,V,&bld,red,&bk,&one,w,&bld));
+    ierr = PetscLogFlops(4.0*m*k*N);CHKERRQ(ierr);
+    for (j=0; j<N; j++) {
+      for (i=0; i<k; i++) h[i+j*ldh] += red[i+j*k];
+    }
+  }
+
+  ierr = PetscMalloc2(N*N,&rtot,N*N,&rtmp);CHKERRQ(ierr);
+  ierr = PetscArrayzero(rtot,N*N);CHKERRQ(ierr);
+  for (i=0; i<N; i++) rtot[i+i*N] = 1.0;
+  for (pass=0; pass<2; pass++) {
+    PetscStackCallBLAS("BLASgemm",BLASgemm_("C","N",&bN,&bN,&bm,&one,w,&bld,w,&bld,&zero,buf,&bN));
+    ierr = PetscLogFlops(2.0*m*N*N);CHKERRQ(ierr);
+    ierr = MPIU_Allreduce(buf,red,N*N,MPIU_SCALAR,MPIU_SUM,comm);CHKERRQ(ierr);
+    ierr = PetscFPTrapPush(PETSC_FP_TRAP_OFF);CHKERRQ(ierr);
+    PetscStackCallBLAS("LAPACKpotrf",LAPACKpotrf_("U",&bN,red,&bN,&info));
+    ierr = PetscFPTrapPop();CHKERRQ(ierr);
+    if (info) {chol = PETSC_FALSE; break;}
+    dmin = dmax = PetscAbsScalar(red[0]);
+    for (i=1; i<N; i++) {
+      dmin = PetscMin(dmin,PetscAbsScalar(red[i+i*N]));
+      dmax = PetscMax(dmax,PetscAbsScalar(red[i+i*N]));
+    }
+    if (dmin <= PETSC_SQRT_MACHINE_EPSILON*dmax) {chol = PETSC_FALSE; break;}
+    for (j=0; j<N; j++) {
+      for (i=j+1; i<N; i++) red[i+j*N] = 0.0;
+    }
+    PetscStackCallBLAS("BLAStrsm",BLAStrsm_("R","U","N","N",&bm,&bN,&one,red,&bN,w,&bld));
+    PetscStackCallBLAS("BLASgemm",BLASgemm_("N","N",&bN,&bN,&bN,&one,red,&bN,rtot,&bN,&zero,rtmp,&bN));
+    ierr = PetscLogFlops(1.0*m*N*N);CHKERRQ(ierr);
+    ierr = PetscArraycpy(rtot,rtmp,N*N);CHKERRQ(ierr);
+  }
+  if (chol) {
+    for (j=0; j<N; j++) {ierr = PetscArraycpy(h+k+j*ldh,rtot+j*N,N);CHKERRQ(ierr);}
+  } else {
+    ierr = PetscInfo1(ksp,"Block of %D vectors is numerically rank deficient, orthogonalizing column by column\n",N);CHKERRQ(ierr);
+    ierr = PetscCalloc1((k+N)*N,&hv);CHKERRQ(ierr);
+    for (c=0; c<N; c++) {
+      wc   = w+c*m;
+      lnrm = 0.0;
+      for (i=0; i<m; i++) lnrm += PetscRealPart(PetscConj(wc[i])*wc[i]);
+      ierr = MPIU_Allreduce(&lnrm,&nrm0,1,MPIU_REAL,MPIU_SUM,comm);CHKERRQ(ierr);
+      for (pass=0; pass<2; pass++) {
+        ierr = KSPGMRESBlockProject_Private(comm,m,k,V,c,w,wc,hv+c*(k+N),buf,red);CHKERRQ(ierr);
+      }
+      lnrm = 0.0;
+      for (i=0; i<m; i++) lnrm += PetscRealPart(PetscConj(wc[i])*wc[i]);
+      ierr = MPIU_Allreduce(&lnrm,&nrm,1,MPIU_REAL,MPIU_SUM,comm);CHKERRQ(ierr);
+      if (nrm > PETSC_MACHINE_EPSILON*nrm0 && nrm > 0.0) {
+        hv[k+c+c*(k+N)] = PetscSqrtReal(nrm);
+      } else {
+        for (i=0; i<m; i++) {ierr = PetscRandomGetValue(rnd,wc+i);CHKERRQ(ierr);}
+        for (pass=0; pass<2; pass++) {
+          ierr = KSPGMRESBlockProject_Private(comm,m,k,V,c,w,wc,NULL,buf,red);CHKERRQ(ierr);
+        }
+        lnrm = 0.0;
+        for (i=0; i<m; i++) lnrm += PetscRealPart(PetscConj(wc[i])*wc[i]);
+        ierr = MPIU_Allreduce(&lnrm,&nrm,1,MPIU_REAL,MPIU_SUM,comm);CHKERRQ(ierr);
+      }
+      nrm = PetscSqrtReal(nrm);
+      for (i=0; i<m; i++) wc[i] /= nrm;
+    }
+    /* W_in = V h + W_cur rtot and W_cur = V hv + W_out r, with r the last N rows of hv */
+    ierr = PetscBLASIntCast(k+N,&bk);CHKERRQ(ierr);
+    PetscStackCallBLAS("BLASgemm",BLASgemm_("N","N",&bk,&bN,&bN,&one,hv,&bk,rtot,&bN,&one,h,&bh));
+    ierr = PetscFree(hv);CHKERRQ(ierr);
+  }
+  ierr = PetscFree2(rtot,rtmp);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/*
+   KSPMatSolve_GMRES - Block GMRES for the right hand sides stored as the columns of B (Vital, 1990).
+
+   The Krylov basis grows by blocks of N vectors, so each iteration needs one product of the operator with the block, one PCMatApply()
+   and a fixed number of reductions, whatever the number of columns. The block Hessenberg matrix is reduced with Householder
+   reflections as it is built, which gives the residual norm of every column without forming the iterate. The restart parameter of
+   KSPGMRESSetRestart() is the number of blocks kept before restarting.
+*/
+static PetscErrorCode KSPMatSolve_GMRES(KSP ksp,Mat B,Mat X)
+{
+  KSP_GMRES      *gmres = (KSP_GMRES*)ksp->data;
+  PetscErrorCode ierr;
+  MPI_Comm       comm = PetscObjectComm((PetscObject)ksp);
+  Mat            Amat,Pmat,*V,T,AV = NULL;
+  PetscRandom    rnd;
+  PetscInt       m,M,N,mk = gmres->max_k,ldh,ldt,ldx,i,j,c,nb;
+  PetscScalar    *varr,*H,*G,*Y,*tau,*S,*work,*buf,*red,*t,*x,one = 1.0,zero = 0.0;
+  PetscReal      *nrm0,*nrm,dmax;
+  PetscBLASInt   bm,bld,bN,b2N,bh,bs,blt,blx,lwork,info;
+#if defined(PETSC_USE_COMPLEX)
+  const char     *trans = "C";
+#else
+  const char     *trans = "T";
+#endif
+
+  PetscFunctionBegin;
+  if (ksp->pc_side == PC_SYMMETRIC) SETERRQ(comm,PETSC_ERR_SUP,"Block GMRES does not support symmetric preconditioning");
+  ierr = PCGetOperators(ksp->pc,&Amat,&Pmat);CHKERRQ(ierr);
+  ierr = MatGetLocalSize(B,&m,NULL);CHKERRQ(ierr);
+  ierr = MatGetSize(B,&M,&N);CHKERRQ(ierr);
+  ldh  = (mk+1)*N;
+  ierr = PetscBLASIntCast(m,&bm);CHKERRQ(ierr);
+  ierr = PetscBLASIntCast(PetscMax(m,1),&bld);CHKERRQ(ierr);
+  ierr = PetscBLASIntCast(N,&bN);CHKERRQ(ierr);
+  ierr = PetscBLASIntCast(2*N,&b2N);CHKERRQ(ierr);
+  ierr = PetscBLASIntCast(ldh,&bh);CHKERRQ(ierr);
+  ierr = PetscBLASIntCast(64*N,&lwork);CHKERRQ(ierr);
+  ierr = PetscMalloc1(m*(mk+1)*N,&varr);CHKERRQ(ierr);
+  ierr = PetscMalloc1(mk+1,&V);CHKERRQ(ierr);
+  for (j=0; j<mk+1; j++) {
+    ierr = MatCreateDense(comm,m,PETSC_DECIDE,M,N,varr+j*m*N,&V[j]);CHKERRQ(ierr);
+  }
+  ierr = MatDuplicate(B,MAT_DO_NOT_COPY_VALUES,&T);CHKERRQ(ierr);
+  ierr = PetscMalloc7(ldh*mk*N,&H,ldh*N,&G,ldh*N,&Y,mk*N,&tau,N*N,&S,lwork,&work,2*N,&nrm0);CHKERRQ(ierr);
+  ierr = PetscMalloc2(ldh*N,&buf,ldh*N,&red);CHKERRQ(ierr);
+  nrm  = nrm0 + N;
+  ierr = PetscRandomCreate(comm,&rnd);CHKERRQ(ierr);
+
+  /* V_0 <- B - A X, preconditioned from the left if needed */
+  ierr = MatCopy(B,T,SAME_NONZERO_PATTERN);CHKERRQ(ierr);
+  if (!ksp->guess_zero) {
+    ierr = KSPMatMatMult_Private(ksp,Amat,X,&AV);CHKERRQ(ierr);
+    ierr = MatAXPY(T,-1.0,AV,SAME_NONZERO_PATTERN);CHKERRQ(ierr);
+  }
+  if (ksp->pc_side == PC_LEFT) {
+    ierr = PCMatApply(ksp->pc,T,V[0]);CHKERRQ(ierr);
+  } else {
+    ierr = MatCopy(T,V[0],SAME_NONZERO_PATTERN);CHKERRQ(ierr);
+  }
+  ierr = MatGetColumnNorms(V[0],NORM_2,nrm0);CHKERRQ(ierr);
+  ierr = PetscObjectSAWsTakeAccess((PetscObject)ksp);CHKERRQ(ierr);
+  ksp->its = 0;
+  ierr = PetscObjectSAWsGrantAccess((PetscObject)ksp);CHKERRQ(ierr);
+  ierr = KSPMatSolveConverged_Private(ksp,N,nrm0,nrm0);CHKERRQ(ierr);
+
+  while (!ksp->reason) {
+    /* V_0 S = R, the right hand side of the least squares problem is [S; 0] */
+    ierr = KSPGMRESBlockOrthogonalize_Private(ksp,rnd,m,N,0,varr,varr,S,N,buf,red);CHKERRQ(ierr);
+    ierr = PetscObjectStateIncrease((PetscObject)V[0]);CHKERRQ(ierr);
+    ierr = PetscArrayzero(G,ldh*N);CHKERRQ(ierr);
+    for (j=0; j<N; j++) {ierr = PetscArraycpy(G+j*ldh,S+j*N,N);CHKERRQ(ierr);}
+    for (nb=0; nb<mk && !ksp->reason; nb++) {
+      if (ksp->pc_side == PC_LEFT) {                                         /*   V_nb+1 <- M A V_nb   */
+        ierr = KSPMatMatMult_Private(ksp,Amat,V[nb],&AV);CHKERRQ(ierr);
+        ierr = PCMatApply(ksp->pc,AV,V[nb+1]);CHKERRQ(ierr);
+      } else {                                                               /*   V_nb+1 <- A M V_nb   */
+        ierr = PCMatApply(ksp->pc,V[nb],T);CHKERRQ(ierr);
+        ierr = KSPMatMatMult_Private(ksp,Amat,T,&AV);CHKERRQ(ierr);
+        ierr = MatCopy(AV,V[nb+1],SAME_NONZERO_PATTERN);CHKERRQ(ierr);
+      }
+      ierr = KSPGMRESBlockOrthogonalize_Private(ksp,rnd,m,N,(nb+1)*N,varr,varr+(nb+1)*m*N,H+nb*N*ldh,ldh,buf,red);CHKERRQ(ierr);
+      ierr = PetscObjectStateIncrease((PetscObject)V[nb+1]);CHKERRQ(ierr);
+
+      /* QR factorization of the block Hessenberg matrix, updated with the new block column */
+      for (i=0; i<nb; i++) {
+        PetscStackCallBLAS("LAPACKormqr",LAPACKormqr_("L",trans,&b2N,&bN,&bN,H+i*N+i*N*ldh,&bh,tau+i*N,H+i*N+nb*N*ldh,&bh,work,&lwork,&info));
+        if (info) SETERRQ1(PETSC_COMM_SELF,PETSC_ERR_LIB,"Error in LAPACK routine ormqr %d",(int)info);
+      }
+      PetscStackCallBLAS("LAPACKgeqrf",LAPACKgeqrf_(&b2N,&bN,H+nb*N+nb*N*ldh,&bh,tau+nb*N,work,&lwork,&info));
+      if (info) SETERRQ1(PETSC_COMM_SELF,PETSC_ERR_LIB,"Error in LAPACK routine geqrf %d",(int)info);
+      PetscStackCallBLAS("LAPACKormqr",LAPACKormqr_("L",trans,&b2N,&bN,&bN,H+nb*N+nb*N*ldh,&bh,tau+nb*N,G+nb*N,&bh,work,&lwork,&info));
+      if (info) SETERRQ1(PETSC_COMM_SELF,PETSC_ERR_LIB,"Error in LAPACK routine ormqr %d",(int)info);
+      ierr = PetscLogFlops(8.0*N*N*N*(nb+2));CHKERRQ(ierr);
+
+      /* the residual norm of each column is the norm of the trailing block of the rotated right hand side */
+      for (j=0; j<N; j++) {
+        nrm[j] = 0.0;
+        for (c=(nb+1)*N; c<(nb+2)*N; c++) nrm[j] += PetscRealPart(PetscConj(G[c+j*ldh])*G[c+j*ldh]);
+        nrm[j] = PetscSqrtReal(nrm[j]);
+      }
+      ierr = PetscObjectSAWsTakeAccess((PetscObject)ksp);CHKERRQ(ierr);
+      ksp->its++;
+      ierr = PetscObjectSAWsGrantAccess((PetscObject)ksp);CHKERRQ(ierr);
+      ierr = KSPMatSolveConverged_Private(ksp,N,nrm0,nrm);CHKERRQ(ierr);
+    }
+
+    /* Y <- R^{-1} G, with R the triangular factor of the block Hessenberg matrix */
+    dmax = 0.0;
+    for (i=0; i<nb*N; i++) dmax = PetscMax(dmax,PetscAbsScalar(H[i+i*ldh]));
+    for (i=0; i<nb*N; i++) {
+      if (PetscAbsScalar(H[i+i*ldh]) <= PETSC_MACHINE_EPSILON*dmax) break;
+    }
+    if (i < nb*N) {
+      ierr = PetscInfo1(ksp,"Singular block Hessenberg matrix at iteration %D\n",ksp->its);CHKERRQ(ierr);
+      ksp->reason = KSP_DIVERGED_BREAKDOWN;
+      break;
+    }
+    ierr = PetscBLASIntCast(nb*N,&bs);CHKERRQ(ierr);
+    for (j=0; j<N; j++) {ierr = PetscArraycpy(Y+j*ldh,G+j*ldh,nb*N);CHKERRQ(ierr);}
+    PetscStackCallBLAS("BLAStrsm",BLAStrsm_("L","U","N","N",&bs,&bN,&one,H,&bh,Y,&bh));
+    ierr = PetscLogFlops(1.0*nb*N*nb*N*N);CHKERRQ(ierr);
+    if (ksp->pc_side == PC_LEFT) {                                           /*   X <- X + V Y         */
+      ierr = MatDenseGetLDA(X,&ldx);CHKERRQ(ierr);
+      ierr = PetscBLASIntCast(PetscMax(ldx,1),&blx);CHKERRQ(ierr);
+      ierr = MatDenseGetArray(X,&x);CHKERRQ(ierr);
+      PetscStackCallBLAS("BLASgemm",BLASgemm_("N","N",&bm,&bN,&bs,&one,varr,&bld,Y,&bh,&one,x,&blx));
+      ierr = MatDenseRestoreArray(X,&x);CHKERRQ(ierr);
+    } else {                                                                 /*   X <- X + M V Y       */
+      ierr = MatDenseGetLDA(T,&ldt);CHKERRQ(ierr);
+      ierr = PetscBLASIntCast(PetscMax(ldt,1),&blt);CHKERRQ(ierr);
+      ierr = MatDenseGetArray(T,&t);CHKERRQ(ierr);
+      PetscStackCallBLAS("BLASgemm",BLASgemm_("N","N",&bm,&bN,&bs,&one,varr,&bld,Y,&bh,&zero,t,&blt));
+      ierr = MatDenseRestoreArray(T,&t);CHKERRQ(ierr);
+      ierr = PCMatApply(ksp->pc,T,V[0]);CHKERRQ(ierr);
+      ierr = MatAXPY(X,1.0,V[0],SAME_NONZERO_PATTERN);CHKERRQ(ierr);
+    }
+    ierr = PetscLogFlops(2.0*m*nb*N*N);CHKERRQ(ierr);
+    if (!ksp->reason) {
+      /* restart from the residual of the current iterate */
+      ierr = MatCopy(B,T,SAME_NONZERO_PATTERN);CHKERRQ(ierr);
+      ierr = KSPMatMatMult_Private(ksp,Amat,X,&AV);CHKERRQ(ierr);
+      ierr = MatAXPY(T,-1.0,AV,SAME_NONZERO_PATTERN);CHKERRQ(ierr);
+      if (ksp->pc_side == PC_LEFT) {
+        ierr = PCMatApply(ksp->pc,T,V[0]);CHKERRQ(ierr);
+      } else {
+        ierr = MatCopy(T,V[0],SAME_NONZERO_PATTERN);CHKERRQ(ierr);
+      }
+    }
+  }
+
+  ierr = PetscRandomDestroy(&rnd);CHKERRQ(ierr);
+  ierr = PetscFree2(buf,red);CHKERRQ(ierr);
+  ierr = PetscFree7(H,G,Y,tau,S,work,nrm0);CHKERRQ(ierr);
+  ierr = MatDestroy(&AV);CHKERRQ(ierr);
+  ierr = MatDestroy(&T);CHKERRQ(ierr);
+  for (j=0; j<mk+1; j++) {ierr = MatDestroy(&V[j]);CHKERRQ(ierr);}
+  ierr = PetscFree(V);CHKERRQ(ierr);
+  ierr = PetscFree(varr);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
 /*MC
      KSPGMRES - Implements the Generalized Minimal Residual method.
                 (Saad and Schultz, 1986) with restart
@@ -839,6 +1137,7 @@ PetscErrorCode  KSPGMRESSetHapTol(KSP ksp,PetscReal tol)
                              vectors are allocated as needed)
 .   -ksp_gmres_classicalgramschmidt - use classical (unmodified) Gram-Schmidt to orthogonalize against the Krylov space (fast) (the default)
 .   -ksp_gmres_modifiedgramschmidt - use modified Gram-Schmidt in the orthogonalization (more stable, but slower)
+.   -ksp_gmres_lowsyncgramschmidt - use classical Gram-Schmidt with a single global reduction per iteration, see KSPGMRESLowSyncGramSchmidtOrthogonalization()
 .   -ksp_gmres_cgs_refinement_type <refine_never,refine_ifneeded,refine_always> - determine if iterative refinement is used to increase the
                                    stability of the classical Gram-Schmidt  orthogonalization.
 -   -ksp_gmres_krylov_monitor - plot the Krylov space generated
@@ -848,13 +1147,16 @@ PetscErrorCode  KSPGMRESSetHapTol(KSP ksp,PetscReal tol)
    Notes:
     Left and right preconditioning are supported, but not symmetric preconditioning.
 
+    KSPMatSolve() uses block GMRES, which builds a single Krylov space for all the right hand sides; the restart is then
+    the number of blocks of vectors kept before restarting.
+
    References:
 .     1. - YOUCEF SAAD AND MARTIN H. SCHULTZ, GMRES: A GENERALIZED MINIMAL RESIDUAL ALGORITHM FOR SOLVING NONSYMMETRIC LINEAR SYSTEMS.
           SIAM J. ScI. STAT. COMPUT. Vo|. 7, No. 3, July 1986.
 
 .seealso:  KSPCreate(), KSPSetType(), KSPType (for list of available types), KSP, KSPFGMRES, KSPLGMRES,
            KSPGMRESSetRestart(), KSPGMRESSetHapTol(), KSPGMRESSetPreAllocateVectors(), KSPGMRESSetOrthogonalization(), KSPGMRESGetOrthogonalization(),
-           KSPGMRESClassicalGramSchmidtOrthogonalization(), KSPGMRESModifiedGramSchmidtOrthogonalization(),
+           KSPGMRESClassicalGramSchmidtOrthogonalization(), KSPGMRESModifiedGramSchmidtOrthogonalization(), KSPGMRESLowSyncGramSchmidtOrthogonalization(),
            KSPGMRESCGSRefinementType, KSPGMRESSetCGSRefinementType(), KSPGMRESGetCGSRefinementType(), KSPGMRESMonitorKrylov(), KSPSetPCSide()
 
 M*/
@@ -877,6 +1179,7 @@ PETSC_EXTERN PetscErrorCode KSPCreate_GMRES(KSP ksp)
   ksp->ops->buildsolution                = KSPBuildSolution_GMRES;
   ksp->ops->setup                        = KSPSetUp_GMRES;
   ksp->ops->solve                        = KSPSolve_GMRES;
+  ksp->ops->matsolve                     = KSPMatSolve_GMRES;
   ksp->ops->reset                        = KSPReset_GMRES;
   ksp->ops->destroy                      = KSPDestroy_GMRES;
   ksp->ops->view                         = KSPView_GMRES;
@@ -905,6 +1208,7 @@ PETSC_EXTERN PetscErrorCode KSPCreate_GMRES(KSP ksp)
   gmres->Rsvd           = 0;
   gmres->cgstype        = KSP_GMRES_CGS_REFINE_NEVER;
   gmres->orthogwork     = 0;
+  gmres->orthognorm     = -1.0;
   PetscFunctionReturn(0);
 }
 
@@ -195,10 +195,14 @@ PetscErrorCode KSPLGMRESCycle(PetscInt *itcount,KSP ksp)
 
     /* update hessenberg matrix and do Gram-Schmidt - new direction is in
        VEC_VV(1+loc_it)*/
+    lgmres->orthognorm = -1.0;
     ierr = (*lgmres->orthog)(ksp,loc_it);CHKERRQ(ierr);
+    if (ksp->reason) break;
 
-    /* new entry in hessenburg is the 2-norm of our new direction */
-    ierr = VecNorm(VEC_VV(loc_it+1),NORM_2,&tt);CHKERRQ(ierr);
+    /* new entry in hessenburg is the 2-norm of our new direction, unless the orthogonalization already computed it */
+    if (lgmres->orthognorm < 0.0) {
+      ierr = VecNorm(VEC_VV(loc_it+1),NORM_2,&tt);CHKERRQ(ierr);
+    } else tt = lgmres->orthognorm;
 
     *HH(loc_it+1,loc_it)  = tt;
     *HES(loc_it+1,loc_it) = tt;
@@ -814,6 +818,7 @@ PETSC_EXTERN PetscErrorCode KSPCreate_LGMRES(KSP ksp)
   lgmres->Rsvd           = 0;
   lgmres->cgstype        = KSP_GMRES_CGS_REFINE_NEVER;
   lgmres->orthogwork     = 0;
+  lgmres->orthognorm     = -1.0;
 
   /*LGMRES_MOD - new defaults */
   lgmres->aug_dim         = LGMRES_DEFAULT_AUGDIM;
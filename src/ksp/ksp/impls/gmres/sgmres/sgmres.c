@@ -0,0 +1,612 @@
+/*
+    This file implements s-step (communication avoiding) GMRES.
+
+    Each block of s iterations generates s new Krylov vectors with a polynomial recurrence (monomial or Newton basis)
+    and orthogonalizes them against the current Arnoldi basis and among themselves with a single block reduction
+    (block classical Gram-Schmidt with a Cholesky QR of the projected block). The Hessenberg matrix of the Arnoldi
+    relation is then recovered from the recurrence and the block factors, so the least squares problem and the
+    solution update are the ones of KSPGMRES.
+*/
+
+#include <../src/ksp/ksp/impls/gmres/gmresimpl.h>       /*I  "petscksp.h"  I*/
+#define SGMRES_DELTA_DIRECTIONS 10
+#define SGMRES_DEFAULT_MAXK     30
+
+typedef enum {KSP_SGMRES_BASIS_MONOMIAL,KSP_SGMRES_BASIS_NEWTON} KSPSGMRESBasisType;
+static const char *const KSPSGMRESBasisTypes[] = {"monomial","newton","KSPSGMRESBasisType","KSP_SGMRES_BASIS_",0};
+
+typedef struct {
+  KSPGMRESHEADER
+  PetscInt           s;              /* number of Krylov vectors per block reduction */
+  KSPSGMRESBasisType basis;
+  PetscInt           nshifts;        /* number of Ritz values available for the Newton basis, 0 before the first restart */
+  PetscScalar        *theta,*sigma;  /* recurrence op K_i = K_{i+1} + theta_i K_i + sigma_i K_{i-1} */
+  PetscScalar        *C,*C2;         /* projections of the block on the previous basis vectors */
+  PetscScalar        *G,*R;          /* Gram matrix of the block and its Cholesky factor */
+  PetscScalar        *X,*coef;
+  PetscReal          *gd;            /* squared norms of the block before orthogonalization */
+} KSP_SGMRES;
+
+static PetscErrorCode KSPSetUp_SGMRES(KSP ksp)
+{
+  KSP_SGMRES     *sgmres = (KSP_SGMRES*)ksp->data;
+  PetscInt       max_k = sgmres->max_k,s = sgmres->s;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  if (s < 1) SETERRQ1(PetscObjectComm((PetscObject)ksp),PETSC_ERR_ARG_OUTOFRANGE,"Number of steps %D must be positive",s);
+  ierr = KSPSetUp_GMRES(ksp);CHKERRQ(ierr);
+  if (sgmres->basis == KSP_SGMRES_BASIS_NEWTON && !sgmres->Rsvd) {
+    /* the shifts of the Newton basis are the eigenvalues of the Hessenberg matrix of the first cycle */
+    ierr = PetscMalloc1((max_k + 3)*(max_k + 9),&sgmres->Rsvd);CHKERRQ(ierr);
+    ierr = PetscLogObjectMemory((PetscObject)ksp,(max_k + 3)*(max_k + 9)*sizeof(PetscScalar));CHKERRQ(ierr);
+    ierr = PetscMalloc1(6*(max_k+2),&sgmres->Dsvd);CHKERRQ(ierr);
+    ierr = PetscLogObjectMemory((PetscObject)ksp,6*(max_k+2)*sizeof(PetscReal));CHKERRQ(ierr);
+  }
+  /* KSPGMRESSetRestart() may have reset the GMRES part only */
+  ierr = PetscFree7(sgmres->theta,sgmres->sigma,sgmres->C,sgmres->G,sgmres->X,sgmres->coef,sgmres->gd);CHKERRQ(ierr);
+  ierr = PetscMalloc7(s,&sgmres->theta,s,&sgmres->sigma,2*(max_k+1)*s,&sgmres->C,2*s*s,&sgmres->G,(max_k+2)*s,&sgmres->X,max_k+1+s,&sgmres->coef,s,&sgmres->gd);CHKERRQ(ierr);
+  ierr = PetscLogObjectMemory((PetscObject)ksp,(2*s+2*(max_k+1)*s+2*s*s+(max_k+2)*s+max_k+1+s)*sizeof(PetscScalar)+s*sizeof(PetscReal));CHKERRQ(ierr);
+  sgmres->C2 = sgmres->C + (max_k+1)*s;
+  sgmres->R  = sgmres->G + s*s;
+  PetscFunctionReturn(0);
+}
+
+/*
+   Cholesky factorization R'R = G - C'C of the Gram matrix of a block projected out of the m previous basis vectors.
+   Stops at the first column whose squared norm after projection is not larger than eta (eta0 for the first column)
+   times its squared norm gd before the orthogonalization, p is the number of columns accepted.
+*/
+static PetscErrorCode KSPSGMRESCholesky(PetscInt t,PetscInt m,const PetscScalar *C,const PetscScalar *G,const PetscReal *gd,PetscReal eta0,PetscReal eta,PetscScalar *R,PetscInt *p)
+{
+  PetscScalar v;
+  PetscInt    i,k,l;
+
+  PetscFunctionBegin;
+  for (i=0; i<t; i++) {
+    for (k=0; k<=i; k++) {
+      v = G[k+i*t];
+      for (l=0; l<m; l++) v -= PetscConj(C[l+k*m])*C[l+i*m];
+      for (l=0; l<k; l++) v -= PetscConj(R[l+k*t])*R[l+i*t];
+      if (k < i) R[k+i*t] = v/R[k+k*t];
+      else if (PetscRealPart(v) <= (i ? eta : eta0)*gd[i]) {
+        *p = i;
+        PetscFunctionReturn(0);
+      } else R[i+i*t] = PetscSqrtReal(PetscRealPart(v));
+    }
+  }
+  *p = t;
+  PetscFunctionReturn(0);
+}
+
+/* All the inner products of the block VEC_VV(j+1 .. j+t) with the basis and with itself, in one reduction */
+static PetscErrorCode KSPSGMRESBlockDot(KSP ksp,PetscInt j,PetscInt t,PetscScalar *C,PetscScalar *G)
+{
+  KSP_GMRES      *gmres = (KSP_GMRES*)ksp->data;
+  PetscErrorCode ierr;
+  PetscInt       i;
+
+  PetscFunctionBegin;
+  for (i=0; i<t; i++) {
+    ierr = VecMDotBegin(VEC_VV(j+1+i),j+1,&VEC_VV(0),C+i*(j+1));CHKERRQ(ierr);
+    ierr = VecMDotBegin(VEC_VV(j+1+i),i+1,&VEC_VV(j+1),G+i*t);CHKERRQ(ierr);
+  }
+  for (i=0; i<t; i++) {
+    ierr = VecMDotEnd(VEC_VV(j+1+i),j+1,&VEC_VV(0),C+i*(j+1));CHKERRQ(ierr);
+    ierr = VecMDotEnd(VEC_VV(j+1+i),i+1,&VEC_VV(j+1),G+i*t);CHKERRQ(ierr);
+  }
+  PetscFunctionReturn(0);
+}
+
+/*
+   Orthonormalizes the block W = VEC_VV(j+1 .. j+t) against VEC_VV(0 .. j) and within itself, W = V C + Q R.
+   The Cholesky factor of the projected block tells if it lost orthogonality, in which case (or always, depending on
+   the KSPGMRESCGSRefinementType) a second pass is done. On output q is the number of columns that could be
+   orthonormalized, or 1 with R(0,0) = 0 if the first one lies in the span of V.
+*/
+static PetscErrorCode KSPSGMRESBlockOrthogonalize(KSP ksp,PetscInt j,PetscInt t,PetscInt *q)
+{
+  KSP_SGMRES     *sgmres = (KSP_SGMRES*)ksp->data;
+  KSP_GMRES      *gmres  = (KSP_GMRES*)ksp->data;
+  PetscScalar    *C = sgmres->C,*C2 = sgmres->C2,*G = sgmres->G,*R = sgmres->R,*coef = sgmres->coef,*Cp = C;
+  PetscReal      eta = PETSC_SQRT_MACHINE_EPSILON;
+  PetscErrorCode ierr;
+  PetscInt       i,k,l,m = j+1,p;
+
+  PetscFunctionBegin;
+  ierr = KSPSGMRESBlockDot(ksp,j,t,C,G);CHKERRQ(ierr);
+  for (i=0; i<t; i++) sgmres->gd[i] = PetscRealPart(G[i+i*t]);
+  if (gmres->cgstype == KSP_GMRES_CGS_REFINE_NEVER) {
+    ierr = KSPSGMRESCholesky(t,m,C,G,sgmres->gd,0.0,eta,R,&p);CHKERRQ(ierr);
+  } else {
+    p = 0;
+    if (gmres->cgstype == KSP_GMRES_CGS_REFINE_IFNEEDED) {
+      /* the same test as in KSPGMRESClassicalGramSchmidtOrthogonalization(), the projection is larger than what remains */
+      ierr = KSPSGMRESCholesky(t,m,C,G,sgmres->gd,0.5,0.5,R,&p);CHKERRQ(ierr);
+    }
+    if (p < t) {
+      ierr = PetscInfo2(ksp,"Performing iterative refinement of block of %D vectors at %D\n",t,j);CHKERRQ(ierr);
+      for (i=0; i<t; i++) {
+        for (l=0; l<m; l++) coef[l] = -C[l+i*m];
+        ierr = VecMAXPY(VEC_VV(j+1+i),m,coef,&VEC_VV(0));CHKERRQ(ierr);
+      }
+      ierr = KSPSGMRESBlockDot(ksp,j,t,C2,G);CHKERRQ(ierr);
+      for (i=0; i<m*t; i++) C[i] += C2[i];
+      ierr = KSPSGMRESCholesky(t,m,C2,G,sgmres->gd,0.0,eta,R,&p);CHKERRQ(ierr);
+      Cp   = C2;
+    }
+  }
+  if (p < t) {
+    ierr = PetscInfo3(ksp,"Block of %D vectors at %D has numerical rank %D\n",t,j,p);CHKERRQ(ierr);
+  }
+
+  /* Q_i = (W_i - V Cp_i - sum_{k<i} R_ki Q_k)/R_ii, the Q_k being stored right after V */
+  for (i=0; i<p; i++) {
+    for (l=0; l<m; l++) coef[l] = -Cp[l+i*m];
+    for (k=0; k<i; k++) coef[m+k] = -R[k+i*t];
+    ierr = VecMAXPY(VEC_VV(j+1+i),m+i,coef,&VEC_VV(0));CHKERRQ(ierr);
+    ierr = VecScale(VEC_VV(j+1+i),1.0/R[i+i*t]);CHKERRQ(ierr);
+  }
+  if (!p) R[0] = 0.0;
+  *q = p ? p : 1;
+  PetscFunctionReturn(0);
+}
+
+/*
+   Computes the columns j .. j+q-1 of the Hessenberg matrix from op K = K Bbar and the factorization of the block of t vectors.
+
+   With Rhat the coordinates of K_0 .. K_q in the orthonormal basis and T its square block in rows j .. j+q-1,
+   op V_{j+c} follows from X T = Rhat Bbar - H(:,0:j-1) Rhat(0:j-1,:), solved column by column.
+*/
+static PetscErrorCode KSPSGMRESBlockHessenberg(KSP ksp,PetscInt j,PetscInt t,PetscInt q)
+{
+  KSP_SGMRES  *sgmres = (KSP_SGMRES*)ksp->data;
+  KSP_GMRES   *gmres  = (KSP_GMRES*)ksp->data;
+  PetscScalar *C = sgmres->C,*R = sgmres->R,*X = sgmres->X,*theta = sgmres->theta,*sigma = sgmres->sigma,v,T;
+  PetscInt    m = j+q+1,c,r,l;
+
+  PetscFunctionBegin;
+  for (c=0; c<q; c++) {
+    PetscScalar *x = X+c*m;
+
+    /* column c of Rhat Bbar: Rhat(:,c+1) + theta_c Rhat(:,c) + sigma_c Rhat(:,c-1) */
+    for (r=0; r<m; r++) x[r] = 0.0;
+    for (r=0; r<=j; r++) x[r] = C[r+c*(j+1)];
+    for (r=0; r<=c; r++) x[j+1+r] = R[r+c*t];
+    if (!c) x[j] += theta[0];
+    else {
+      for (r=0; r<=j; r++) x[r] += theta[c]*C[r+(c-1)*(j+1)];
+      for (r=0; r<c; r++) x[j+1+r] += theta[c]*R[r+(c-1)*t];
+      if (c == 1) x[j] += sigma[1];
+      else {
+        for (r=0; r<=j; r++) x[r] += sigma[c]*C[r+(c-2)*(j+1)];
+        for (r=0; r<c-1; r++) x[j+1+r] += sigma[c]*R[r+(c-2)*t];
+      }
+      /* minus the part of op K_c coming from the previous Arnoldi vectors */
+      for (l=0; l<j; l++) {
+        v = C[l+(c-1)*(j+1)];
+        if (v == 0.0) continue;
+        for (r=0; r<=l+1; r++) x[r] -= *HES(r,l)*v;
+      }
+    }
+    /* forward substitution with T */
+    for (l=0; l<c; l++) {
+      T = l ? R[(l-1)+(c-1)*t] : C[j+(c-1)*(j+1)];
+      for (r=0; r<m; r++) x[r] -= X[r+l*m]*T;
+    }
+    if (c) {
+      T = R[(c-1)+(c-1)*t];
+      for (r=0; r<m; r++) x[r] /= T;
+    }
+    for (r=0; r<=j+c+1; r++) *HES(r,j+c) = *HH(r,j+c) = x[r];
+  }
+  PetscFunctionReturn(0);
+}
+
+/*
+   Do the scalar work for the orthogonalization.  Return new residual norm.
+ */
+static PetscErrorCode KSPSGMRESUpdateHessenberg(KSP ksp,PetscInt it,PetscBool hapend,PetscReal *res)
+{
+  PetscScalar *hh,*cc,*ss,tt;
+  PetscInt    j;
+  KSP_GMRES   *gmres = (KSP_GMRES*)(ksp->data);
+
+  PetscFunctionBegin;
+  hh = HH(0,it);
+  cc = CC(0);
+  ss = SS(0);
+
+  /* Apply all the previously computed plane rotations to the new column
+     of the Hessenberg matrix */
+  for (j=1; j<=it; j++) {
+    tt  = *hh;
+    *hh = PetscConj(*cc) * tt + *ss * *(hh+1);
+    hh++;
+    *hh = *cc++ * *hh - (*ss++ * tt);
+  }
+
+  /*
+    compute the new plane rotation, and apply it to:
+     1) the right-hand-side of the Hessenberg system
+     2) the new column of the Hessenberg matrix
+    thus obtaining the updated value of the residual
+  */
+  if (!hapend) {
+    tt = PetscSqrtScalar(PetscConj(*hh) * *hh + PetscConj(*(hh+1)) * *(hh+1));
+    if (tt == 0.0) {
+      if (ksp->errorifnotconverged) SETERRQ(PetscObjectComm((PetscObject)ksp),PETSC_ERR_NOT_CONVERGED,"tt == 0.0");
+      else {
+        ksp->reason = KSP_DIVERGED_NULL;
+        PetscFunctionReturn(0);
+      }
+    }
+    *cc        = *hh / tt;
+    *ss        = *(hh+1) / tt;
+    *GRS(it+1) = -(*ss * *GRS(it));
+    *GRS(it)   = PetscConj(*cc) * *GRS(it);
+    *hh        = PetscConj(*cc) * *hh + *ss * *(hh+1);
+    *res       = PetscAbsScalar(*GRS(it+1));
+  } else {
+    /* happy breakdown: HH(it+1, it) = 0, so no rotation is needed and the residual is zero */
+    *res = 0.0;
+  }
+  PetscFunctionReturn(0);
+}
+
+/*
+   Leja ordered Ritz values of the first cycle as the shifts of the Newton basis. In real arithmetic complex conjugate
+   pairs are kept together and applied as one real quadratic factor.
+*/
+static PetscErrorCode KSPSGMRESComputeShifts(KSP ksp)
+{
+  KSP_SGMRES     *sgmres = (KSP_SGMRES*)ksp->data;
+  PetscInt       s = sgmres->s,n = sgmres->it+1,neig,i,k,l,nord = 0,pos,*ord;
+  PetscReal      *re,*im,best,score,dist;
+  PetscBool      *used;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  if (n < 1 || !sgmres->Rsvd) PetscFunctionReturn(0);
+  ierr = PetscMalloc4(n,&re,n,&im,n,&ord,n,&used);CHKERRQ(ierr);
+  ierr = KSPComputeEigenvalues_GMRES(ksp,n,re,im,&neig);CHKERRQ(ierr);
+  for (i=0; i<neig; i++) {
+#if defined(PETSC_USE_COMPLEX)
+    used[i] = PETSC_FALSE;
+#else
+    used[i] = (PetscBool)(im[i] < 0.0);
+#endif
+  }
+  for (k=0; k<neig; k++) {
+    l    = -1;
+    best = PETSC_MIN_REAL;
+    for (i=0; i<neig; i++) {
+      if (used[i]) continue;
+      if (!nord) score = PetscSqrtReal(re[i]*re[i]+im[i]*im[i]);
+      else {
+        score = 0.0;
+        for (pos=0; pos<nord; pos++) {
+          dist = PetscSqrtReal((re[i]-re[ord[pos]])*(re[i]-re[ord[pos]])+(im[i]-im[ord[pos]])*(im[i]-im[ord[pos]]));
+#if !defined(PETSC_USE_COMPLEX)
+          if (im[ord[pos]] > 0.0) dist *= PetscSqrtReal((re[i]-re[ord[pos]])*(re[i]-re[ord[pos]])+(im[i]+im[ord[pos]])*(im[i]+im[ord[pos]]));
+#endif
+          score = dist > 0.0 ? score + PetscLogReal(dist) : PETSC_MIN_REAL;
+          if (score == PETSC_MIN_REAL) break;
+        }
+      }
+      if (l < 0 || score > best) {l = i; best = score;}
+    }
+    if (l < 0) break;
+    used[l]      = PETSC_TRUE;
+    ord[nord++]  = l;
+  }
+  if (nord) {
+    for (pos=0,k=0; pos<s; k++) {
+      i = ord[k % nord];
+#if defined(PETSC_USE_COMPLEX)
+      sgmres->theta[pos]   = PetscCMPLX(re[i],im[i]);
+      sgmres->sigma[pos++] = 0.0;
+#else
+      sgmres->theta[pos]   = re[i];
+      sgmres->sigma[pos++] = 0.0;
+      if (im[i] > 0.0 && pos < s) {
+        sgmres->theta[pos]   = re[i];
+        sgmres->sigma[pos++] = -im[i]*im[i];
+      }
+#endif
+    }
+    sgmres->nshifts = nord;
+  }
+  ierr = PetscFree4(re,im,ord,used);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/*
+    Run s-step gmres, possibly with restart.
+
+    Notes:
+    On entry, the value in vector VEC_VV(0) should be the initial residual.
+ */
+static PetscErrorCode KSPSGMRESCycle(PetscInt *itcount,KSP ksp)
+{
+  KSP_SGMRES     *sgmres = (KSP_SGMRES*)ksp->data;
+  KSP_GMRES      *gmres  = (KSP_GMRES*)ksp->data;
+  PetscReal      res,hapbnd,tt;
+  PetscErrorCode ierr;
+  PetscInt       it = 0,max_k = gmres->max_k,s,t,q = 0,c,i;
+  PetscBool      hapend = PETSC_FALSE;
+
+  PetscFunctionBegin;
+  if (itcount) *itcount = 0;
+  ierr    = VecNormalize(VEC_VV(0),&res);CHKERRQ(ierr);
+  KSPCheckNorm(ksp,res);
+  *GRS(0) = res;
+
+  /* check for the convergence */
+  ierr       = PetscObjectSAWsTakeAccess((PetscObject)ksp);CHKERRQ(ierr);
+  ksp->rnorm = res;
+  ierr       = PetscObjectSAWsGrantAccess((PetscObject)ksp);CHKERRQ(ierr);
+  gmres->it  = (it - 1);
+  ierr = KSPLogResidualHistory(ksp,res);CHKERRQ(ierr);
+  ierr = KSPMonitor(ksp,ksp->its,res);CHKERRQ(ierr);
+  if (!res) {
+    ksp->reason = KSP_CONVERGED_ATOL;
+    ierr        = PetscInfo(ksp,"Converged due to zero residual norm on entry\n");CHKERRQ(ierr);
+    PetscFunctionReturn(0);
+  }
+  ierr = (*ksp->converged)(ksp,ksp->its,res,&ksp->reason,ksp->cnvP);CHKERRQ(ierr);
+
+  /* without shifts the Newton basis is built one vector at a time, which is the Arnoldi process */
+  s = (sgmres->basis == KSP_SGMRES_BASIS_NEWTON && !sgmres->nshifts) ? 1 : sgmres->s;
+  while (!ksp->reason && it < max_k && ksp->its < ksp->max_it) {
+    t = PetscMin(s,PetscMin(max_k-it,ksp->max_it-ksp->its));
+    while (gmres->vv_allocated <= it + t + VEC_OFFSET) {
+      ierr = KSPGMRESGetNewVectors(ksp,gmres->vv_allocated-VEC_OFFSET);CHKERRQ(ierr);
+    }
+
+    /* K_0 = v_it, K_{i+1} = (op - theta_i) K_i - sigma_i K_{i-1} */
+    for (i=0; i<t; i++) {
+      ierr = KSP_PCApplyBAorAB(ksp,VEC_VV(it+i),VEC_VV(it+i+1),VEC_TEMP_MATOP);CHKERRQ(ierr);
+      if (i && sgmres->sigma[i] != 0.0) {
+        ierr = VecAXPBYPCZ(VEC_VV(it+i+1),-sgmres->theta[i],-sgmres->sigma[i],1.0,VEC_VV(it+i),VEC_VV(it+i-1));CHKERRQ(ierr);
+      } else if (sgmres->theta[i] != 0.0) {
+        ierr = VecAXPY(VEC_VV(it+i+1),-sgmres->theta[i],VEC_VV(it+i));CHKERRQ(ierr);
+      }
+    }
+    ierr = KSPSGMRESBlockOrthogonalize(ksp,it,t,&q);CHKERRQ(ierr);
+    ierr = KSPSGMRESBlockHessenberg(ksp,it,t,q);CHKERRQ(ierr);
+
+    for (c=0; c<q; c++) {
+      if (it) {
+        ierr = KSPLogResidualHistory(ksp,res);CHKERRQ(ierr);
+        ierr = KSPMonitor(ksp,ksp->its,res);CHKERRQ(ierr);
+      }
+      gmres->it = (it - 1);
+
+      /* check for the happy breakdown */
+      tt     = PetscAbsScalar(*HH(it+1,it));
+      hapbnd = PetscAbsScalar(tt / *GRS(it));
+      if (hapbnd > gmres->haptol) hapbnd = gmres->haptol;
+      if (tt < hapbnd) {
+        ierr   = PetscInfo2(ksp,"Detected happy breakdown, current hapbnd = %14.12e tt = %14.12e\n",(double)hapbnd,(double)tt);CHKERRQ(ierr);
+        hapend = PETSC_TRUE;
+      }
+      ierr = KSPSGMRESUpdateHessenberg(ksp,it,hapend,&res);CHKERRQ(ierr);
+
+      it++;
+      gmres->it = (it-1);   /* For converged */
+      ksp->its++;
+      ksp->rnorm = res;
+      if (ksp->reason) break;
+
+      ierr = (*ksp->converged)(ksp,ksp->its,res,&ksp->reason,ksp->cnvP);CHKERRQ(ierr);
+
+      /* Catch error in happy breakdown and signal convergence and break from loop */
+      if (hapend) {
+        if (ksp->normtype == KSP_NORM_NONE) { /* convergence test was skipped in this case */
+          ksp->reason = KSP_CONVERGED_HAPPY_BREAKDOWN;
+        } else if (!ksp->reason) {
+          if (ksp->errorifnotconverged) SETERRQ1(PetscObjectComm((PetscObject)ksp),PETSC_ERR_NOT_CONVERGED,"You reached the happy break down, but convergence was not indicated. Residual norm = %g",(double)res);
+          else ksp->reason = KSP_DIVERGED_BREAKDOWN;
+        }
+      }
+      if (ksp->reason) break;
+    }
+  }
+
+  /* Monitor if we know that we will not return for a restart */
+  if (it && (ksp->reason || ksp->its >= ksp->max_it)) {
+    ierr = KSPLogResidualHistory(ksp,res);CHKERRQ(ierr);
+    ierr = KSPMonitor(ksp,ksp->its,res);CHKERRQ(ierr);
+  }
+
+  if (itcount) *itcount = it;
+
+  /* Form the solution (or the solution so far) */
+  ierr = KSPBuildSolution_GMRES(ksp,ksp->vec_sol,NULL);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode KSPSolve_SGMRES(KSP ksp)
+{
+  PetscErrorCode ierr;
+  PetscInt       its,itcount;
+  KSP_SGMRES     *sgmres    = (KSP_SGMRES*)ksp->data;
+  KSP_GMRES      *gmres     = (KSP_GMRES*)ksp->data;
+  PetscBool      guess_zero = ksp->guess_zero;
+
+  PetscFunctionBegin;
+  ierr     = PetscObjectSAWsTakeAccess((PetscObject)ksp);CHKERRQ(ierr);
+  ksp->its = 0;
+  ierr     = PetscObjectSAWsGrantAccess((PetscObject)ksp);CHKERRQ(ierr);
+
+  /* the operator may have changed since the last solve, the Newton shifts are recomputed */
+  sgmres->nshifts = 0;
+  ierr = PetscArrayzero(sgmres->theta,sgmres->s);CHKERRQ(ierr);
+  ierr = PetscArrayzero(sgmres->sigma,sgmres->s);CHKERRQ(ierr);
+
+  itcount     = 0;
+  ksp->reason = KSP_CONVERGED_ITERATING;
+  while (!ksp->reason) {
+    ierr     = KSPInitialResidual(ksp,ksp->vec_sol,VEC_TEMP,VEC_TEMP_MATOP,VEC_VV(0),ksp->vec_rhs);CHKERRQ(ierr);
+    ierr     = KSPSGMRESCycle(&its,ksp);CHKERRQ(ierr);
+    itcount += its;
+    if (itcount >= ksp->max_it) {
+      if (!ksp->reason) ksp->reason = KSP_DIVERGED_ITS;
+      break;
+    }
+    if (!ksp->reason && sgmres->basis == KSP_SGMRES_BASIS_NEWTON && !sgmres->nshifts) {
+      ierr = KSPSGMRESComputeShifts(ksp);CHKERRQ(ierr);
+    }
+    ksp->guess_zero = PETSC_FALSE; /* every future call to KSPInitialResidual() will have nonzero guess */
+  }
+  ksp->guess_zero = guess_zero; /* restore if user provided nonzero initial guess */
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode KSPReset_SGMRES(KSP ksp)
+{
+  KSP_SGMRES     *sgmres = (KSP_SGMRES*)ksp->data;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscFree7(sgmres->theta,sgmres->sigma,sgmres->C,sgmres->G,sgmres->X,sgmres->coef,sgmres->gd);CHKERRQ(ierr);
+  ierr = KSPReset_GMRES(ksp);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode KSPDestroy_SGMRES(KSP ksp)
+{
+  KSP_SGMRES     *sgmres = (KSP_SGMRES*)ksp->data;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscFree7(sgmres->theta,sgmres->sigma,sgmres->C,sgmres->G,sgmres->X,sgmres->coef,sgmres->gd);CHKERRQ(ierr);
+  ierr = KSPDestroy_GMRES(ksp);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode KSPView_SGMRES(KSP ksp,PetscViewer viewer)
+{
+  KSP_SGMRES     *sgmres = (KSP_SGMRES*)ksp->data;
+  PetscErrorCode ierr;
+  PetscBool      iascii;
+
+  PetscFunctionBegin;
+  ierr = KSPView_GMRES(ksp,viewer);CHKERRQ(ierr);
+  ierr = PetscObjectTypeCompare((PetscObject)viewer,PETSCVIEWERASCII,&iascii);CHKERRQ(ierr);
+  if (iascii) {
+    ierr = PetscViewerASCIIPrintf(viewer,"  %D steps per block reduction, %s basis\n",sgmres->s,KSPSGMRESBasisTypes[sgmres->basis]);CHKERRQ(ierr);
+  }
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode KSPSetFromOptions_SGMRES(PetscOptionItems *PetscOptionsObject,KSP ksp)
+{
+  KSP_SGMRES     *sgmres = (KSP_SGMRES*)ksp->data;
+  PetscInt       s;
+  PetscBool      flg;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = KSPSetFromOptions_GMRES(PetscOptionsObject,ksp);CHKERRQ(ierr);
+  ierr = PetscOptionsHead(PetscOptionsObject,"KSP s-step GMRES Options");CHKERRQ(ierr);
+  ierr = PetscOptionsInt("-ksp_sgmres_steps","Number of Krylov vectors per block reduction","KSPSGMRES",sgmres->s,&s,&flg);CHKERRQ(ierr);
+  if (flg && s != sgmres->s) {
+    if (s < 1) SETERRQ(PetscObjectComm((PetscObject)ksp),PETSC_ERR_ARG_OUTOFRANGE,"Number of steps must be positive");
+    sgmres->s = s;
+    if (ksp->setupstage) {
+      ksp->setupstage = KSP_SETUP_NEW;
+      ierr = KSPReset_SGMRES(ksp);CHKERRQ(ierr);
+    }
+  }
+  ierr = PetscOptionsEnum("-ksp_sgmres_basis","Polynomial basis of the s-step Krylov space","KSPSGMRES",KSPSGMRESBasisTypes,(PetscEnum)sgmres->basis,(PetscEnum*)&sgmres->basis,NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsTail();CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/*MC
+     KSPSGMRES - Implements the s-step (communication avoiding) Generalized Minimal Residual method.
+
+   Blocks of s Krylov vectors are generated without intermediate inner products and are orthogonalized together with
+   one global reduction, instead of the s (or 2s) reductions of KSPGMRES. The residual norm is available at every
+   iteration and the monitors, convergence tests and restarts behave as in KSPGMRES.
+
+   Options Database Keys:
++   -ksp_sgmres_steps <s> - the number of Krylov vectors generated per block reduction (default 4)
+.   -ksp_sgmres_basis <monomial,newton> - the polynomial basis; the Newton basis uses Leja ordered Ritz values of the
+                                          first restart cycle (run as standard Arnoldi) as shifts (default newton)
+.   -ksp_gmres_restart <restart> - the number of Krylov directions to orthogonalize against
+.   -ksp_gmres_haptol <tol> - sets the tolerance for "happy ending" (exact convergence)
+.   -ksp_gmres_preallocate - preallocate all the Krylov search directions initially
+-   -ksp_gmres_cgs_refinement_type <refine_never,refine_ifneeded,refine_always> - determine if a second block
+                                   orthogonalization (and reduction) is used, the default is refine_ifneeded
+
+   Level: intermediate
+
+   Notes:
+   The orthogonalization is block classical Gram-Schmidt combined with a Cholesky QR of the new block, computed from the
+   Gram matrices of a single fused reduction; the -ksp_gmres_classicalgramschmidt and -ksp_gmres_modifiedgramschmidt
+   options have no effect. The monomial basis becomes ill-conditioned quickly and should only be used with small s;
+   the block is truncated when it is numerically rank deficient.
+
+   References:
++   1. - M. Hoemmen, "Communication-avoiding Krylov subspace methods", PhD thesis, UC Berkeley, 2010.
+-   2. - Z. Bai, D. Hu and L. Reichel, "A Newton basis GMRES implementation", IMA J. Numer. Anal. 14, 1994.
+
+   Developer Notes:
+    This object is subclassed off of KSPGMRES
+
+.seealso:  KSPCreate(), KSPSetType(), KSPType (for list of available types), KSP, KSPGMRES, KSPPGMRES, KSPPIPEFGMRES, KSPSCG,
+           KSPGMRESSetRestart(), KSPGMRESSetHapTol(), KSPGMRESSetPreAllocateVectors(), KSPGMRESCGSRefinementType,
+           KSPGMRESSetCGSRefinementType(), KSPGMRESGetCGSRefinementType()
+M*/
+
+PETSC_EXTERN PetscErrorCode KSPCreate_SGMRES(KSP ksp)
+{
+  KSP_SGMRES     *sgmres;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscNewLog(ksp,&sgmres);CHKERRQ(ierr);
+
+  ksp->data                              = (void*)sgmres;
+  ksp->ops->buildsolution                = KSPBuildSolution_GMRES;
+  ksp->ops->setup                        = KSPSetUp_SGMRES;
+  ksp->ops->solve                        = KSPSolve_SGMRES;
+  ksp->ops->reset                        = KSPReset_SGMRES;
+  ksp->ops->destroy                      = KSPDestroy_SGMRES;
+  ksp->ops->view                         = KSPView_SGMRES;
+  ksp->ops->setfromoptions               = KSPSetFromOptions_SGMRES;
+  ksp->ops->computeextremesingularvalues = KSPComputeExtremeSingularValues_GMRES;
+  ksp->ops->computeeigenvalues           = KSPComputeEigenvalues_GMRES;
+
+  ierr = KSPSetSupportedNorm(ksp,KSP_NORM_PRECONDITIONED,PC_LEFT,4);CHKERRQ(ierr);
+  ierr = KSPSetSupportedNorm(ksp,KSP_NORM_UNPRECONDITIONED,PC_RIGHT,3);CHKERRQ(ierr);
+  ierr = KSPSetSupportedNorm(ksp,KSP_NORM_PRECONDITIONED,PC_SYMMETRIC,2);CHKERRQ(ierr);
+  ierr = KSPSetSupportedNorm(ksp,KSP_NORM_NONE,PC_RIGHT,1);CHKERRQ(ierr);
+  ierr = KSPSetSupportedNorm(ksp,KSP_NORM_NONE,PC_LEFT,1);CHKERRQ(ierr);
+
+  ierr = PetscObjectComposeFunction((PetscObject)ksp,"KSPGMRESSetPreAllocateVectors_C",KSPGMRESSetPreAllocateVectors_GMRES);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)ksp,"KSPGMRESSetOrthogonalization_C",KSPGMRESSetOrthogonalization_GMRES);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)ksp,"KSPGMRESGetOrthogonalization_C",KSPGMRESGetOrthogonalization_GMRES);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)ksp,"KSPGMRESSetRestart_C",KSPGMRESSetRestart_GMRES);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)ksp,"KSPGMRESGetRestart_C",KSPGMRESGetRestart_GMRES);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)ksp,"KSPGMRESSetHapTol_C",KSPGMRESSetHapTol_GMRES);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)ksp,"KSPGMRESSetCGSRefinementType_C",KSPGMRESSetCGSRefinementType_GMRES);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)ksp,"KSPGMRESGetCGSRefinementType_C",KSPGMRESGetCGSRefinementType_GMRES);CHKERRQ(ierr);
+
+  sgmres->haptol         = 1.0e-30;
+  sgmres->q_preallocate  = 0;
+  sgmres->delta_allocate = SGMRES_DELTA_DIRECTIONS;
+  sgmres->orthog         = KSPGMRESClassicalGramSchmidtOrthogonalization;
+  sgmres->nrs            = 0;
+  sgmres->sol_temp       = 0;
+  sgmres->max_k          = SGMRES_DEFAULT_MAXK;
+  sgmres->Rsvd           = 0;
+  sgmres->orthogwork     = 0;
+  sgmres->cgstype        = KSP_GMRES_CGS_REFINE_IFNEEDED;
+  sgmres->s              = 4;
+  sgmres->basis          = KSP_SGMRES_BASIS_NEWTON;
+  PetscFunctionReturn(0);
+}
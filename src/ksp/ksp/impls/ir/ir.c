@@ -0,0 +1,366 @@
+/*
+    Mixed precision iterative refinement: the residual and the solution updates are computed with the
+    operator in working precision, the corrections are computed by an inner solver that works with
+    single precision copies of the operators.
+*/
+#include <petsc/private/kspimpl.h>     /*I "petscksp.h" I*/
+
+typedef struct {
+  KSP              inner;             /* solver for the corrections */
+  PetscBool        single;            /* give the inner solver single precision copies of AIJ operators */
+  Mat              A,P;               /* operators of the inner solver */
+  Mat              Asrc,Psrc;         /* outer operators A and P were last updated from */
+  PetscObjectState Astate,Anzstate;   /* states of Asrc and Psrc when A and P were last updated */
+  PetscObjectState Pstate,Pnzstate;
+  PetscInt         innerits;          /* total number of inner iterations of the last solve */
+} KSP_IR;
+
+/*
+   Brings the inner operator *L up to date with the outer operator M: when only the values of M changed since *L was
+   made from *src they are copied into *L, otherwise *L is created again as a MATAIJSINGLE copy of M, or is M itself if
+   M is not AIJ.
+*/
+static PetscErrorCode KSPIRUpdateOperator_Private(KSP ksp,Mat M,Mat *src,Mat *L,PetscObjectState *state,PetscObjectState *nzstate)
+{
+  KSP_IR           *ir = (KSP_IR*)ksp->data;
+  PetscErrorCode   ierr;
+  PetscObjectState s,nz;
+  PetscBool        isaij;
+
+  PetscFunctionBegin;
+  ierr = PetscObjectStateGet((PetscObject)M,&s);CHKERRQ(ierr);
+  ierr = MatGetNonzeroState(M,&nz);CHKERRQ(ierr);
+  if (*L && *src == M && (*L == M || s == *state)) PetscFunctionReturn(0);
+  if (*L && *src == M && nz == *nzstate) {
+    ierr = MatCopy(M,*L,SAME_NONZERO_PATTERN);CHKERRQ(ierr);
+  } else {
+    ierr = MatDestroy(L);CHKERRQ(ierr);
+    ierr = PetscObjectReference((PetscObject)M);CHKERRQ(ierr);
+    ierr = MatDestroy(src);CHKERRQ(ierr);
+    *src = M;
+    ierr = PetscObjectTypeCompareAny((PetscObject)M,&isaij,MATSEQAIJ,MATMPIAIJ,"");CHKERRQ(ierr);
+#if defined(PETSC_USE_COMPLEX)
+    isaij = PETSC_FALSE; /* MATAIJSINGLE is not available for complex scalars */
+#endif
+    if (ir->single && isaij) {
+      ierr = MatConvert(M,MATAIJSINGLE,MAT_INITIAL_MATRIX,L);CHKERRQ(ierr);
+    } else {
+      if (ir->single) {ierr = PetscInfo1(ksp,"Inner solver uses the %s operator itself, only real AIJ operators have a single precision copy\n",((PetscObject)M)->type_name);CHKERRQ(ierr);}
+      ierr = PetscObjectReference((PetscObject)M);CHKERRQ(ierr);
+      *L   = M;
+    }
+  }
+  *state   = s;
+  *nzstate = nz;
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode KSPSetUp_IR(KSP ksp)
+{
+  PetscErrorCode ierr;
+  PetscBool      isnone;
+
+  PetscFunctionBegin;
+  /* the PC of the outer KSP is never applied, do not let a requested one be silently ignored */
+  ierr = PetscObjectTypeCompare((PetscObject)ksp->pc,PCNONE,&isnone);CHKERRQ(ierr);
+  if (!isnone) SETERRQ1(PetscObjectComm((PetscObject)ksp),PETSC_ERR_ARG_INCOMP,"KSPIR does not use its own PC (type %s): set the preconditioner of the inner solver with -ir_pc_type or KSPIRGetInnerKSP()",((PetscObject)ksp->pc)->type_name);
+  ierr = KSPSetWorkVecs(ksp,2);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode KSPSolve_IR(KSP ksp)
+{
+  KSP_IR             *ir = (KSP_IR*)ksp->data;
+  PetscErrorCode     ierr;
+  PetscInt           i,its;
+  PetscReal          rnorm = 0.0;
+  Vec                x,b,r,d;
+  Mat                Amat,Pmat;
+  KSPConvergedReason reason;
+
+  PetscFunctionBegin;
+  ierr = PCGetOperators(ksp->pc,&Amat,&Pmat);CHKERRQ(ierr);
+  ierr = KSPIRUpdateOperator_Private(ksp,Amat,&ir->Asrc,&ir->A,&ir->Astate,&ir->Anzstate);CHKERRQ(ierr);
+  if (Pmat == Amat) {
+    if (ir->P != ir->A) {
+      ierr  = MatDestroy(&ir->P);CHKERRQ(ierr);
+      ierr  = PetscObjectReference((PetscObject)ir->A);CHKERRQ(ierr);
+      ir->P = ir->A;
+    }
+  } else {
+    if (ir->P == ir->A) {ierr = MatDestroy(&ir->P);CHKERRQ(ierr);}
+    ierr = KSPIRUpdateOperator_Private(ksp,Pmat,&ir->Psrc,&ir->P,&ir->Pstate,&ir->Pnzstate);CHKERRQ(ierr);
+  }
+  ierr = KSPSetOperators(ir->inner,ir->A,ir->P);CHKERRQ(ierr);
+
+  x = ksp->vec_sol;
+  b = ksp->vec_rhs;
+  r = ksp->work[0];
+  d = ksp->work[1];
+
+  if (!ksp->guess_zero) {                          /*   r <- b - A x     */
+    ierr = KSP_MatMult(ksp,Amat,x,r);CHKERRQ(ierr);
+    ierr = VecAYPX(r,-1.0,b);CHKERRQ(ierr);
+  } else {
+    ierr = VecCopy(b,r);CHKERRQ(ierr);
+  }
+
+  ksp->its     = 0;
+  ir->innerits = 0;
+  for (i=0; ; i++) {
+    if (ksp->normtype == KSP_NORM_UNPRECONDITIONED) {
+      ierr       = VecNorm(r,NORM_2,&rnorm);CHKERRQ(ierr);
+      KSPCheckNorm(ksp,rnorm);
+      ksp->rnorm = rnorm;
+      ierr = KSPLogResidualHistory(ksp,rnorm);CHKERRQ(ierr);
+      ierr = KSPMonitor(ksp,i,rnorm);CHKERRQ(ierr);
+      ierr = (*ksp->converged)(ksp,i,rnorm,&ksp->reason,ksp->cnvP);CHKERRQ(ierr);
+      if (ksp->reason) break;
+    }
+    if (i == ksp->max_it) break;
+
+    /* the inner solver computes the correction d ~ A^{-1} r with the low precision operators */
+    if (ksp->transpose_solve) {
+      ierr = KSPSolveTranspose(ir->inner,r,d);CHKERRQ(ierr);
+    } else {
+      ierr = KSPSolve(ir->inner,r,d);CHKERRQ(ierr);
+    }
+    ierr = KSPGetConvergedReason(ir->inner,&reason);CHKERRQ(ierr);
+    if (reason == KSP_DIVERGED_PC_FAILED) {
+      ksp->reason = KSP_DIVERGED_PC_FAILED;
+      break;
+    }
+    ierr          = KSPGetIterationNumber(ir->inner,&its);CHKERRQ(ierr);
+    ir->innerits += its;
+
+    ierr = VecAXPY(x,1.0,d);CHKERRQ(ierr);          /*   x <- x + d       */
+    ksp->its++;
+    if (i+1 < ksp->max_it || ksp->normtype != KSP_NORM_NONE) {
+      ierr = KSP_MatMult(ksp,Amat,x,r);CHKERRQ(ierr); /*   r <- b - A x     */
+      ierr = VecAYPX(r,-1.0,b);CHKERRQ(ierr);
+    }
+  }
+  if (!ksp->reason) {
+    if (ksp->normtype == KSP_NORM_NONE) ksp->reason = KSP_CONVERGED_ITS;
+    else ksp->reason = KSP_DIVERGED_ITS;
+  }
+  ierr = PetscInfo2(ksp,"%D refinement steps used %D inner iterations\n",ksp->its,ir->innerits);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode KSPView_IR(KSP ksp,PetscViewer viewer)
+{
+  KSP_IR         *ir = (KSP_IR*)ksp->data;
+  PetscErrorCode ierr;
+  PetscBool      iascii;
+
+  PetscFunctionBegin;
+  ierr = PetscObjectTypeCompare((PetscObject)viewer,PETSCVIEWERASCII,&iascii);CHKERRQ(ierr);
+  if (iascii) {
+    ierr = PetscViewerASCIIPrintf(viewer,"  inner solver operators: %s\n",ir->single ? "single precision copies of AIJ operators" : "outer operators");CHKERRQ(ierr);
+    ierr = PetscViewerASCIIPrintf(viewer,"  inner iterations of the last solve: %D\n",ir->innerits);CHKERRQ(ierr);
+    ierr = PetscViewerASCIIPrintf(viewer,"Inner KSP solver details\n");CHKERRQ(ierr);
+  }
+  ierr = PetscViewerASCIIPushTab(viewer);CHKERRQ(ierr);
+  ierr = KSPView(ir->inner,viewer);CHKERRQ(ierr);
+  ierr = PetscViewerASCIIPopTab(viewer);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode KSPSetFromOptions_IR(PetscOptionItems *PetscOptionsObject,KSP ksp)
+{
+  KSP_IR         *ir = (KSP_IR*)ksp->data;
+  PetscErrorCode ierr;
+  PetscBool      single,flg,isnone;
+  char           pctype[256];
+
+  PetscFunctionBegin;
+  /* KSPCreate_IR() resets the PC to PCNONE after PCSetFromOptions(), so check what was asked for */
+  ierr = PetscOptionsGetString(((PetscObject)ksp->pc)->options,((PetscObject)ksp->pc)->prefix,"-pc_type",pctype,sizeof(pctype),&flg);CHKERRQ(ierr);
+  if (flg) {
+    ierr = PetscStrcmp(pctype,PCNONE,&isnone);CHKERRQ(ierr);
+    if (!isnone) SETERRQ1(PetscObjectComm((PetscObject)ksp),PETSC_ERR_ARG_INCOMP,"KSPIR does not use its own PC, -pc_type %s is ignored: set the preconditioner of the inner solver with -ir_pc_type",pctype);
+  }
+  /* set the options prefix of the inner solver, since the parent prefix will be valid at this point */
+  ierr = KSPSetOptionsPrefix(ir->inner,((PetscObject)ksp)->prefix);CHKERRQ(ierr);
+  ierr = KSPAppendOptionsPrefix(ir->inner,"ir_");CHKERRQ(ierr);
+  ierr = PetscOptionsHead(PetscOptionsObject,"KSP IR options");CHKERRQ(ierr);
+  ierr = PetscOptionsBool("-ksp_ir_single_precision","Give the inner solver single precision copies of AIJ operators","KSPIRSetSinglePrecision",ir->single,&single,&flg);CHKERRQ(ierr);
+  if (flg) {ierr = KSPIRSetSinglePrecision(ksp,single);CHKERRQ(ierr);}
+  ierr = PetscOptionsTail();CHKERRQ(ierr);
+  ierr = KSPSetFromOptions(ir->inner);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode KSPReset_IR(KSP ksp)
+{
+  KSP_IR         *ir = (KSP_IR*)ksp->data;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MatDestroy(&ir->A);CHKERRQ(ierr);
+  ierr = MatDestroy(&ir->P);CHKERRQ(ierr);
+  ierr = MatDestroy(&ir->Asrc);CHKERRQ(ierr);
+  ierr = MatDestroy(&ir->Psrc);CHKERRQ(ierr);
+  ierr = KSPReset(ir->inner);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode KSPDestroy_IR(KSP ksp)
+{
+  KSP_IR         *ir = (KSP_IR*)ksp->data;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = KSPReset_IR(ksp);CHKERRQ(ierr);
+  ierr = KSPDestroy(&ir->inner);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)ksp,"KSPIRGetInnerKSP_C",NULL);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)ksp,"KSPIRSetSinglePrecision_C",NULL);CHKERRQ(ierr);
+  ierr = KSPDestroyDefault(ksp);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode KSPIRGetInnerKSP_IR(KSP ksp,KSP *inner)
+{
+  KSP_IR *ir = (KSP_IR*)ksp->data;
+
+  PetscFunctionBegin;
+  *inner = ir->inner;
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode KSPIRSetSinglePrecision_IR(KSP ksp,PetscBool flg)
+{
+  KSP_IR         *ir = (KSP_IR*)ksp->data;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  if (ir->single != flg) {
+    ierr = MatDestroy(&ir->A);CHKERRQ(ierr);
+    ierr = MatDestroy(&ir->P);CHKERRQ(ierr);
+  }
+  ir->single = flg;
+  PetscFunctionReturn(0);
+}
+
+/*@
+   KSPIRGetInnerKSP - Gets the solver that computes the corrections of the KSPIR mixed precision iterative refinement
+
+   Not Collective
+
+   Input Parameter:
+.  ksp - the KSPIR solver
+
+   Output Parameter:
+.  inner - the inner solver; its options prefix is that of ksp followed by ir_
+
+   Level: advanced
+
+.seealso: KSPIR, KSPIRSetSinglePrecision()
+@*/
+PetscErrorCode KSPIRGetInnerKSP(KSP ksp,KSP *inner)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  PetscValidHeaderSpecific(ksp,KSP_CLASSID,1);
+  PetscValidPointer(inner,2);
+  ierr = PetscUseMethod(ksp,"KSPIRGetInnerKSP_C",(KSP,KSP*),(ksp,inner));CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/*@
+   KSPIRSetSinglePrecision - Sets whether the inner solver of KSPIR works with single precision copies of the operators
+
+   Logically Collective on ksp
+
+   Input Parameters:
++  ksp - the KSPIR solver
+-  flg - PETSC_TRUE to give the inner solver MATAIJSINGLE copies of AIJ operators (the default), PETSC_FALSE to give it the operators themselves
+
+   Options Database Key:
+.  -ksp_ir_single_precision <bool> - use the single precision copies
+
+   Level: advanced
+
+.seealso: KSPIR, KSPIRGetInnerKSP(), MATAIJSINGLE
+@*/
+PetscErrorCode KSPIRSetSinglePrecision(KSP ksp,PetscBool flg)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  PetscValidHeaderSpecific(ksp,KSP_CLASSID,1);
+  PetscValidLogicalCollectiveBool(ksp,flg,2);
+  ierr = PetscTryMethod(ksp,"KSPIRSetSinglePrecision_C",(KSP,PetscBool),(ksp,flg));CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/*MC
+     KSPIR - Mixed precision iterative refinement. The residual r = b - A x and the updates x = x + d are computed in
+             working precision with the operator of the KSP, while each correction d is computed by an inner solver
+             for A d = r that works with single precision copies of the operators.
+
+   Options Database Keys:
++  -ksp_ir_single_precision <bool> - give the inner solver MATAIJSINGLE copies of AIJ operators (default true)
+-  -ir_ksp_type, -ir_pc_type, -ir_ksp_rtol ... - options of the inner solver, by default GMRES with relative tolerance 1e-4
+
+   Level: intermediate
+
+   Notes:
+    The inner solver and its preconditioner spend their time in bandwidth bound products, SOR sweeps and triangular solves
+    with the operator; with the single precision values of MATAIJSINGLE these read about half the data. Each refinement step
+    reduces the residual by about the accuracy of the inner solve, as long as the rounding of the operator to single precision
+    times its condition number is well below one, so the outer iteration reaches working precision accuracy in a few steps.
+
+    The preconditioner is that of the inner solver, set with -ir_pc_type or through KSPIRGetInnerKSP(); the PC of the KSPIR
+    object itself is of type PCNONE and is not used, setting it to another type, for example with -pc_type, is an error. The copies are refreshed when the operators change; when only their values
+    changed, the values are copied without converting again. Operators that are not AIJ, and all operators with complex scalars,
+    are given to the inner solver unchanged.
+
+    Only the unpreconditioned residual norm is available. The inner solve is an approximate, iteration dependent operator, so
+    KSPIR used as a preconditioner (PCKSP) requires a flexible outer method such as KSPFGMRES or KSPGCR.
+
+   References:
+.   1. - E. Carson and N. J. Higham, Accelerating the Solution of Linear Systems by Iterative Refinement in Three Precisions, SIAM J. Sci. Comput. 40(2), 2018.
+
+.seealso:  KSPCreate(), KSPSetType(), KSPType (for list of available types), KSP, KSPIRGetInnerKSP(), KSPIRSetSinglePrecision(),
+           KSPRICHARDSON, KSPFGMRES, PCKSP, MATAIJSINGLE
+M*/
+PETSC_EXTERN PetscErrorCode KSPCreate_IR(KSP ksp)
+{
+  PetscErrorCode ierr;
+  KSP_IR         *ir;
+  PC             pc;
+
+  PetscFunctionBegin;
+  ierr       = PetscNewLog(ksp,&ir);CHKERRQ(ierr);
+  ksp->data  = (void*)ir;
+  ir->single = PETSC_TRUE;
+
+  ierr = KSPSetSupportedNorm(ksp,KSP_NORM_UNPRECONDITIONED,PC_LEFT,3);CHKERRQ(ierr);
+  ierr = KSPSetSupportedNorm(ksp,KSP_NORM_UNPRECONDITIONED,PC_RIGHT,2);CHKERRQ(ierr);
+  ierr = KSPSetSupportedNorm(ksp,KSP_NORM_NONE,PC_LEFT,1);CHKERRQ(ierr);
+  ierr = KSPSetSupportedNorm(ksp,KSP_NORM_NONE,PC_RIGHT,1);CHKERRQ(ierr);
+
+  ksp->ops->setup          = KSPSetUp_IR;
+  ksp->ops->solve          = KSPSolve_IR;
+  ksp->ops->reset          = KSPReset_IR;
+  ksp->ops->destroy        = KSPDestroy_IR;
+  ksp->ops->view           = KSPView_IR;
+  ksp->ops->setfromoptions = KSPSetFromOptions_IR;
+  ksp->ops->buildsolution  = KSPBuildSolutionDefault;
+  ksp->ops->buildresidual  = KSPBuildResidualDefault;
+
+  ierr = KSPGetPC(ksp,&pc);CHKERRQ(ierr);
+  ierr = PCSetType(pc,PCNONE);CHKERRQ(ierr);
+
+  ierr = KSPCreate(PetscObjectComm((PetscObject)ksp),&ir->inner);CHKERRQ(ierr);
+  ierr = PetscObjectIncrementTabLevel((PetscObject)ir->inner,(PetscObject)ksp,1);CHKERRQ(ierr);
+  ierr = PetscLogObjectParent((PetscObject)ksp,(PetscObject)ir->inner);CHKERRQ(ierr);
+  ierr = KSPSetTolerances(ir->inner,1.e-4,PETSC_DEFAULT,PETSC_DEFAULT,PETSC_DEFAULT);CHKERRQ(ierr);
+
+  ierr = PetscObjectComposeFunction((PetscObject)ksp,"KSPIRGetInnerKSP_C",KSPIRGetInnerKSP_IR);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)ksp,"KSPIRSetSinglePrecision_C",KSPIRSetSinglePrecision_IR);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
@@ -166,6 +166,71 @@ PetscErrorCode  KSPSolve_Richardson(KSP ksp)
   PetscFunctionReturn(0);
 }
 
+/*
+   KSPMatSolve_Richardson - X <- X + scale M (B - A X) on all the columns of B at once, with the products done by
+   KSPMatMatMult_Private() and the preconditioner by PCMatApply(). The self-scaling variant has no block version.
+*/
+static PetscErrorCode KSPMatSolve_Richardson(KSP ksp,Mat B,Mat X)
+{
+  KSP_Richardson *richardsonP = (KSP_Richardson*)ksp->data;
+  PetscErrorCode ierr;
+  PetscInt       i,N;
+  PetscReal      *nrm0,*nrm;
+  Mat            Amat,Pmat,R,Z,Q = NULL;
+  PetscBool      diagonalscale;
+
+  PetscFunctionBegin;
+  ierr = PCGetDiagonalScale(ksp->pc,&diagonalscale);CHKERRQ(ierr);
+  if (diagonalscale) SETERRQ1(PetscObjectComm((PetscObject)ksp),PETSC_ERR_SUP,"Krylov method %s does not support diagonal scaling",((PetscObject)ksp)->type_name);
+  ierr = PCGetOperators(ksp->pc,&Amat,&Pmat);CHKERRQ(ierr);
+  ierr = MatGetSize(B,NULL,&N);CHKERRQ(ierr);
+  ierr = PetscCalloc2(N,&nrm0,N,&nrm);CHKERRQ(ierr);
+  ierr = MatDuplicate(B,MAT_COPY_VALUES,&R);CHKERRQ(ierr);
+  if (!ksp->guess_zero) {                          /*   R <- B - A X     */
+    ierr = KSPMatMatMult_Private(ksp,Amat,X,&Q);CHKERRQ(ierr);
+    ierr = MatAXPY(R,-1.0,Q,SAME_NONZERO_PATTERN);CHKERRQ(ierr);
+  }
+  ierr = MatDuplicate(B,MAT_DO_NOT_COPY_VALUES,&Z);CHKERRQ(ierr);
+
+  ksp->its = 0;
+  for (i=0; i<ksp->max_it; i++) {
+    if (ksp->normtype == KSP_NORM_UNPRECONDITIONED) {
+      ierr = MatGetColumnNorms(R,NORM_2,i ? nrm : nrm0);CHKERRQ(ierr);
+      ierr = KSPMatSolveConverged_Private(ksp,N,nrm0,i ? nrm : nrm0);CHKERRQ(ierr);
+      if (ksp->reason) break;
+    }
+    ierr = PCMatApply(ksp->pc,R,Z);CHKERRQ(ierr);  /*   Z <- M R         */
+    if (ksp->normtype == KSP_NORM_PRECONDITIONED) {
+      ierr = MatGetColumnNorms(Z,NORM_2,i ? nrm : nrm0);CHKERRQ(ierr);
+      ierr = KSPMatSolveConverged_Private(ksp,N,nrm0,i ? nrm : nrm0);CHKERRQ(ierr);
+      if (ksp->reason) break;
+    }
+    ierr = MatAXPY(X,richardsonP->scale,Z,SAME_NONZERO_PATTERN);CHKERRQ(ierr); /*   X <- X + scale Z */
+    ksp->its++;
+    if (i+1 < ksp->max_it || ksp->normtype != KSP_NORM_NONE) {
+      ierr = KSPMatMatMult_Private(ksp,Amat,X,&Q);CHKERRQ(ierr);
+      ierr = MatCopy(B,R,SAME_NONZERO_PATTERN);CHKERRQ(ierr);
+      ierr = MatAXPY(R,-1.0,Q,SAME_NONZERO_PATTERN);CHKERRQ(ierr);
+    }
+  }
+  if (!ksp->reason) {
+    if (ksp->normtype != KSP_NORM_NONE) {
+      if (ksp->normtype == KSP_NORM_PRECONDITIONED) {
+        ierr = PCMatApply(ksp->pc,R,Z);CHKERRQ(ierr);
+      }
+      ierr = MatGetColumnNorms(ksp->normtype == KSP_NORM_PRECONDITIONED ? Z : R,NORM_2,nrm);CHKERRQ(ierr);
+      ierr = KSPMatSolveConverged_Private(ksp,N,nrm0,nrm);CHKERRQ(ierr);
+    } else {
+      ksp->reason = KSP_CONVERGED_ITS;
+    }
+  }
+  ierr = MatDestroy(&R);CHKERRQ(ierr);
+  ierr = MatDestroy(&Z);CHKERRQ(ierr);
+  ierr = MatDestroy(&Q);CHKERRQ(ierr);
+  ierr = PetscFree2(nrm0,nrm);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
 PetscErrorCode KSPView_Richardson(KSP ksp,PetscViewer viewer)
 {
   KSP_Richardson *richardsonP = (KSP_Richardson*)ksp->data;
@@ -228,6 +293,7 @@ static PetscErrorCode  KSPRichardsonSetSelfScale_Richardson(KSP ksp,PetscBool se
   PetscFunctionBegin;
   richardsonP            = (KSP_Richardson*)ksp->data;
   richardsonP->selfscale = selfscale;
+  ksp->ops->matsolve     = selfscale ? NULL : KSPMatSolve_Richardson;
   PetscFunctionReturn(0);
 }
 
@@ -288,6 +354,7 @@ PETSC_EXTERN PetscErrorCode KSPCreate_Richardson(KSP ksp)
 
   ksp->ops->setup          = KSPSetUp_Richardson;
   ksp->ops->solve          = KSPSolve_Richardson;
+  ksp->ops->matsolve       = KSPMatSolve_Richardson;
   ksp->ops->destroy        = KSPDestroy_Richardson;
   ksp->ops->buildsolution  = KSPBuildSolutionDefault;
   ksp->ops->buildresidual  = KSPBuildResidualDefault;
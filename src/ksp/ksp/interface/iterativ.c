@@ -1263,4 +1263,92 @@ PetscErrorCode KSPCheckSolve(KSP ksp,PC pc,Vec vec)
   }
   PetscFunctionReturn(0);
 }
- 
+
+/*
+   KSPMatSolveConverged_Private - Convergence test of the block solvers used by KSPMatSolve(): each of the n columns must satisfy
+   the KSP tolerances relative to its own initial residual norm. The largest column norm is logged and monitored as the residual norm.
+*/
+PetscErrorCode KSPMatSolveConverged_Private(KSP ksp,PetscInt n,const PetscReal nrm0[],const PetscReal nrm[])
+{
+  PetscErrorCode ierr;
+  PetscInt       i;
+  PetscReal      rnorm = 0.0;
+  PetscBool      conv = PETSC_TRUE,atol = PETSC_TRUE,div = PETSC_FALSE;
+
+  PetscFunctionBegin;
+  for (i=0; i<n; i++) {
+    rnorm = PetscMax(rnorm,nrm[i]);
+    if (nrm[i] >= ksp->abstol) atol = PETSC_FALSE;
+    if (nrm[i] > PetscMax(ksp->rtol*nrm0[i],ksp->abstol)) {
+      conv = PETSC_FALSE;
+      /* columns already below tolerance, e.g. a zero right-hand side, cannot be diverging */
+      if (ksp->its && nrm0[i] > 0.0 && nrm[i] >= ksp->divtol*nrm0[i]) div = PETSC_TRUE;
+    }
+  }
+  ierr = PetscObjectSAWsTakeAccess((PetscObject)ksp);CHKERRQ(ierr);
+  ksp->rnorm = rnorm;
+  ierr = PetscObjectSAWsGrantAccess((PetscObject)ksp);CHKERRQ(ierr);
+  ierr = KSPLogResidualHistory(ksp,rnorm);CHKERRQ(ierr);
+  ierr = KSPMonitor(ksp,ksp->its,rnorm);CHKERRQ(ierr);
+  ksp->reason = KSP_CONVERGED_ITERATING;
+  if (PetscIsInfOrNanReal(rnorm)) {
+    ierr = PetscInfo(ksp,"Block solver has created a not a number (NaN) as a residual norm, declaring divergence\n");CHKERRQ(ierr);
+    ksp->reason = KSP_DIVERGED_NANORINF;
+  } else if (conv) {
+    ierr = PetscInfo3(ksp,"Block solver has converged, largest residual norm of the %D columns %14.12e at iteration %D\n",n,(double)rnorm,ksp->its);CHKERRQ(ierr);
+    ksp->reason = atol ? KSP_CONVERGED_ATOL : KSP_CONVERGED_RTOL;
+  } else if (div) {
+    ierr = PetscInfo2(ksp,"Block solver is diverging, largest residual norm %14.12e at iteration %D\n",(double)rnorm,ksp->its);CHKERRQ(ierr);
+    ksp->reason = KSP_DIVERGED_DTOL;
+  } else if (ksp->its >= ksp->max_it) ksp->reason = KSP_DIVERGED_ITS;
+  PetscFunctionReturn(0);
+}
+
+/*
+   KSPMatMatMult_Private - Computes Y = A X for a dense X. On the first call *Y must be NULL and is created; later calls reuse it
+   with any X of the same layout. Operators without a sparse-dense product are applied column by column.
+*/
+PetscErrorCode KSPMatMatMult_Private(KSP ksp,Mat A,Mat X,Mat *Y)
+{
+  PetscErrorCode    ierr;
+  PetscBool         flg;
+  PetscInt          i,m,n,N,ldx,ldy;
+  const PetscScalar *x;
+  PetscScalar       *y;
+  Vec               cx,cy;
+
+  PetscFunctionBegin;
+  ierr = PetscObjectTypeCompareAny((PetscObject)A,&flg,MATSEQAIJ,MATMPIAIJ,MATSEQDENSE,MATMPIDENSE,"");CHKERRQ(ierr);
+  if (flg) {
+    if (!*Y) {
+      ierr = MatMatMult(A,X,MAT_INITIAL_MATRIX,PETSC_DEFAULT,Y);CHKERRQ(ierr);
+    } else {
+      ierr = MatProductReplaceMats(NULL,X,NULL,*Y);CHKERRQ(ierr);
+      ierr = MatProductNumeric(*Y);CHKERRQ(ierr);
+    }
+    PetscFunctionReturn(0);
+  }
+  if (!*Y) {
+    ierr = MatDuplicate(X,MAT_DO_NOT_COPY_VALUES,Y);CHKERRQ(ierr);
+  }
+  ierr = MatGetLocalSize(A,&m,&n);CHKERRQ(ierr);
+  ierr = MatGetSize(X,NULL,&N);CHKERRQ(ierr);
+  ierr = MatDenseGetLDA(X,&ldx);CHKERRQ(ierr);
+  ierr = MatDenseGetLDA(*Y,&ldy);CHKERRQ(ierr);
+  ierr = VecCreateMPIWithArray(PetscObjectComm((PetscObject)ksp),1,n,PETSC_DECIDE,NULL,&cx);CHKERRQ(ierr);
+  ierr = VecCreateMPIWithArray(PetscObjectComm((PetscObject)ksp),1,m,PETSC_DECIDE,NULL,&cy);CHKERRQ(ierr);
+  ierr = MatDenseGetArrayRead(X,&x);CHKERRQ(ierr);
+  ierr = MatDenseGetArray(*Y,&y);CHKERRQ(ierr);
+  for (i=0; i<N; i++) {
+    ierr = VecPlaceArray(cx,x+i*ldx);CHKERRQ(ierr);
+    ierr = VecPlaceArray(cy,y+i*ldy);CHKERRQ(ierr);
+    ierr = MatMult(A,cx,cy);CHKERRQ(ierr);
+    ierr = VecResetArray(cx);CHKERRQ(ierr);
+    ierr = VecResetArray(cy);CHKERRQ(ierr);
+  }
+  ierr = MatDenseRestoreArray(*Y,&y);CHKERRQ(ierr);
+  ierr = MatDenseRestoreArrayRead(X,&x);CHKERRQ(ierr);
+  ierr = VecDestroy(&cx);CHKERRQ(ierr);
+  ierr = VecDestroy(&cy);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
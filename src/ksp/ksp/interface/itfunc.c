@@ -888,6 +888,109 @@ PetscErrorCode KSPSolveTranspose(KSP ksp,Vec b,Vec x)
   PetscFunctionReturn(0);
 }
 
+/*@
+   KSPMatSolve - Solves a linear system with several right hand sides stored as the columns of a dense matrix.
+
+   Collective on ksp
+
+   Input Parameters:
++  ksp - iterative context
+-  B - block of right hand sides, of type MATDENSE
+
+   Output Parameter:
+.  X - block of solutions, of type MATDENSE with the same layout as B
+
+   Notes:
+   KSPCG, KSPGMRES and KSPPREONLY solve all the systems together, so the products with the operator become sparse-dense
+   products, the preconditioner is applied with PCMatApply(), and the inner products of all the columns share one reduction.
+   The other KSP types call KSPSolve() on each column in turn.
+
+   The block solvers declare convergence when every column satisfies the tolerances of KSPSetTolerances() relative to its own
+   initial residual norm. The residual norm logged and monitored is the largest one among the columns. A convergence test set
+   with KSPSetConvergenceTest() is not used by the block solvers, and monitors that need the current solution or residual,
+   such as KSPMonitorTrueResidualNorm(), cannot be used with them.
+
+   When KSPSetInitialGuessNonzero() has been called, X holds the initial guesses on entry.
+
+   Level: intermediate
+
+.seealso: KSPSolve(), PCMatApply(), KSPCG, KSPGMRES, KSPPREONLY
+@*/
+PetscErrorCode KSPMatSolve(KSP ksp,Mat B,Mat X)
+{
+  PetscErrorCode    ierr;
+  PetscBool         match;
+  PetscInt          m,M,N,mx,Nx,i,ldb,ldx,its = 0;
+  const PetscScalar *b;
+  PetscScalar       *x;
+  Vec               cb,cx,vec_rhs,vec_sol;
+
+  PetscFunctionBegin;
+  PetscValidHeaderSpecific(ksp,KSP_CLASSID,1);
+  PetscValidHeaderSpecific(B,MAT_CLASSID,2);
+  PetscValidHeaderSpecific(X,MAT_CLASSID,3);
+  PetscCheckSameComm(ksp,1,B,2);
+  PetscCheckSameComm(ksp,1,X,3);
+  if (B == X) SETERRQ(PetscObjectComm((PetscObject)ksp),PETSC_ERR_ARG_IDN,"B and X must be different matrices");
+  ierr = PetscObjectTypeCompareAny((PetscObject)B,&match,MATSEQDENSE,MATMPIDENSE,"");CHKERRQ(ierr);
+  if (!match) SETERRQ(PetscObjectComm((PetscObject)ksp),PETSC_ERR_ARG_WRONG,"B must be of type MATDENSE");
+  ierr = PetscObjectTypeCompareAny((PetscObject)X,&match,MATSEQDENSE,MATMPIDENSE,"");CHKERRQ(ierr);
+  if (!match) SETERRQ(PetscObjectComm((PetscObject)ksp),PETSC_ERR_ARG_WRONG,"X must be of type MATDENSE");
+  ierr = MatGetLocalSize(B,&m,NULL);CHKERRQ(ierr);
+  ierr = MatGetLocalSize(X,&mx,NULL);CHKERRQ(ierr);
+  ierr = MatGetSize(B,&M,&N);CHKERRQ(ierr);
+  ierr = MatGetSize(X,NULL,&Nx);CHKERRQ(ierr);
+  if (m != mx || N != Nx) SETERRQ4(PETSC_COMM_SELF,PETSC_ERR_ARG_SIZ,"B has %D local rows and %D columns while X has %D local rows and %D columns",m,N,mx,Nx);
+
+  ierr = KSPSetUp(ksp);CHKERRQ(ierr);
+  ierr = KSPSetUpOnBlocks(ksp);CHKERRQ(ierr);
+  if (ksp->ops->matsolve && !ksp->dscale) {
+    if (ksp->res_hist_reset) ksp->res_hist_len = 0;
+    ksp->transpose_solve = PETSC_FALSE;
+    if (ksp->guess_zero) {ierr = MatZeroEntries(X);CHKERRQ(ierr);}
+    /* the vectors of a previous KSPSolve() must not be mistaken for the current iterate by the monitors */
+    vec_rhs      = ksp->vec_rhs;
+    vec_sol      = ksp->vec_sol;
+    ksp->vec_rhs = NULL;
+    ksp->vec_sol = NULL;
+    ierr = PetscLogEventBegin(KSP_MatSolve,ksp,B,X,0);CHKERRQ(ierr);
+    ierr = (*ksp->ops->matsolve)(ksp,B,X);
+    ksp->vec_rhs = vec_rhs;
+    ksp->vec_sol = vec_sol;
+    CHKERRQ(ierr);
+    ierr = PetscLogEventEnd(KSP_MatSolve,ksp,B,X,0);CHKERRQ(ierr);
+    if (!ksp->reason) SETERRQ(PetscObjectComm((PetscObject)ksp),PETSC_ERR_PLIB,"Internal error, solver returned without setting converged reason");
+    ksp->totalits += ksp->its;
+  } else {
+    ierr = PetscInfo1(ksp,"No block solver for this KSP, solving the %D systems one after the other\n",N);CHKERRQ(ierr);
+    ierr = PetscLogEventBegin(KSP_MatSolve,ksp,B,X,0);CHKERRQ(ierr);
+    ierr = MatDenseGetLDA(B,&ldb);CHKERRQ(ierr);
+    ierr = MatDenseGetLDA(X,&ldx);CHKERRQ(ierr);
+    ierr = VecCreateMPIWithArray(PetscObjectComm((PetscObject)ksp),1,m,M,NULL,&cb);CHKERRQ(ierr);
+    ierr = VecCreateMPIWithArray(PetscObjectComm((PetscObject)ksp),1,m,M,NULL,&cx);CHKERRQ(ierr);
+    ierr = MatDenseGetArrayRead(B,&b);CHKERRQ(ierr);
+    ierr = MatDenseGetArray(X,&x);CHKERRQ(ierr);
+    for (i=0; i<N; i++) {
+      ierr = VecPlaceArray(cb,b+i*ldb);CHKERRQ(ierr);
+      ierr = VecPlaceArray(cx,x+i*ldx);CHKERRQ(ierr);
+      ierr = KSPSolve(ksp,cb,cx);CHKERRQ(ierr);
+      its += ksp->its;
+      ierr = VecResetArray(cb);CHKERRQ(ierr);
+      ierr = VecResetArray(cx);CHKERRQ(ierr);
+      if (ksp->reason < 0) break;
+    }
+    ierr = MatDenseRestoreArray(X,&x);CHKERRQ(ierr);
+    ierr = MatDenseRestoreArrayRead(B,&b);CHKERRQ(ierr);
+    ierr = VecDestroy(&cb);CHKERRQ(ierr);
+    ierr = VecDestroy(&cx);CHKERRQ(ierr);
+    ierr = PetscLogEventEnd(KSP_MatSolve,ksp,B,X,0);CHKERRQ(ierr);
+    ksp->its = its;
+  }
+  if (ksp->viewReason) {ierr = KSPReasonView_Internal(ksp,ksp->viewerReason,ksp->formatReason);CHKERRQ(ierr);}
+  if (ksp->errorifnotconverged && ksp->reason < 0 && ksp->reason != KSP_DIVERGED_ITS) SETERRQ1(PetscObjectComm((PetscObject)ksp),PETSC_ERR_NOT_CONVERGED,"KSPMatSolve has not converged, reason %s",KSPConvergedReasons[ksp->reason]);
+  PetscFunctionReturn(0);
+}
+
 /*@
    KSPResetViewers - Resets all the viewers set from the options database during KSPSetFromOptions()
 
@@ -2070,6 +2173,7 @@ PetscErrorCode  KSPBuildSolution(KSP ksp,Vec v,Vec *V)
   PetscFunctionBegin;
   PetscValidHeaderSpecific(ksp,KSP_CLASSID,1);
   if (!V && !v) SETERRQ(PetscObjectComm((PetscObject)ksp),PETSC_ERR_ARG_WRONG,"Must provide either v or V");
+  if (!ksp->vec_sol) SETERRQ(PetscObjectComm((PetscObject)ksp),PETSC_ERR_ORDER,"The solution is only available from KSPSolve(), not KSPMatSolve()");
   if (!V) V = &v;
   ierr = (*ksp->ops->buildsolution)(ksp,v,V);CHKERRQ(ierr);
   PetscFunctionReturn(0);
@@ -2105,6 +2209,7 @@ PetscErrorCode  KSPBuildResidual(KSP ksp,Vec t,Vec v,Vec *V)
 
   PetscFunctionBegin;
   PetscValidHeaderSpecific(ksp,KSP_CLASSID,1);
+  if (!ksp->vec_rhs || !ksp->vec_sol) SETERRQ(PetscObjectComm((PetscObject)ksp),PETSC_ERR_ORDER,"The residual is only available from KSPSolve(), not KSPMatSolve()");
   if (!w) {
     ierr = VecDuplicate(ksp->vec_rhs,&w);CHKERRQ(ierr);
     ierr = PetscLogObjectParent((PetscObject)ksp,(PetscObject)w);CHKERRQ(ierr);
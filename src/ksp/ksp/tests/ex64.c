@@ -0,0 +1,153 @@
+static char help[] = "Tests KSPMatSolve() and PCMatApply() against column by column KSPSolve() and PCApply() on a 2D Laplacian.\n\n\
+Input parameters include:\n\
+  -m <mesh_x>       : number of mesh points in x-direction\n\
+  -n <mesh_y>       : number of mesh points in y-direction\n\
+  -nrhs <N>         : number of right hand sides\n\
+  -zero_column      : use a zero second right hand side\n\n";
+
+#include <petscksp.h>
+
+int main(int argc,char **args)
+{
+  KSP            ksp;
+  PC             pc;
+  Mat            A,B,X,R,Y;
+  Vec            b,x,y;
+  PetscInt       i,j,k,Ii,J,Istart,Iend,m = 8,n = 7,N = 4;
+  PetscScalar    v;
+  PetscReal      *nrmb,*nrmr,err,rtol;
+  PetscBool      flg,zero = PETSC_FALSE;
+  PetscErrorCode ierr;
+
+  ierr = PetscInitialize(&argc,&args,(char*)0,help);if (ierr) return ierr;
+  ierr = PetscOptionsGetInt(NULL,NULL,"-m",&m,NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetInt(NULL,NULL,"-n",&n,NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetInt(NULL,NULL,"-nrhs",&N,NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsGetBool(NULL,NULL,"-zero_column",&zero,NULL);CHKERRQ(ierr);
+
+  ierr = MatCreate(PETSC_COMM_WORLD,&A);CHKERRQ(ierr);
+  ierr = MatSetSizes(A,PETSC_DECIDE,PETSC_DECIDE,m*n,m*n);CHKERRQ(ierr);
+  ierr = MatSetFromOptions(A);CHKERRQ(ierr);
+  ierr = MatMPIAIJSetPreallocation(A,5,NULL,5,NULL);CHKERRQ(ierr);
+  ierr = MatSeqAIJSetPreallocation(A,5,NULL);CHKERRQ(ierr);
+  ierr = MatGetOwnershipRange(A,&Istart,&Iend);CHKERRQ(ierr);
+  for (Ii=Istart; Ii<Iend; Ii++) {
+    v = -1.0; i = Ii/n; j = Ii - i*n;
+    if (i>0)   {J = Ii - n; ierr = MatSetValues(A,1,&Ii,1,&J,&v,ADD_VALUES);CHKERRQ(ierr);}
+    if (i<m-1) {J = Ii + n; ierr = MatSetValues(A,1,&Ii,1,&J,&v,ADD_VALUES);CHKERRQ(ierr);}
+    if (j>0)   {J = Ii - 1; ierr = MatSetValues(A,1,&Ii,1,&J,&v,ADD_VALUES);CHKERRQ(ierr);}
+    if (j<n-1) {J = Ii + 1; ierr = MatSetValues(A,1,&Ii,1,&J,&v,ADD_VALUES);CHKERRQ(ierr);}
+    v = 4.0; ierr = MatSetValues(A,1,&Ii,1,&Ii,&v,ADD_VALUES);CHKERRQ(ierr);
+  }
+  ierr = MatAssemblyBegin(A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  ierr = MatAssemblyEnd(A,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+
+  /* N right hand sides, the last one being a copy of the first so that the block is rank deficient, optionally with a zero second one */
+  ierr = MatCreateDense(PETSC_COMM_WORLD,Iend-Istart,PETSC_DECIDE,m*n,N,NULL,&B);CHKERRQ(ierr);
+  for (Ii=Istart; Ii<Iend; Ii++) {
+    for (k=0; k<N; k++) {
+      v    = (PetscScalar)(k == N-1 && N > 1 ? 1 + (Ii*3)%7 : 1 + (Ii*(k+3))%7 + k);
+      if (zero && k == 1) v = 0.0;
+      ierr = MatSetValue(B,Ii,k,v,INSERT_VALUES);CHKERRQ(ierr);
+    }
+  }
+  ierr = MatAssemblyBegin(B,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  ierr = MatAssemblyEnd(B,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  ierr = MatDuplicate(B,MAT_DO_NOT_COPY_VALUES,&X);CHKERRQ(ierr);
+  ierr = MatDuplicate(B,MAT_DO_NOT_COPY_VALUES,&Y);CHKERRQ(ierr);
+
+  ierr = KSPCreate(PETSC_COMM_WORLD,&ksp);CHKERRQ(ierr);
+  ierr = KSPSetOperators(ksp,A,A);CHKERRQ(ierr);
+  ierr = KSPSetTolerances(ksp,1.e-8,PETSC_DEFAULT,PETSC_DEFAULT,PETSC_DEFAULT);CHKERRQ(ierr);
+  ierr = KSPSetFromOptions(ksp);CHKERRQ(ierr);
+  ierr = KSPGetTolerances(ksp,&rtol,NULL,NULL,NULL);CHKERRQ(ierr);
+  ierr = KSPGetPC(ksp,&pc);CHKERRQ(ierr);
+
+  /* check the block residuals column by column */
+  ierr = KSPMatSolve(ksp,B,X);CHKERRQ(ierr);
+  ierr = PetscMalloc2(N,&nrmb,N,&nrmr);CHKERRQ(ierr);
+  ierr = MatMatMult(A,X,MAT_INITIAL_MATRIX,PETSC_DEFAULT,&R);CHKERRQ(ierr);
+  ierr = MatAYPX(R,-1.0,B,SAME_NONZERO_PATTERN);CHKERRQ(ierr);
+  ierr = MatGetColumnNorms(B,NORM_2,nrmb);CHKERRQ(ierr);
+  ierr = MatGetColumnNorms(R,NORM_2,nrmr);CHKERRQ(ierr);
+  flg  = PETSC_TRUE;
+  for (k=0; k<N; k++) if (nrmr[k] > 100*rtol*nrmb[k] && nrmr[k] > PETSC_SMALL) flg = PETSC_FALSE;
+  ierr = PetscPrintf(PETSC_COMM_WORLD,"KSPMatSolve() residuals %s\n",flg ? "below tolerance" : "above tolerance");CHKERRQ(ierr);
+
+  /* compare with single right hand side solves */
+  ierr = MatCreateVecs(A,&x,&b);CHKERRQ(ierr);
+  ierr = VecDuplicate(x,&y);CHKERRQ(ierr);
+  err  = 0.0;
+  for (k=0; k<N; k++) {
+    ierr = MatGetColumnVector(B,b,k);CHKERRQ(ierr);
+    ierr = MatGetColumnVector(X,y,k);CHKERRQ(ierr);
+    ierr = KSPSolve(ksp,b,x);CHKERRQ(ierr);
+    ierr = VecAXPY(y,-1.0,x);CHKERRQ(ierr);
+    ierr = VecNorm(y,NORM_2,&nrmr[k]);CHKERRQ(ierr);
+    ierr = VecNorm(x,NORM_2,&nrmb[k]);CHKERRQ(ierr);
+    err  = PetscMax(err,nrmb[k] > 0.0 ? nrmr[k]/nrmb[k] : nrmr[k]);
+  }
+  ierr = PetscPrintf(PETSC_COMM_WORLD,"KSPMatSolve() and KSPSolve() %s\n",err < 1.e-5 ? "agree" : "differ");CHKERRQ(ierr);
+
+  /* PCMatApply() against PCApply() */
+  ierr = PCMatApply(pc,B,Y);CHKERRQ(ierr);
+  err  = 0.0;
+  for (k=0; k<N; k++) {
+    ierr = MatGetColumnVector(B,b,k);CHKERRQ(ierr);
+    ierr = MatGetColumnVector(Y,y,k);CHKERRQ(ierr);
+    ierr = PCApply(pc,b,x);CHKERRQ(ierr);
+    ierr = VecAXPY(y,-1.0,x);CHKERRQ(ierr);
+    ierr = VecNorm(y,NORM_2,&nrmr[k]);CHKERRQ(ierr);
+    ierr = VecNorm(x,NORM_2,&nrmb[k]);CHKERRQ(ierr);
+    err  = PetscMax(err,nrmb[k] > 0.0 ? nrmr[k]/nrmb[k] : nrmr[k]);
+  }
+  ierr = PetscPrintf(PETSC_COMM_WORLD,"PCMatApply() and PCApply() %s\n",err < 100*PETSC_MACHINE_EPSILON ? "agree" : "differ");CHKERRQ(ierr);
+
+  ierr = PetscFree2(nrmb,nrmr);CHKERRQ(ierr);
+  ierr = VecDestroy(&x);CHKERRQ(ierr);
+  ierr = VecDestroy(&y);CHKERRQ(ierr);
+  ierr = VecDestroy(&b);CHKERRQ(ierr);
+  ierr = MatDestroy(&R);CHKERRQ(ierr);
+  ierr = MatDestroy(&Y);CHKERRQ(ierr);
+  ierr = MatDestroy(&X);CHKERRQ(ierr);
+  ierr = MatDestroy(&B);CHKERRQ(ierr);
+  ierr = MatDestroy(&A);CHKERRQ(ierr);
+  ierr = KSPDestroy(&ksp);CHKERRQ(ierr);
+  ierr = PetscFinalize();
+  return ierr;
+}
+
+/*TEST
+
+   testset:
+      output_file: output/ex64_1.out
+      nsize: {{1 2}}
+      test:
+         suffix: cg
+         args: -ksp_type cg -pc_type {{jacobi bjacobi}}
+      test:
+         suffix: gmres
+         args: -ksp_type gmres -ksp_gmres_restart 5 -pc_type {{jacobi bjacobi}} -ksp_pc_side {{left right}}
+
+   test:
+      suffix: preonly
+      output_file: output/ex64_1.out
+      args: -ksp_type preonly -pc_type {{lu cholesky}}
+
+   testset:
+      output_file: output/ex64_1.out
+      nsize: {{1 2}}
+      test:
+         suffix: sor
+         args: -ksp_type richardson -pc_type sor -ksp_max_it 200
+      test:
+         suffix: gamg
+         args: -ksp_type cg -pc_type gamg -mg_levels_ksp_type richardson -mg_levels_pc_type sor -mg_levels_ksp_max_it 2
+
+   test:
+      suffix: zero_column
+      output_file: output/ex64_1.out
+      nsize: {{1 2}}
+      args: -zero_column -ksp_type {{cg gmres richardson}} -pc_type jacobi -ksp_max_it 500
+
+TEST*/
@@ -26,7 +26,7 @@ int main(int argc,char **args)
   PC             pc;           /* preconditioner context */
   PetscReal      norm;         /* norm of solution error */
   PetscErrorCode ierr;
-  PetscInt       i,n = 10,col[3],its;
+  PetscInt       i,n = 10,col[3],its,nsolves = 1;
   PetscMPIInt    size;
   PetscScalar    value[3];
 
@@ -138,6 +138,18 @@ int main(int argc,char **args)
   ierr = KSPGetIterationNumber(ksp,&its);CHKERRQ(ierr);
   ierr = PetscPrintf(PETSC_COMM_WORLD,"Norm of error %g, Iterations %D\n",(double)norm,its);CHKERRQ(ierr);
 
+  /*
+     Solve the same system again, solvers such as KSPGCRODR reuse information from the previous solves
+  */
+  ierr = PetscOptionsGetInt(NULL,NULL,"-num_solves",&nsolves,NULL);CHKERRQ(ierr);
+  for (i=1; i<nsolves; i++) {
+    ierr = KSPSolve(ksp,b,x);CHKERRQ(ierr);
+    ierr = VecAXPY(x,-1.0,u);CHKERRQ(ierr);
+    ierr = VecNorm(x,NORM_2,&norm);CHKERRQ(ierr);
+    ierr = KSPGetIterationNumber(ksp,&its);CHKERRQ(ierr);
+    ierr = PetscPrintf(PETSC_COMM_WORLD,"Norm of error %g, Iterations %D\n",(double)norm,its);CHKERRQ(ierr);
+  }
+
   /*
      Free work space.  All PETSc objects should be destroyed when they
      are no longer needed.
@@ -179,6 +191,11 @@ int main(int argc,char **args)
       requires: cuda
       args: -pc_type eisenstat -ksp_monitor_short -ksp_gmres_cgs_refinement_type refine_always -mat_type aijcusparse -vec_type cuda
 
+   test:
+      suffix: gcrodr
+      args: -n 400 -pc_type none -ksp_type gcrodr -ksp_gcrodr_restart 20 -ksp_gcrodr_recycle 8 -ksp_rtol 1e-6 -num_solves 3
+      filter: grep Iterations
+
    test:
       suffix: aijcusparse
       requires: cuda
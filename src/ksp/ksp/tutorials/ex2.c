@@ -253,6 +253,18 @@ int main(int argc,char **args)
       nsize: 4
       args: -pc_type bjacobi -pc_bjacobi_blocks 4 -ksp_monitor_short -sub_pc_type jacobi -sub_ksp_type gmres
 
+   test:
+      suffix: bjacobi_threads
+      nsize: 2
+      requires: openmp threadsafety
+      args: -pc_type bjacobi -pc_bjacobi_blocks 8 -pc_bjacobi_threads 2 -ksp_monitor_short -sub_pc_type ilu
+
+   test:
+      suffix: asm_threads
+      nsize: 2
+      requires: openmp threadsafety
+      args: -pc_type asm -pc_asm_local_blocks 4 -pc_asm_overlap 1 -pc_asm_threads 2 -ksp_monitor_short -sub_pc_type ilu
+
    test:
       suffix: fbcgs
       args: -ksp_type fbcgs -pc_type ilu
@@ -297,10 +309,90 @@ int main(int argc,char **args)
       args: -ksp_monitor_short -ksp_type pipelcg -m 9 -n 9 -pc_type none -ksp_pipelcg_pipel 2 -ksp_pipelcg_lmax 2
       filter: grep -v "sqrt breakdown in iteration"
 
+   test:
+      suffix: scg
+      args: -ksp_monitor_short -ksp_type scg -m 9 -n 9
+
+   test:
+      suffix: scg_2
+      nsize: 3
+      args: -ksp_monitor_short -ksp_type scg -ksp_scg_steps 6 -ksp_scg_basis monomial -ksp_norm_type unpreconditioned -m 9 -n 9
+
+   test:
+      suffix: lowsync
+      nsize: 2
+      args: -ksp_monitor_short -m 5 -n 5 -ksp_type {{gmres dgmres}} -ksp_gmres_lowsyncgramschmidt
+      output_file: output/ex2_2.out
+
+   test:
+      suffix: lowsync_fgmres
+      nsize: 3
+      args: -ksp_monitor_short -ksp_type fgmres -ksp_gmres_lowsyncgramschmidt -pc_type none -ksp_gmres_restart 20 -m 15 -n 15
+
+   test:
+      suffix: sgmres
+      args: -ksp_monitor_short -ksp_type sgmres -ksp_gmres_restart 4 -m 9 -n 9
+
+   test:
+      suffix: sgmres_2
+      nsize: 3
+      args: -ksp_monitor_short -ksp_type sgmres -ksp_sgmres_steps 3 -ksp_sgmres_basis monomial -ksp_gmres_cgs_refinement_type refine_always -m 9 -n 9
+
    test:
       suffix: sell
       args: -ksp_monitor_short -ksp_gmres_cgs_refinement_type refine_always -m 9 -n 9 -mat_type sell
 
+   test:
+      suffix: ilu_threads
+      requires: openmp
+      args: -m 64 -n 64 -pc_type ilu -pc_factor_mat_ordering_type {{natural rcm}} -mat_aij_threads 2
+      output_file: output/ex2_ilu_threads.out
+
+   test:
+      suffix: chowilu
+      args: -m 64 -n 64 -pc_type ilu -pc_factor_levels 1 -pc_factor_mat_solver_type chowilu
+
+   test:
+      suffix: aijsingle
+      requires: !complex
+      args: -ksp_monitor_short -ksp_gmres_cgs_refinement_type refine_always -pc_type sor -pc_sor_symmetric -mat_type aijsingle
+      output_file: output/ex2_3.out
+
+   test:
+      suffix: aijsingle_2
+      requires: !complex
+      nsize: 3
+      args: -ksp_type fbcgsr -pc_type bjacobi -mat_type aijsingle
+      output_file: output/ex2_fbcgs_2.out
+
+   test:
+      suffix: ir
+      requires: !complex
+      args: -ksp_type ir -ksp_rtol 1e-12 -ksp_monitor_short
+
+   test:
+      suffix: ir_2
+      requires: !complex
+      nsize: 2
+      args: -m 40 -n 40 -ksp_type ir -ksp_rtol 1e-10 -ksp_monitor_short -ir_ksp_type bcgs -ir_sub_pc_type sor
+
+   testset:
+      suffix: fused
+      nsize: 2
+      args: -m 30 -n 30 -pc_type jacobi -ksp_converged_reason -ksp_monitor_short -ksp_max_it 8
+      test:
+        suffix: cg
+        args: -ksp_type cg -ksp_cg_fused
+      test:
+        suffix: cg_unprec
+        args: -ksp_type cg -ksp_cg_fused -ksp_norm_type unpreconditioned
+      test:
+        suffix: cr
+        args: -ksp_type cr -ksp_cr_fused
+      test:
+        suffix: bcgs
+        args: -ksp_type bcgs -ksp_bcgs_fused
+
    test:
       requires: mumps
       suffix: sell_mumps
@@ -363,6 +363,24 @@ int main(int argc,char **args)
       args: -pc_type asm -mat_type baij
       output_file: output/ex5_asm.out
 
+   test:
+      suffix: asm_newmat
+      nsize: 4
+      args: -pc_type asm -test_newMat -info
+      filter: grep -E "keep their symbolic|Norm of error"
+
+   test:
+      suffix: bjacobi_newmat
+      nsize: 4
+      args: -pc_type bjacobi -pc_bjacobi_blocks 8 -test_newMat -info
+      filter: grep -E "keep their symbolic|Norm of error"
+
+   test:
+      suffix: gcrodr
+      nsize: 2
+      args: -m 60 -ksp_type gcrodr -ksp_gcrodr_restart 10 -ksp_gcrodr_recycle 4 -pc_type jacobi -ksp_rtol 1e-8 -ksp_converged_reason -info
+      filter: grep -E "converged due|Norm of error|recycled vectors kept"
+
    test:
       suffix: redundant_0
       args: -m 1000 -pc_type redundant -pc_redundant_number 1 -redundant_ksp_type gmres -redundant_pc_type jacobi
@@ -220,6 +220,24 @@ int main(int argc,char **args)
       nsize: 4
       args: -ne 49 -alpha 1.e-3 -ksp_type cg -pc_type gamg -pc_gamg_type agg -pc_gamg_agg_nsmooths 1 -ksp_converged_reason -mg_levels_ksp_chebyshev_esteig 0,0.05,0,1.1 -mg_levels_esteig_ksp_type cg -mg_levels_esteig_ksp_max_it 10 -mg_levels_pc_type sor -pc_gamg_use_sa_esteig
 
+   test:
+      suffix: luby
+      nsize: {{1 4}}
+      args: -ne 49 -alpha 1.e-3 -ksp_type cg -pc_type gamg -pc_gamg_type agg -pc_gamg_agg_nsmooths 1 -ksp_converged_reason -mg_levels_ksp_chebyshev_esteig 0,0.05,0,1.1 -mg_levels_esteig_ksp_type cg -mg_levels_esteig_ksp_max_it 10 -mg_levels_pc_type sor -pc_gamg_use_sa_esteig -mat_coarsen_type luby -mat_coarsen_luby_threads 2 -pc_gamg_coarse_eq_limit 20 -ksp_view ::ascii_info_detail
+      filter: grep -E "(converged|rows=)" | tr -s " " | sort -u
+      output_file: output/ex54_luby.out
+
+   test:
+      suffix: implicit
+      nsize: 4
+      args: -ne 49 -alpha 1.e-3 -ksp_type cg -pc_type gamg -pc_gamg_type agg -pc_gamg_agg_nsmooths 1 -ksp_converged_reason -mg_levels_ksp_chebyshev_esteig 0,0.05,0,1.1 -mg_levels_esteig_ksp_type cg -mg_levels_esteig_ksp_max_it 10 -mg_levels_pc_type sor -pc_gamg_use_sa_esteig -pc_gamg_agg_implicit_prolongator
+      output_file: output/ex54_1.out
+
+   test:
+      suffix: multadd
+      nsize: 4
+      args: -ne 49 -alpha 1.e-3 -ksp_type cg -pc_type gamg -pc_gamg_type agg -pc_gamg_agg_nsmooths 1 -ksp_converged_reason -mg_levels_ksp_chebyshev_esteig 0,0.05,0,1.1 -mg_levels_esteig_ksp_type cg -mg_levels_esteig_ksp_max_it 10 -mg_levels_pc_type jacobi -pc_mg_type multadd
+
    test:
       suffix: seqaijmkl
       nsize: 4
@@ -32,6 +32,7 @@ typedef struct {
   PetscBool  dm_subdomains;       /* whether DM is allowed to define subdomains */
   PCCompositeType loctype;        /* the type of composition for local solves */
   MatType    sub_mat_type;        /* the type of Mat used for subdomain solves (can be MATSAME or NULL) */
+  PetscInt   nthreads;            /* number of OpenMP threads used for the local block setups and solves, set with -pc_asm_threads */
   /* For multiplicative solve */
   Mat       *lmats;               /* submatrices for overlapping multiplicative (process) subdomain */
 } PC_ASM;
@@ -56,6 +57,7 @@ static PetscErrorCode PCView_ASM(PC pc,PetscViewer viewer)
     ierr = PetscViewerASCIIPrintf(viewer,"  restriction/interpolation type - %s\n",PCASMTypes[osm->type]);CHKERRQ(ierr);
     if (osm->dm_subdomains) {ierr = PetscViewerASCIIPrintf(viewer,"  Additive Schwarz: using DM to define subdomains\n");CHKERRQ(ierr);}
     if (osm->loctype != PC_COMPOSITE_ADDITIVE) {ierr = PetscViewerASCIIPrintf(viewer,"  Additive Schwarz: local solve composition type - %s\n",PCCompositeTypes[osm->loctype]);CHKERRQ(ierr);}
+    if (osm->nthreads > 1) {ierr = PetscViewerASCIIPrintf(viewer,"  Additive Schwarz: using %D OpenMP threads for the local blocks\n",osm->nthreads);CHKERRQ(ierr);}
     ierr = MPI_Comm_rank(PetscObjectComm((PetscObject)pc),&rank);CHKERRQ(ierr);
     if (osm->same_local_solves) {
       if (osm->ksp) {
@@ -188,6 +190,9 @@ static PetscErrorCode PCSetUp_ASM(PC pc)
   const char     *prefix,*pprefix;
   Vec            vec;
   DM             *domain_dm = NULL;
+  Mat            *oldpmat = NULL;
+  PetscBool      reused;
+  PetscInt       nreused = 0;
 
   PetscFunctionBegin;
   if (!pc->setupcalled) {
@@ -309,11 +314,13 @@ static PetscErrorCode PCSetUp_ASM(PC pc)
     scall = MAT_INITIAL_MATRIX;
   } else {
     /*
-       Destroy the blocks from the previous iteration
+       Extract new blocks; the ones from the previous iteration are kept until the block solvers
+       have been told whether their structure changed, see PCSetSubOperators_Private()
     */
     if (pc->flag == DIFFERENT_NONZERO_PATTERN) {
-      ierr = MatDestroyMatrices(osm->n_local_true,&osm->pmat);CHKERRQ(ierr);
-      scall = MAT_INITIAL_MATRIX;
+      oldpmat   = osm->pmat;
+      osm->pmat = NULL;
+      scall     = MAT_INITIAL_MATRIX;
     }
   }
 
@@ -429,11 +436,16 @@ static PetscErrorCode PCSetUp_ASM(PC pc)
      Loop over subdomains putting them into local ksp
   */
   for (i=0; i<osm->n_local_true; i++) {
-    ierr = KSPSetOperators(osm->ksp[i],osm->pmat[i],osm->pmat[i]);CHKERRQ(ierr);
+    ierr = PCSetSubOperators_Private(osm->ksp[i],osm->pmat[i],osm->pmat[i],oldpmat ? oldpmat[i] : NULL,&reused);CHKERRQ(ierr);
+    if (reused) nreused++;
     if (!pc->setupcalled) {
       ierr = KSPSetFromOptions(osm->ksp[i]);CHKERRQ(ierr);
     }
   }
+  if (oldpmat) {
+    ierr = PetscInfo2(pc,"Nonzero pattern changed, %D of %D local blocks keep their symbolic factorization\n",nreused,osm->n_local_true);CHKERRQ(ierr);
+    ierr = MatDestroyMatrices(osm->n_local_true,&oldpmat);CHKERRQ(ierr);
+  }
   PetscFunctionReturn(0);
 }
 
@@ -445,6 +457,16 @@ static PetscErrorCode PCSetUpOnBlocks_ASM(PC pc)
   KSPConvergedReason reason;
 
   PetscFunctionBegin;
+#if defined(PETSC_HAVE_OPENMP) && defined(PETSC_HAVE_THREADSAFETY)
+  if (osm->nthreads > 1 && osm->n_local_true > 1) {
+    PetscErrorCode ierrt = 0;
+
+    /* the block factorizations are independent; the loop below then only collects the failures */
+#pragma omp parallel for num_threads((int)osm->nthreads) schedule(dynamic) reduction(max:ierrt)
+    for (i=0; i<osm->n_local_true; i++) ierrt = PetscMax(ierrt,KSPSetUp(osm->ksp[i]));
+    CHKERRQ(ierrt);
+  }
+#endif
   for (i=0; i<osm->n_local_true; i++) {
     ierr = KSPSetUp(osm->ksp[i]);CHKERRQ(ierr);
     ierr = KSPGetConvergedReason(osm->ksp[i],&reason);CHKERRQ(ierr);
@@ -455,6 +477,44 @@ static PetscErrorCode PCSetUpOnBlocks_ASM(PC pc)
   PetscFunctionReturn(0);
 }
 
+#if defined(PETSC_HAVE_OPENMP) && defined(PETSC_HAVE_THREADSAFETY)
+/*
+   Additive local solves with osm->nthreads OpenMP threads: each block's right-hand side is first restricted
+   into its own work vector osm->x[i], the block solves then run concurrently writing into the private osm->y[i],
+   and the block solutions are added into osm->ly afterwards in block order so the result does not depend on
+   the thread schedule.
+*/
+static PetscErrorCode PCASMLocalSolve_Threads(PC pc,PetscBool transpose,ScatterMode forward,ScatterMode reverse)
+{
+  PC_ASM         *osm = (PC_ASM*)pc->data;
+  PetscErrorCode ierr,ierrt = 0;
+  PetscInt       i,n_local_true = osm->n_local_true;
+
+  PetscFunctionBegin;
+  for (i=0; i<n_local_true; i++) {
+    ierr = VecScatterBegin(osm->lrestriction[i], osm->lx, osm->x[i], INSERT_VALUES, forward);CHKERRQ(ierr);
+    ierr = VecScatterEnd(osm->lrestriction[i], osm->lx, osm->x[i], INSERT_VALUES, forward);CHKERRQ(ierr);
+  }
+#pragma omp parallel for num_threads((int)osm->nthreads) schedule(dynamic) reduction(max:ierrt)
+  for (i=0; i<n_local_true; i++) {
+    if (transpose) ierrt = PetscMax(ierrt,KSPSolveTranspose(osm->ksp[i], osm->x[i], osm->y[i]));
+    else ierrt = PetscMax(ierrt,KSPSolve(osm->ksp[i], osm->x[i], osm->y[i]));
+  }
+  CHKERRQ(ierrt);
+  for (i=0; i<n_local_true; i++) {
+    ierr = KSPCheckSolve(osm->ksp[i],pc,osm->y[i]);CHKERRQ(ierr);
+    if (osm->lprolongation) {
+      ierr = VecScatterBegin(osm->lprolongation[i], osm->y[i], osm->ly, ADD_VALUES, forward);CHKERRQ(ierr);
+      ierr = VecScatterEnd(osm->lprolongation[i], osm->y[i], osm->ly, ADD_VALUES, forward);CHKERRQ(ierr);
+    } else {
+      ierr = VecScatterBegin(osm->lrestriction[i], osm->y[i], osm->ly, ADD_VALUES, reverse);CHKERRQ(ierr);
+      ierr = VecScatterEnd(osm->lrestriction[i], osm->y[i], osm->ly, ADD_VALUES, reverse);CHKERRQ(ierr);
+    }
+  }
+  PetscFunctionReturn(0);
+}
+#endif
+
 static PetscErrorCode PCApply_ASM(PC pc,Vec x,Vec y)
 {
   PC_ASM         *osm = (PC_ASM*)pc->data;
@@ -485,6 +545,15 @@ static PetscErrorCode PCApply_ASM(PC pc,Vec x,Vec y)
     ierr = VecScatterBegin(osm->restriction, x, osm->lx, INSERT_VALUES, forward);CHKERRQ(ierr);
     ierr = VecScatterEnd(osm->restriction, x, osm->lx, INSERT_VALUES, forward);CHKERRQ(ierr);
 
+#if defined(PETSC_HAVE_OPENMP) && defined(PETSC_HAVE_THREADSAFETY)
+    if (osm->nthreads > 1 && n_local_true > 1 && osm->loctype == PC_COMPOSITE_ADDITIVE) {
+      ierr = PCASMLocalSolve_Threads(pc,PETSC_FALSE,forward,reverse);CHKERRQ(ierr);
+      ierr = VecScatterBegin(osm->restriction, osm->ly, y,  ADD_VALUES, reverse);CHKERRQ(ierr);
+      ierr = VecScatterEnd(osm->restriction,  osm->ly, y, ADD_VALUES, reverse);CHKERRQ(ierr);
+      PetscFunctionReturn(0);
+    }
+#endif
+
     /* Restrict local RHS to the overlapping 0-block RHS */
     ierr = VecScatterBegin(osm->lrestriction[0], osm->lx, osm->x[0], INSERT_VALUES, forward);CHKERRQ(ierr);
     ierr = VecScatterEnd(osm->lrestriction[0], osm->lx, osm->x[0],  INSERT_VALUES, forward);CHKERRQ(ierr);
@@ -559,6 +628,15 @@ static PetscErrorCode PCApplyTranspose_ASM(PC pc,Vec x,Vec y)
   ierr = VecScatterBegin(osm->restriction, x, osm->lx, INSERT_VALUES, forward);CHKERRQ(ierr);
   ierr = VecScatterEnd(osm->restriction, x, osm->lx, INSERT_VALUES, forward);CHKERRQ(ierr);
 
+#if defined(PETSC_HAVE_OPENMP) && defined(PETSC_HAVE_THREADSAFETY)
+  if (osm->nthreads > 1 && n_local_true > 1) {
+    ierr = PCASMLocalSolve_Threads(pc,PETSC_TRUE,forward,reverse);CHKERRQ(ierr);
+    ierr = VecScatterBegin(osm->restriction, osm->ly, y,  ADD_VALUES, reverse);CHKERRQ(ierr);
+    ierr = VecScatterEnd(osm->restriction,  osm->ly, y, ADD_VALUES, reverse);CHKERRQ(ierr);
+    PetscFunctionReturn(0);
+  }
+#endif
+
   /* Restrict local RHS to the overlapping 0-block RHS */
   ierr = VecScatterBegin(osm->lrestriction[0], osm->lx, osm->x[0], INSERT_VALUES, forward);CHKERRQ(ierr);
   ierr = VecScatterEnd(osm->lrestriction[0], osm->lx, osm->x[0],  INSERT_VALUES, forward);CHKERRQ(ierr);
@@ -697,6 +775,10 @@ static PetscErrorCode PCSetFromOptions_ASM(PetscOptionItems *PetscOptionsObject,
   if(flg){
     ierr = PCASMSetSubMatType(pc,sub_mat_type);CHKERRQ(ierr);
   }
+  ierr = PetscOptionsInt("-pc_asm_threads","Number of OpenMP threads used for the local block setups and solves","None",osm->nthreads,&osm->nthreads,&flg);CHKERRQ(ierr);
+#if !defined(PETSC_HAVE_OPENMP) || !defined(PETSC_HAVE_THREADSAFETY)
+  if (flg && osm->nthreads > 1) {ierr = PetscInfo(pc,"Ignoring -pc_asm_threads: threaded block solves require PETSc configured with OpenMP and --with-threadsafety\n");CHKERRQ(ierr);}
+#endif
   ierr = PetscOptionsTail();CHKERRQ(ierr);
   PetscFunctionReturn(0);
 }
@@ -1239,7 +1321,8 @@ PetscErrorCode  PCASMGetSubKSP(PC pc,PetscInt *n_local,PetscInt *first_local,KSP
 +  -pc_asm_blocks <blks> - Sets total blocks
 .  -pc_asm_overlap <ovl> - Sets overlap
 .  -pc_asm_type [basic,restrict,interpolate,none] - Sets ASM type, default is restrict
--  -pc_asm_local_type [additive, multiplicative] - Sets ASM type, default is additive
+.  -pc_asm_local_type [additive, multiplicative] - Sets ASM type, default is additive
+-  -pc_asm_threads <n> - number of OpenMP threads that set up and apply the local blocks concurrently, see the notes
 
      IMPORTANT: If you run with, for example, 3 blocks on 1 processor or 3 blocks on 3 processors you
       will get a different convergence rate due to the default option of -pc_asm_type restrict. Use
@@ -1256,6 +1339,12 @@ PetscErrorCode  PCASMGetSubKSP(PC pc,PetscInt *n_local,PetscInt *first_local,KSP
          and set the options directly on the resulting KSP object (you can access its PC
          with KSPGetPC())
 
+     With -pc_asm_threads and more than one block per process, the block factorizations in PCSetUpOnBlocks() and the
+     additive block solves in PCApply() are distributed over OpenMP threads; the restrictions to and the additions from
+     the blocks stay sequential so the result is identical to the unthreaded one. The block solvers must only use
+     sequential objects. This requires PETSc configured with OpenMP and --with-threadsafety (hence --with-log=0),
+     otherwise the option is ignored. The multiplicative local composition is always sequential.
+
    Level: beginner
 
     References:
@@ -1294,6 +1383,7 @@ PETSC_EXTERN PetscErrorCode PCCreate_ASM(PC pc)
   osm->pmat              = 0;
   osm->type              = PC_ASM_RESTRICT;
   osm->loctype           = PC_COMPOSITE_ADDITIVE;
+  osm->nthreads          = 1;
   osm->same_local_solves = PETSC_TRUE;
   osm->sort_indices      = PETSC_TRUE;
   osm->dm_subdomains     = PETSC_FALSE;
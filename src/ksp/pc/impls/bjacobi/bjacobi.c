@@ -167,6 +167,10 @@ static PetscErrorCode PCSetFromOptions_BJacobi(PetscOptionItems *PetscOptionsObj
   if (flg) {ierr = PCBJacobiSetTotalBlocks(pc,blocks,NULL);CHKERRQ(ierr);}
   ierr = PetscOptionsInt("-pc_bjacobi_local_blocks","Local number of blocks","PCBJacobiSetLocalBlocks",jac->n_local,&blocks,&flg);CHKERRQ(ierr);
   if (flg) {ierr = PCBJacobiSetLocalBlocks(pc,blocks,NULL);CHKERRQ(ierr);}
+  ierr = PetscOptionsInt("-pc_bjacobi_threads","Number of OpenMP threads used for the setups and solves of multiple blocks per process","None",jac->nthreads,&jac->nthreads,&flg);CHKERRQ(ierr);
+#if !defined(PETSC_HAVE_OPENMP) || !defined(PETSC_HAVE_THREADSAFETY)
+  if (flg && jac->nthreads > 1) {ierr = PetscInfo(pc,"Ignoring -pc_bjacobi_threads: threaded block solves require PETSc configured with OpenMP and --with-threadsafety\n");CHKERRQ(ierr);}
+#endif
   if (jac->ksp) {
     /* The sub-KSP has already been set up (e.g., PCSetUp_BJacobi_Singleblock), but KSPSetFromOptions was not called
      * unless we had already been called. */
@@ -198,6 +202,7 @@ static PetscErrorCode PCView_BJacobi(PC pc,PetscViewer viewer)
       ierr = PetscViewerASCIIPrintf(viewer,"  using Amat local matrix, number of blocks = %D\n",jac->n);CHKERRQ(ierr);
     }
     ierr = PetscViewerASCIIPrintf(viewer,"  number of blocks = %D\n",jac->n);CHKERRQ(ierr);
+    if (jac->nthreads > 1) {ierr = PetscViewerASCIIPrintf(viewer,"  using %D OpenMP threads for multiple blocks per process\n",jac->nthreads);CHKERRQ(ierr);}
     ierr = MPI_Comm_rank(PetscObjectComm((PetscObject)pc),&rank);CHKERRQ(ierr);
     if (jac->same_local_solves) {
       ierr = PetscViewerASCIIPrintf(viewer,"  Local solver is the same for all blocks, as in the following KSP and PC objects on rank 0:\n");CHKERRQ(ierr);
@@ -505,7 +510,8 @@ PetscErrorCode  PCBJacobiGetLocalBlocks(PC pc, PetscInt *blocks, const PetscInt
 
    Options Database Keys:
 +  -pc_use_amat - use Amat to apply block of operator in inner Krylov method
--  -pc_bjacobi_blocks <n> - use n total blocks
+.  -pc_bjacobi_blocks <n> - use n total blocks
+-  -pc_bjacobi_threads <n> - number of OpenMP threads that set up and solve the blocks of a process concurrently, see the notes
 
    Notes:
     Each processor can have one or more blocks, or a single block can be shared by several processes. Defaults to one block per processor.
@@ -525,6 +531,10 @@ PetscErrorCode  PCBJacobiGetLocalBlocks(PC pc, PetscInt *blocks, const PetscInt
 
      When multiple processes share a single block, each block encompasses exactly all the unknowns owned its set of processes.
 
+     With -pc_bjacobi_threads and more than one block per process, the block factorizations in PCSetUpOnBlocks() and the
+     block solves are distributed over OpenMP threads; each block works in place on its own disjoint part of the vectors.
+     This requires PETSc configured with OpenMP and --with-threadsafety (hence --with-log=0), otherwise the option is ignored.
+
    Level: beginner
 
 .seealso:  PCCreate(), PCSetType(), PCType (for list of available types), PC,
@@ -559,6 +569,7 @@ PETSC_EXTERN PetscErrorCode PCCreate_BJacobi(PC pc)
   jac->g_lens            = 0;
   jac->l_lens            = 0;
   jac->psubcomm          = 0;
+  jac->nthreads          = 1;
 
   ierr = PetscObjectComposeFunction((PetscObject)pc,"PCBJacobiGetSubKSP_C",PCBJacobiGetSubKSP_BJacobi);CHKERRQ(ierr);
   ierr = PetscObjectComposeFunction((PetscObject)pc,"PCBJacobiSetTotalBlocks_C",PCBJacobiSetTotalBlocks_BJacobi);CHKERRQ(ierr);
@@ -638,6 +649,28 @@ static PetscErrorCode PCApply_BJacobi_Singleblock(PC pc,Vec x,Vec y)
   PetscFunctionReturn(0);
 }
 
+static PetscErrorCode PCMatApply_BJacobi_Singleblock(PC pc,Mat X,Mat Y)
+{
+  PC_BJacobi         *jac  = (PC_BJacobi*)pc->data;
+  PetscErrorCode     ierr;
+  Mat                sX,sY;
+  KSPConvergedReason reason;
+
+  PetscFunctionBegin;
+  /* the local parts of X and Y are sequential dense matrices that the block solver handles directly */
+  ierr = KSPSetReusePreconditioner(jac->ksp[0],pc->reusepreconditioner);CHKERRQ(ierr);
+  ierr = MatDenseGetLocalMatrix(X,&sX);CHKERRQ(ierr);
+  ierr = MatDenseGetLocalMatrix(Y,&sY);CHKERRQ(ierr);
+  ierr = KSPMatSolve(jac->ksp[0],sX,sY);CHKERRQ(ierr);
+  ierr = KSPGetConvergedReason(jac->ksp[0],&reason);CHKERRQ(ierr);
+  if (reason < 0 && reason != KSP_DIVERGED_ITS) {
+    if (pc->erroriffailure) SETERRQ1(PETSC_COMM_SELF,PETSC_ERR_NOT_CONVERGED,"Detected not converged in KSP inner solve: KSP reason %s",KSPConvergedReasons[reason]);
+    ierr = PetscInfo1(pc,"Detected not converged in KSP inner solve: KSP reason %s\n",KSPConvergedReasons[reason]);CHKERRQ(ierr);
+    pc->failedreason = PC_SUBPC_ERROR;
+  }
+  PetscFunctionReturn(0);
+}
+
 static PetscErrorCode PCApplySymmetricLeft_BJacobi_Singleblock(PC pc,Vec x,Vec y)
 {
   PetscErrorCode         ierr;
@@ -760,6 +793,7 @@ static PetscErrorCode PCSetUp_BJacobi_Singleblock(PC pc,Mat mat,Mat pmat)
       pc->ops->reset               = PCReset_BJacobi_Singleblock;
       pc->ops->destroy             = PCDestroy_BJacobi_Singleblock;
       pc->ops->apply               = PCApply_BJacobi_Singleblock;
+      pc->ops->matapply            = PCMatApply_BJacobi_Singleblock;
       pc->ops->applysymmetricleft  = PCApplySymmetricLeft_BJacobi_Singleblock;
       pc->ops->applysymmetricright = PCApplySymmetricRight_BJacobi_Singleblock;
       pc->ops->applytranspose      = PCApplyTranspose_BJacobi_Singleblock;
@@ -877,6 +911,16 @@ static PetscErrorCode PCSetUpOnBlocks_BJacobi_Multiblock(PC pc)
   KSPConvergedReason reason;
 
   PetscFunctionBegin;
+#if defined(PETSC_HAVE_OPENMP) && defined(PETSC_HAVE_THREADSAFETY)
+  if (jac->nthreads > 1 && n_local > 1) {
+    PetscErrorCode ierrt = 0;
+
+    /* the block factorizations are independent; the loop below then only collects the failures */
+#pragma omp parallel for num_threads((int)jac->nthreads) schedule(dynamic) reduction(max:ierrt)
+    for (i=0; i<n_local; i++) ierrt = PetscMax(ierrt,KSPSetUp(jac->ksp[i]));
+    CHKERRQ(ierrt);
+  }
+#endif
   for (i=0; i<n_local; i++) {
     ierr = KSPSetUp(jac->ksp[i]);CHKERRQ(ierr);
     ierr = KSPGetConvergedReason(jac->ksp[i],&reason);CHKERRQ(ierr);
@@ -887,6 +931,38 @@ static PetscErrorCode PCSetUpOnBlocks_BJacobi_Multiblock(PC pc)
   PetscFunctionReturn(0);
 }
 
+#if defined(PETSC_HAVE_OPENMP) && defined(PETSC_HAVE_THREADSAFETY)
+/*
+   Solves the blocks with jac->nthreads OpenMP threads; the work vectors of each block are placed on its own
+   disjoint part of the arrays of x and y before the threads start, so the concurrent solves share no data.
+*/
+static PetscErrorCode PCBJacobiSolveBlocks_Threads(PC pc,PetscBool transpose,const PetscScalar *xin,PetscScalar *yin)
+{
+  PC_BJacobi            *jac = (PC_BJacobi*)pc->data;
+  PC_BJacobi_Multiblock *bjac = (PC_BJacobi_Multiblock*)jac->data;
+  PetscErrorCode        ierr,ierrt = 0;
+  PetscInt              i,n_local = jac->n_local;
+
+  PetscFunctionBegin;
+  for (i=0; i<n_local; i++) {
+    ierr = VecPlaceArray(bjac->x[i],xin+bjac->starts[i]);CHKERRQ(ierr);
+    ierr = VecPlaceArray(bjac->y[i],yin+bjac->starts[i]);CHKERRQ(ierr);
+  }
+#pragma omp parallel for num_threads((int)jac->nthreads) schedule(dynamic) reduction(max:ierrt)
+  for (i=0; i<n_local; i++) {
+    if (transpose) ierrt = PetscMax(ierrt,KSPSolveTranspose(jac->ksp[i],bjac->x[i],bjac->y[i]));
+    else ierrt = PetscMax(ierrt,KSPSolve(jac->ksp[i],bjac->x[i],bjac->y[i]));
+  }
+  CHKERRQ(ierrt);
+  for (i=0; i<n_local; i++) {
+    ierr = KSPCheckSolve(jac->ksp[i],pc,bjac->y[i]);CHKERRQ(ierr);
+    ierr = VecResetArray(bjac->x[i]);CHKERRQ(ierr);
+    ierr = VecResetArray(bjac->y[i]);CHKERRQ(ierr);
+  }
+  PetscFunctionReturn(0);
+}
+#endif
+
 /*
       Preconditioner for block Jacobi
 */
@@ -902,6 +978,14 @@ static PetscErrorCode PCApply_BJacobi_Multiblock(PC pc,Vec x,Vec y)
   PetscFunctionBegin;
   ierr = VecGetArrayRead(x,&xin);CHKERRQ(ierr);
   ierr = VecGetArray(y,&yin);CHKERRQ(ierr);
+#if defined(PETSC_HAVE_OPENMP) && defined(PETSC_HAVE_THREADSAFETY)
+  if (jac->nthreads > 1 && n_local > 1) {
+    ierr = PCBJacobiSolveBlocks_Threads(pc,PETSC_FALSE,xin,yin);CHKERRQ(ierr);
+    ierr = VecRestoreArrayRead(x,&xin);CHKERRQ(ierr);
+    ierr = VecRestoreArray(y,&yin);CHKERRQ(ierr);
+    PetscFunctionReturn(0);
+  }
+#endif
   for (i=0; i<n_local; i++) {
     /*
        To avoid copying the subvector from x into a workspace we instead
@@ -939,6 +1023,14 @@ static PetscErrorCode PCApplyTranspose_BJacobi_Multiblock(PC pc,Vec x,Vec y)
   PetscFunctionBegin;
   ierr = VecGetArrayRead(x,&xin);CHKERRQ(ierr);
   ierr = VecGetArray(y,&yin);CHKERRQ(ierr);
+#if defined(PETSC_HAVE_OPENMP) && defined(PETSC_HAVE_THREADSAFETY)
+  if (jac->nthreads > 1 && n_local > 1) {
+    ierr = PCBJacobiSolveBlocks_Threads(pc,PETSC_TRUE,xin,yin);CHKERRQ(ierr);
+    ierr = VecRestoreArrayRead(x,&xin);CHKERRQ(ierr);
+    ierr = VecRestoreArray(y,&yin);CHKERRQ(ierr);
+    PetscFunctionReturn(0);
+  }
+#endif
   for (i=0; i<n_local; i++) {
     /*
        To avoid copying the subvector from x into a workspace we instead
@@ -973,6 +1065,9 @@ static PetscErrorCode PCSetUp_BJacobi_Multiblock(PC pc,Mat mat,Mat pmat)
   PC                    subpc;
   IS                    is;
   MatReuse              scall;
+  Mat                   *oldpmat = NULL;
+  PetscBool             reused;
+  PetscInt              nreused = 0;
 #if defined(PETSC_HAVE_CUDA) || defined(PETSC_HAVE_VIENNACL)
   PetscBool              is_gpumatrix = PETSC_FALSE;
 #endif
@@ -1069,10 +1164,12 @@ static PetscErrorCode PCSetUp_BJacobi_Multiblock(PC pc,Mat mat,Mat pmat)
   } else {
     bjac = (PC_BJacobi_Multiblock*)jac->data;
     /*
-       Destroy the blocks from the previous iteration
+       Destroy the blocks from the previous iteration; the preconditioner blocks are kept until the block
+       solvers have been told whether their structure changed, see PCSetSubOperators_Private()
     */
     if (pc->flag == DIFFERENT_NONZERO_PATTERN) {
-      ierr = MatDestroyMatrices(n_local,&bjac->pmat);CHKERRQ(ierr);
+      oldpmat    = bjac->pmat;
+      bjac->pmat = NULL;
       if (pc->useAmat) {
         ierr = MatDestroyMatrices(n_local,&bjac->mat);CHKERRQ(ierr);
       }
@@ -1096,14 +1193,19 @@ static PetscErrorCode PCSetUp_BJacobi_Multiblock(PC pc,Mat mat,Mat pmat)
       ierr = PetscLogObjectParent((PetscObject)pc,(PetscObject)bjac->mat[i]);CHKERRQ(ierr);
       ierr = PetscObjectGetOptionsPrefix((PetscObject)mat,&mprefix);CHKERRQ(ierr);
       ierr = PetscObjectSetOptionsPrefix((PetscObject)bjac->mat[i],mprefix);CHKERRQ(ierr);
-      ierr = KSPSetOperators(jac->ksp[i],bjac->mat[i],bjac->pmat[i]);CHKERRQ(ierr);
+      ierr = PCSetSubOperators_Private(jac->ksp[i],bjac->mat[i],bjac->pmat[i],oldpmat ? oldpmat[i] : NULL,&reused);CHKERRQ(ierr);
     } else {
-      ierr = KSPSetOperators(jac->ksp[i],bjac->pmat[i],bjac->pmat[i]);CHKERRQ(ierr);
+      ierr = PCSetSubOperators_Private(jac->ksp[i],bjac->pmat[i],bjac->pmat[i],oldpmat ? oldpmat[i] : NULL,&reused);CHKERRQ(ierr);
     }
+    if (reused) nreused++;
     if (pc->setfromoptionscalled) {
       ierr = KSPSetFromOptions(jac->ksp[i]);CHKERRQ(ierr);
     }
   }
+  if (oldpmat) {
+    ierr = PetscInfo2(pc,"Nonzero pattern changed, %D of %D local blocks keep their symbolic factorization\n",nreused,n_local);CHKERRQ(ierr);
+    ierr = MatDestroyMatrices(n_local,&oldpmat);CHKERRQ(ierr);
+  }
   PetscFunctionReturn(0);
 }
 
@@ -21,6 +21,7 @@ typedef struct {
   PetscInt     *l_lens;           /* lens of each block */
   PetscInt     *g_lens;
   PetscSubcomm psubcomm;          /* for multiple processors per block */
+  PetscInt     nthreads;          /* number of OpenMP threads for the setups and solves of multiple blocks per process, set with -pc_bjacobi_threads */
 } PC_BJacobi;
 
 /*
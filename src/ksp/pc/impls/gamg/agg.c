@@ -7,11 +7,13 @@
 #include <petsc/private/kspimpl.h>
 #include <petscblaslapack.h>
 #include <petscdm.h>
+#include <petscsf.h>
 
 typedef struct {
   PetscInt  nsmooths;
   PetscBool sym_graph;
   PetscInt  square_graph;
+  PetscBool implicit_prol;
 } PC_GAMG_AGG;
 
 /*@
@@ -127,6 +129,50 @@ static PetscErrorCode PCGAMGSetSquareGraph_AGG(PC pc, PetscInt n)
   PetscFunctionReturn(0);
 }
 
+/*@
+   PCGAMGSetImplicitProlongator - Keep the smoothed prolongator as the product (I - omega D^{-1}A) P0 instead of forming it
+
+   Not Collective on PC
+
+   Input Parameters:
++  pc - the preconditioner context
+-  n - PETSC_TRUE or PETSC_FALSE
+
+   Options Database Key:
+.  -pc_gamg_agg_implicit_prolongator <true,default=false> - do not form the smoothed prolongator
+
+   Notes:
+   The smoothed prolongator is considerably denser than the tentative prolongator P0 and forming it, and then the
+   Galerkin coarse grid operator from it, dominates the setup memory of smoothed aggregation. With this option the
+   last smoothing step is not applied explicitly; the coarse grid operator is computed one fine grid row at a time
+   directly from A and P0, and the interpolation applies the factors, which costs an extra fine grid matrix-vector
+   product for each interpolation and restriction. It is ignored with PCGAMGSetReuseInterpolation().
+
+   Level: advanced
+
+.seealso: PCGAMGSetNSmooths()
+@*/
+PetscErrorCode PCGAMGSetImplicitProlongator(PC pc, PetscBool n)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  PetscValidHeaderSpecific(pc,PC_CLASSID,1);
+  ierr = PetscTryMethod(pc,"PCGAMGSetImplicitProlongator_C",(PC,PetscBool),(pc,n));CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode PCGAMGSetImplicitProlongator_AGG(PC pc, PetscBool n)
+{
+  PC_MG       *mg          = (PC_MG*)pc->data;
+  PC_GAMG     *pc_gamg     = (PC_GAMG*)mg->innerctx;
+  PC_GAMG_AGG *pc_gamg_agg = (PC_GAMG_AGG*)pc_gamg->subctx;
+
+  PetscFunctionBegin;
+  pc_gamg_agg->implicit_prol = n;
+  PetscFunctionReturn(0);
+}
+
 static PetscErrorCode PCSetFromOptions_GAMG_AGG(PetscOptionItems *PetscOptionsObject,PC pc)
 {
   PetscErrorCode ierr;
@@ -140,6 +186,7 @@ static PetscErrorCode PCSetFromOptions_GAMG_AGG(PetscOptionItems *PetscOptionsOb
     ierr = PetscOptionsInt("-pc_gamg_agg_nsmooths","smoothing steps for smoothed aggregation, usually 1","PCGAMGSetNSmooths",pc_gamg_agg->nsmooths,&pc_gamg_agg->nsmooths,NULL);CHKERRQ(ierr);
     ierr = PetscOptionsBool("-pc_gamg_sym_graph","Set for asymmetric matrices","PCGAMGSetSymGraph",pc_gamg_agg->sym_graph,&pc_gamg_agg->sym_graph,NULL);CHKERRQ(ierr);
     ierr = PetscOptionsInt("-pc_gamg_square_graph","Number of levels to square graph for faster coarsening and lower coarse grid complexity","PCGAMGSetSquareGraph",pc_gamg_agg->square_graph,&pc_gamg_agg->square_graph,NULL);CHKERRQ(ierr);
+    ierr = PetscOptionsBool("-pc_gamg_agg_implicit_prolongator","Do not form the smoothed prolongator, compute the coarse grid operator from A and P0","PCGAMGSetImplicitProlongator",pc_gamg_agg->implicit_prol,&pc_gamg_agg->implicit_prol,NULL);CHKERRQ(ierr);
   }
   ierr = PetscOptionsTail();CHKERRQ(ierr);
   PetscFunctionReturn(0);
@@ -795,6 +842,9 @@ static PetscErrorCode PCView_GAMG_AGG(PC pc,PetscViewer viewer)
   ierr = PetscViewerASCIIPrintf(viewer,"        Symmetric graph %s\n",pc_gamg_agg->sym_graph ? "true" : "false");CHKERRQ(ierr);
   ierr = PetscViewerASCIIPrintf(viewer,"        Number of levels to square graph %D\n",pc_gamg_agg->square_graph);CHKERRQ(ierr);
   ierr = PetscViewerASCIIPrintf(viewer,"        Number smoothing steps %D\n",pc_gamg_agg->nsmooths);CHKERRQ(ierr);
+  if (pc_gamg_agg->implicit_prol) {
+    ierr = PetscViewerASCIIPrintf(viewer,"        Smoothed prolongator kept in product form\n");CHKERRQ(ierr);
+  }
   PetscFunctionReturn(0);
 }
 
@@ -1079,6 +1129,543 @@ static PetscErrorCode PCGAMGProlongator_AGG(PC pc,Mat Amat,Mat Gmat,PetscCoarsen
   PetscFunctionReturn(0);
 }
 
+/* -------------------------------------------------------------------------- */
+/*
+   Smoothed prolongator kept in product form, P = (I - omega D^{-1}A) P0, with omega = 1.4/lam.
+
+   Used with -pc_gamg_agg_implicit_prolongator so that the smoothed prolongator, which is much denser than P0, is
+   never formed. MatMult() and MatMultTranspose() apply the factors one after the other and the Galerkin coarse grid
+   operator is computed by MatPtAP_SmoothedProl_AGG(), which PCGAMGCreateLevel_GAMG() finds through "PCGAMGPtAP_C".
+*/
+typedef struct {
+  Mat       A;     /* fine grid operator */
+  Mat       P0;    /* tentative prolongator */
+  Vec       dinv;  /* omega D^{-1} */
+  Vec       w,t;   /* work vectors */
+  PetscReal omega;
+} SmoothedProl_AGG;
+
+static PetscErrorCode MatCreateSmoothedProl_AGG(Mat,Mat,PetscReal,Vec,Mat*);
+
+static PetscErrorCode MatMult_SmoothedProl_AGG(Mat P,Vec x,Vec y)
+{
+  PetscErrorCode   ierr;
+  SmoothedProl_AGG *ctx;
+
+  PetscFunctionBegin;
+  ierr = MatShellGetContext(P,(void**)&ctx);CHKERRQ(ierr);
+  ierr = MatMult(ctx->P0,x,y);CHKERRQ(ierr);
+  ierr = MatMult(ctx->A,y,ctx->w);CHKERRQ(ierr);
+  ierr = VecPointwiseMult(ctx->w,ctx->dinv,ctx->w);CHKERRQ(ierr);
+  ierr = VecAXPY(y,-1.0,ctx->w);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode MatMultTranspose_SmoothedProl_AGG(Mat P,Vec x,Vec y)
+{
+  PetscErrorCode   ierr;
+  SmoothedProl_AGG *ctx;
+
+  PetscFunctionBegin;
+  ierr = MatShellGetContext(P,(void**)&ctx);CHKERRQ(ierr);
+  ierr = VecPointwiseMult(ctx->w,ctx->dinv,x);CHKERRQ(ierr);
+  ierr = MatMultTranspose(ctx->A,ctx->w,ctx->t);CHKERRQ(ierr);
+  ierr = VecAYPX(ctx->t,-1.0,x);CHKERRQ(ierr);
+  ierr = MatMultTranspose(ctx->P0,ctx->t,y);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/* column selection only, used to move the coarse grid unknowns when the coarse grid is repartitioned */
+static PetscErrorCode MatCreateSubMatrix_SmoothedProl_AGG(Mat P,IS isrow,IS iscol,MatReuse reuse,Mat *B)
+{
+  PetscErrorCode   ierr;
+  SmoothedProl_AGG *ctx;
+  Mat              P0sub;
+  PetscInt         m,n;
+
+  PetscFunctionBegin;
+  if (reuse != MAT_INITIAL_MATRIX) SETERRQ(PetscObjectComm((PetscObject)P),PETSC_ERR_SUP,"Only MAT_INITIAL_MATRIX is supported");
+  ierr = MatShellGetContext(P,(void**)&ctx);CHKERRQ(ierr);
+  ierr = MatGetLocalSize(P,&m,NULL);CHKERRQ(ierr);
+  ierr = ISGetLocalSize(isrow,&n);CHKERRQ(ierr);
+  if (m != n) SETERRQ2(PETSC_COMM_SELF,PETSC_ERR_SUP,"Only the locally owned rows can be selected, %D requested and %D owned",n,m);
+  ierr = MatCreateSubMatrix(ctx->P0,isrow,iscol,MAT_INITIAL_MATRIX,&P0sub);CHKERRQ(ierr);
+  ierr = MatCreateSmoothedProl_AGG(ctx->A,P0sub,ctx->omega,ctx->dinv,B);CHKERRQ(ierr);
+  ierr = MatDestroy(&P0sub);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode MatDestroy_SmoothedProl_AGG(Mat P)
+{
+  PetscErrorCode   ierr;
+  SmoothedProl_AGG *ctx;
+
+  PetscFunctionBegin;
+  ierr = MatShellGetContext(P,(void**)&ctx);CHKERRQ(ierr);
+  ierr = MatDestroy(&ctx->A);CHKERRQ(ierr);
+  ierr = MatDestroy(&ctx->P0);CHKERRQ(ierr);
+  ierr = VecDestroy(&ctx->dinv);CHKERRQ(ierr);
+  ierr = VecDestroy(&ctx->w);CHKERRQ(ierr);
+  ierr = VecDestroy(&ctx->t);CHKERRQ(ierr);
+  ierr = PetscFree(ctx);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)P,"PCGAMGPtAP_C",NULL);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/* acc[idx] += alpha*v on a sparse accumulator, entries are added to 'list' the first time they are touched */
+PETSC_STATIC_INLINE void SparseAXPY_AGG(PetscScalar alpha,PetscInt nz,const PetscInt *idx,const PetscScalar *v,PetscScalar *acc,PetscBool *used,PetscInt *list,PetscInt *n)
+{
+  PetscInt k;
+
+  for (k=0; k<nz; k++) {
+    if (!used[idx[k]]) {
+      used[idx[k]]  = PETSC_TRUE;
+      acc[idx[k]]   = 0.0;
+      list[(*n)++]  = idx[k];
+    }
+    acc[idx[k]] += alpha*v[k];
+  }
+}
+
+/* row of A, fine grid rows in rows1 are either locally owned, found in A, or ghosts, found in Ahat */
+PETSC_STATIC_INLINE PetscErrorCode SmoothedProlGetRow_AGG(Mat A,Mat Ahat,PetscInt off,PetscInt nloc,const PetscInt rows1[],PetscInt l1,PetscInt *ncols,const PetscInt **cols,const PetscScalar **vals)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  if (l1 >= off && l1 < off+nloc) {
+    ierr = MatGetRow(A,rows1[l1],ncols,cols,vals);CHKERRQ(ierr);
+  } else {
+    ierr = MatGetRow(Ahat,l1 < off ? l1 : l1-nloc,ncols,cols,vals);CHKERRQ(ierr);
+  }
+  PetscFunctionReturn(0);
+}
+
+PETSC_STATIC_INLINE PetscErrorCode SmoothedProlRestoreRow_AGG(Mat A,Mat Ahat,PetscInt off,PetscInt nloc,const PetscInt rows1[],PetscInt l1,PetscInt *ncols,const PetscInt **cols,const PetscScalar **vals)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  if (l1 >= off && l1 < off+nloc) {
+    ierr = MatRestoreRow(A,rows1[l1],ncols,cols,vals);CHKERRQ(ierr);
+  } else {
+    ierr = MatRestoreRow(Ahat,l1 < off ? l1 : l1-nloc,ncols,cols,vals);CHKERRQ(ierr);
+  }
+  PetscFunctionReturn(0);
+}
+
+/*
+   MatPtAP_SmoothedProl_AGG - Galerkin coarse grid operator P^T A P for P = (I - omega D^{-1}A) P0 without forming P or AP
+
+   The locally owned fine grid rows are processed in tiles. For a tile the rows p_l = p0_l - omega/a_ll sum_m a_lm p0_m
+   of the smoothed prolongator are formed for the neighbors l of the tile only, then for each fine row i of the tile
+   (AP)_i = sum_l a_il p_l is accumulated, and each coarse row c touched by the tile gets sum_i p_ic (AP)_i added at
+   once through a dense accumulator. A coarse row is finished with the last tile whose rows of P touch it, known beforehand from the patterns
+   of A and P0, and it is released at the end of that tile. A first pass merges only the patterns and keeps the entry
+   counts of the finished rows, which are summed over the processes to preallocate the result. The second pass merges
+   the values and adds each finished row to the result, rows owned by other processes going through the stash. Besides
+   the rows alive across tiles, only the ghost rows of A one layer, and of P0 two layers, beyond the locally owned rows
+   are stored.
+*/
+static PetscErrorCode MatPtAP_SmoothedProl_AGG(Mat A,Mat P,Mat *C)
+{
+  PetscErrorCode    ierr;
+  SmoothedProl_AGG  *ctx;
+  MPI_Comm          comm;
+  Mat               *Ahat,*Phat,B = NULL;
+  IS                isrow,iscol;
+  MatType           mtype;
+  PCGAMGHashTable   map1,map2,mapc;
+  PetscLayout       layout;
+  PetscSF           sf;
+  PetscMPIInt       owner;
+  PetscBool         set,flg,*lused,*apused;
+  const PetscInt    tile = 1024,*pi,*cols,*ranges;
+  const PetscScalar *pa,*vals;
+  PetscScalar       diag,*lacc,*apacc,*tpv,*apv,*tcv,**cval;
+  PetscInt          rstart,rend,nloc,M,Nc,mc,cbs,n1,n2,ng,nc,nz,off,ii,jj,kk,tt,ncols,nl,nt,nap,tnz,tcap,apcap,tccap,ntc,l1,l2,s;
+  PetscInt          *work,*rows1,*rows2,*r1to2,*cmap,*pj,*llist,*aplist,*tslot,*tlist,*tpi,*tpj,*clen,*ccap,**ccol;
+  PetscInt          *api,*apj,*cslot,*tclist,*tci,*tcrow;
+  PetscInt          *dnnz,*onnz,*dleaf,*oleaf,*clast,*cbucket,*ctp,ntiles,t,pass;
+
+  PetscFunctionBegin;
+  ierr = MatShellGetContext(P,(void**)&ctx);CHKERRQ(ierr);
+  if (A != ctx->A) SETERRQ(PetscObjectComm((PetscObject)A),PETSC_ERR_ARG_INCOMP,"Matrix is not the operator the prolongator was smoothed with");
+  ierr = PetscObjectGetComm((PetscObject)A,&comm);CHKERRQ(ierr);
+  ierr = MatGetOwnershipRange(A,&rstart,&rend);CHKERRQ(ierr);
+  ierr = MatGetSize(A,&M,NULL);CHKERRQ(ierr);
+  ierr = MatGetSize(ctx->P0,NULL,&Nc);CHKERRQ(ierr);
+  ierr = MatGetLocalSize(ctx->P0,NULL,&mc);CHKERRQ(ierr);
+  ierr = MatGetBlockSizes(ctx->P0,NULL,&cbs);CHKERRQ(ierr);
+  nloc = rend - rstart;
+
+  /* fine grid rows: the locally owned rows and their ghost neighbors, whose rows of A are extracted */
+  for (ii=rstart,nz=0; ii<rend; ii++) {
+    ierr = MatGetRow(A,ii,&ncols,&cols,NULL);CHKERRQ(ierr);
+    for (jj=0; jj<ncols; jj++) if (cols[jj] < rstart || cols[jj] >= rend) nz++;
+    ierr = MatRestoreRow(A,ii,&ncols,&cols,NULL);CHKERRQ(ierr);
+  }
+  ierr = PetscMalloc1(nz,&work);CHKERRQ(ierr);
+  for (ii=rstart,ng=0; ii<rend; ii++) {
+    ierr = MatGetRow(A,ii,&ncols,&cols,NULL);CHKERRQ(ierr);
+    for (jj=0; jj<ncols; jj++) if (cols[jj] < rstart || cols[jj] >= rend) work[ng++] = cols[jj];
+    ierr = MatRestoreRow(A,ii,&ncols,&cols,NULL);CHKERRQ(ierr);
+  }
+  ierr = PetscSortRemoveDupsInt(&ng,work);CHKERRQ(ierr);
+  ierr = ISCreateGeneral(PETSC_COMM_SELF,ng,work,PETSC_USE_POINTER,&isrow);CHKERRQ(ierr);
+  ierr = ISCreateStride(PETSC_COMM_SELF,M,0,1,&iscol);CHKERRQ(ierr);
+  ierr = MatCreateSubMatrices(A,1,&isrow,&iscol,MAT_INITIAL_MATRIX,&Ahat);CHKERRQ(ierr);
+  ierr = ISDestroy(&isrow);CHKERRQ(ierr);
+  ierr = ISDestroy(&iscol);CHKERRQ(ierr);
+  n1   = nloc + ng;
+  ierr = PetscMalloc1(n1,&rows1);CHKERRQ(ierr);
+  for (off=0; off<ng && work[off]<rstart; off++) rows1[off] = work[off];
+  for (ii=0; ii<nloc; ii++) rows1[off+ii] = rstart + ii;
+  for (ii=off; ii<ng; ii++) rows1[nloc+ii] = work[ii];
+  ierr = PetscFree(work);CHKERRQ(ierr);
+
+  /* rows of P0: the rows above and the neighbors of the ghost rows */
+  for (ii=0,nz=n1; ii<ng; ii++) {
+    ierr = MatGetRow(Ahat[0],ii,&ncols,NULL,NULL);CHKERRQ(ierr);
+    nz  += ncols;
+    ierr = MatRestoreRow(Ahat[0],ii,&ncols,NULL,NULL);CHKERRQ(ierr);
+  }
+  ierr = PetscMalloc1(nz,&work);CHKERRQ(ierr);
+  ierr = PetscArraycpy(work,rows1,n1);CHKERRQ(ierr);
+  for (ii=0,n2=n1; ii<ng; ii++) {
+    ierr = MatGetRow(Ahat[0],ii,&ncols,&cols,NULL);CHKERRQ(ierr);
+    ierr = PetscArraycpy(work+n2,cols,ncols);CHKERRQ(ierr);
+    n2  += ncols;
+    ierr = MatRestoreRow(Ahat[0],ii,&ncols,&cols,NULL);CHKERRQ(ierr);
+  }
+  ierr = PetscSortRemoveDupsInt(&n2,work);CHKERRQ(ierr);
+  ierr = PetscMalloc1(n2,&rows2);CHKERRQ(ierr);
+  ierr = PetscArraycpy(rows2,work,n2);CHKERRQ(ierr);
+  ierr = PetscFree(work);CHKERRQ(ierr);
+  ierr = PCGAMGHashTableCreate(2*n1+1,&map1);CHKERRQ(ierr);
+  ierr = PCGAMGHashTableCreate(2*n2+1,&map2);CHKERRQ(ierr);
+  for (ii=0; ii<n1; ii++) {
+    ierr = PCGAMGHashTableAdd(&map1,rows1[ii],ii);CHKERRQ(ierr);
+  }
+  for (ii=0; ii<n2; ii++) {
+    ierr = PCGAMGHashTableAdd(&map2,rows2[ii],ii);CHKERRQ(ierr);
+  }
+  ierr = PetscMalloc1(n1,&r1to2);CHKERRQ(ierr);
+  for (ii=0; ii<n1; ii++) {
+    ierr = PCGAMGHashTableFind(&map2,rows1[ii],&r1to2[ii]);CHKERRQ(ierr);
+  }
+
+  /* rows of P0 with the coarse columns numbered compactly */
+  ierr = ISCreateGeneral(PETSC_COMM_SELF,n2,rows2,PETSC_USE_POINTER,&isrow);CHKERRQ(ierr);
+  ierr = ISCreateStride(PETSC_COMM_SELF,Nc,0,1,&iscol);CHKERRQ(ierr);
+  ierr = MatCreateSubMatrices(ctx->P0,1,&isrow,&iscol,MAT_INITIAL_MATRIX,&Phat);CHKERRQ(ierr);
+  ierr = ISDestroy(&isrow);CHKERRQ(ierr);
+  ierr = ISDestroy(&iscol);CHKERRQ(ierr);
+  ierr = MatGetRowIJ(Phat[0],0,PETSC_FALSE,PETSC_FALSE,&n2,&pi,&cols,&flg);CHKERRQ(ierr);
+  if (!flg) SETERRQ(PETSC_COMM_SELF,PETSC_ERR_SUP,"Cannot get the rows of the local prolongator");
+  ierr = MatSeqAIJGetArrayRead(Phat[0],&pa);CHKERRQ(ierr);
+  ierr = PetscMalloc2(pi[n2],&pj,pi[n2],&cmap);CHKERRQ(ierr);
+  ierr = PetscArraycpy(cmap,cols,pi[n2]);CHKERRQ(ierr);
+  nc   = pi[n2];
+  ierr = PetscSortRemoveDupsInt(&nc,cmap);CHKERRQ(ierr);
+  ierr = PCGAMGHashTableCreate(2*nc+1,&mapc);CHKERRQ(ierr);
+  for (kk=0; kk<nc; kk++) {
+    ierr = PCGAMGHashTableAdd(&mapc,cmap[kk],kk);CHKERRQ(ierr);
+  }
+  for (kk=0; kk<pi[n2]; kk++) {
+    ierr = PCGAMGHashTableFind(&mapc,cols[kk],&pj[kk]);CHKERRQ(ierr);
+  }
+  ierr = PCGAMGHashTableDestroy(&mapc);CHKERRQ(ierr);
+
+  /* coarse rows are finished with the last tile whose smoothed prolongator rows, with the pattern of the rows of P0 of the neighbors, touch them */
+  ntiles = (nloc+tile-1)/tile;
+  ierr   = PetscMalloc3(nc,&clast,nc,&cbucket,ntiles+1,&ctp);CHKERRQ(ierr);
+  for (kk=0; kk<nc; kk++) clast[kk] = -1;
+  for (ii=off; ii<off+nloc; ii++) {
+    t    = (ii-off)/tile;
+    l2   = r1to2[ii];
+    for (kk=pi[l2]; kk<pi[l2+1]; kk++) clast[pj[kk]] = t;
+    ierr = MatGetRow(A,rows1[ii],&ncols,&cols,NULL);CHKERRQ(ierr);
+    for (jj=0; jj<ncols; jj++) {
+      ierr = PCGAMGHashTableFind(&map2,cols[jj],&l2);CHKERRQ(ierr);
+      for (kk=pi[l2]; kk<pi[l2+1]; kk++) clast[pj[kk]] = t;
+    }
+    ierr = MatRestoreRow(A,rows1[ii],&ncols,&cols,NULL);CHKERRQ(ierr);
+  }
+  ierr = PetscArrayzero(ctp,ntiles+1);CHKERRQ(ierr);
+  for (kk=0; kk<nc; kk++) if (clast[kk] >= 0) ctp[clast[kk]+1]++;
+  for (t=0; t<ntiles; t++) ctp[t+1] += ctp[t];
+  for (kk=0; kk<nc; kk++) if (clast[kk] >= 0) cbucket[ctp[clast[kk]]++] = kk;
+  for (t=ntiles; t>0; t--) ctp[t] = ctp[t-1];
+  ctp[0] = 0;
+
+  ierr = PetscLayoutCreate(comm,&layout);CHKERRQ(ierr);
+  ierr = PetscLayoutSetLocalSize(layout,mc);CHKERRQ(ierr);
+  ierr = PetscLayoutSetSize(layout,Nc);CHKERRQ(ierr);
+  ierr = PetscLayoutSetUp(layout);CHKERRQ(ierr);
+  ierr = PetscLayoutGetRanges(layout,&ranges);CHKERRQ(ierr);
+
+  /* rows of the coarse operator in the compact numbering, alive from the first to the last tile touching them */
+  ierr = PetscCalloc4(nc,&clen,nc,&ccap,nc,&ccol,nc,&cval);CHKERRQ(ierr);
+  ierr = PetscCalloc2(nc,&dleaf,nc,&oleaf);CHKERRQ(ierr);
+  ierr = PetscCalloc2(nc,&lused,nc,&apused);CHKERRQ(ierr);
+  ierr = PetscMalloc4(nc,&lacc,nc,&llist,nc,&apacc,nc,&aplist);CHKERRQ(ierr);
+  ierr = PetscMalloc3(nc,&cslot,nc,&tclist,nc+1,&tci);CHKERRQ(ierr);
+  for (kk=0; kk<nc; kk++) cslot[kk] = -1;
+  ierr = PetscMalloc3(n1,&tslot,n1,&tlist,n1+1,&tpi);CHKERRQ(ierr);
+  for (kk=0; kk<n1; kk++) tslot[kk] = -1;
+  tcap  = pi[n2] + 1;
+  ierr  = PetscMalloc2(tcap,&tpj,tcap,&tpv);CHKERRQ(ierr);
+  apcap = tccap = tcap;
+  ierr  = PetscMalloc1(tile+1,&api);CHKERRQ(ierr);
+  ierr  = PetscMalloc2(apcap,&apj,apcap,&apv);CHKERRQ(ierr);
+  ierr  = PetscMalloc2(tccap,&tcrow,tccap,&tcv);CHKERRQ(ierr);
+  /* the first pass merges the patterns only, to preallocate the result, the second one adds the values */
+  for (pass=0; pass<2; pass++) {
+    for (tt=off,t=0; tt<off+nloc; tt+=tile,t++) {
+      const PetscInt tend = PetscMin(tt+tile,off+nloc);
+
+      /* rows of the smoothed prolongator needed by the tile, the rows of the tile and their neighbors */
+      for (ii=tt,nt=0; ii<tend; ii++) {
+        if (tslot[ii] < 0) {tslot[ii] = nt; tlist[nt++] = ii;}
+        ierr = MatGetRow(A,rows1[ii],&ncols,&cols,NULL);CHKERRQ(ierr);
+        for (jj=0; jj<ncols; jj++) {
+          ierr = PCGAMGHashTableFind(&map1,cols[jj],&l1);CHKERRQ(ierr);
+          if (tslot[l1] < 0) {tslot[l1] = nt; tlist[nt++] = l1;}
+        }
+        ierr = MatRestoreRow(A,rows1[ii],&ncols,&cols,NULL);CHKERRQ(ierr);
+      }
+      for (s=0,tnz=0,tpi[0]=0; s<nt; s++) {
+        l1   = tlist[s];
+        l2   = r1to2[l1];
+        nl   = 0;
+        SparseAXPY_AGG(1.0,pi[l2+1]-pi[l2],pj+pi[l2],pa+pi[l2],lacc,lused,llist,&nl);
+        ierr = SmoothedProlGetRow_AGG(A,Ahat[0],off,nloc,rows1,l1,&ncols,&cols,&vals);CHKERRQ(ierr);
+        for (jj=0,diag=0.0; jj<ncols; jj++) if (cols[jj] == rows1[l1]) diag = vals[jj];
+        if (diag != 0.0) { /* zero for a missing diagonal, as VecReciprocal() */
+          diag = ctx->omega/diag;
+          for (jj=0; jj<ncols; jj++) {
+            ierr = PCGAMGHashTableFind(&map2,cols[jj],&l2);CHKERRQ(ierr);
+            SparseAXPY_AGG(-diag*vals[jj],pi[l2+1]-pi[l2],pj+pi[l2],pa+pi[l2],lacc,lused,llist,&nl);
+          }
+        }
+        ierr = SmoothedProlRestoreRow_AGG(A,Ahat[0],off,nloc,rows1,l1,&ncols,&cols,&vals);CHKERRQ(ierr);
+        if (tnz+nl > tcap) {
+          PetscInt    *tj;
+          PetscScalar *tv;
+
+          tcap = PetscMax(2*tcap,tnz+nl);
+          ierr = PetscMalloc2(tcap,&tj,tcap,&tv);CHKERRQ(ierr);
+          ierr = PetscArraycpy(tj,tpj,tnz);CHKERRQ(ierr);
+          ierr = PetscArraycpy(tv,tpv,tnz);CHKERRQ(ierr);
+          ierr = PetscFree2(tpj,tpv);CHKERRQ(ierr);
+          tpj  = tj;
+          tpv  = tv;
+        }
+        for (kk=0; kk<nl; kk++) {
+          tpj[tnz]         = llist[kk];
+          tpv[tnz++]       = lacc[llist[kk]];
+          lused[llist[kk]] = PETSC_FALSE;
+        }
+        tpi[s+1] = tnz;
+      }
+      /* (AP)_i = sum_l a_il p_l for the rows of the tile */
+      for (ii=tt,api[0]=0; ii<tend; ii++) {
+        ierr = MatGetRow(A,rows1[ii],&ncols,&cols,&vals);CHKERRQ(ierr);
+        for (jj=0,nap=0; jj<ncols; jj++) {
+          ierr = PCGAMGHashTableFind(&map1,cols[jj],&l1);CHKERRQ(ierr);
+          s    = tslot[l1];
+          SparseAXPY_AGG(vals[jj],tpi[s+1]-tpi[s],tpj+tpi[s],tpv+tpi[s],apacc,apused,aplist,&nap);
+        }
+        ierr = MatRestoreRow(A,rows1[ii],&ncols,&cols,&vals);CHKERRQ(ierr);
+        if (api[ii-tt]+nap > apcap) {
+          PetscInt    *tj;
+          PetscScalar *tv;
+
+          apcap = PetscMax(2*apcap,api[ii-tt]+nap);
+          ierr  = PetscMalloc2(apcap,&tj,apcap,&tv);CHKERRQ(ierr);
+          ierr  = PetscArraycpy(tj,apj,api[ii-tt]);CHKERRQ(ierr);
+          ierr  = PetscArraycpy(tv,apv,api[ii-tt]);CHKERRQ(ierr);
+          ierr  = PetscFree2(apj,apv);CHKERRQ(ierr);
+          apj   = tj;
+          apv   = tv;
+        }
+        for (kk=0; kk<nap; kk++) {
+          apj[api[ii-tt]+kk] = aplist[kk];
+          apv[api[ii-tt]+kk] = apacc[aplist[kk]];
+          apused[aplist[kk]] = PETSC_FALSE;
+        }
+        api[ii-tt+1] = api[ii-tt] + nap;
+      }
+      /* coarse rows touched by the tile, with the fine rows i and the entries p_ic contributing to them */
+      for (ii=tt,ntc=0,tci[0]=0; ii<tend; ii++) {
+        s = tslot[ii];
+        for (kk=tpi[s]; kk<tpi[s+1]; kk++) {
+          const PetscInt c = tpj[kk];
+
+          if (cslot[c] < 0) {cslot[c] = ntc; tclist[ntc++] = c; tci[ntc] = 0;}
+          tci[cslot[c]+1]++;
+        }
+      }
+      for (s=0; s<ntc; s++) tci[s+1] += tci[s];
+      if (tci[ntc] > tccap) {
+        tccap = PetscMax(2*tccap,tci[ntc]);
+        ierr  = PetscFree2(tcrow,tcv);CHKERRQ(ierr);
+        ierr  = PetscMalloc2(tccap,&tcrow,tccap,&tcv);CHKERRQ(ierr);
+      }
+      for (ii=tt; ii<tend; ii++) {
+        s = tslot[ii];
+        for (kk=tpi[s]; kk<tpi[s+1]; kk++) {
+          const PetscInt q = cslot[tpj[kk]];
+
+          tcrow[tci[q]] = ii-tt;
+          tcv[tci[q]++] = tpv[kk];
+        }
+      }
+      for (s=ntc; s>0; s--) tci[s] = tci[s-1];
+      tci[0] = 0;
+      /* each touched coarse row is accumulated once, row += sum_i p_ic (AP)_i, keeping only its pattern in the first pass */
+      for (s=0; s<ntc; s++) {
+        const PetscInt c = tclist[s];
+
+        nl = 0;
+        if (pass) SparseAXPY_AGG(1.0,clen[c],ccol[c],cval[c],apacc,apused,aplist,&nl);
+        else {
+          for (kk=0; kk<clen[c]; kk++) {
+            apused[ccol[c][kk]] = PETSC_TRUE;
+            aplist[nl++]        = ccol[c][kk];
+          }
+        }
+        for (kk=tci[s]; kk<tci[s+1]; kk++) {
+          const PetscInt r = tcrow[kk];
+
+          SparseAXPY_AGG(tcv[kk],api[r+1]-api[r],apj+api[r],apv+api[r],apacc,apused,aplist,&nl);
+        }
+        if (nl > ccap[c]) {
+          ccap[c] = nl + nl/2;
+          ierr    = PetscFree(ccol[c]);CHKERRQ(ierr);
+          ierr    = PetscFree(cval[c]);CHKERRQ(ierr);
+          ierr    = PetscMalloc1(ccap[c],&ccol[c]);CHKERRQ(ierr);
+          if (pass) {ierr = PetscMalloc1(ccap[c],&cval[c]);CHKERRQ(ierr);}
+        }
+        for (kk=0; kk<nl; kk++) {
+          ccol[c][kk]        = aplist[kk];
+          if (pass) cval[c][kk] = apacc[aplist[kk]];
+          apused[aplist[kk]] = PETSC_FALSE;
+        }
+        clen[c]  = nl;
+        cslot[c] = -1;
+      }
+      for (s=0; s<nt; s++) tslot[tlist[s]] = -1;
+
+      /* rows finished with the tile are counted, or added to the result with the rows owned by other processes going through the stash, then freed */
+      for (kk=ctp[t]; kk<ctp[t+1]; kk++) {
+        const PetscInt c = cbucket[kk];
+
+        if (!clen[c]) continue;
+        for (jj=0; jj<clen[c]; jj++) ccol[c][jj] = cmap[ccol[c][jj]];
+        if (!pass) {
+          ierr = PetscLayoutFindOwner(layout,cmap[c],&owner);CHKERRQ(ierr);
+          for (jj=0; jj<clen[c]; jj++) {
+            if (ccol[c][jj] >= ranges[owner] && ccol[c][jj] < ranges[owner+1]) dleaf[c]++;
+          }
+          oleaf[c] = clen[c] - dleaf[c];
+        } else {
+          ierr = PetscSortIntWithScalarArray(clen[c],ccol[c],cval[c]);CHKERRQ(ierr);
+          ierr = MatSetValues(B,1,&cmap[c],clen[c],ccol[c],cval[c],ADD_VALUES);CHKERRQ(ierr);
+        }
+        ierr    = PetscFree(ccol[c]);CHKERRQ(ierr);
+        ierr    = PetscFree(cval[c]);CHKERRQ(ierr);
+        clen[c] = ccap[c] = 0;
+      }
+    }
+    if (pass) break;
+
+    /* preallocation, an upper bound as the rows computed on several processes are counted by each of them */
+    ierr = PetscCalloc2(mc,&dnnz,mc,&onnz);CHKERRQ(ierr);
+    ierr = PetscSFCreate(comm,&sf);CHKERRQ(ierr);
+    ierr = PetscSFSetGraphLayout(sf,layout,nc,NULL,PETSC_COPY_VALUES,cmap);CHKERRQ(ierr);
+    ierr = PetscSFReduceBegin(sf,MPIU_INT,dleaf,dnnz,MPI_SUM);CHKERRQ(ierr);
+    ierr = PetscSFReduceEnd(sf,MPIU_INT,dleaf,dnnz,MPI_SUM);CHKERRQ(ierr);
+    ierr = PetscSFReduceBegin(sf,MPIU_INT,oleaf,onnz,MPI_SUM);CHKERRQ(ierr);
+    ierr = PetscSFReduceEnd(sf,MPIU_INT,oleaf,onnz,MPI_SUM);CHKERRQ(ierr);
+    ierr = PetscSFDestroy(&sf);CHKERRQ(ierr);
+    for (kk=0; kk<mc; kk++) {
+      dnnz[kk] = PetscMin(dnnz[kk],mc);
+      onnz[kk] = PetscMin(onnz[kk],Nc-mc);
+    }
+    ierr = MatGetType(A,&mtype);CHKERRQ(ierr);
+    ierr = MatCreate(comm,&B);CHKERRQ(ierr);
+    ierr = MatSetSizes(B,mc,mc,Nc,Nc);CHKERRQ(ierr);
+    ierr = MatSetBlockSize(B,cbs);CHKERRQ(ierr);
+    ierr = MatSetType(B,mtype);CHKERRQ(ierr);
+    ierr = MatSeqAIJSetPreallocation(B,0,dnnz);CHKERRQ(ierr);
+    ierr = MatMPIAIJSetPreallocation(B,0,dnnz,0,onnz);CHKERRQ(ierr);
+    ierr = PetscFree2(dnnz,onnz);CHKERRQ(ierr);
+  }
+  ierr = PetscFree2(lused,apused);CHKERRQ(ierr);
+  ierr = PetscFree4(lacc,llist,apacc,aplist);CHKERRQ(ierr);
+  ierr = PetscFree3(cslot,tclist,tci);CHKERRQ(ierr);
+  ierr = PetscFree(api);CHKERRQ(ierr);
+  ierr = PetscFree2(apj,apv);CHKERRQ(ierr);
+  ierr = PetscFree2(tcrow,tcv);CHKERRQ(ierr);
+  ierr = PetscFree3(tslot,tlist,tpi);CHKERRQ(ierr);
+  ierr = PetscFree2(tpj,tpv);CHKERRQ(ierr);
+  ierr = PetscFree3(clast,cbucket,ctp);CHKERRQ(ierr);
+  ierr = PetscFree4(clen,ccap,ccol,cval);CHKERRQ(ierr);
+  ierr = PetscFree2(dleaf,oleaf);CHKERRQ(ierr);
+  ierr = PetscLayoutDestroy(&layout);CHKERRQ(ierr);
+  ierr = PCGAMGHashTableDestroy(&map1);CHKERRQ(ierr);
+  ierr = PCGAMGHashTableDestroy(&map2);CHKERRQ(ierr);
+  ierr = PetscFree(r1to2);CHKERRQ(ierr);
+  ierr = MatSeqAIJRestoreArrayRead(Phat[0],&pa);CHKERRQ(ierr);
+  ierr = MatRestoreRowIJ(Phat[0],0,PETSC_FALSE,PETSC_FALSE,&n2,&pi,NULL,&flg);CHKERRQ(ierr);
+  ierr = MatDestroySubMatrices(1,&Phat);CHKERRQ(ierr);
+  ierr = MatDestroySubMatrices(1,&Ahat);CHKERRQ(ierr);
+  ierr = PetscFree(rows2);CHKERRQ(ierr);
+  ierr = PetscFree(rows1);CHKERRQ(ierr);
+  ierr = PetscFree2(pj,cmap);CHKERRQ(ierr);
+  ierr = MatAssemblyBegin(B,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  ierr = MatAssemblyEnd(B,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  ierr = MatIsSymmetricKnown(A,&set,&flg);CHKERRQ(ierr);
+  if (set && flg) {
+    ierr = MatSetOption(B,MAT_SYMMETRIC,PETSC_TRUE);CHKERRQ(ierr);
+  }
+  *C   = B;
+  PetscFunctionReturn(0);
+}
+
+/*
+   MatCreateSmoothedProl_AGG - creates the MATSHELL for P = (I - omega D^{-1}A) P0, dinv holds omega D^{-1}
+*/
+static PetscErrorCode MatCreateSmoothedProl_AGG(Mat A,Mat P0,PetscReal omega,Vec dinv,Mat *P)
+{
+  PetscErrorCode   ierr;
+  SmoothedProl_AGG *ctx;
+  PetscInt         m,n,M,N;
+
+  PetscFunctionBegin;
+  ierr = PetscNew(&ctx);CHKERRQ(ierr);
+  ierr = PetscObjectReference((PetscObject)A);CHKERRQ(ierr);
+  ierr = PetscObjectReference((PetscObject)P0);CHKERRQ(ierr);
+  ierr = PetscObjectReference((PetscObject)dinv);CHKERRQ(ierr);
+  ctx->A     = A;
+  ctx->P0    = P0;
+  ctx->dinv  = dinv;
+  ctx->omega = omega;
+  ierr = MatCreateVecs(A,&ctx->t,&ctx->w);CHKERRQ(ierr);
+  ierr = MatGetLocalSize(P0,&m,&n);CHKERRQ(ierr);
+  ierr = MatGetSize(P0,&M,&N);CHKERRQ(ierr);
+  ierr = MatCreateShell(PetscObjectComm((PetscObject)A),m,n,M,N,ctx,P);CHKERRQ(ierr);
+  ierr = MatSetBlockSizesFromMats(*P,P0,P0);CHKERRQ(ierr);
+  ierr = MatShellSetOperation(*P,MATOP_MULT,(void(*)(void))MatMult_SmoothedProl_AGG);CHKERRQ(ierr);
+  ierr = MatShellSetOperation(*P,MATOP_MULT_TRANSPOSE,(void(*)(void))MatMultTranspose_SmoothedProl_AGG);CHKERRQ(ierr);
+  ierr = MatShellSetOperation(*P,MATOP_CREATE_SUBMATRIX,(void(*)(void))MatCreateSubMatrix_SmoothedProl_AGG);CHKERRQ(ierr);
+  ierr = MatShellSetOperation(*P,MATOP_DESTROY,(void(*)(void))MatDestroy_SmoothedProl_AGG);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)*P,"PCGAMGPtAP_C",MatPtAP_SmoothedProl_AGG);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
 /* -------------------------------------------------------------------------- */
 /*
    PCGAMGOptProlongator_AGG
@@ -1171,14 +1758,24 @@ static PetscErrorCode PCGAMGOptProlongator_AGG(PC pc,Mat Amat,Mat *a_P)
 #endif
 
     /* smooth P1 := (I - omega/lam D^{-1}A)P0 */
-    ierr  = MatMatMult(Amat, Prol, MAT_INITIAL_MATRIX, PETSC_DEFAULT, &tMat);CHKERRQ(ierr);
-    ierr  = MatCreateVecs(Amat, &diag, 0);CHKERRQ(ierr);
-    ierr  = MatGetDiagonal(Amat, diag);CHKERRQ(ierr); /* effectively PCJACOBI */
-    ierr  = VecReciprocal(diag);CHKERRQ(ierr);
-    ierr  = MatDiagonalScale(tMat, diag, 0);CHKERRQ(ierr);
-    ierr  = VecDestroy(&diag);CHKERRQ(ierr);
-    alpha = -1.4/emax;
-    ierr  = MatAYPX(tMat, alpha, Prol, SUBSET_NONZERO_PATTERN);CHKERRQ(ierr);
+    if (pc_gamg_agg->implicit_prol && jj == pc_gamg_agg->nsmooths-1 && !pc_gamg->reuse_prol) {
+      /* last step kept in product form, the coarse grid operator is computed without forming P1 */
+      ierr  = MatCreateVecs(Amat, &diag, 0);CHKERRQ(ierr);
+      ierr  = MatGetDiagonal(Amat, diag);CHKERRQ(ierr);
+      ierr  = VecReciprocal(diag);CHKERRQ(ierr);
+      ierr  = VecScale(diag, 1.4/emax);CHKERRQ(ierr);
+      ierr  = MatCreateSmoothedProl_AGG(Amat, Prol, 1.4/emax, diag, &tMat);CHKERRQ(ierr);
+      ierr  = VecDestroy(&diag);CHKERRQ(ierr);
+    } else {
+      ierr  = MatMatMult(Amat, Prol, MAT_INITIAL_MATRIX, PETSC_DEFAULT, &tMat);CHKERRQ(ierr);
+      ierr  = MatCreateVecs(Amat, &diag, 0);CHKERRQ(ierr);
+      ierr  = MatGetDiagonal(Amat, diag);CHKERRQ(ierr); /* effectively PCJACOBI */
+      ierr  = VecReciprocal(diag);CHKERRQ(ierr);
+      ierr  = MatDiagonalScale(tMat, diag, 0);CHKERRQ(ierr);
+      ierr  = VecDestroy(&diag);CHKERRQ(ierr);
+      alpha = -1.4/emax;
+      ierr  = MatAYPX(tMat, alpha, Prol, SUBSET_NONZERO_PATTERN);CHKERRQ(ierr);
+    }
     ierr  = MatDestroy(&Prol);CHKERRQ(ierr);
     Prol  = tMat;
 #if defined PETSC_GAMG_USE_LOG
@@ -1221,13 +1818,15 @@ PetscErrorCode  PCCreateGAMG_AGG(PC pc)
   pc_gamg->ops->createdefaultdata = PCSetData_AGG;
   pc_gamg->ops->view              = PCView_GAMG_AGG;
 
-  pc_gamg_agg->square_graph = 1;
-  pc_gamg_agg->sym_graph    = PETSC_FALSE;
-  pc_gamg_agg->nsmooths     = 1;
+  pc_gamg_agg->square_graph  = 1;
+  pc_gamg_agg->sym_graph     = PETSC_FALSE;
+  pc_gamg_agg->nsmooths      = 1;
+  pc_gamg_agg->implicit_prol = PETSC_FALSE;
 
   ierr = PetscObjectComposeFunction((PetscObject)pc,"PCGAMGSetNSmooths_C",PCGAMGSetNSmooths_AGG);CHKERRQ(ierr);
   ierr = PetscObjectComposeFunction((PetscObject)pc,"PCGAMGSetSymGraph_C",PCGAMGSetSymGraph_AGG);CHKERRQ(ierr);
   ierr = PetscObjectComposeFunction((PetscObject)pc,"PCGAMGSetSquareGraph_C",PCGAMGSetSquareGraph_AGG);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)pc,"PCGAMGSetImplicitProlongator_C",PCGAMGSetImplicitProlongator_AGG);CHKERRQ(ierr);
   ierr = PetscObjectComposeFunction((PetscObject)pc,"PCSetCoordinates_C",PCSetCoordinates_AGG);CHKERRQ(ierr);
   PetscFunctionReturn(0);
 }
@@ -42,6 +42,7 @@ PetscErrorCode PCReset_GAMG(PC pc)
   for (level = 0; level < PETSC_MG_MAXLEVELS ; level++) {
     mg->min_eigen_DinvA[level] = 0;
     mg->max_eigen_DinvA[level] = 0;
+    ierr = VecDestroy(&pc_gamg->esteig_vec[level]);CHKERRQ(ierr);
   }
   pc_gamg->emin = 0;
   pc_gamg->emax = 0;
@@ -74,13 +75,19 @@ static PetscErrorCode PCGAMGCreateLevel_GAMG(PC pc,Mat Amat_fine,PetscInt cr_bs,
   MPI_Comm        comm;
   PetscMPIInt     rank,size,new_size,nactive=*a_nactive_proc;
   PetscInt        ncrs_eq,ncrs,f_bs;
+  PetscErrorCode  (*ptap)(Mat,Mat,Mat*);
 
   PetscFunctionBegin;
   ierr = PetscObjectGetComm((PetscObject)Amat_fine,&comm);CHKERRQ(ierr);
   ierr = MPI_Comm_rank(comm, &rank);CHKERRQ(ierr);
   ierr = MPI_Comm_size(comm, &size);CHKERRQ(ierr);
   ierr = MatGetBlockSize(Amat_fine, &f_bs);CHKERRQ(ierr);
-  ierr = MatPtAP(Amat_fine, Pold, MAT_INITIAL_MATRIX, 2.0, &Cmat);CHKERRQ(ierr);
+  ierr = PetscObjectQueryFunction((PetscObject)Pold,"PCGAMGPtAP_C",&ptap);CHKERRQ(ierr);
+  if (ptap) { /* prolongator not formed explicitly */
+    ierr = (*ptap)(Amat_fine, Pold, &Cmat);CHKERRQ(ierr);
+  } else {
+    ierr = MatPtAP(Amat_fine, Pold, MAT_INITIAL_MATRIX, 2.0, &Cmat);CHKERRQ(ierr);
+  }
 
   if (Pcolumnperm) *Pcolumnperm = NULL;
 
@@ -410,11 +417,15 @@ static PetscErrorCode PCGAMGCreateLevel_GAMG(PC pc,Mat Amat_fine,PetscInt cr_bs,
       if (1) { /* lvec is created, need to pin it, this is done in MatSetUpMultiply_MPIAIJ. Hack */
         Mat         A = *a_Amat_crs, P = *a_P_inout;
         PetscMPIInt size;
+        PetscBool   isaij;
         ierr = MPI_Comm_size(PetscObjectComm((PetscObject)A),&size);CHKERRQ(ierr);
         if (size > 1) {
           Mat_MPIAIJ     *a = (Mat_MPIAIJ*)A->data, *p = (Mat_MPIAIJ*)P->data;
           ierr = VecBindToCPU(a->lvec,PETSC_TRUE);CHKERRQ(ierr);
-          ierr = VecBindToCPU(p->lvec,PETSC_TRUE);CHKERRQ(ierr);
+          ierr = PetscObjectBaseTypeCompare((PetscObject)P,MATMPIAIJ,&isaij);CHKERRQ(ierr);
+          if (isaij) { /* not with a prolongator in product form */
+            ierr = VecBindToCPU(p->lvec,PETSC_TRUE);CHKERRQ(ierr);
+          }
         }
       }
     }
@@ -425,6 +436,66 @@ static PetscErrorCode PCGAMGCreateLevel_GAMG(PC pc,Mat Amat_fine,PetscInt cr_bs,
   PetscFunctionReturn(0);
 }
 
+/* -------------------------------------------------------------------------- */
+/*
+   PCGAMGRefreshEstEig_Private - Updates the eigenvalue bounds of the Chebyshev smoothers after the operators changed
+     with a few power iterations on the preconditioned operator of each level, started from the approximate eigenvector
+     of the previous update. The first update starts from a random vector with PCGAMGSetEstEigKSPMaxIt() iterations and
+     does not lower the bounds of the first setup.
+*/
+static PetscErrorCode PCGAMGRefreshEstEig_Private(PC pc)
+{
+  PetscErrorCode ierr;
+  PC_MG          *mg      = (PC_MG*)pc->data;
+  PC_GAMG        *pc_gamg = (PC_GAMG*)mg->innerctx;
+  PetscInt       lidx,level,its,ii;
+
+  PetscFunctionBegin;
+  for (lidx = 1, level = pc_gamg->Nlevels-2; level >= 0 ; lidx++, level--) {
+    KSP           smoother;
+    KSP_Chebyshev *cheb;
+    PC            subpc;
+    Mat           A;
+    Vec           x;
+    PetscReal     emax = 0.0,emin = 0.0;
+    PetscBool     ischeb,first;
+
+    ierr = PCMGGetSmoother(pc, lidx, &smoother);CHKERRQ(ierr);
+    ierr = PetscObjectTypeCompare((PetscObject)smoother,KSPCHEBYSHEV,&ischeb);CHKERRQ(ierr);
+    if (!ischeb) continue;
+    cheb = (KSP_Chebyshev*)smoother->data;
+    ierr = KSPGetOperators(smoother,&A,NULL);CHKERRQ(ierr);
+    ierr = KSPGetPC(smoother, &subpc);CHKERRQ(ierr);
+    its   = pc_gamg->esteig_refresh_its;
+    first = (PetscBool)!pc_gamg->esteig_vec[level];
+    if (first) {
+      PetscRandom rand;
+
+      ierr = MatCreateVecs(A,&pc_gamg->esteig_vec[level],NULL);CHKERRQ(ierr);
+      ierr = PetscRandomCreate(PetscObjectComm((PetscObject)pc),&rand);CHKERRQ(ierr);
+      ierr = VecSetRandom(pc_gamg->esteig_vec[level],rand);CHKERRQ(ierr);
+      ierr = PetscRandomDestroy(&rand);CHKERRQ(ierr);
+      its  = PetscMax(its,pc_gamg->esteig_max_it);
+    }
+    x    = pc_gamg->esteig_vec[level];
+    ierr = VecNormalize(x,NULL);CHKERRQ(ierr);
+    for (ii=0; ii<its; ii++) {
+      /* the work vectors of the smoother are only used inside its solve */
+      ierr = MatMult(A,x,smoother->work[0]);CHKERRQ(ierr);
+      ierr = PCApply(subpc,smoother->work[0],x);CHKERRQ(ierr);
+      ierr = VecNormalize(x,&emax);CHKERRQ(ierr);
+    }
+    /* from a random vector the power iterations underestimate the largest eigenvalue, keep the previous one if larger */
+    if (first) emax = PetscMax(emax,cheb->emax_computed);
+    if (cheb->emax_computed > 0.0) emin = cheb->emin_computed*emax/cheb->emax_computed;
+    ierr = PetscInfo4(pc,"level %D (N=%D) updated emax = %g emin = %g\n",level,A->rmap->N,(double)emax,(double)emin);CHKERRQ(ierr);
+    cheb->emin_computed = emin;
+    cheb->emax_computed = emax;
+    ierr = KSPChebyshevSetEigenvalues(smoother, cheb->tform[2]*emin + cheb->tform[3]*emax, cheb->tform[0]*emin + cheb->tform[1]*emax);CHKERRQ(ierr);
+  }
+  PetscFunctionReturn(0);
+}
+
 /* -------------------------------------------------------------------------- */
 /*
    PCSetUp_GAMG - Prepares for the use of the GAMG preconditioner
@@ -457,6 +528,9 @@ PetscErrorCode PCSetUp_GAMG(PC pc)
   if (pc_gamg->setup_count++ > 0) {
     if ((PetscBool)(!pc_gamg->reuse_prol)) {
       /* reset everything */
+      for (level=0; level<PETSC_MG_MAXLEVELS; level++) {
+        ierr = VecDestroy(&pc_gamg->esteig_vec[level]);CHKERRQ(ierr);
+      }
       ierr = PCReset_MG(pc);CHKERRQ(ierr);
       pc->setupcalled = 0;
     } else {
@@ -472,15 +546,15 @@ PetscErrorCode PCSetUp_GAMG(PC pc)
         ierr = KSPSetOperators(mglevels[pc_gamg->Nlevels-1]->smoothd,dA,dB);CHKERRQ(ierr);
 
         for (level=pc_gamg->Nlevels-2; level>=0; level--) {
-          /* 2nd solve, matrix structure can change from repartitioning or process reduction but don't know if we have process reduction here. Should fix */
-          if (pc_gamg->setup_count==2 /* && pc_gamg->repart||reduction */) {
+          /* the coarse matrix has no product data if it comes from repartitioning or process reduction */
+          ierr = KSPGetOperators(mglevels[level]->smoothd,NULL,&B);CHKERRQ(ierr);
+          if (!B->product) {
             ierr = PetscInfo2(pc,"new RAP after first solve level %D, %D setup\n",level,pc_gamg->setup_count);CHKERRQ(ierr);
             ierr = MatPtAP(dB,mglevels[level+1]->interpolate,MAT_INITIAL_MATRIX,2.0,&B);CHKERRQ(ierr);
             ierr = MatDestroy(&mglevels[level]->A);CHKERRQ(ierr);
             mglevels[level]->A = B;
           } else {
             ierr = PetscInfo2(pc,"RAP after first solve reusing matrix level %D, %D setup\n",level,pc_gamg->setup_count);CHKERRQ(ierr);
-            ierr = KSPGetOperators(mglevels[level]->smoothd,NULL,&B);CHKERRQ(ierr);
             ierr = MatPtAP(dB,mglevels[level+1]->interpolate,MAT_REUSE_MATRIX,1.0,&B);CHKERRQ(ierr);
           }
           ierr = KSPSetOperators(mglevels[level]->smoothd,B,B);CHKERRQ(ierr);
@@ -489,6 +563,9 @@ PetscErrorCode PCSetUp_GAMG(PC pc)
       }
 
       ierr = PCSetUp_MG(pc);CHKERRQ(ierr);
+      if (pc_gamg->esteig_refresh_its > 0) {
+        ierr = PCGAMGRefreshEstEig_Private(pc);CHKERRQ(ierr);
+      }
       PetscFunctionReturn(0);
     }
   }
@@ -1078,6 +1155,50 @@ static PetscErrorCode PCGAMGSetReuseInterpolation_GAMG(PC pc, PetscBool n)
   PetscFunctionReturn(0);
 }
 
+/*@
+   PCGAMGSetEstEigRefreshIts - Set the number of power iterations that update the Chebyshev smoother eigenvalue bounds when the preconditioner is rebuilt with the reused interpolation
+
+   Collective on PC
+
+   Input Parameters:
++  pc - the preconditioner context
+-  n - number of power iterations, 0 to estimate the eigenvalues as in the first setup
+
+   Options Database Key:
+.  -pc_gamg_esteig_refresh_its <its>
+
+   Level: advanced
+
+   Notes:
+    Only used with PCGAMGSetReuseInterpolation(). The power iterations on the preconditioned operator of each level start from
+    the approximate eigenvector of the previous rebuild, so a few of them suffice when the matrix entries change slowly, as in
+    time dependent problems. The first rebuild starts from a random vector with the number of iterations from PCGAMGSetEstEigKSPMaxIt()
+    if that is larger, and only raises the bounds of the first setup. The bounds computed this way replace any estimation requested with KSPChebyshevEstEigSet(), the transform it
+    was given is kept.
+
+.seealso: PCGAMGSetReuseInterpolation(), PCGAMGSetEstEigKSPMaxIt(), KSPChebyshevSetEigenvalues()
+@*/
+PetscErrorCode PCGAMGSetEstEigRefreshIts(PC pc, PetscInt n)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  PetscValidHeaderSpecific(pc,PC_CLASSID,1);
+  PetscValidLogicalCollectiveInt(pc,n,2);
+  ierr = PetscTryMethod(pc,"PCGAMGSetEstEigRefreshIts_C",(PC,PetscInt),(pc,n));CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode PCGAMGSetEstEigRefreshIts_GAMG(PC pc, PetscInt n)
+{
+  PC_MG   *mg      = (PC_MG*)pc->data;
+  PC_GAMG *pc_gamg = (PC_GAMG*)mg->innerctx;
+
+  PetscFunctionBegin;
+  pc_gamg->esteig_refresh_its = n;
+  PetscFunctionReturn(0);
+}
+
 /*@
    PCGAMGASMSetUseAggs - Have the PCGAMG smoother on each level use the aggregates defined by the coarsening process as the subdomains for the additive Schwarz preconditioner.
 
@@ -1537,6 +1658,7 @@ PetscErrorCode PCSetFromOptions_GAMG(PetscOptionItems *PetscOptionsObject,PC pc)
   ierr = PetscOptionsBool("-pc_gamg_use_sa_esteig","Use eigen estimate from Smoothed aggregation for smoother","PCGAMGSetUseSAEstEig",f2,&f2,&flag);CHKERRQ(ierr);
   if (flag) pc_gamg->use_sa_esteig = f2 ? 1 : 0;
   ierr = PetscOptionsBool("-pc_gamg_reuse_interpolation","Reuse prolongation operator","PCGAMGReuseInterpolation",pc_gamg->reuse_prol,&pc_gamg->reuse_prol,NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsInt("-pc_gamg_esteig_refresh_its","Power iterations to update the smoother eigenvalue bounds when reusing the prolongation","PCGAMGSetEstEigRefreshIts",pc_gamg->esteig_refresh_its,&pc_gamg->esteig_refresh_its,NULL);CHKERRQ(ierr);
   ierr = PetscOptionsBool("-pc_gamg_asm_use_agg","Use aggregation aggregates for ASM smoother","PCGAMGASMSetUseAggs",pc_gamg->use_aggs_in_asm,&pc_gamg->use_aggs_in_asm,NULL);CHKERRQ(ierr);
   ierr = PetscOptionsBool("-pc_gamg_use_parallel_coarse_grid_solver","Use parallel coarse grid solver (otherwise put last grid on one process)","PCGAMGSetUseParallelCoarseGridSolve",pc_gamg->use_parallel_coarse_grid_solver,&pc_gamg->use_parallel_coarse_grid_solver,NULL);CHKERRQ(ierr);
   ierr = PetscOptionsBool("-pc_gamg_cpu_pin_coarse_grids","Pin coarse grids to the CPU","PCGAMGSetCpuPinCoarseGrids",pc_gamg->cpu_pin_coarse_grids,&pc_gamg->cpu_pin_coarse_grids,NULL);CHKERRQ(ierr);
@@ -1579,6 +1701,7 @@ PetscErrorCode PCSetFromOptions_GAMG(PetscOptionItems *PetscOptionsObject,PC pc)
 +   -pc_gamg_type <type> - one of agg, geo, or classical
 .   -pc_gamg_repartition  <true,default=false> - repartition the degrees of freedom accross the coarse grids as they are determined
 .   -pc_gamg_reuse_interpolation <true,default=false> - when rebuilding the algebraic multigrid preconditioner reuse the previously computed interpolations
+.   -pc_gamg_esteig_refresh_its <its,default=0> - with reused interpolations update the smoother eigenvalue bounds with this many power iterations
 .   -pc_gamg_asm_use_agg <true,default=false> - use the aggregates from the coasening process to defined the subdomains on each level for the PCASM smoother
 .   -pc_gamg_process_eq_limit <limit, default=50> - GAMG will reduce the number of MPI processes used directly on the coarse grids so that there are around <limit>
                                         equations on each process that has degrees of freedom
@@ -1589,7 +1712,8 @@ PetscErrorCode PCSetFromOptions_GAMG(PetscOptionItems *PetscOptionsObject,PC pc)
    Options Database Keys for default Aggregation:
 +  -pc_gamg_agg_nsmooths <nsmooth, default=1> - number of smoothing steps to use with smooth aggregation
 .  -pc_gamg_sym_graph <true,default=false> - symmetrize the graph before computing the aggregation
--  -pc_gamg_square_graph <n,default=1> - number of levels to square the graph before aggregating it
+.  -pc_gamg_square_graph <n,default=1> - number of levels to square the graph before aggregating it
+-  -pc_gamg_agg_implicit_prolongator <true,default=false> - compute the coarse grid operators without forming the smoothed prolongator, see PCGAMGSetImplicitProlongator()
 
    Multigrid options:
 +  -pc_mg_cycles <v> - v or w, see PCMGSetCycleType()
@@ -1607,7 +1731,7 @@ PetscErrorCode PCSetFromOptions_GAMG(PetscOptionItems *PetscOptionsObject,PC pc)
   Level: intermediate
 
 .seealso:  PCCreate(), PCSetType(), MatSetBlockSize(), PCMGType, PCSetCoordinates(), MatSetNearNullSpace(), PCGAMGSetType(), PCGAMGAGG, PCGAMGGEO, PCGAMGCLASSICAL, PCGAMGSetProcEqLim(),
-           PCGAMGSetCoarseEqLim(), PCGAMGSetRepartition(), PCGAMGRegister(), PCGAMGSetReuseInterpolation(), PCGAMGASMSetUseAggs(), PCGAMGSetUseParallelCoarseGridSolve(), PCGAMGSetNlevels(), PCGAMGSetThreshold(), PCGAMGGetType(), PCGAMGSetReuseInterpolation(), PCGAMGSetUseSAEstEig(), PCGAMGSetEstEigKSPMaxIt(), PCGAMGSetEstEigKSPType()
+           PCGAMGSetCoarseEqLim(), PCGAMGSetRepartition(), PCGAMGRegister(), PCGAMGSetReuseInterpolation(), PCGAMGASMSetUseAggs(), PCGAMGSetUseParallelCoarseGridSolve(), PCGAMGSetNlevels(), PCGAMGSetThreshold(), PCGAMGGetType(), PCGAMGSetReuseInterpolation(), PCGAMGSetUseSAEstEig(), PCGAMGSetEstEigKSPMaxIt(), PCGAMGSetEstEigKSPType(), PCGAMGSetEstEigRefreshIts()
 M*/
 
 PETSC_EXTERN PetscErrorCode PCCreate_GAMG(PC pc)
@@ -1654,6 +1778,7 @@ PETSC_EXTERN PetscErrorCode PCCreate_GAMG(PC pc)
   ierr = PetscObjectComposeFunction((PetscObject)pc,"PCGAMGSetEigenvalues_C",PCGAMGSetEigenvalues_GAMG);CHKERRQ(ierr);
   ierr = PetscObjectComposeFunction((PetscObject)pc,"PCGAMGSetUseSAEstEig_C",PCGAMGSetUseSAEstEig_GAMG);CHKERRQ(ierr);
   ierr = PetscObjectComposeFunction((PetscObject)pc,"PCGAMGSetReuseInterpolation_C",PCGAMGSetReuseInterpolation_GAMG);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)pc,"PCGAMGSetEstEigRefreshIts_C",PCGAMGSetEstEigRefreshIts_GAMG);CHKERRQ(ierr);
   ierr = PetscObjectComposeFunction((PetscObject)pc,"PCGAMGASMSetUseAggs_C",PCGAMGASMSetUseAggs_GAMG);CHKERRQ(ierr);
   ierr = PetscObjectComposeFunction((PetscObject)pc,"PCGAMGSetUseParallelCoarseGridSolve_C",PCGAMGSetUseParallelCoarseGridSolve_GAMG);CHKERRQ(ierr);
   ierr = PetscObjectComposeFunction((PetscObject)pc,"PCGAMGSetCpuPinCoarseGrids_C",PCGAMGSetCpuPinCoarseGrids_GAMG);CHKERRQ(ierr);
@@ -1677,6 +1802,7 @@ PETSC_EXTERN PetscErrorCode PCCreate_GAMG(PC pc)
   pc_gamg->current_level    = 0; /* don't need to init really */
   ierr = PetscStrcpy(pc_gamg->esteig_type,KSPGMRES);CHKERRQ(ierr);
   pc_gamg->esteig_max_it    = 10;
+  pc_gamg->esteig_refresh_its = 0;
   pc_gamg->use_sa_esteig    = -1;
   pc_gamg->emin             = 0;
   pc_gamg->emax             = 0;
@@ -272,6 +272,35 @@ static PetscErrorCode PCApply_Jacobi(PC pc,Vec x,Vec y)
   ierr = VecPointwiseMult(y,x,jac->diag);CHKERRQ(ierr);
   PetscFunctionReturn(0);
 }
+
+static PetscErrorCode PCMatApply_Jacobi(PC pc,Mat X,Mat Y)
+{
+  PC_Jacobi         *jac = (PC_Jacobi*)pc->data;
+  PetscErrorCode    ierr;
+  PetscInt          i,j,m,N,ldx,ldy;
+  const PetscScalar *d,*x;
+  PetscScalar       *y;
+
+  PetscFunctionBegin;
+  if (!jac->diag) {
+    ierr = PCSetUp_Jacobi_NonSymmetric(pc);CHKERRQ(ierr);
+  }
+  ierr = MatGetLocalSize(Y,&m,NULL);CHKERRQ(ierr);
+  ierr = MatGetSize(Y,NULL,&N);CHKERRQ(ierr);
+  ierr = MatDenseGetLDA(X,&ldx);CHKERRQ(ierr);
+  ierr = MatDenseGetLDA(Y,&ldy);CHKERRQ(ierr);
+  ierr = VecGetArrayRead(jac->diag,&d);CHKERRQ(ierr);
+  ierr = MatDenseGetArrayRead(X,&x);CHKERRQ(ierr);
+  ierr = MatDenseGetArray(Y,&y);CHKERRQ(ierr);
+  for (j=0; j<N; j++) {
+    for (i=0; i<m; i++) y[i+j*ldy] = d[i]*x[i+j*ldx];
+  }
+  ierr = MatDenseRestoreArray(Y,&y);CHKERRQ(ierr);
+  ierr = MatDenseRestoreArrayRead(X,&x);CHKERRQ(ierr);
+  ierr = VecRestoreArrayRead(jac->diag,&d);CHKERRQ(ierr);
+  ierr = PetscLogFlops(1.0*m*N);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
 /* -------------------------------------------------------------------------- */
 /*
    PCApplySymmetricLeftOrRight_Jacobi - Applies the left or right part of a
@@ -416,6 +445,7 @@ PETSC_EXTERN PetscErrorCode PCCreate_Jacobi(PC pc)
       not needed.
   */
   pc->ops->apply               = PCApply_Jacobi;
+  pc->ops->matapply            = PCMatApply_Jacobi;
   pc->ops->applytranspose      = PCApply_Jacobi;
   pc->ops->setup               = PCSetUp_Jacobi;
   pc->ops->reset               = PCReset_Jacobi;
@@ -58,6 +58,74 @@ PetscErrorCode PCMGMCycle_Private(PC pc,PC_MG_Levels **mglevelsin,PCRichardsonCo
   PetscFunctionReturn(0);
 }
 
+/* MatRestrict() and MatInterpolate() on the columns of X: the transfer matrix is applied transposed when its rows do not match the target level */
+static PetscErrorCode PCMGMatTransfer_Private(Mat A,Mat X,PetscInt Ny,Mat *Y)
+{
+  PetscErrorCode ierr;
+  PetscInt       M;
+
+  PetscFunctionBegin;
+  ierr = MatGetSize(A,&M,NULL);CHKERRQ(ierr);
+  if (M == Ny) {
+    ierr = MatMatMult(A,X,MAT_INITIAL_MATRIX,PETSC_DEFAULT,Y);CHKERRQ(ierr);
+  } else {
+    ierr = MatTransposeMatMult(A,X,MAT_INITIAL_MATRIX,PETSC_DEFAULT,Y);CHKERRQ(ierr);
+  }
+  PetscFunctionReturn(0);
+}
+
+/*
+   PCMGMCycleMat_Private - PCMGMCycle_Private() on all the columns of B at once: the smoothers are applied with KSPMatSolve(),
+   the residual and the grid transfers with products of the sparse matrices and the dense blocks
+*/
+static PetscErrorCode PCMGMCycleMat_Private(PC pc,PC_MG_Levels **mglevelsin,Mat B,Mat X)
+{
+  PC_MG_Levels       *mgc,*mglevels = *mglevelsin;
+  PetscErrorCode     ierr;
+  PetscInt           cycles = (mglevels->level == 1) ? 1 : (PetscInt) mglevels->cycles,M,Mc;
+  Mat                R,Bc,Xc,T;
+  KSPConvergedReason kspreason;
+
+  PetscFunctionBegin;
+  if (mglevels->eventsmoothsolve) {ierr = PetscLogEventBegin(mglevels->eventsmoothsolve,0,0,0,0);CHKERRQ(ierr);}
+  ierr = KSPMatSolve(mglevels->smoothd,B,X);CHKERRQ(ierr);  /* pre-smooth */
+  ierr = KSPGetConvergedReason(mglevels->smoothd,&kspreason);CHKERRQ(ierr);
+  if (kspreason == KSP_DIVERGED_PC_FAILED) pc->failedreason = PC_SUBPC_ERROR;
+  if (mglevels->eventsmoothsolve) {ierr = PetscLogEventEnd(mglevels->eventsmoothsolve,0,0,0,0);CHKERRQ(ierr);}
+  if (mglevels->level) {  /* not the coarsest grid */
+    mgc  = *(mglevelsin - 1);
+    ierr = MatGetSize(mglevels->A,&M,NULL);CHKERRQ(ierr);
+    ierr = MatGetSize(mgc->A,&Mc,NULL);CHKERRQ(ierr);
+    if (mglevels->eventresidual) {ierr = PetscLogEventBegin(mglevels->eventresidual,0,0,0,0);CHKERRQ(ierr);}
+    ierr = MatMatMult(mglevels->A,X,MAT_INITIAL_MATRIX,PETSC_DEFAULT,&R);CHKERRQ(ierr);
+    ierr = MatAYPX(R,-1.0,B,SAME_NONZERO_PATTERN);CHKERRQ(ierr);
+    if (mglevels->eventresidual) {ierr = PetscLogEventEnd(mglevels->eventresidual,0,0,0,0);CHKERRQ(ierr);}
+
+    if (mglevels->eventinterprestrict) {ierr = PetscLogEventBegin(mglevels->eventinterprestrict,0,0,0,0);CHKERRQ(ierr);}
+    ierr = PCMGMatTransfer_Private(mglevels->restrct,R,Mc,&Bc);CHKERRQ(ierr);
+    if (mglevels->eventinterprestrict) {ierr = PetscLogEventEnd(mglevels->eventinterprestrict,0,0,0,0);CHKERRQ(ierr);}
+    ierr = MatDestroy(&R);CHKERRQ(ierr);
+    ierr = MatDuplicate(Bc,MAT_DO_NOT_COPY_VALUES,&Xc);CHKERRQ(ierr);
+    ierr = MatZeroEntries(Xc);CHKERRQ(ierr);
+    while (cycles--) {
+      ierr = PCMGMCycleMat_Private(pc,mglevelsin-1,Bc,Xc);CHKERRQ(ierr);
+    }
+    if (mglevels->eventinterprestrict) {ierr = PetscLogEventBegin(mglevels->eventinterprestrict,0,0,0,0);CHKERRQ(ierr);}
+    ierr = PCMGMatTransfer_Private(mglevels->interpolate,Xc,M,&T);CHKERRQ(ierr);
+    ierr = MatAXPY(X,1.0,T,SAME_NONZERO_PATTERN);CHKERRQ(ierr);
+    if (mglevels->eventinterprestrict) {ierr = PetscLogEventEnd(mglevels->eventinterprestrict,0,0,0,0);CHKERRQ(ierr);}
+    ierr = MatDestroy(&T);CHKERRQ(ierr);
+    ierr = MatDestroy(&Xc);CHKERRQ(ierr);
+    ierr = MatDestroy(&Bc);CHKERRQ(ierr);
+    if (mglevels->eventsmoothsolve) {ierr = PetscLogEventBegin(mglevels->eventsmoothsolve,0,0,0,0);CHKERRQ(ierr);}
+    ierr = KSPMatSolve(mglevels->smoothu,B,X);CHKERRQ(ierr);    /* post smooth */
+    ierr = KSPGetConvergedReason(mglevels->smoothu,&kspreason);CHKERRQ(ierr);
+    if (kspreason == KSP_DIVERGED_PC_FAILED) pc->failedreason = PC_SUBPC_ERROR;
+    if (mglevels->eventsmoothsolve) {ierr = PetscLogEventEnd(mglevels->eventsmoothsolve,0,0,0,0);CHKERRQ(ierr);}
+  }
+  PetscFunctionReturn(0);
+}
+
 static PetscErrorCode PCApplyRichardson_MG(PC pc,Vec b,Vec x,Vec w,PetscReal rtol,PetscReal abstol, PetscReal dtol,PetscInt its,PetscBool zeroguess,PetscInt *outits,PCRichardsonConvergedReason *reason)
 {
   PC_MG          *mg        = (PC_MG*)pc->data;
@@ -145,6 +213,9 @@ PetscErrorCode PCReset_MG(PC pc)
     n = mglevels[0]->levels;
     for (i=0; i<n-1; i++) {
       ierr = VecDestroy(&mglevels[i+1]->r);CHKERRQ(ierr);
+      ierr = VecDestroy(&mglevels[i+1]->z);CHKERRQ(ierr);
+      ierr = VecDestroy(&mglevels[i+1]->dinv);CHKERRQ(ierr);
+      ierr = MatDestroy(&mglevels[i+1]->sinterpolate);CHKERRQ(ierr);
       ierr = VecDestroy(&mglevels[i]->b);CHKERRQ(ierr);
       ierr = VecDestroy(&mglevels[i]->x);CHKERRQ(ierr);
       ierr = MatDestroy(&mglevels[i+1]->restrct);CHKERRQ(ierr);
@@ -329,6 +400,8 @@ PetscErrorCode PCDestroy_MG(PC pc)
 
 
 extern PetscErrorCode PCMGACycle_Private(PC,PC_MG_Levels**);
+extern PetscErrorCode PCMGMACycle_Private(PC,PC_MG_Levels**);
+extern PetscErrorCode PCMGMASetUp_Private(PC,PC_MG_Levels**);
 extern PetscErrorCode PCMGFCycle_Private(PC,PC_MG_Levels**);
 extern PetscErrorCode PCMGKCycle_Private(PC,PC_MG_Levels**);
 
@@ -386,6 +459,8 @@ static PetscErrorCode PCApply_MG(PC pc,Vec b,Vec x)
     ierr = PCMGACycle_Private(pc,mglevels);CHKERRQ(ierr);
   } else if (mg->am == PC_MG_KASKADE) {
     ierr = PCMGKCycle_Private(pc,mglevels);CHKERRQ(ierr);
+  } else if (mg->am == PC_MG_MULTADD) {
+    ierr = PCMGMACycle_Private(pc,mglevels);CHKERRQ(ierr);
   } else {
     ierr = PCMGFCycle_Private(pc,mglevels);CHKERRQ(ierr);
   }
@@ -394,6 +469,54 @@ static PetscErrorCode PCApply_MG(PC pc,Vec b,Vec x)
   PetscFunctionReturn(0);
 }
 
+/*
+   PCMatApply_MG - the multiplicative cycle on all the columns of X at once, when the level operators and the grid transfers are AIJ
+   matrices and the default residual is used. The smoothers treat the columns together when their KSP has a KSPMatSolve()
+   implementation, for example KSPRICHARDSON or KSPPREONLY with PCSOR or PCJACOBI. The other cycles and configurations apply
+   PCApply_MG() to each column in turn.
+*/
+static PetscErrorCode PCMatApply_MG(PC pc,Mat X,Mat Y)
+{
+  PC_MG          *mg        = (PC_MG*)pc->data;
+  PC_MG_Levels   **mglevels = mg->levels;
+  PetscErrorCode ierr;
+  PC             tpc;
+  PetscInt       levels = mglevels[0]->levels,i;
+  PetscBool      changeu,changed,flg = PETSC_TRUE,match;
+
+  PetscFunctionBegin;
+  for (i=0; i<levels; i++) {
+    if (!mglevels[i]->A) {
+      ierr = KSPGetOperators(mglevels[i]->smoothu,&mglevels[i]->A,NULL);CHKERRQ(ierr);
+      ierr = PetscObjectReference((PetscObject)mglevels[i]->A);CHKERRQ(ierr);
+    }
+  }
+  ierr = KSPGetPC(mglevels[levels-1]->smoothd,&tpc);CHKERRQ(ierr);
+  ierr = PCPreSolveChangeRHS(tpc,&changed);CHKERRQ(ierr);
+  ierr = KSPGetPC(mglevels[levels-1]->smoothu,&tpc);CHKERRQ(ierr);
+  ierr = PCPreSolveChangeRHS(tpc,&changeu);CHKERRQ(ierr);
+  if (mg->am != PC_MG_MULTIPLICATIVE || changed || changeu) flg = PETSC_FALSE;
+  for (i=1; i<levels && flg; i++) {
+    if (mglevels[i]->residual != PCMGResidualDefault) flg = PETSC_FALSE;
+    ierr = PetscObjectBaseTypeCompareAny((PetscObject)mglevels[i]->A,&match,MATSEQAIJ,MATMPIAIJ,"");CHKERRQ(ierr);
+    if (!match) flg = PETSC_FALSE;
+    ierr = PetscObjectBaseTypeCompareAny((PetscObject)mglevels[i]->interpolate,&match,MATSEQAIJ,MATMPIAIJ,"");CHKERRQ(ierr);
+    if (!match) flg = PETSC_FALSE;
+    ierr = PetscObjectBaseTypeCompareAny((PetscObject)mglevels[i]->restrct,&match,MATSEQAIJ,MATMPIAIJ,"");CHKERRQ(ierr);
+    if (!match) flg = PETSC_FALSE;
+  }
+  if (!flg) {
+    ierr = PCMatApplyColumns_Private(pc,X,Y);CHKERRQ(ierr);
+    PetscFunctionReturn(0);
+  }
+  if (mg->stageApply) {ierr = PetscLogStagePush(mg->stageApply);CHKERRQ(ierr);}
+  ierr = MatZeroEntries(Y);CHKERRQ(ierr);
+  for (i=0; i<mg->cyclesperpcapply; i++) {
+    ierr = PCMGMCycleMat_Private(pc,mglevels+levels-1,X,Y);CHKERRQ(ierr);
+  }
+  if (mg->stageApply) {ierr = PetscLogStagePop();CHKERRQ(ierr);}
+  PetscFunctionReturn(0);
+}
 
 PetscErrorCode PCSetFromOptions_MG(PetscOptionItems *PetscOptionsObject,PC pc)
 {
@@ -487,7 +610,7 @@ PetscErrorCode PCSetFromOptions_MG(PetscOptionItems *PetscOptionsObject,PC pc)
   PetscFunctionReturn(0);
 }
 
-const char *const PCMGTypes[] = {"MULTIPLICATIVE","ADDITIVE","FULL","KASKADE","PCMGType","PC_MG",0};
+const char *const PCMGTypes[] = {"MULTIPLICATIVE","ADDITIVE","FULL","KASKADE","MULTADD","PCMGType","PC_MG",0};
 const char *const PCMGCycleTypes[] = {"invalid","v","w","PCMGCycleType","PC_MG_CYCLE",0};
 const char *const PCMGGalerkinTypes[] = {"both","pmat","mat","none","external","PCMGGalerkinType","PC_MG_GALERKIN",0};
 
@@ -877,6 +1000,16 @@ PetscErrorCode PCSetUp_MG(PC pc)
   }
   if (mglevels[0]->eventsmoothsetup) {ierr = PetscLogEventEnd(mglevels[0]->eventsmoothsetup,0,0,0,0);CHKERRQ(ierr);}
 
+  if (mg->am == PC_MG_MULTADD) {
+    ierr = PCMGMASetUp_Private(pc,mglevels);CHKERRQ(ierr);
+  } else {
+    for (i=1; i<n; i++) {
+      ierr = MatDestroy(&mglevels[i]->sinterpolate);CHKERRQ(ierr);
+      ierr = VecDestroy(&mglevels[i]->dinv);CHKERRQ(ierr);
+      ierr = VecDestroy(&mglevels[i]->z);CHKERRQ(ierr);
+    }
+  }
+
   /*
      Dump the interpolation/restriction matrices plus the
    Jacobian/stiffness on each level. This allows MATLAB users to
@@ -944,18 +1077,31 @@ PetscErrorCode PCMGGetLevels(PC pc,PetscInt *levels)
 
 /*@
    PCMGSetType - Determines the form of multigrid to use:
-   multiplicative, additive, full, or the Kaskade algorithm.
+   multiplicative, additive, full, the Kaskade algorithm, or mult-additive.
 
    Logically Collective on PC
 
    Input Parameters:
 +  pc - the preconditioner context
 -  form - multigrid form, one of PC_MG_MULTIPLICATIVE, PC_MG_ADDITIVE,
-   PC_MG_FULL, PC_MG_KASKADE
+   PC_MG_FULL, PC_MG_KASKADE, PC_MG_MULTADD
 
    Options Database Key:
 .  -pc_mg_type <form> - Sets <form>, one of multiplicative,
-   additive, full, kaskade
+   additive, full, kaskade, multadd
+
+   Notes:
+   With PC_MG_MULTADD the right hand side is restricted with Pbar^T and the corrections are interpolated with Pbar,
+   the smoothed interpolation (I - D^{-1} A) P, D being the l1 row sums of A, formed in PCSetUp() for AIJ matrices.
+   The pre and post smoothing of a level then do not wait for the other levels, and the way up costs one
+   interpolation per level. The coarse grid solve is still on the critical path of every level: the restrictions
+   lead down to it and the correction of each level waits for the interpolations up from it. The preconditioner is
+   symmetric for symmetric smoothers whose post smoother is the transpose of the pre smoother.
+
+   PC_MG_MULTADD is expected to need more iterations than PC_MG_MULTIPLICATIVE for about the same work per cycle,
+   for example 24 against 15 CG iterations for the 3D elasticity problem of src/ksp/ksp/tutorials/ex56.c with GAMG.
+   Since this implementation still visits the levels one after the other, it only pays off if the levels can be
+   overlapped, for instance with the coarse levels on a subcommunicator, see PCTELESCOPE.
 
    Level: advanced
 
@@ -984,7 +1130,7 @@ PetscErrorCode  PCMGSetType(PC pc,PCMGType form)
 .  pc - the preconditioner context
 
    Output Parameter:
-.  type - one of PC_MG_MULTIPLICATIVE, PC_MG_ADDITIVE,PC_MG_FULL, PC_MG_KASKADE
+.  type - one of PC_MG_MULTIPLICATIVE, PC_MG_ADDITIVE,PC_MG_FULL, PC_MG_KASKADE, PC_MG_MULTADD
 
 
    Level: advanced
@@ -1271,7 +1417,7 @@ PetscErrorCode  PCGetCoarseOperators_MG(PC pc,PetscInt *num_levels,Mat *coarseOp
    Options Database Keys:
 +  -pc_mg_levels <nlevels> - number of levels including finest
 .  -pc_mg_cycle_type <v,w> - provide the cycle desired
-.  -pc_mg_type <additive,multiplicative,full,kaskade> - multiplicative is the default
+.  -pc_mg_type <additive,multiplicative,full,kaskade,multadd> - multiplicative is the default
 .  -pc_mg_log - log information about time spent on each level of the solver
 .  -pc_mg_distinct_smoothup - configure up (after interpolation) and down (before restriction) smoothers separately (with different options prefixes)
 .  -pc_mg_galerkin <both,pmat,mat,none> - use Galerkin process to compute coarser operators, i.e. Acoarse = R A R'
@@ -1315,6 +1461,7 @@ PETSC_EXTERN PetscErrorCode PCCreate_MG(PC pc)
   pc->useAmat = PETSC_TRUE;
 
   pc->ops->apply          = PCApply_MG;
+  pc->ops->matapply       = PCMatApply_MG;
   pc->ops->setup          = PCSetUp_MG;
   pc->ops->reset          = PCReset_MG;
   pc->ops->destroy        = PCDestroy_MG;
@@ -31,3 +31,116 @@ PetscErrorCode PCMGACycle_Private(PC pc,PC_MG_Levels **mglevels)
   }
   PetscFunctionReturn(0);
 }
+
+/*
+   PCMGMASetUp_Private - forms the smoothed interpolations Pbar = (I - D^{-1} A) P of the mult-additive cycle, D being
+   the l1 row sums of A, a Jacobi step that needs no eigenvalue estimate. When A or P is not an AIJ matrix only D^{-1}
+   is kept and the cycle applies P followed by the Jacobi step.
+*/
+PetscErrorCode PCMGMASetUp_Private(PC pc,PC_MG_Levels **mglevels)
+{
+  PetscErrorCode    ierr;
+  PetscInt          i,j,k,l = mglevels[0]->levels,rstart,rend,ncols,M,Mf;
+  const PetscScalar *vals;
+  PetscScalar       *d;
+  PetscReal         sum;
+  PetscBool         aij,paij;
+  Mat               A,P,AP;
+
+  PetscFunctionBegin;
+  for (i=1; i<l; i++) {
+    ierr = MatDestroy(&mglevels[i]->sinterpolate);CHKERRQ(ierr);
+    ierr = VecDestroy(&mglevels[i]->dinv);CHKERRQ(ierr);
+    ierr = VecDestroy(&mglevels[i]->z);CHKERRQ(ierr);
+    ierr = KSPGetOperators(mglevels[i]->smoothu,&A,NULL);CHKERRQ(ierr);
+    ierr = MatCreateVecs(A,NULL,&mglevels[i]->dinv);CHKERRQ(ierr);
+    ierr = MatGetOwnershipRange(A,&rstart,&rend);CHKERRQ(ierr);
+    ierr = VecGetArray(mglevels[i]->dinv,&d);CHKERRQ(ierr);
+    for (j=rstart; j<rend; j++) {
+      ierr = MatGetRow(A,j,&ncols,NULL,&vals);CHKERRQ(ierr);
+      for (k=0,sum=0.0; k<ncols; k++) sum += PetscAbsScalar(vals[k]);
+      ierr = MatRestoreRow(A,j,&ncols,NULL,&vals);CHKERRQ(ierr);
+      d[j-rstart] = sum != 0.0 ? 1.0/sum : 0.0;
+    }
+    ierr = VecRestoreArray(mglevels[i]->dinv,&d);CHKERRQ(ierr);
+    ierr = PetscObjectBaseTypeCompareAny((PetscObject)A,&aij,MATSEQAIJ,MATMPIAIJ,"");CHKERRQ(ierr);
+    ierr = PetscObjectBaseTypeCompareAny((PetscObject)mglevels[i]->interpolate,&paij,MATSEQAIJ,MATMPIAIJ,"");CHKERRQ(ierr);
+    if (aij && paij) {
+      ierr = MatGetSize(mglevels[i]->interpolate,&M,NULL);CHKERRQ(ierr);
+      ierr = MatGetSize(A,&Mf,NULL);CHKERRQ(ierr);
+      if (M == Mf) {
+        P    = mglevels[i]->interpolate;
+        ierr = PetscObjectReference((PetscObject)P);CHKERRQ(ierr);
+      } else {
+        ierr = MatTranspose(mglevels[i]->interpolate,MAT_INITIAL_MATRIX,&P);CHKERRQ(ierr);
+      }
+      ierr = MatMatMult(A,P,MAT_INITIAL_MATRIX,PETSC_DEFAULT,&AP);CHKERRQ(ierr);
+      ierr = MatDiagonalScale(AP,mglevels[i]->dinv,NULL);CHKERRQ(ierr);
+      ierr = MatAYPX(AP,-1.0,P,DIFFERENT_NONZERO_PATTERN);CHKERRQ(ierr);
+      ierr = MatDestroy(&P);CHKERRQ(ierr);
+      ierr = VecDestroy(&mglevels[i]->dinv);CHKERRQ(ierr);
+      mglevels[i]->sinterpolate = AP;
+    } else {
+      ierr = VecDuplicate(mglevels[i]->dinv,&mglevels[i]->z);CHKERRQ(ierr);
+    }
+  }
+  PetscFunctionReturn(0);
+}
+
+/*
+     Mult-additive multigrid V cycle routine, the additive form of the multiplicative V cycle with smoothed
+   interpolations Pbar = (I - D^{-1} A) P, see Vassilevski and Yang, Reducing communication in algebraic multigrid
+   using additive variants, Numer. Linear Algebra Appl. 21 (2014).
+
+   The right hand side is restricted down with Pbar^T, then each level is pre and post smoothed from its own right
+   hand side without waiting for the other levels, and the corrections are added up with Pbar, one interpolation
+   per level.
+*/
+PetscErrorCode PCMGMACycle_Private(PC pc,PC_MG_Levels **mglevels)
+{
+  PetscErrorCode ierr;
+  PetscInt       i,l = mglevels[0]->levels;
+
+  PetscFunctionBegin;
+  if (l > 1 && !mglevels[1]->sinterpolate && !mglevels[1]->dinv) {
+    ierr = PCMGMASetUp_Private(pc,mglevels);CHKERRQ(ierr);
+  }
+  for (i=l-1; i>0; i--) {
+    /* b_{i-1} = Pbar^T b_i */
+    if (mglevels[i]->eventinterprestrict) {ierr = PetscLogEventBegin(mglevels[i]->eventinterprestrict,0,0,0,0);CHKERRQ(ierr);}
+    if (mglevels[i]->sinterpolate) {
+      ierr = MatRestrict(mglevels[i]->sinterpolate,mglevels[i]->b,mglevels[i-1]->b);CHKERRQ(ierr);
+    } else {
+      ierr = VecPointwiseMult(mglevels[i]->z,mglevels[i]->dinv,mglevels[i]->b);CHKERRQ(ierr);
+      ierr = MatMultTranspose(mglevels[i]->A,mglevels[i]->z,mglevels[i]->r);CHKERRQ(ierr);
+      ierr = VecAYPX(mglevels[i]->r,-1.0,mglevels[i]->b);CHKERRQ(ierr);
+      ierr = MatRestrict(mglevels[i]->interpolate,mglevels[i]->r,mglevels[i-1]->b);CHKERRQ(ierr);
+    }
+    if (mglevels[i]->eventinterprestrict) {ierr = PetscLogEventEnd(mglevels[i]->eventinterprestrict,0,0,0,0);CHKERRQ(ierr);}
+  }
+  for (i=l-1; i>=0; i--) {
+    ierr = VecSet(mglevels[i]->x,0.0);CHKERRQ(ierr);
+    if (mglevels[i]->eventsmoothsolve) {ierr = PetscLogEventBegin(mglevels[i]->eventsmoothsolve,0,0,0,0);CHKERRQ(ierr);}
+    ierr = KSPSolve(mglevels[i]->smoothd,mglevels[i]->b,mglevels[i]->x);CHKERRQ(ierr);
+    ierr = KSPCheckSolve(mglevels[i]->smoothd,pc,mglevels[i]->x);CHKERRQ(ierr);
+    if (i) {
+      ierr = KSPSolve(mglevels[i]->smoothu,mglevels[i]->b,mglevels[i]->x);CHKERRQ(ierr);
+      ierr = KSPCheckSolve(mglevels[i]->smoothu,pc,mglevels[i]->x);CHKERRQ(ierr);
+    }
+    if (mglevels[i]->eventsmoothsolve) {ierr = PetscLogEventEnd(mglevels[i]->eventsmoothsolve,0,0,0,0);CHKERRQ(ierr);}
+  }
+  for (i=1; i<l; i++) {
+    /* x_i += (I - D^{-1} A) P x_{i-1} */
+    if (mglevels[i]->eventinterprestrict) {ierr = PetscLogEventBegin(mglevels[i]->eventinterprestrict,0,0,0,0);CHKERRQ(ierr);}
+    if (mglevels[i]->sinterpolate) {
+      ierr = MatInterpolateAdd(mglevels[i]->sinterpolate,mglevels[i-1]->x,mglevels[i]->x,mglevels[i]->x);CHKERRQ(ierr);
+    } else {
+      ierr = MatInterpolate(mglevels[i]->interpolate,mglevels[i-1]->x,mglevels[i]->r);CHKERRQ(ierr);
+      ierr = MatMult(mglevels[i]->A,mglevels[i]->r,mglevels[i]->z);CHKERRQ(ierr);
+      ierr = VecPointwiseMult(mglevels[i]->z,mglevels[i]->dinv,mglevels[i]->z);CHKERRQ(ierr);
+      ierr = VecAXPBYPCZ(mglevels[i]->x,1.0,-1.0,1.0,mglevels[i]->r,mglevels[i]->z);CHKERRQ(ierr);
+    }
+    if (mglevels[i]->eventinterprestrict) {ierr = PetscLogEventEnd(mglevels[i]->eventinterprestrict,0,0,0,0);CHKERRQ(ierr);}
+  }
+  PetscFunctionReturn(0);
+}
@@ -5,7 +5,7 @@
 #include <petscsf.h>
 #include <petscbt.h>
 #include <petscds.h>
-#include <../src/mat/impls/dense/seq/dense.h> /*I "petscmat.h" I*/
+#include <petscblaslapack.h>
 
 PetscLogEvent PC_Patch_CreatePatches, PC_Patch_ComputeOp, PC_Patch_Solve, PC_Patch_Apply, PC_Patch_Prealloc;
 
@@ -1761,6 +1761,14 @@ static PetscErrorCode PCPatchCreateMatrix_Private(PC pc, PetscInt point, Mat *ma
     csize = rsize;
   }
 
+  if (!withArtificial && patch->denseInv) {
+    /* The operator is assembled into its slot of the packed storage and later inverted there */
+    ierr = MatCreateSeqDense(PETSC_COMM_SELF, rsize, csize, rsize ? patch->denseInv + patch->denseInvOffset[point] : NULL, mat);CHKERRQ(ierr);
+    ierr = PCGetOptionsPrefix(pc, &prefix);CHKERRQ(ierr);
+    ierr = MatSetOptionsPrefix(*mat, prefix);CHKERRQ(ierr);
+    ierr = MatAppendOptionsPrefix(*mat, "pc_patch_sub_");CHKERRQ(ierr);
+    PetscFunctionReturn(0);
+  }
   ierr = MatCreate(PETSC_COMM_SELF, mat);CHKERRQ(ierr);
   ierr = PCGetOptionsPrefix(pc, &prefix);CHKERRQ(ierr);
   ierr = MatSetOptionsPrefix(*mat, prefix);CHKERRQ(ierr);
@@ -2209,13 +2217,10 @@ PetscErrorCode PCPatchComputeOperator_Internal(PC pc, Vec x, Mat mat, PetscInt p
   ierr = MatAssemblyEnd(mat, MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
 
   if (!(withArtificial || isNonlinear) && patch->denseinverse) {
-    MatFactorInfo info;
-    PetscBool     flg;
+    PetscBool flg;
+    /* The inverse is formed in PCPatchSetUpDenseInverse_Private() once all patch operators are assembled */
     ierr = PetscObjectTypeCompare((PetscObject)mat, MATSEQDENSE, &flg);CHKERRQ(ierr);
     if (!flg) SETERRQ(PetscObjectComm((PetscObject)pc), PETSC_ERR_ARG_WRONGSTATE, "Invalid Mat type for dense inverse");
-    ierr = MatFactorInfoInitialize(&info);CHKERRQ(ierr);
-    ierr = MatLUFactor(mat, NULL, NULL, &info);CHKERRQ(ierr);
-    ierr = MatSeqDenseInvertFactors_Private(mat);CHKERRQ(ierr);
   }
   PetscStackPop;
   ierr = ISDestroy(&patch->cellIS);CHKERRQ(ierr);
@@ -2463,6 +2468,162 @@ PetscErrorCode PCPatch_ScatterLocal_Private(PC pc, PetscInt p, Vec x, Vec y, Ins
   PetscFunctionReturn(0);
 }
 
+/* y_k = A_k^{-1} x_k for nb consecutive patches with n dofs each, stored contiguously in column-major order */
+PETSC_STATIC_INLINE void PCPatchDenseInverseApply_Private(PetscInt nb, PetscInt n, const PetscScalar *inv, const PetscScalar *x, PetscScalar *y)
+{
+  PetscInt k, r, c;
+
+  for (k = 0; k < nb; ++k, inv += n*n, x += n, y += n) {
+    for (r = 0; r < n; ++r) y[r] = 0.0;
+    for (c = 0; c < n; ++c) {
+      const PetscScalar *col = inv + c*n;
+      const PetscScalar  xc  = x[c];
+
+      for (r = 0; r < n; ++r) y[r] += col[r]*xc;
+    }
+  }
+}
+
+/*
+  Lays out the dense patch operators in one array, grouping patches of the same size together. The patch matrices are
+  created on top of this storage, so that their inverses can be formed in place without keeping a copy of the operators.
+*/
+static PetscErrorCode PCPatchSetUpDenseLayout_Private(PC pc)
+{
+  PC_PATCH      *patch = (PC_PATCH *) pc->data;
+  PetscInt      *dims, b, k, pStart, first, invsize = 0, vecsize = 0;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscSectionGetChart(patch->gtolCounts, &pStart, NULL);CHKERRQ(ierr);
+  ierr = PetscMalloc1(patch->npatch, &dims);CHKERRQ(ierr);
+  ierr = PetscMalloc3(patch->npatch, &patch->densebatchPatches, patch->npatch, &patch->denseInvOffset, patch->npatch, &patch->denseVecOffset);CHKERRQ(ierr);
+  for (k = 0; k < patch->npatch; ++k) {
+    ierr = PetscSectionGetDof(patch->gtolCounts, k+pStart, &dims[k]);CHKERRQ(ierr);
+    patch->densebatchPatches[k] = k;
+    patch->denseInvOffset[k]    = -1;
+    patch->denseVecOffset[k]    = -1;
+  }
+  ierr = PetscSortIntWithArray(patch->npatch, dims, patch->densebatchPatches);CHKERRQ(ierr);
+  for (first = 0; first < patch->npatch && !dims[first]; ++first);
+  patch->ndensebatch = 0;
+  for (k = first; k < patch->npatch; ++k) if (k == first || dims[k] != dims[k-1]) ++patch->ndensebatch;
+  ierr = PetscMalloc2(patch->ndensebatch, &patch->densebatchDim, patch->ndensebatch+1, &patch->densebatchStart);CHKERRQ(ierr);
+  for (k = first, b = 0; k < patch->npatch; ++k) {
+    const PetscInt p = patch->densebatchPatches[k];
+
+    if (k == first || dims[k] != dims[k-1]) {
+      patch->densebatchDim[b]   = dims[k];
+      patch->densebatchStart[b] = k;
+      ++b;
+    }
+    patch->denseInvOffset[p] = invsize;
+    patch->denseVecOffset[p] = vecsize;
+    invsize += dims[k]*dims[k];
+    vecsize += dims[k];
+  }
+  patch->densebatchStart[patch->ndensebatch] = patch->npatch;
+  ierr = PetscMalloc3(invsize, &patch->denseInv, vecsize, &patch->denseRHS, vecsize, &patch->denseUpdate);CHKERRQ(ierr);
+  ierr = PetscLogObjectMemory((PetscObject) pc, (invsize+2*vecsize)*sizeof(PetscScalar));CHKERRQ(ierr);
+  ierr = PetscFree(dims);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/* Inverts the assembled patch operators in place, each one overwrites its own storage in denseInv */
+static PetscErrorCode PCPatchSetUpDenseInverse_Private(PC pc)
+{
+  PC_PATCH      *patch = (PC_PATCH *) pc->data;
+  PetscScalar   *work;
+  PetscBLASInt  *pivots, bn, lwork, info;
+  PetscInt       b, k, n, maxn;
+  PetscLogDouble flops = 0.0;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  /* Batches are sorted by increasing size */
+  maxn = patch->ndensebatch ? patch->densebatchDim[patch->ndensebatch-1] : 0;
+  ierr = PetscBLASIntCast(maxn, &lwork);CHKERRQ(ierr);
+  ierr = PetscMalloc2(maxn, &pivots, maxn, &work);CHKERRQ(ierr);
+  for (b = 0; b < patch->ndensebatch; ++b) {
+    n    = patch->densebatchDim[b];
+    ierr = PetscBLASIntCast(n, &bn);CHKERRQ(ierr);
+    for (k = patch->densebatchStart[b]; k < patch->densebatchStart[b+1]; ++k) {
+      const PetscInt p = patch->densebatchPatches[k];
+      PetscScalar   *inv;
+
+      ierr = MatDenseGetArray(patch->mat[p], &inv);CHKERRQ(ierr);
+      if (inv != patch->denseInv + patch->denseInvOffset[p]) SETERRQ1(PETSC_COMM_SELF, PETSC_ERR_PLIB, "Patch %D matrix does not use the packed storage", p);
+      ierr = PetscFPTrapPush(PETSC_FP_TRAP_OFF);CHKERRQ(ierr);
+      PetscStackCallBLAS("LAPACKgetrf", LAPACKgetrf_(&bn, &bn, inv, &bn, pivots, &info));
+      ierr = PetscFPTrapPop();CHKERRQ(ierr);
+      if (info < 0) SETERRQ(PETSC_COMM_SELF, PETSC_ERR_LIB, "Bad argument to LU factorization");
+      if (info > 0) SETERRQ1(PETSC_COMM_SELF, PETSC_ERR_MAT_LU_ZRPVT, "Bad LU factorization of patch %D", p);
+      ierr = PetscFPTrapPush(PETSC_FP_TRAP_OFF);CHKERRQ(ierr);
+      PetscStackCallBLAS("LAPACKgetri", LAPACKgetri_(&bn, inv, &bn, pivots, work, &lwork, &info));
+      ierr = PetscFPTrapPop();CHKERRQ(ierr);
+      if (info) SETERRQ1(PETSC_COMM_SELF, PETSC_ERR_LIB, "Bad inversion of patch %D", p);
+      ierr = MatDenseRestoreArray(patch->mat[p], &inv);CHKERRQ(ierr);
+      flops += (2.0*n*n*n)/3.0 + (4.0*n*n*n)/3.0;
+    }
+  }
+  ierr = PetscFree2(pivots, work);CHKERRQ(ierr);
+  ierr = PetscLogFlops(flops);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/* Applies all patch inverses at once: gather every patch right hand side, sweep over the batches, then add the updates back */
+static PetscErrorCode PCApply_PATCH_DenseBatched_Private(PC pc, PetscInt pStart, PetscInt nsweep)
+{
+  PC_PATCH          *patch = (PC_PATCH *) pc->data;
+  const PetscScalar *localRHS;
+  PetscScalar       *localUpdate;
+  const PetscInt    *gtolArray;
+  PetscInt           b, k, l, n, offset, sweep;
+  PetscLogDouble     flops = 0.0;
+  PetscErrorCode     ierr;
+
+  PetscFunctionBegin;
+  ierr = VecGetArrayRead(patch->localRHS, &localRHS);CHKERRQ(ierr);
+  ierr = ISGetIndices(patch->gtol, &gtolArray);CHKERRQ(ierr);
+  for (b = 0; b < patch->ndensebatch; ++b) {
+    n = patch->densebatchDim[b];
+    for (k = patch->densebatchStart[b]; k < patch->densebatchStart[b+1]; ++k) {
+      const PetscInt p   = patch->densebatchPatches[k];
+      PetscScalar   *rhs = patch->denseRHS + patch->denseVecOffset[p];
+
+      ierr = PetscSectionGetOffset(patch->gtolCounts, p+pStart, &offset);CHKERRQ(ierr);
+      for (l = 0; l < n; ++l) rhs[l] = localRHS[gtolArray[offset+l]];
+    }
+  }
+  ierr = VecRestoreArrayRead(patch->localRHS, &localRHS);CHKERRQ(ierr);
+  for (b = 0; b < patch->ndensebatch; ++b) {
+    const PetscInt p  = patch->densebatchPatches[patch->densebatchStart[b]];
+    const PetscInt nb = patch->densebatchStart[b+1] - patch->densebatchStart[b];
+
+    n = patch->densebatchDim[b];
+    PCPatchDenseInverseApply_Private(nb, n, patch->denseInv + patch->denseInvOffset[p], patch->denseRHS + patch->denseVecOffset[p], patch->denseUpdate + patch->denseVecOffset[p]);
+    flops += 2.0*n*n*nb;
+  }
+  ierr = PetscLogFlops(flops);CHKERRQ(ierr);
+  /* A symmetrised additive sweep visits each patch twice */
+  ierr = VecGetArray(patch->localUpdate, &localUpdate);CHKERRQ(ierr);
+  for (sweep = 0; sweep < nsweep; ++sweep) {
+    for (b = 0; b < patch->ndensebatch; ++b) {
+      n = patch->densebatchDim[b];
+      for (k = patch->densebatchStart[b]; k < patch->densebatchStart[b+1]; ++k) {
+        const PetscInt     p   = patch->densebatchPatches[k];
+        const PetscScalar *upd = patch->denseUpdate + patch->denseVecOffset[p];
+
+        ierr = PetscSectionGetOffset(patch->gtolCounts, p+pStart, &offset);CHKERRQ(ierr);
+        for (l = 0; l < n; ++l) localUpdate[gtolArray[offset+l]] += upd[l];
+      }
+    }
+  }
+  ierr = VecRestoreArray(patch->localUpdate, &localUpdate);CHKERRQ(ierr);
+  ierr = ISRestoreIndices(patch->gtol, &gtolArray);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
 static PetscErrorCode PCSetUp_PATCH_Linear(PC pc)
 {
   PC_PATCH      *patch = (PC_PATCH *) pc->data;
@@ -2500,11 +2661,11 @@ static PetscErrorCode PCSetUp_PATCH_Linear(PC pc)
       ierr = PCPatchComputeOperator_Internal(pc, NULL, patch->mat[i], i, PETSC_FALSE);CHKERRQ(ierr);
       if (!patch->denseinverse) {
         ierr = KSPSetOperators((KSP) patch->solver[i], patch->mat[i], patch->mat[i]);CHKERRQ(ierr);
-      } else if (patch->mat[i] && !patch->densesolve) {
-        /* Setup matmult callback */
-        ierr = MatGetOperation(patch->mat[i], MATOP_MULT, (void (**)(void))&patch->densesolve);CHKERRQ(ierr);
       }
     }
+    if (patch->denseinverse) {
+      ierr = PCPatchSetUpDenseInverse_Private(pc);CHKERRQ(ierr);
+    }
   }
   if(patch->local_composition_type == PC_COMPOSITE_MULTIPLICATIVE) {
     for (i = 0; i < patch->npatch; ++i) {
@@ -2730,6 +2891,7 @@ static PetscErrorCode PCSetUp_PATCH(PC pc)
     ierr = VecCreateSeq(PETSC_COMM_SELF, maxDof, &patch->patchUpdate);CHKERRQ(ierr);
     ierr = VecSetUp(patch->patchUpdate);CHKERRQ(ierr);
     if (patch->save_operators) {
+      if (patch->denseinverse && !patch->isNonlinear) {ierr = PCPatchSetUpDenseLayout_Private(pc);CHKERRQ(ierr);}
       ierr = PetscMalloc1(patch->npatch, &patch->mat);CHKERRQ(ierr);
       for (i = 0; i < patch->npatch; ++i) {
         ierr = PCPatchCreateMatrix_Private(pc, i, &patch->mat[i], PETSC_FALSE);CHKERRQ(ierr);
@@ -2796,7 +2958,16 @@ static PetscErrorCode PCApply_PATCH_Linear(PC pc, PetscInt i, Vec x, Vec y)
 
   PetscFunctionBegin;
   if (patch->denseinverse) {
-    ierr = (*patch->densesolve)(patch->mat[i], x, y);CHKERRQ(ierr);
+    const PetscScalar *xArray;
+    PetscScalar       *yArray;
+
+    ierr = MatGetSize(patch->mat[i], &m, NULL);CHKERRQ(ierr);
+    ierr = VecGetArrayRead(x, &xArray);CHKERRQ(ierr);
+    ierr = VecGetArray(y, &yArray);CHKERRQ(ierr);
+    PCPatchDenseInverseApply_Private(1, m, patch->denseInv + patch->denseInvOffset[i], xArray, yArray);
+    ierr = VecRestoreArrayRead(x, &xArray);CHKERRQ(ierr);
+    ierr = VecRestoreArray(y, &yArray);CHKERRQ(ierr);
+    ierr = PetscLogFlops(2.0*m*m);CHKERRQ(ierr);
     PetscFunctionReturn(0);
   }
   ksp = (KSP) patch->solver[i];
@@ -2911,21 +3082,25 @@ static PetscErrorCode PCApply_PATCH(PC pc, Vec x, Vec y)
   ierr = VecSet(patch->localUpdate, 0.0);CHKERRQ(ierr);
   ierr = PetscSectionGetChart(patch->gtolCounts, &pStart, NULL);CHKERRQ(ierr);
   ierr = PetscLogEventBegin(PC_Patch_Solve, pc, 0, 0, 0);CHKERRQ(ierr);
-  for (sweep = 0; sweep < nsweep; sweep++) {
-    for (j = start[sweep]; j*inc[sweep] < end[sweep]*inc[sweep]; j += inc[sweep]) {
-      PetscInt i       = patch->user_patches ? iterationSet[j] : j;
-      PetscInt start, len;
-
-      ierr = PetscSectionGetDof(patch->gtolCounts, i+pStart, &len);CHKERRQ(ierr);
-      ierr = PetscSectionGetOffset(patch->gtolCounts, i+pStart, &start);CHKERRQ(ierr);
-      /* TODO: Squash out these guys in the setup as well. */
-      if (len <= 0) continue;
-      /* TODO: Do we need different scatters for X and Y? */
-      ierr = PCPatch_ScatterLocal_Private(pc, i+pStart, patch->localRHS, patch->patchRHS, INSERT_VALUES, SCATTER_FORWARD, SCATTER_INTERIOR);CHKERRQ(ierr);
-      ierr = (*patch->applysolver)(pc, i, patch->patchRHS, patch->patchUpdate);CHKERRQ(ierr);
-      ierr = PCPatch_ScatterLocal_Private(pc, i+pStart, patch->patchUpdate, patch->localUpdate, ADD_VALUES, SCATTER_REVERSE, SCATTER_INTERIOR);CHKERRQ(ierr);
-      if(patch->local_composition_type == PC_COMPOSITE_MULTIPLICATIVE) {
-        ierr = (*patch->updatemultiplicative)(pc, i, pStart);CHKERRQ(ierr);
+  if (patch->denseinverse && patch->local_composition_type == PC_COMPOSITE_ADDITIVE && !patch->user_patches) {
+    ierr = PCApply_PATCH_DenseBatched_Private(pc, pStart, nsweep);CHKERRQ(ierr);
+  } else {
+    for (sweep = 0; sweep < nsweep; sweep++) {
+      for (j = start[sweep]; j*inc[sweep] < end[sweep]*inc[sweep]; j += inc[sweep]) {
+        PetscInt i       = patch->user_patches ? iterationSet[j] : j;
+        PetscInt start, len;
+
+        ierr = PetscSectionGetDof(patch->gtolCounts, i+pStart, &len);CHKERRQ(ierr);
+        ierr = PetscSectionGetOffset(patch->gtolCounts, i+pStart, &start);CHKERRQ(ierr);
+        /* TODO: Squash out these guys in the setup as well. */
+        if (len <= 0) continue;
+        /* TODO: Do we need different scatters for X and Y? */
+        ierr = PCPatch_ScatterLocal_Private(pc, i+pStart, patch->localRHS, patch->patchRHS, INSERT_VALUES, SCATTER_FORWARD, SCATTER_INTERIOR);CHKERRQ(ierr);
+        ierr = (*patch->applysolver)(pc, i, patch->patchRHS, patch->patchUpdate);CHKERRQ(ierr);
+        ierr = PCPatch_ScatterLocal_Private(pc, i+pStart, patch->patchUpdate, patch->localUpdate, ADD_VALUES, SCATTER_REVERSE, SCATTER_INTERIOR);CHKERRQ(ierr);
+        if(patch->local_composition_type == PC_COMPOSITE_MULTIPLICATIVE) {
+          ierr = (*patch->updatemultiplicative)(pc, i, pStart);CHKERRQ(ierr);
+        }
       }
     }
   }
@@ -2972,6 +3147,10 @@ static PetscErrorCode PCReset_PATCH_Linear(PC pc)
   if (patch->solver) {
     for (i = 0; i < patch->npatch; ++i) {ierr = KSPReset((KSP) patch->solver[i]);CHKERRQ(ierr);}
   }
+  ierr = PetscFree3(patch->densebatchPatches, patch->denseInvOffset, patch->denseVecOffset);CHKERRQ(ierr);
+  ierr = PetscFree2(patch->densebatchDim, patch->densebatchStart);CHKERRQ(ierr);
+  ierr = PetscFree3(patch->denseInv, patch->denseRHS, patch->denseUpdate);CHKERRQ(ierr);
+  patch->ndensebatch = 0;
   PetscFunctionReturn(0);
 }
 
@@ -3254,7 +3433,8 @@ static PetscErrorCode PCView_PATCH(PC pc, PetscViewer viewer)
   else                                                        {ierr = PetscViewerASCIIPrintf(viewer, "Patch construction operator: unknown\n");CHKERRQ(ierr);}
 
   if (patch->denseinverse) {
-    ierr = PetscViewerASCIIPrintf(viewer, "Explicitly forming dense inverse and applying patch solver via MatMult.\n");CHKERRQ(ierr);
+    ierr = PetscViewerASCIIPrintf(viewer, "Explicitly forming dense inverses in place and applying them directly (no KSP on patches)\n");CHKERRQ(ierr);
+    if (patch->densebatchStart) {ierr = PetscViewerASCIIPrintf(viewer, "Patch inverses stored in %D batches of equal size\n", patch->ndensebatch);CHKERRQ(ierr);}
   } else {
     if (patch->isNonlinear) {
       ierr = PetscViewerASCIIPrintf(viewer, "SNES on patches (all same):\n");CHKERRQ(ierr);
@@ -3289,7 +3469,13 @@ static PetscErrorCode PCView_PATCH(PC pc, PetscViewer viewer)
 . -pc_patch_points_view  - Views the process local mesh point numbers for each patch
 . -pc_patch_g2l_view     - Views the map between global dofs and patch local dofs for each patch
 . -pc_patch_patches_view - Views the global dofs associated with each patch and its boundary
-- -pc_patch_sub_mat_view - Views the matrix associated with each patch
+. -pc_patch_sub_mat_view - Views the matrix associated with each patch
+- -pc_patch_dense_inverse - Explicitly inverts the patch matrices (requires -pc_patch_sub_mat_type seqdense) instead of using a KSP on each patch
+
+  Notes:
+  With -pc_patch_dense_inverse the patch inverses are packed in a single array with patches of the same size stored
+  contiguously, and the additive preconditioner gathers all patch right hand sides, applies the inverses batch by batch
+  and adds the updates back in one sweep.
 
   Level: intermediate
 
@@ -3335,7 +3521,6 @@ PETSC_EXTERN PetscErrorCode PCCreate_Patch(PC pc)
   patch->viewPoints         = PETSC_FALSE;
   patch->viewSection        = PETSC_FALSE;
   patch->viewMatrix         = PETSC_FALSE;
-  patch->densesolve         = NULL;
   patch->setupsolver        = PCSetUp_PATCH_Linear;
   patch->applysolver        = PCApply_PATCH_Linear;
   patch->resetsolver        = PCReset_PATCH_Linear;
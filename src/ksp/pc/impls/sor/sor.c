@@ -32,6 +32,34 @@ static PetscErrorCode PCApply_SOR(PC pc,Vec x,Vec y)
   PetscFunctionReturn(0);
 }
 
+/* all the columns are swept together by the SeqAIJ kernel, for MPIAIJ when a single local sweep does not need the off-process values */
+static PetscErrorCode PCMatApply_SOR(PC pc,Mat X,Mat Y)
+{
+  PC_SOR         *jac = (PC_SOR*)pc->data;
+  PetscErrorCode ierr,(*f)(Mat,Mat,PetscReal,MatSORType,PetscReal,PetscInt,PetscInt,Mat) = NULL;
+  PetscInt       flag = jac->sym | SOR_ZERO_INITIAL_GUESS;
+  Mat            A = pc->pmat,Xl = X,Yl = Y;
+  PetscBool      mpi;
+
+  PetscFunctionBegin;
+  ierr = PetscObjectBaseTypeCompare((PetscObject)pc->pmat,MATMPIAIJ,&mpi);CHKERRQ(ierr);
+  if (mpi) {
+    if (jac->its == 1 && !(flag & (SOR_FORWARD_SWEEP | SOR_BACKWARD_SWEEP))) {
+      ierr = MatMPIAIJGetSeqAIJ(pc->pmat,&A,NULL,NULL);CHKERRQ(ierr);
+      ierr = MatDenseGetLocalMatrix(X,&Xl);CHKERRQ(ierr);
+      ierr = MatDenseGetLocalMatrix(Y,&Yl);CHKERRQ(ierr);
+    } else A = NULL;
+  }
+  if (A) {ierr = PetscObjectQueryFunction((PetscObject)A,"MatSORDense_C",&f);CHKERRQ(ierr);}
+  if (f && !(flag & (SOR_EISENSTAT | SOR_APPLY_UPPER | SOR_APPLY_LOWER))) {
+    ierr = (*f)(A,Xl,jac->omega,(MatSORType)flag,jac->fshift,jac->its,jac->lits,Yl);CHKERRQ(ierr);
+    ierr = MatFactorGetError(A,(MatFactorError*)&pc->failedreason);CHKERRQ(ierr);
+  } else {
+    ierr = PCMatApplyColumns_Private(pc,X,Y);CHKERRQ(ierr);
+  }
+  PetscFunctionReturn(0);
+}
+
 static PetscErrorCode PCApplyTranspose_SOR(PC pc,Vec x,Vec y)
 {
   PC_SOR         *jac = (PC_SOR*)pc->data;
@@ -448,6 +476,7 @@ PETSC_EXTERN PetscErrorCode PCCreate_SOR(PC pc)
   ierr = PetscNewLog(pc,&jac);CHKERRQ(ierr);
 
   pc->ops->apply           = PCApply_SOR;
+  pc->ops->matapply        = PCMatApply_SOR;
   pc->ops->applytranspose  = PCApplyTranspose_SOR;
   pc->ops->applyrichardson = PCApplyRichardson_SOR;
   pc->ops->setfromoptions  = PCSetFromOptions_SOR;
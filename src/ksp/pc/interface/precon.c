@@ -7,7 +7,7 @@
 
 /* Logging support */
 PetscClassId  PC_CLASSID;
-PetscLogEvent PC_SetUp, PC_SetUpOnBlocks, PC_Apply, PC_ApplyCoarse, PC_ApplyMultiple, PC_ApplySymmetricLeft;
+PetscLogEvent PC_SetUp, PC_SetUpOnBlocks, PC_Apply, PC_MatApply, PC_ApplyCoarse, PC_ApplyMultiple, PC_ApplySymmetricLeft;
 PetscLogEvent PC_ApplySymmetricRight, PC_ModifySubMatrices, PC_ApplyOnBlocks, PC_ApplyTransposeOnBlocks;
 PetscInt      PetscMGLevelId;
 
@@ -448,6 +448,103 @@ PetscErrorCode  PCApply(PC pc,Vec x,Vec y)
   PetscFunctionReturn(0);
 }
 
+/*
+   PCMatApplyColumns_Private - PCMatApply() for preconditioners, or configurations of them, without a block implementation:
+   applies PCApply() to each column of X in turn
+*/
+PetscErrorCode PCMatApplyColumns_Private(PC pc,Mat X,Mat Y)
+{
+  PetscErrorCode    ierr;
+  PetscInt          m,n,N,i,ldx,ldy;
+  const PetscScalar *x;
+  PetscScalar       *y;
+  Vec               cx,cy;
+
+  PetscFunctionBegin;
+  ierr = MatGetLocalSize(pc->pmat,&m,&n);CHKERRQ(ierr);
+  ierr = MatGetSize(X,NULL,&N);CHKERRQ(ierr);
+  ierr = MatDenseGetLDA(X,&ldx);CHKERRQ(ierr);
+  ierr = MatDenseGetLDA(Y,&ldy);CHKERRQ(ierr);
+  ierr = VecCreateMPIWithArray(PetscObjectComm((PetscObject)pc),1,n,PETSC_DECIDE,NULL,&cx);CHKERRQ(ierr);
+  ierr = VecCreateMPIWithArray(PetscObjectComm((PetscObject)pc),1,m,PETSC_DECIDE,NULL,&cy);CHKERRQ(ierr);
+  ierr = MatDenseGetArrayRead(X,&x);CHKERRQ(ierr);
+  ierr = MatDenseGetArray(Y,&y);CHKERRQ(ierr);
+  for (i=0; i<N; i++) {
+    ierr = VecPlaceArray(cx,x+i*ldx);CHKERRQ(ierr);
+    ierr = VecPlaceArray(cy,y+i*ldy);CHKERRQ(ierr);
+    ierr = VecLockReadPush(cx);CHKERRQ(ierr);
+    ierr = (*pc->ops->apply)(pc,cx,cy);CHKERRQ(ierr);
+    ierr = VecLockReadPop(cx);CHKERRQ(ierr);
+    ierr = VecResetArray(cx);CHKERRQ(ierr);
+    ierr = VecResetArray(cy);CHKERRQ(ierr);
+  }
+  ierr = MatDenseRestoreArray(Y,&y);CHKERRQ(ierr);
+  ierr = MatDenseRestoreArrayRead(X,&x);CHKERRQ(ierr);
+  ierr = VecDestroy(&cx);CHKERRQ(ierr);
+  ierr = VecDestroy(&cy);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/*@
+   PCMatApply - Applies the preconditioner to several vectors at once, stored as the columns of a dense matrix.
+
+   Collective on PC
+
+   Input Parameters:
++  pc - the preconditioner context
+-  X - dense matrix whose columns are the input vectors
+
+   Output Parameter:
+.  Y - dense matrix whose columns are the output vectors, it must be different from X
+
+   Notes:
+   PCJACOBI, PCBJACOBI with a single block, PCSOR, PCMG and the factorization preconditioners treat all the columns together.
+   PCMG does so for the multiplicative cycle with AIJ operators, and its smoothers still apply one column at a time when
+   their KSP has no KSPMatSolve() implementation, for example the default KSPCHEBYSHEV.
+   Preconditioners that have no block implementation apply PCApply() to each column in turn.
+
+   Level: developer
+
+.seealso: PCApply(), KSPMatSolve()
+@*/
+PetscErrorCode PCMatApply(PC pc,Mat X,Mat Y)
+{
+  PetscErrorCode ierr;
+  PetscInt       m,n,mx,my,N,Ny;
+  PetscBool      match;
+
+  PetscFunctionBegin;
+  PetscValidHeaderSpecific(pc,PC_CLASSID,1);
+  PetscValidHeaderSpecific(X,MAT_CLASSID,2);
+  PetscValidHeaderSpecific(Y,MAT_CLASSID,3);
+  PetscCheckSameComm(pc,1,X,2);
+  PetscCheckSameComm(pc,1,Y,3);
+  if (X == Y) SETERRQ(PetscObjectComm((PetscObject)pc),PETSC_ERR_ARG_IDN,"X and Y must be different matrices");
+  ierr = PetscObjectTypeCompareAny((PetscObject)X,&match,MATSEQDENSE,MATMPIDENSE,"");CHKERRQ(ierr);
+  if (!match) SETERRQ(PetscObjectComm((PetscObject)pc),PETSC_ERR_ARG_WRONG,"X must be of type MATDENSE");
+  ierr = PetscObjectTypeCompareAny((PetscObject)Y,&match,MATSEQDENSE,MATMPIDENSE,"");CHKERRQ(ierr);
+  if (!match) SETERRQ(PetscObjectComm((PetscObject)pc),PETSC_ERR_ARG_WRONG,"Y must be of type MATDENSE");
+  ierr = MatGetLocalSize(pc->pmat,&m,&n);CHKERRQ(ierr);
+  ierr = MatGetLocalSize(X,&mx,NULL);CHKERRQ(ierr);
+  ierr = MatGetLocalSize(Y,&my,NULL);CHKERRQ(ierr);
+  ierr = MatGetSize(X,NULL,&N);CHKERRQ(ierr);
+  ierr = MatGetSize(Y,NULL,&Ny);CHKERRQ(ierr);
+  if (my != m) SETERRQ2(PETSC_COMM_SELF,PETSC_ERR_ARG_SIZ,"Preconditioner number of local rows %D does not equal the number of local rows of Y %D",m,my);
+  if (mx != n) SETERRQ2(PETSC_COMM_SELF,PETSC_ERR_ARG_SIZ,"Preconditioner number of local columns %D does not equal the number of local rows of X %D",n,mx);
+  if (N != Ny) SETERRQ2(PetscObjectComm((PetscObject)pc),PETSC_ERR_ARG_SIZ,"X has %D columns while Y has %D columns",N,Ny);
+
+  ierr = PCSetUp(pc);CHKERRQ(ierr);
+  if (!pc->ops->apply) SETERRQ(PetscObjectComm((PetscObject)pc),PETSC_ERR_SUP,"PC does not have apply");
+  ierr = PetscLogEventBegin(PC_MatApply,pc,X,Y,0);CHKERRQ(ierr);
+  if (pc->ops->matapply) {
+    ierr = (*pc->ops->matapply)(pc,X,Y);CHKERRQ(ierr);
+  } else {
+    ierr = PCMatApplyColumns_Private(pc,X,Y);CHKERRQ(ierr);
+  }
+  ierr = PetscLogEventEnd(PC_MatApply,pc,X,Y,0);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
 /*@
    PCApplySymmetricLeft - Applies the left part of a symmetric preconditioner to a vector.
 
@@ -1019,6 +1116,52 @@ PetscErrorCode  PCModifySubMatrices(PC pc,PetscInt nsub,const IS row[],const IS
   PetscFunctionReturn(0);
 }
 
+/*
+   PCSetSubOperators_Private - Sets the operators of a block solver of PCASM or PCBJACOBI after the blocks were extracted
+   again because the nonzero pattern of the outer preconditioner matrix changed.
+
+   If oldpmat, the previous block preconditioner matrix, has the same type and exactly the same nonzero structure as the
+   new one, the block PC is told that only the values changed; it then keeps its ordering and symbolic factorization and
+   only redoes the numeric factorization. A change in the pattern of the outer matrix often leaves most blocks unchanged,
+   for example when it occurs on another process. The row offsets are compared first and the column indices only if
+   those agree, so a changed block is usually detected after reading its row lengths.
+*/
+PetscErrorCode PCSetSubOperators_Private(KSP ksp,Mat amat,Mat pmat,Mat oldpmat,PetscBool *reused)
+{
+  PetscErrorCode  ierr;
+  PC              pc;
+  PetscBool       same = PETSC_FALSE,doneold,donenew;
+  PetscInt        m,n,mold,nold,bs,bsold,nrow,nrowold;
+  const PetscInt  *ia,*ja,*iaold,*jaold;
+
+  PetscFunctionBegin;
+  if (oldpmat && oldpmat != pmat) {
+    ierr = PetscObjectTypeCompare((PetscObject)pmat,((PetscObject)oldpmat)->type_name,&same);CHKERRQ(ierr);
+    ierr = MatGetSize(pmat,&m,&n);CHKERRQ(ierr);
+    ierr = MatGetSize(oldpmat,&mold,&nold);CHKERRQ(ierr);
+    ierr = MatGetBlockSize(pmat,&bs);CHKERRQ(ierr);
+    ierr = MatGetBlockSize(oldpmat,&bsold);CHKERRQ(ierr);
+    if (same && m == mold && n == nold && bs == bsold) {
+      ierr = MatGetRowIJ(pmat,0,PETSC_FALSE,PETSC_FALSE,&nrow,&ia,&ja,&donenew);CHKERRQ(ierr);
+      ierr = MatGetRowIJ(oldpmat,0,PETSC_FALSE,PETSC_FALSE,&nrowold,&iaold,&jaold,&doneold);CHKERRQ(ierr);
+      same = (PetscBool)(donenew && doneold && nrow == nrowold);
+      if (same) {ierr = PetscArraycmp(ia,iaold,nrow+1,&same);CHKERRQ(ierr);}
+      if (same) {ierr = PetscArraycmp(ja,jaold,ia[nrow],&same);CHKERRQ(ierr);}
+      if (donenew) {ierr = MatRestoreRowIJ(pmat,0,PETSC_FALSE,PETSC_FALSE,&nrow,&ia,&ja,&donenew);CHKERRQ(ierr);}
+      if (doneold) {ierr = MatRestoreRowIJ(oldpmat,0,PETSC_FALSE,PETSC_FALSE,&nrowold,&iaold,&jaold,&doneold);CHKERRQ(ierr);}
+    } else same = PETSC_FALSE;
+  }
+  ierr = KSPSetOperators(ksp,amat,pmat);CHKERRQ(ierr);
+  if (same) {
+    /* PCSetOperators() cleared the states because the matrix object changed; the next PCSetUp() then sees SAME_NONZERO_PATTERN */
+    ierr = KSPGetPC(ksp,&pc);CHKERRQ(ierr);
+    if (pc->setupcalled) {ierr = MatGetNonzeroState(pmat,&pc->matnonzerostate);CHKERRQ(ierr);}
+    else same = PETSC_FALSE;
+  }
+  if (reused) *reused = same;
+  PetscFunctionReturn(0);
+}
+
 /*@
    PCSetOperators - Sets the matrix associated with the linear system and
    a (possibly) different one associated with the preconditioner.
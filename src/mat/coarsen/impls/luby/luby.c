@@ -0,0 +1,369 @@
+#include <petsc/private/matimpl.h>    /*I "petscmat.h" I*/
+#include <../src/mat/impls/aij/seq/aij.h>
+#include <../src/mat/impls/aij/mpi/mpiaij.h>
+#include <petscsf.h>
+
+#define LUBY_NOT_DONE -2
+#define LUBY_DELETED  -1
+#define LUBY_REMOVED  -3
+#define LUBY_IS_SELECTED(s) ((s) >= 0)
+
+/* vertex a, of priority pa and global index ga, beats vertex b */
+#define LUBY_BEATS(pa,ga,pb,gb) ((pa) > (pb) || ((pa) == (pb) && (ga) > (gb)))
+
+typedef struct {
+  PetscInt seed;
+  PetscInt nthreads;
+} MatCoarsen_Luby;
+
+/*
+   The priority of a vertex is a hash of its global index, so the independent set only depends on the seed, not on the
+   number of processes, the number of threads or the order in which the vertices are visited.
+*/
+PETSC_STATIC_INLINE unsigned long long LubyPriority(PetscInt gid,PetscInt seed)
+{
+  unsigned long long z = (unsigned long long)gid + 0x9E3779B97F4A7C15ULL*((unsigned long long)seed + 1);
+
+  z = (z ^ (z >> 30))*0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27))*0x94D049BB133111EBULL;
+  return z ^ (z >> 31);
+}
+
+/* -------------------------------------------------------------------------- */
+/*
+   lubyIndSetAgg - parallel maximal independent set (MIS) of Luby type, with the aggregates of the selected vertices. MatAIJ specific!!!
+
+   Each round selects the undecided vertices whose priority beats the one of all their undecided neighbors, then attaches the undecided
+   neighbors of the selected vertices to the one of highest priority. Both sweeps only read the states of the previous sweep, so they
+   are split over OpenMP threads, and the result is the same for any number of threads.
+
+   As in MATCOARSENMIS, without strict_aggs the list of a selected vertex also holds every ghost neighbor that was still undecided
+   when it was selected, whichever aggregate that ghost joined, so these lists may overlap across processes.
+
+   Input Parameter:
+   . Gmat - global matrix of graph (data not defined)
+   . strict_aggs - flag for whether to keep strict (non overlapping) aggregates in 'llist';
+
+   Output Parameter:
+   . a_locals_llist - array of list of nodes rooted at selected nodes
+*/
+static PetscErrorCode lubyIndSetAgg(MatCoarsen_Luby *luby,Mat Gmat,PetscBool strict_aggs,PetscCoarsenData **a_locals_llist)
+{
+  PetscErrorCode     ierr;
+  Mat_SeqAIJ         *matA,*matB=NULL;
+  Mat_MPIAIJ         *mpimat=NULL;
+  MPI_Comm           comm;
+  PetscInt           num_fine_ghosts,kk,ix,iter,Iend,my0,gid,cpid,pgid,nremoved=0,nselected=0,t1,t2,j,n;
+  PetscInt           *cpcol_gid=NULL,*cpcol_state=NULL,*cpcol_parent=NULL,*cpcol_round=NULL,*lid_cprowID,*lid_gid,*lid_state,*lid_next,*lid_parent,*lid_parent_cpid,*lid_round,*swap;
+  const PetscInt     *idx;
+  unsigned long long *lid_prio,*cpcol_prio=NULL;
+  PetscBool          isMPI,isAIJ;
+  const PetscInt     nloc = Gmat->rmap->n;
+  PetscCoarsenData   *agg_lists;
+  PetscLayout        layout;
+  PetscSF            sf = NULL;
+
+  PetscFunctionBegin;
+  ierr = PetscObjectGetComm((PetscObject)Gmat,&comm);CHKERRQ(ierr);
+
+  /* get submatrices */
+  ierr = PetscObjectBaseTypeCompare((PetscObject)Gmat,MATMPIAIJ,&isMPI);CHKERRQ(ierr);
+  if (isMPI) {
+    mpimat = (Mat_MPIAIJ*)Gmat->data;
+    matA   = (Mat_SeqAIJ*)mpimat->A->data;
+    matB   = (Mat_SeqAIJ*)mpimat->B->data;
+    /* force compressed storage of B */
+    ierr   = MatCheckCompressedRow(mpimat->B,matB->nonzerorowcnt,&matB->compressedrow,matB->i,Gmat->rmap->n,-1.0);CHKERRQ(ierr);
+  } else {
+    ierr = PetscObjectBaseTypeCompare((PetscObject)Gmat,MATSEQAIJ,&isAIJ);CHKERRQ(ierr);
+    if (!isAIJ) SETERRQ(PETSC_COMM_SELF,PETSC_ERR_USER,"Require AIJ matrix.");
+    matA = (Mat_SeqAIJ*)Gmat->data;
+  }
+  ierr = MatGetOwnershipRange(Gmat,&my0,&Iend);CHKERRQ(ierr);
+  ierr = PetscMalloc7(nloc,&lid_gid,nloc,&lid_cprowID,nloc,&lid_state,nloc,&lid_next,nloc,&lid_parent,nloc,&lid_parent_cpid,nloc,&lid_prio);CHKERRQ(ierr);
+  ierr = PetscMalloc1(nloc,&lid_round);CHKERRQ(ierr);
+  for (kk=0; kk<nloc; kk++) {
+    lid_gid[kk]     = my0+kk;
+    lid_cprowID[kk] = -1;
+  }
+  if (mpimat) {
+    ierr = VecGetLocalSize(mpimat->lvec,&num_fine_ghosts);CHKERRQ(ierr);
+    ierr = PetscMalloc5(num_fine_ghosts,&cpcol_gid,num_fine_ghosts,&cpcol_state,num_fine_ghosts,&cpcol_parent,num_fine_ghosts,&cpcol_round,num_fine_ghosts,&cpcol_prio);CHKERRQ(ierr);
+    ierr = PetscSFCreate(comm,&sf);CHKERRQ(ierr);
+    ierr = MatGetLayouts(Gmat,&layout,NULL);CHKERRQ(ierr);
+    ierr = PetscSFSetGraphLayout(sf,layout,num_fine_ghosts,NULL,PETSC_COPY_VALUES,mpimat->garray);CHKERRQ(ierr);
+    ierr = PetscSFBcastBegin(sf,MPIU_INT,lid_gid,cpcol_gid);CHKERRQ(ierr);
+    ierr = PetscSFBcastEnd(sf,MPIU_INT,lid_gid,cpcol_gid);CHKERRQ(ierr);
+    for (cpid=0; cpid<num_fine_ghosts; cpid++) {
+      cpcol_prio[cpid]  = LubyPriority(cpcol_gid[cpid],luby->seed);
+      cpcol_round[cpid] = 0;
+    }
+    for (ix=0; ix<matB->compressedrow.nrows; ix++) lid_cprowID[matB->compressedrow.rindex[ix]] = ix;
+  } else num_fine_ghosts = 0;
+
+  /* priorities, and removal of the singletons: one local adj (me) and no ghost */
+#if defined(PETSC_HAVE_OPENMP)
+#pragma omp parallel for num_threads((int)luby->nthreads) schedule(static) reduction(+:nremoved) if(luby->nthreads > 1)
+#endif
+  for (kk=0; kk<nloc; kk++) {
+    PetscInt ix = lid_cprowID[kk];
+
+    lid_prio[kk]        = LubyPriority(my0+kk,luby->seed);
+    lid_parent[kk]      = -1;
+    lid_parent_cpid[kk] = -1;
+    lid_round[kk]       = 0;
+    if (matA->i[kk+1] - matA->i[kk] < 2 && (ix == -1 || !(matB->compressedrow.i[ix+1] - matB->compressedrow.i[ix]))) {
+      lid_state[kk] = LUBY_REMOVED;
+      nremoved++;
+    } else lid_state[kk] = LUBY_NOT_DONE;
+  }
+  if (sf) {
+    ierr = PetscSFBcastBegin(sf,MPIU_INT,lid_state,cpcol_state);CHKERRQ(ierr);
+    ierr = PetscSFBcastEnd(sf,MPIU_INT,lid_state,cpcol_state);CHKERRQ(ierr);
+  }
+
+  for (iter=1; ; iter++) {
+    /* select the undecided vertices that beat all their undecided neighbors */
+#if defined(PETSC_HAVE_OPENMP)
+#pragma omp parallel for num_threads((int)luby->nthreads) schedule(static) if(luby->nthreads > 1)
+#endif
+    for (kk=0; kk<nloc; kk++) {
+      const unsigned long long prio = lid_prio[kk];
+      const PetscInt           gid  = my0+kk,*idx;
+      PetscInt                 j,n,ix,lidj,cpid;
+      PetscBool                isOK = PETSC_TRUE;
+
+      lid_next[kk] = lid_state[kk];
+      if (lid_state[kk] != LUBY_NOT_DONE) continue;
+      n   = matA->i[kk+1] - matA->i[kk];
+      idx = matA->j + matA->i[kk];
+      for (j=0; j<n && isOK; j++) {
+        lidj = idx[j];
+        if (lidj != kk && lid_state[lidj] == LUBY_NOT_DONE && !LUBY_BEATS(prio,gid,lid_prio[lidj],my0+lidj)) isOK = PETSC_FALSE;
+      }
+      if ((ix=lid_cprowID[kk]) != -1) {
+        n   = matB->compressedrow.i[ix+1] - matB->compressedrow.i[ix];
+        idx = matB->j + matB->compressedrow.i[ix];
+        for (j=0; j<n && isOK; j++) {
+          cpid = idx[j];
+          if (cpcol_state[cpid] == LUBY_NOT_DONE && !LUBY_BEATS(prio,gid,cpcol_prio[cpid],cpcol_gid[cpid])) isOK = PETSC_FALSE;
+        }
+      }
+      if (isOK) {
+        lid_next[kk]   = gid; /* SELECTED state encoded with global index */
+        lid_parent[kk] = gid;
+        lid_round[kk]  = iter;
+      }
+    }
+    swap = lid_state; lid_state = lid_next; lid_next = swap;
+    if (sf) {
+      /* ghosts undecided until now are undecided at the selection of this round */
+      for (cpid=0; cpid<num_fine_ghosts; cpid++) if (cpcol_state[cpid] == LUBY_NOT_DONE) cpcol_round[cpid] = iter;
+      ierr = PetscSFBcastBegin(sf,MPIU_INT,lid_state,cpcol_state);CHKERRQ(ierr);
+      ierr = PetscSFBcastEnd(sf,MPIU_INT,lid_state,cpcol_state);CHKERRQ(ierr);
+    }
+
+    /* the undecided neighbors of the selected vertices join the aggregate of the selected neighbor of highest priority */
+    t1 = 0;
+#if defined(PETSC_HAVE_OPENMP)
+#pragma omp parallel for num_threads((int)luby->nthreads) schedule(static) reduction(+:t1) if(luby->nthreads > 1)
+#endif
+    for (kk=0; kk<nloc; kk++) {
+      unsigned long long bprio = 0;
+      const PetscInt     *idx;
+      PetscInt           j,n,ix,lidj,cpid,bgid = -1,bcpid = -1;
+
+      lid_next[kk] = lid_state[kk];
+      if (lid_state[kk] != LUBY_NOT_DONE) continue;
+      n   = matA->i[kk+1] - matA->i[kk];
+      idx = matA->j + matA->i[kk];
+      for (j=0; j<n; j++) {
+        lidj = idx[j];
+        if (LUBY_IS_SELECTED(lid_state[lidj]) && (bgid == -1 || LUBY_BEATS(lid_prio[lidj],my0+lidj,bprio,bgid))) {
+          bprio = lid_prio[lidj];
+          bgid  = my0+lidj;
+          bcpid = -1;
+        }
+      }
+      if ((ix=lid_cprowID[kk]) != -1) {
+        n   = matB->compressedrow.i[ix+1] - matB->compressedrow.i[ix];
+        idx = matB->j + matB->compressedrow.i[ix];
+        for (j=0; j<n; j++) {
+          cpid = idx[j];
+          if (LUBY_IS_SELECTED(cpcol_state[cpid]) && (bgid == -1 || LUBY_BEATS(cpcol_prio[cpid],cpcol_gid[cpid],bprio,bgid))) {
+            bprio = cpcol_prio[cpid];
+            bgid  = cpcol_gid[cpid];
+            bcpid = cpid;
+          }
+        }
+      }
+      if (bgid != -1) {
+        lid_next[kk]        = LUBY_DELETED;
+        lid_parent[kk]      = bgid;
+        lid_parent_cpid[kk] = bcpid;
+      } else t1++;
+    }
+    swap = lid_state; lid_state = lid_next; lid_next = swap;
+    if (!sf) {
+      if (!t1) break;
+      continue;
+    }
+    ierr = PetscSFBcastBegin(sf,MPIU_INT,lid_state,cpcol_state);CHKERRQ(ierr);
+    ierr = PetscSFBcastEnd(sf,MPIU_INT,lid_state,cpcol_state);CHKERRQ(ierr);
+    ierr = MPIU_Allreduce(&t1,&t2,1,MPIU_INT,MPI_SUM,comm);CHKERRQ(ierr);
+    if (!t2) break;
+  }
+
+  /* the selected vertices head their lists, followed by the local vertices they took and then by their ghosts */
+  ierr = PetscCDCreate(strict_aggs ? nloc : num_fine_ghosts+nloc,&agg_lists);CHKERRQ(ierr);
+  if (a_locals_llist) *a_locals_llist = agg_lists;
+  for (kk=0; kk<nloc; kk++) {
+    if (LUBY_IS_SELECTED(lid_state[kk])) {
+      nselected++;
+      ierr = PetscCDAppendID(agg_lists,kk,strict_aggs ? my0+kk : kk);CHKERRQ(ierr);
+    }
+  }
+  for (kk=0; kk<nloc; kk++) {
+    if (lid_state[kk] != LUBY_DELETED) continue;
+    pgid = lid_parent[kk];
+    if (pgid >= my0 && pgid < Iend) {
+      ierr = PetscCDAppendID(agg_lists,pgid-my0,strict_aggs ? my0+kk : kk);CHKERRQ(ierr);
+    } else if (!strict_aggs) {
+      ierr = PetscCDAppendID(agg_lists,nloc+lid_parent_cpid[kk],kk);CHKERRQ(ierr);
+    }
+  }
+  if (sf && strict_aggs) {
+    /* tell the owners of the selected vertices which of their ghosts they took */
+    ierr = PetscSFBcastBegin(sf,MPIU_INT,lid_parent,cpcol_parent);CHKERRQ(ierr);
+    ierr = PetscSFBcastEnd(sf,MPIU_INT,lid_parent,cpcol_parent);CHKERRQ(ierr);
+    for (cpid=0; cpid<num_fine_ghosts; cpid++) {
+      pgid = cpcol_parent[cpid];
+      gid  = cpcol_gid[cpid];
+      if (cpcol_state[cpid] == LUBY_DELETED && pgid >= my0 && pgid < Iend) {
+        ierr = PetscCDAppendID(agg_lists,pgid-my0,gid);CHKERRQ(ierr);
+      }
+    }
+  } else if (sf) {
+    /* like MATCOARSENMIS, keep all the ghost neighbors that were undecided when the vertex was selected */
+    for (kk=0; kk<nloc; kk++) {
+      if (!LUBY_IS_SELECTED(lid_state[kk]) || (ix=lid_cprowID[kk]) == -1) continue;
+      n   = matB->compressedrow.i[ix+1] - matB->compressedrow.i[ix];
+      idx = matB->j + matB->compressedrow.i[ix];
+      for (j=0; j<n; j++) {
+        cpid = idx[j];
+        if (cpcol_round[cpid] >= lid_round[kk]) {ierr = PetscCDAppendID(agg_lists,kk,nloc+cpid);CHKERRQ(ierr);}
+      }
+    }
+  }
+  if (sf) {
+    ierr = PetscSFDestroy(&sf);CHKERRQ(ierr);
+    ierr = PetscFree5(cpcol_gid,cpcol_state,cpcol_parent,cpcol_round,cpcol_prio);CHKERRQ(ierr);
+  }
+  ierr = PetscInfo4(Gmat,"\t removed %D of %D vertices.  %D selected in %D rounds.\n",nremoved,nloc,nselected,iter);CHKERRQ(ierr);
+  ierr = PetscFree7(lid_gid,lid_cprowID,lid_state,lid_next,lid_parent,lid_parent_cpid,lid_prio);CHKERRQ(ierr);
+  ierr = PetscFree(lid_round);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode MatCoarsenApply_Luby(MatCoarsen coarse)
+{
+  MatCoarsen_Luby *luby = (MatCoarsen_Luby*)coarse->subctx;
+  PetscErrorCode  ierr;
+
+  PetscFunctionBegin;
+  PetscValidHeaderSpecific(coarse,MAT_COARSEN_CLASSID,1);
+  /* the priorities replace the greedy ordering */
+  ierr = lubyIndSetAgg(luby,coarse->graph,coarse->strict_aggs,&coarse->agg_lists);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode MatCoarsenSetFromOptions_Luby(PetscOptionItems *PetscOptionsObject,MatCoarsen coarse)
+{
+  MatCoarsen_Luby *luby = (MatCoarsen_Luby*)coarse->subctx;
+  PetscErrorCode  ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscOptionsHead(PetscOptionsObject,"Luby coarsen options");CHKERRQ(ierr);
+  ierr = PetscOptionsInt("-mat_coarsen_luby_seed","Seed of the vertex priorities","None",luby->seed,&luby->seed,NULL);CHKERRQ(ierr);
+#if defined(PETSC_HAVE_OPENMP)
+  ierr = PetscOptionsInt("-mat_coarsen_luby_threads","Number of OpenMP threads used by each process","None",luby->nthreads,&luby->nthreads,NULL);CHKERRQ(ierr);
+  if (luby->nthreads < 1) SETERRQ1(PetscObjectComm((PetscObject)coarse),PETSC_ERR_ARG_OUTOFRANGE,"Number of threads %D must be positive",luby->nthreads);
+#endif
+  ierr = PetscOptionsTail();CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode MatCoarsenView_Luby(MatCoarsen coarse,PetscViewer viewer)
+{
+  MatCoarsen_Luby *luby = (MatCoarsen_Luby*)coarse->subctx;
+  PetscErrorCode  ierr;
+  PetscMPIInt     rank;
+  PetscBool       iascii;
+
+  PetscFunctionBegin;
+  PetscValidHeaderSpecific(coarse,MAT_COARSEN_CLASSID,1);
+  ierr = MPI_Comm_rank(PetscObjectComm((PetscObject)coarse),&rank);CHKERRQ(ierr);
+  ierr = PetscObjectTypeCompare((PetscObject)viewer,PETSCVIEWERASCII,&iascii);CHKERRQ(ierr);
+  if (iascii) {
+    ierr = PetscViewerASCIIPushSynchronized(viewer);CHKERRQ(ierr);
+    ierr = PetscViewerASCIISynchronizedPrintf(viewer,"  [%d] Luby MIS aggregator, seed %D, %D threads\n",rank,luby->seed,luby->nthreads);CHKERRQ(ierr);
+    ierr = PetscViewerFlush(viewer);CHKERRQ(ierr);
+    ierr = PetscViewerASCIIPopSynchronized(viewer);CHKERRQ(ierr);
+  }
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode MatCoarsenDestroy_Luby(MatCoarsen coarse)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  PetscValidHeaderSpecific(coarse,MAT_COARSEN_CLASSID,1);
+  ierr = PetscFree(coarse->subctx);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/*MC
+   MATCOARSENLUBY - Creates a coarsen context with a maximal independent set of Luby type.
+
+   Collective
+
+   Input Parameter:
+.  coarse - the coarsen context
+
+   Options Database Keys:
++  -mat_coarsen_luby_seed <seed> - seed of the vertex priorities
+-  -mat_coarsen_luby_threads <n> - number of OpenMP threads used by each process
+
+   Notes:
+   Unlike MATCOARSENMIS, which visits the vertices of a process one after the other, all the undecided vertices are examined
+   at once in each round against random priorities, so the rounds run on several threads. The priorities are a hash of the
+   global indices: for a given seed the aggregates do not depend on the number of processes, of threads, or on the greedy
+   ordering given with MatCoarsenSetGreedyOrdering(), which is ignored. Use -mat_coarsen_type luby with PCGAMG to compare
+   the hierarchy with the one of MATCOARSENMIS.
+
+   Without MatCoarsenSetStrictAggs() the aggregates are built as in MATCOARSENMIS: a selected vertex also keeps the ghost
+   neighbors that were undecided when it was selected, even those that joined the aggregate of another selected vertex.
+
+   Level: beginner
+
+.seealso: MatCoarsenSetType(), MatCoarsenType, MATCOARSENMIS
+
+M*/
+
+PETSC_EXTERN PetscErrorCode MatCoarsenCreate_Luby(MatCoarsen coarse)
+{
+  PetscErrorCode  ierr;
+  MatCoarsen_Luby *luby;
+
+  PetscFunctionBegin;
+  ierr           = PetscNewLog(coarse,&luby);CHKERRQ(ierr);
+  luby->nthreads = 1;
+  coarse->subctx = (void*)luby;
+
+  coarse->ops->apply          = MatCoarsenApply_Luby;
+  coarse->ops->view           = MatCoarsenView_Luby;
+  coarse->ops->destroy        = MatCoarsenDestroy_Luby;
+  coarse->ops->setfromoptions = MatCoarsenSetFromOptions_Luby;
+  PetscFunctionReturn(0);
+}
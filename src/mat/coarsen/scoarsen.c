@@ -4,6 +4,7 @@
 
 PETSC_EXTERN PetscErrorCode MatCoarsenCreate_MIS(MatCoarsen);
 PETSC_EXTERN PetscErrorCode MatCoarsenCreate_HEM(MatCoarsen);
+PETSC_EXTERN PetscErrorCode MatCoarsenCreate_Luby(MatCoarsen);
 
 /*@C
   MatCoarsenRegisterAll - Registers all of the matrix Coarsen routines in PETSc.
@@ -35,6 +36,7 @@ PetscErrorCode  MatCoarsenRegisterAll(void)
 
   ierr = MatCoarsenRegister(MATCOARSENMIS,MatCoarsenCreate_MIS);CHKERRQ(ierr);
   ierr = MatCoarsenRegister(MATCOARSENHEM,MatCoarsenCreate_HEM);CHKERRQ(ierr);
+  ierr = MatCoarsenRegister(MATCOARSENLUBY,MatCoarsenCreate_Luby);CHKERRQ(ierr);
   PetscFunctionReturn(0);
 }
 
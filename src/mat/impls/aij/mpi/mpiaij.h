@@ -65,6 +65,7 @@ typedef struct {
   VecScatter Mvctx,Mvctx_mpi1;     /* scatter context for vector */
   PetscBool  Mvctx_mpi1_flg;       /* if true, additional Mvctx_mpi1 is requested for mat-mat ops, default false */
   PetscBool  roworiented;          /* if true, row-oriented input, default true */
+  PetscBool  usehash;              /* MAT_USE_HASH_TABLE, passed on to A and B when they are preallocated */
 
   /* The following variables are for MatGetRow() */
   PetscInt    *rowindices;         /* column indices for row */
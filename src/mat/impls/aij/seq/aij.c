@@ -15,14 +15,45 @@ PetscErrorCode MatSeqAIJSetTypeFromOptions(Mat A)
   PetscErrorCode       ierr;
   PetscBool            flg;
   char                 type[256];
+  Mat_SeqAIJ           *a = (Mat_SeqAIJ*)A->data;
 
   PetscFunctionBegin;
   ierr = PetscObjectOptionsBegin((PetscObject)A);
+#if defined(PETSC_HAVE_OPENMP)
+  ierr = PetscOptionsInt("-mat_aij_threads","Number of OpenMP threads used in MatMult(), MatMultAdd(), the numeric MatMatMult() and MatPtAP() and the MatSolve() of factors","None",a->nthreads,&a->nthreads,NULL);CHKERRQ(ierr);
+#endif
+  ierr = PetscOptionsBool("-mat_aij_compress_indices","Store the column indices as 16-bit offsets from the first column of each row for MatMult() and MatMultAdd()","None",a->compressidx,&a->compressidx,NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsBool("-mat_aij_autotune","Convert to the SeqAIJ subtype with the fastest MatMult() at assembly","None",a->autotune,&a->autotune,NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsInt("-mat_aij_autotune_its","Number of MatMult() timed for each subtype","None",a->autotune_its,&a->autotune_its,NULL);CHKERRQ(ierr);
   ierr = PetscOptionsFList("-mat_seqaij_type","Matrix SeqAIJ type","MatSeqAIJSetType",MatSeqAIJList,"seqaij",type,256,&flg);CHKERRQ(ierr);
   if (flg) {
     ierr = MatSeqAIJSetType(A,type);CHKERRQ(ierr);
   }
   ierr = PetscOptionsEnd();CHKERRQ(ierr);
+#if defined(PETSC_HAVE_OPENMP)
+  if (a->nthreads < 1) SETERRQ1(PetscObjectComm((PetscObject)A),PETSC_ERR_ARG_OUTOFRANGE,"Number of threads %D must be positive",a->nthreads);
+#endif
+  if (a->autotune_its < 1) SETERRQ1(PetscObjectComm((PetscObject)A),PETSC_ERR_ARG_OUTOFRANGE,"Number of autotuning iterations %D must be positive",a->autotune_its);
+  PetscFunctionReturn(0);
+}
+
+/*
+   Options read only when MatSetFromOptions() is called on the matrix, so they do not reach the SeqAIJ matrices
+   created internally (blocks of parallel matrices, products, submatrices)
+*/
+static PetscErrorCode MatSetFromOptions_SeqAIJ(PetscOptionItems *PetscOptionsObject,Mat A)
+{
+  Mat_SeqAIJ     *a = (Mat_SeqAIJ*)A->data;
+  PetscBool      usehash = a->ht ? PETSC_TRUE : PETSC_FALSE,flg;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscOptionsHead(PetscOptionsObject,"SeqAIJ options");CHKERRQ(ierr);
+  ierr = PetscOptionsBool("-mat_use_hash_table","Collect the entries in a hash table until the first assembly","MatSetOption",usehash,&usehash,&flg);CHKERRQ(ierr);
+  if (flg) {
+    ierr = MatSetOption(A,MAT_USE_HASH_TABLE,usehash);CHKERRQ(ierr);
+  }
+  ierr = PetscOptionsTail();CHKERRQ(ierr);
   PetscFunctionReturn(0);
 }
 
@@ -521,6 +552,143 @@ noinsert:;
   PetscFunctionReturn(0);
 }
 
+/*
+   Used in place of MatSetValues_SeqAIJ() before the first assembly when MAT_USE_HASH_TABLE is set: the entries are
+   collected in a->ht, keyed by (row,column), and compressed into the CSR storage by MatSeqAIJCompressHash_Private()
+   so no reallocation happens whatever the preallocation was
+*/
+PetscErrorCode MatSetValues_SeqAIJ_Hash(Mat A,PetscInt m,const PetscInt im[],PetscInt n,const PetscInt in[],const PetscScalar v[],InsertMode is)
+{
+  Mat_SeqAIJ     *a = (Mat_SeqAIJ*)A->data;
+  PetscInt       k,l;
+  PetscHashIJKey key;
+  PetscScalar    value = 0.0;
+  PetscBool      has;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  for (k=0; k<m; k++) { /* loop over added rows */
+    key.i = im[k];
+    if (key.i < 0) continue;
+    if (PetscUnlikelyDebug(key.i >= A->rmap->n)) SETERRQ2(PETSC_COMM_SELF,PETSC_ERR_ARG_OUTOFRANGE,"Row too large: row %D max %D",key.i,A->rmap->n-1);
+    for (l=0; l<n; l++) { /* loop over added columns */
+      key.j = in[l];
+      if (key.j < 0) continue;
+      if (PetscUnlikelyDebug(key.j >= A->cmap->n)) SETERRQ2(PETSC_COMM_SELF,PETSC_ERR_ARG_OUTOFRANGE,"Column too large: col %D max %D",key.j,A->cmap->n-1);
+      if (v && !A->structure_only) value = a->roworiented ? v[l + k*n] : v[k + l*m];
+      if (value == 0.0 && a->ignorezeroentries && key.i != key.j) {
+        /* as in MatSetValues_SeqAIJ() a zero only overwrites an existing entry */
+        if (is == ADD_VALUES) continue;
+        ierr = PetscHMapIJVHas(a->ht,key,&has);CHKERRQ(ierr);
+        if (!has) continue;
+      }
+      if (is == ADD_VALUES) {
+        ierr = PetscHMapIJVAddValue(a->ht,key,value);CHKERRQ(ierr);
+      } else {
+        ierr = PetscHMapIJVSet(a->ht,key,value);CHKERRQ(ierr);
+      }
+    }
+  }
+  PetscFunctionReturn(0);
+}
+
+/*
+   Turns on (or off) the collection of the entries in a hash table until the first assembly. Entries already in the
+   CSR storage are moved to the hash table so that later MatSetValues() apply their own InsertMode to them.
+*/
+PetscErrorCode MatSeqAIJSetUseHash_Private(Mat A,PetscBool flg)
+{
+  Mat_SeqAIJ     *a = (Mat_SeqAIJ*)A->data;
+  PetscHashIJKey key;
+  PetscInt       k;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  if (!flg) {
+    ierr = MatSeqAIJCompressHash_Private(A);CHKERRQ(ierr);
+    PetscFunctionReturn(0);
+  }
+  if (a->ht) PetscFunctionReturn(0);
+  if (A->assembled || A->was_assembled) {
+    ierr = PetscInfo(A,"Option MAT_USE_HASH_TABLE ignored since the matrix has already been assembled\n");CHKERRQ(ierr);
+    PetscFunctionReturn(0);
+  }
+  if (A->preallocated && (!a->free_ij || (!a->free_a && !A->structure_only))) SETERRQ(PETSC_COMM_SELF,PETSC_ERR_SUP,"MAT_USE_HASH_TABLE is not supported for a matrix using arrays provided by the user");
+  ierr = PetscHMapIJVCreate(&a->ht);CHKERRQ(ierr);
+  if (A->preallocated && a->ilen) {
+    for (key.i=0; key.i<A->rmap->n; key.i++) {
+      for (k=a->i[key.i]; k<a->i[key.i]+a->ilen[key.i]; k++) {
+        key.j = a->j[k];
+        ierr  = PetscHMapIJVSet(a->ht,key,A->structure_only ? 0.0 : a->a[k]);CHKERRQ(ierr);
+      }
+      a->ilen[key.i] = 0;
+    }
+    a->nz = 0;
+  }
+  A->ops->setvalues = MatSetValues_SeqAIJ_Hash;
+  PetscFunctionReturn(0);
+}
+
+/*
+   Moves the entries collected by MatSetValues_SeqAIJ_Hash() into a CSR storage allocated with their exact count.
+   The CSR storage was emptied when the hash table was turned on, anything found there was written directly into the
+   arrays, without going through MatSetValues(), and is added to the collected entries.
+*/
+PetscErrorCode MatSeqAIJCompressHash_Private(Mat A)
+{
+  Mat_SeqAIJ     *a = (Mat_SeqAIJ*)A->data;
+  PetscInt       i,k,m = A->rmap->n,nz,nonew = a->nonew,*nnz;
+  PetscHashIter  hi;
+  PetscHashIJKey key;
+  PetscScalar    value;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  if (!a->ht) PetscFunctionReturn(0);
+  if (A->preallocated && a->ilen) {
+    for (key.i=0; key.i<m; key.i++) {
+      for (i=0; i<a->ilen[key.i]; i++) {
+        k     = a->i[key.i]+i;
+        key.j = a->j[k];
+        ierr  = PetscHMapIJVAddValue(a->ht,key,A->structure_only ? 0.0 : a->a[k]);CHKERRQ(ierr);
+      }
+    }
+  }
+  ierr = PetscHMapIJVGetSize(a->ht,&nz);CHKERRQ(ierr);
+  ierr = PetscCalloc1(m,&nnz);CHKERRQ(ierr);
+  PetscHashIterBegin(a->ht,hi);
+  while (!PetscHashIterAtEnd(a->ht,hi)) {
+    PetscHashIterGetKey(a->ht,hi,key);
+    nnz[key.i]++;
+    PetscHashIterNext(a->ht,hi);
+  }
+  ierr = MatSeqAIJSetPreallocation_SeqAIJ(A,0,nnz);CHKERRQ(ierr);
+  a->nonew = nonew; /* not changed by the implicit preallocation */
+  PetscHashIterBegin(a->ht,hi);
+  while (!PetscHashIterAtEnd(a->ht,hi)) {
+    PetscHashIterGetKey(a->ht,hi,key);
+    PetscHashIterGetVal(a->ht,hi,value);
+    k = a->i[key.i] + a->ilen[key.i]++;
+    a->j[k] = key.j;
+    if (!A->structure_only) a->a[k] = value;
+    PetscHashIterNext(a->ht,hi);
+  }
+  for (i=0; i<m; i++) {
+    if (A->structure_only) {
+      ierr = PetscSortInt(a->ilen[i],a->j+a->i[i]);CHKERRQ(ierr);
+    } else {
+      ierr = PetscSortIntWithScalarArray(a->ilen[i],a->j+a->i[i],a->a+a->i[i]);CHKERRQ(ierr);
+    }
+  }
+  a->nz = nz;
+  A->nonzerostate++;
+  ierr = PetscFree(nnz);CHKERRQ(ierr);
+  ierr = PetscHMapIJVDestroy(&a->ht);CHKERRQ(ierr);
+  A->ops->setvalues = MatSetValues_SeqAIJ;
+  ierr = PetscInfo2(A,"Compressed %D entries collected in the hash table into %D rows\n",nz,m);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
 PetscErrorCode MatSetValues_SeqAIJ_SortedFull(Mat A,PetscInt m,const PetscInt im[],PetscInt n,const PetscInt in[],const PetscScalar v[],InsertMode is)
 {
   Mat_SeqAIJ     *a = (Mat_SeqAIJ*)A->data;
@@ -701,6 +869,9 @@ PetscErrorCode MatView_SeqAIJ_ASCII(Mat A,PetscViewer viewer)
     ierr = PetscViewerASCIIPrintf(viewer,"];\n %s = spconvert(zzz);\n",name);CHKERRQ(ierr);
     ierr = PetscViewerASCIIUseTabs(viewer,PETSC_TRUE);CHKERRQ(ierr);
   } else if (format == PETSC_VIEWER_ASCII_FACTOR_INFO || format == PETSC_VIEWER_ASCII_INFO || format == PETSC_VIEWER_ASCII_INFO_DETAIL) {
+    if (format != PETSC_VIEWER_ASCII_FACTOR_INFO && a->autotuned) {
+      ierr = PetscViewerASCIIPrintf(viewer,"MatMult() format selected by -mat_aij_autotune: %s\n",a->autotuned);CHKERRQ(ierr);
+    }
     PetscFunctionReturn(0);
   } else if (format == PETSC_VIEWER_ASCII_COMMON) {
     ierr = PetscViewerASCIIUseTabs(viewer,PETSC_FALSE);CHKERRQ(ierr);
@@ -1033,6 +1204,98 @@ PetscErrorCode MatView_SeqAIJ(Mat A,PetscViewer viewer)
   PetscFunctionReturn(0);
 }
 
+/*
+   Times a->autotune_its MatMult() with each SeqAIJ subtype that keeps the AIJ storage and converts A in place to the
+   fastest one. Called at the end of MatAssemblyEnd_SeqAIJ() so A is only retuned when its nonzero structure changes.
+*/
+static PetscErrorCode MatSeqAIJAutotune_Private(Mat A)
+{
+  Mat_SeqAIJ     *a = (Mat_SeqAIJ*)A->data;
+  MatType        types[] = {MATSEQAIJ,MATSEQAIJPERM,MATSEQAIJSELL}; /* MATSEQAIJCRL cannot be duplicated */
+  PetscInt       i,k,best = 0,ntypes = sizeof(types)/sizeof(types[0]);
+  PetscLogDouble t0,t1,tbest = 0.0;
+  Mat            B;
+  Vec            x,y;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  if (!a->nz) PetscFunctionReturn(0);
+  ierr = PetscLogEventBegin(MAT_Autotune,A,0,0,0);CHKERRQ(ierr);
+  A->assembled = PETSC_TRUE; /* the candidates are duplicated from A; MatAssemblyEnd() is about to set this anyway */
+  ierr = MatCreateVecs(A,&x,&y);CHKERRQ(ierr);
+  ierr = VecSet(x,1.0);CHKERRQ(ierr);
+  for (i=0; i<ntypes; i++) {
+    B = A;
+    if (i) {
+      ierr = MatDuplicate(A,MAT_COPY_VALUES,&B);CHKERRQ(ierr);
+      ((Mat_SeqAIJ*)B->data)->autotune = PETSC_FALSE;
+      ierr = MatSeqAIJSetType(B,types[i]);CHKERRQ(ierr);
+    }
+    /* the first product builds data created lazily, such as the SELL copy of MATSEQAIJSELL */
+    ierr = (*B->ops->mult)(B,x,y);CHKERRQ(ierr);
+    ierr = PetscTime(&t0);CHKERRQ(ierr);
+    for (k=0; k<a->autotune_its; k++) {
+      ierr = (*B->ops->mult)(B,x,y);CHKERRQ(ierr);
+    }
+    ierr = PetscTime(&t1);CHKERRQ(ierr);
+    if (i) {ierr = MatDestroy(&B);CHKERRQ(ierr);}
+    ierr = PetscInfo2(A,"MatMult() with %s takes %g seconds\n",types[i],(t1-t0)/a->autotune_its);CHKERRQ(ierr);
+    if (!i || t1-t0 < tbest) {
+      tbest = t1-t0;
+      best  = i;
+    }
+  }
+  ierr = VecDestroy(&x);CHKERRQ(ierr);
+  ierr = VecDestroy(&y);CHKERRQ(ierr);
+  a->autotuned = types[best];
+  ierr = PetscInfo1(A,"Selected %s\n",types[best]);CHKERRQ(ierr);
+  if (best) {
+    ierr = MatSeqAIJSetType(A,types[best]);CHKERRQ(ierr);
+  }
+  ierr = PetscLogEventEnd(MAT_Autotune,A,0,0,0);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/*
+    Builds the 16-bit column offsets used by MatMult_SeqAIJ() and MatMultAdd_SeqAIJ() when
+    -mat_aij_compress_indices is set; nothing is stored if some row spans more than 65536 columns
+*/
+static PetscErrorCode MatSeqAIJCompressIndices_Private(Mat A)
+{
+  Mat_SeqAIJ     *a = (Mat_SeqAIJ*)A->data;
+  PetscErrorCode ierr;
+  PetscInt       i,k,m = A->rmap->n,cmin,cmax;
+  const PetscInt *ai = a->i,*aj = a->j;
+
+  PetscFunctionBegin;
+  if (!a->compressidx || A->structure_only) PetscFunctionReturn(0);
+  if (a->cj && a->cj_state == A->nonzerostate) PetscFunctionReturn(0);
+  ierr = PetscFree2(a->cj,a->cjbase);CHKERRQ(ierr);
+  for (i=0; i<m; i++) {
+    if (ai[i+1] == ai[i]) continue;
+    cmin = cmax = aj[ai[i]];
+    for (k=ai[i]+1; k<ai[i+1]; k++) {
+      cmin = PetscMin(cmin,aj[k]);
+      cmax = PetscMax(cmax,aj[k]);
+    }
+    if (cmax - cmin > 65535) {
+      ierr = PetscInfo2(A,"Row %D spans %D columns, not compressing the column indices\n",i,cmax-cmin+1);CHKERRQ(ierr);
+      PetscFunctionReturn(0);
+    }
+  }
+  ierr = PetscMalloc2(a->nz,&a->cj,m,&a->cjbase);CHKERRQ(ierr);
+  ierr = PetscLogObjectMemory((PetscObject)A,a->nz*sizeof(unsigned short)+m*sizeof(PetscInt));CHKERRQ(ierr);
+  for (i=0; i<m; i++) {
+    cmin = ai[i+1] > ai[i] ? aj[ai[i]] : 0;
+    for (k=ai[i]+1; k<ai[i+1]; k++) cmin = PetscMin(cmin,aj[k]);
+    for (k=ai[i]; k<ai[i+1]; k++) a->cj[k] = (unsigned short)(aj[k] - cmin);
+    a->cjbase[i] = cmin;
+  }
+  a->cj_state = A->nonzerostate;
+  ierr = PetscInfo1(A,"Stored %D column indices as 16-bit offsets\n",a->nz);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
 PetscErrorCode MatAssemblyEnd_SeqAIJ(Mat A,MatAssemblyType mode)
 {
   Mat_SeqAIJ     *a = (Mat_SeqAIJ*)A->data;
@@ -1041,9 +1304,11 @@ PetscErrorCode MatAssemblyEnd_SeqAIJ(Mat A,MatAssemblyType mode)
   PetscInt       m      = A->rmap->n,*ip,N,*ailen = a->ilen,rmax = 0;
   MatScalar      *aa    = a->a,*ap;
   PetscReal      ratio  = 0.6;
+  PetscBool      isseqaij;
 
   PetscFunctionBegin;
   if (mode == MAT_FLUSH_ASSEMBLY) PetscFunctionReturn(0);
+  ierr = MatSeqAIJCompressHash_Private(A);CHKERRQ(ierr);
   ierr = MatSeqAIJInvalidateDiagonal(A);CHKERRQ(ierr);
   if (A->was_assembled && A->ass_nonzerostate == A->nonzerostate) PetscFunctionReturn(0);
 
@@ -1095,7 +1360,13 @@ PetscErrorCode MatAssemblyEnd_SeqAIJ(Mat A,MatAssemblyType mode)
   if (!A->structure_only) {
     ierr = MatCheckCompressedRow(A,a->nonzerorowcnt,&a->compressedrow,a->i,m,ratio);CHKERRQ(ierr);
   }
+  ierr = MatSeqAIJCompressIndices_Private(A);CHKERRQ(ierr);
   ierr = MatAssemblyEnd_SeqAIJ_Inode(A,mode);CHKERRQ(ierr);
+  if (a->autotune && !A->structure_only) {
+    /* subtypes call this routine from their own MatAssemblyEnd() so they cannot be converted here */
+    ierr = PetscObjectTypeCompare((PetscObject)A,MATSEQAIJ,&isseqaij);CHKERRQ(ierr);
+    if (isseqaij) {ierr = MatSeqAIJAutotune_Private(A);CHKERRQ(ierr);}
+  }
   PetscFunctionReturn(0);
 }
 
@@ -1169,6 +1440,10 @@ PetscErrorCode MatDestroy_SeqAIJ(Mat A)
   ierr = ISColoringDestroy(&a->coloring);CHKERRQ(ierr);
   ierr = PetscFree2(a->compressedrow.i,a->compressedrow.rindex);CHKERRQ(ierr);
   ierr = PetscFree(a->matmult_abdense);CHKERRQ(ierr);
+  ierr = PetscFree(a->threadrows);CHKERRQ(ierr);
+  ierr = PetscFree2(a->levelptr,a->levelrows);CHKERRQ(ierr);
+  ierr = PetscFree2(a->cj,a->cjbase);CHKERRQ(ierr);
+  ierr = PetscHMapIJVDestroy(&a->ht);CHKERRQ(ierr);
 
   ierr = MatDestroy_SeqAIJ_Inode(A);CHKERRQ(ierr);
   ierr = PetscFree(A->data);CHKERRQ(ierr);
@@ -1198,6 +1473,7 @@ PetscErrorCode MatDestroy_SeqAIJ(Mat A)
   ierr = PetscObjectComposeFunction((PetscObject)A,"MatConvert_seqaij_is_C",NULL);CHKERRQ(ierr);
   ierr = PetscObjectComposeFunction((PetscObject)A,"MatIsTranspose_C",NULL);CHKERRQ(ierr);
   ierr = PetscObjectComposeFunction((PetscObject)A,"MatSeqAIJSetPreallocation_C",NULL);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)A,"MatSORDense_C",NULL);CHKERRQ(ierr);
   ierr = PetscObjectComposeFunction((PetscObject)A,"MatResetPreallocation_C",NULL);CHKERRQ(ierr);
   ierr = PetscObjectComposeFunction((PetscObject)A,"MatSeqAIJSetPreallocationCSR_C",NULL);CHKERRQ(ierr);
   ierr = PetscObjectComposeFunction((PetscObject)A,"MatReorderForNonzeroDiagonal_C",NULL);CHKERRQ(ierr);
@@ -1245,9 +1521,11 @@ PetscErrorCode MatSetOption_SeqAIJ(Mat A,MatOption op,PetscBool flg)
     break;
   case MAT_NEW_DIAGONALS:
   case MAT_IGNORE_OFF_PROC_ENTRIES:
-  case MAT_USE_HASH_TABLE:
     ierr = PetscInfo1(A,"Option %s ignored\n",MatOptions[op]);CHKERRQ(ierr);
     break;
+  case MAT_USE_HASH_TABLE:
+    ierr = MatSeqAIJSetUseHash_Private(A,flg);CHKERRQ(ierr);
+    break;
   case MAT_USE_INODES:
     /* Not an error because MatSetOption_SeqAIJ_Inode handles this one */
     break;
@@ -1358,6 +1636,176 @@ PetscErrorCode MatMultTranspose_SeqAIJ(Mat A,Vec xx,Vec yy)
   PetscFunctionReturn(0);
 }
 
+/*
+    Splits the m rows described by the row offsets ii[] into nparts contiguous chunks
+    holding approximately the same number of nonzeros; chunk t is rows[t] <= i < rows[t+1].
+*/
+PetscErrorCode MatSeqAIJPartitionRows_Private(PetscInt m,const PetscInt ii[],PetscInt nparts,PetscInt rows[])
+{
+  PetscInt  t,i = 0;
+  PetscReal nz = (PetscReal)(ii[m] - ii[0]);
+
+  PetscFunctionBegin;
+  rows[0] = 0;
+  for (t=1; t<nparts; t++) {
+    PetscInt target = ii[0] + (PetscInt)((nz*t)/nparts);
+    while (i < m && ii[i] < target) i++;
+    rows[t] = i;
+  }
+  rows[nparts] = m;
+  PetscFunctionReturn(0);
+}
+
+#if defined(PETSC_HAVE_OPENMP)
+/*
+    Returns the row split used by the threaded MatMult_SeqAIJ() and MatMultAdd_SeqAIJ(); it is
+    recomputed only when the nonzero structure of the matrix has changed
+*/
+static PetscErrorCode MatSeqAIJGetThreadRows_Private(Mat A,PetscInt m,const PetscInt ii[],const PetscInt *rows[])
+{
+  Mat_SeqAIJ     *a = (Mat_SeqAIJ*)A->data;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  if (!a->threadrows) {
+    ierr = PetscMalloc1(a->nthreads+1,&a->threadrows);CHKERRQ(ierr);
+    ierr = PetscLogObjectMemory((PetscObject)A,(a->nthreads+1)*sizeof(PetscInt));CHKERRQ(ierr);
+  } else if (a->threadrows_state == A->nonzerostate && a->threadrows[a->nthreads] == m) {
+    *rows = a->threadrows;
+    PetscFunctionReturn(0);
+  }
+  ierr = MatSeqAIJPartitionRows_Private(m,ii,a->nthreads,a->threadrows);CHKERRQ(ierr);
+  ierr = PetscInfo2(A,"Split %D rows among %D threads by number of nonzeros\n",m,a->nthreads);CHKERRQ(ierr);
+  a->threadrows_state = A->nonzerostate;
+  *rows = a->threadrows;
+  PetscFunctionReturn(0);
+}
+
+/*
+    Computes zz = A*xx + yy (or zz = A*xx when yy is NULL) with a->nthreads OpenMP threads
+*/
+static PetscErrorCode MatMultAdd_SeqAIJ_OpenMP(Mat A,Vec xx,Vec yy,Vec zz)
+{
+  Mat_SeqAIJ        *a = (Mat_SeqAIJ*)A->data;
+  PetscScalar       *y = NULL,*z;
+  const PetscScalar *x;
+  PetscErrorCode    ierr;
+  const PetscInt    *ii,*ridx = NULL,*rows,*cjbase = NULL;
+  PetscInt          m = A->rmap->n,t;
+  PetscBool         usecprow = a->compressedrow.use;
+
+  PetscFunctionBegin;
+  ierr = VecGetArrayRead(xx,&x);CHKERRQ(ierr);
+  if (yy) {
+    ierr = VecGetArrayPair(yy,zz,&y,&z);CHKERRQ(ierr);
+  } else {
+    ierr = VecGetArray(zz,&z);CHKERRQ(ierr);
+  }
+  ii = a->i;
+  if (usecprow) { /* use compressed row format */
+    if (!yy) {
+      ierr = PetscArrayzero(z,m);CHKERRQ(ierr);
+    } else if (zz != yy) {
+      ierr = PetscArraycpy(z,y,m);CHKERRQ(ierr);
+    }
+    m    = a->compressedrow.nrows;
+    ii   = a->compressedrow.i;
+    ridx = a->compressedrow.rindex;
+  }
+  ierr = MatSeqAIJGetThreadRows_Private(A,m,ii,&rows);CHKERRQ(ierr);
+  if (a->cj && a->cj_state == A->nonzerostate) cjbase = a->cjbase;
+#pragma omp parallel for num_threads((int)a->nthreads) schedule(static,1)
+  for (t=0; t<a->nthreads; t++) {
+    const PetscInt       *aj;
+    const unsigned short *cj;
+    const PetscScalar    *xb;
+    const MatScalar      *aa;
+    PetscInt             i,k,n,row;
+    PetscScalar          sum;
+
+    for (i=rows[t]; i<rows[t+1]; i++) {
+      n   = ii[i+1] - ii[i];
+      aa  = a->a + ii[i];
+      row = usecprow ? ridx[i] : i;
+      sum = y ? y[row] : 0.0;
+      if (cjbase) {
+        cj = a->cj + ii[i];
+        xb = x + cjbase[row];
+        for (k=0; k<n; k++) sum += aa[k]*xb[cj[k]];
+      } else {
+        aj = a->j + ii[i];
+        PetscSparseDensePlusDot(sum,x,aa,aj,n);
+      }
+      z[row] = sum;
+    }
+  }
+  if (yy) {
+    ierr = PetscLogFlops(2.0*a->nz);CHKERRQ(ierr);
+    ierr = VecRestoreArrayPair(yy,zz,&y,&z);CHKERRQ(ierr);
+  } else {
+    ierr = PetscLogFlops(2.0*a->nz - a->nonzerorowcnt);CHKERRQ(ierr);
+    ierr = VecRestoreArray(zz,&z);CHKERRQ(ierr);
+  }
+  ierr = VecRestoreArrayRead(xx,&x);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+#endif
+
+/*
+    Computes zz = A*xx + yy (or zz = A*xx when yy is NULL) reading the 16-bit column offsets a->cj[]
+    instead of a->j[]; requires a->cj[] to be current
+*/
+static PetscErrorCode MatMultAdd_SeqAIJ_CompressedIndices(Mat A,Vec xx,Vec yy,Vec zz)
+{
+  Mat_SeqAIJ           *a = (Mat_SeqAIJ*)A->data;
+  PetscScalar          *y = NULL,*z,sum;
+  const PetscScalar    *x,*xb;
+  const MatScalar      *aa;
+  const unsigned short *cj;
+  const PetscInt       *ii,*ridx = NULL;
+  PetscInt             m = A->rmap->n,i,k,n,row;
+  PetscBool            usecprow = a->compressedrow.use;
+  PetscErrorCode       ierr;
+
+  PetscFunctionBegin;
+  ierr = VecGetArrayRead(xx,&x);CHKERRQ(ierr);
+  if (yy) {
+    ierr = VecGetArrayPair(yy,zz,&y,&z);CHKERRQ(ierr);
+  } else {
+    ierr = VecGetArray(zz,&z);CHKERRQ(ierr);
+  }
+  ii = a->i;
+  if (usecprow) { /* use compressed row format */
+    if (!yy) {
+      ierr = PetscArrayzero(z,m);CHKERRQ(ierr);
+    } else if (zz != yy) {
+      ierr = PetscArraycpy(z,y,m);CHKERRQ(ierr);
+    }
+    m    = a->compressedrow.nrows;
+    ii   = a->compressedrow.i;
+    ridx = a->compressedrow.rindex;
+  }
+  for (i=0; i<m; i++) {
+    n   = ii[i+1] - ii[i];
+    cj  = a->cj + ii[i];
+    aa  = a->a + ii[i];
+    row = usecprow ? ridx[i] : i;
+    xb  = x + a->cjbase[row];
+    sum = y ? y[row] : 0.0;
+    for (k=0; k<n; k++) sum += aa[k]*xb[cj[k]];
+    z[row] = sum;
+  }
+  if (yy) {
+    ierr = PetscLogFlops(2.0*a->nz);CHKERRQ(ierr);
+    ierr = VecRestoreArrayPair(yy,zz,&y,&z);CHKERRQ(ierr);
+  } else {
+    ierr = PetscLogFlops(2.0*a->nz - a->nonzerorowcnt);CHKERRQ(ierr);
+    ierr = VecRestoreArray(zz,&z);CHKERRQ(ierr);
+  }
+  ierr = VecRestoreArrayRead(xx,&x);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
 #include <../src/mat/impls/aij/seq/ftn-kernels/fmult.h>
 
 PetscErrorCode MatMult_SeqAIJ(Mat A,Vec xx,Vec yy)
@@ -1378,6 +1826,16 @@ PetscErrorCode MatMult_SeqAIJ(Mat A,Vec xx,Vec yy)
 #endif
 
   PetscFunctionBegin;
+#if defined(PETSC_HAVE_OPENMP)
+  if (a->nthreads > 1) {
+    ierr = MatMultAdd_SeqAIJ_OpenMP(A,xx,NULL,yy);CHKERRQ(ierr);
+    PetscFunctionReturn(0);
+  }
+#endif
+  if (a->cj && a->cj_state == A->nonzerostate) {
+    ierr = MatMultAdd_SeqAIJ_CompressedIndices(A,xx,NULL,yy);CHKERRQ(ierr);
+    PetscFunctionReturn(0);
+  }
   ierr = VecGetArrayRead(xx,&x);CHKERRQ(ierr);
   ierr = VecGetArray(yy,&y);CHKERRQ(ierr);
   ii   = a->i;
@@ -1530,6 +1988,16 @@ PetscErrorCode MatMultAdd_SeqAIJ(Mat A,Vec xx,Vec yy,Vec zz)
   PetscBool         usecprow=a->compressedrow.use;
 
   PetscFunctionBegin;
+#if defined(PETSC_HAVE_OPENMP)
+  if (a->nthreads > 1) {
+    ierr = MatMultAdd_SeqAIJ_OpenMP(A,xx,yy,zz);CHKERRQ(ierr);
+    PetscFunctionReturn(0);
+  }
+#endif
+  if (a->cj && a->cj_state == A->nonzerostate) {
+    ierr = MatMultAdd_SeqAIJ_CompressedIndices(A,xx,yy,zz);CHKERRQ(ierr);
+    PetscFunctionReturn(0);
+  }
   ierr = VecGetArrayRead(xx,&x);CHKERRQ(ierr);
   ierr = VecGetArrayPair(yy,zz,&y,&z);CHKERRQ(ierr);
   if (usecprow) { /* use compressed row format */
@@ -1990,6 +2458,135 @@ PetscErrorCode MatSOR_SeqAIJ(Mat A,Vec bb,PetscReal omega,MatSORType flag,PetscR
   PetscFunctionReturn(0);
 }
 
+/*
+   MatSORDense_SeqAIJ - the sweeps of MatSOR_SeqAIJ() applied to all the columns of the dense matrices B and X at once, so that
+   each row of the matrix is read once per sweep for all the columns. Used by PCMatApply() with PCSOR.
+*/
+PetscErrorCode MatSORDense_SeqAIJ(Mat A,Mat B,PetscReal omega,MatSORType flag,PetscReal fshift,PetscInt its,PetscInt lits,Mat X)
+{
+  Mat_SeqAIJ        *a = (Mat_SeqAIJ*)A->data;
+  PetscScalar       *x,*t,sum;
+  const MatScalar   *v,*idiag,*mdiag;
+  const PetscScalar *b,*xb;
+  PetscErrorCode    ierr;
+  PetscInt          n,m = A->rmap->n,N,ldb,ldx,ldxb,i,k,c;
+  const PetscInt    *idx,*diag;
+
+  PetscFunctionBegin;
+  if (flag & (SOR_EISENSTAT | SOR_APPLY_UPPER | SOR_APPLY_LOWER)) SETERRQ(PETSC_COMM_SELF,PETSC_ERR_SUP,"Only forward, backward and symmetric sweeps are supported on several vectors");
+  its = its*lits;
+
+  if (fshift != a->fshift || omega != a->omega) a->idiagvalid = PETSC_FALSE; /* must recompute idiag[] */
+  if (!a->idiagvalid) {ierr = MatInvertDiagonal_SeqAIJ(A,omega,fshift);CHKERRQ(ierr);}
+  a->fshift = fshift;
+  a->omega  = omega;
+
+  diag  = a->diag;
+  idiag = a->idiag;
+  mdiag = a->mdiag;
+
+  ierr = MatGetSize(B,NULL,&N);CHKERRQ(ierr);
+  ierr = MatDenseGetLDA(B,&ldb);CHKERRQ(ierr);
+  ierr = MatDenseGetLDA(X,&ldx);CHKERRQ(ierr);
+  ierr = PetscMalloc1(m*N,&t);CHKERRQ(ierr);
+  ierr = MatDenseGetArrayRead(B,&b);CHKERRQ(ierr);
+  ierr = MatDenseGetArray(X,&x);CHKERRQ(ierr);
+  /* t[] saves the application of the lower triangular part of each column, as a->ssor_work does for one vector */
+  if (flag & SOR_ZERO_INITIAL_GUESS) {
+    if (flag & SOR_FORWARD_SWEEP || flag & SOR_LOCAL_FORWARD_SWEEP) {
+      for (i=0; i<m; i++) {
+        n   = diag[i] - a->i[i];
+        idx = a->j + a->i[i];
+        v   = a->a + a->i[i];
+        for (c=0; c<N; c++) {
+          sum = b[i+c*ldb];
+          for (k=0; k<n; k++) sum -= v[k]*x[idx[k]+c*ldx];
+          t[i+c*m]   = sum;
+          x[i+c*ldx] = sum*idiag[i];
+        }
+      }
+      xb   = t;
+      ldxb = m;
+      ierr = PetscLogFlops(1.0*N*a->nz);CHKERRQ(ierr);
+    } else {
+      xb   = b;
+      ldxb = ldb;
+    }
+    if (flag & SOR_BACKWARD_SWEEP || flag & SOR_LOCAL_BACKWARD_SWEEP) {
+      for (i=m-1; i>=0; i--) {
+        n   = a->i[i+1] - diag[i] - 1;
+        idx = a->j + diag[i] + 1;
+        v   = a->a + diag[i] + 1;
+        for (c=0; c<N; c++) {
+          sum = xb[i+c*ldxb];
+          for (k=0; k<n; k++) sum -= v[k]*x[idx[k]+c*ldx];
+          if (xb == b) x[i+c*ldx] = sum*idiag[i];
+          else         x[i+c*ldx] = (1-omega)*x[i+c*ldx] + sum*idiag[i]; /* omega in idiag */
+        }
+      }
+      ierr = PetscLogFlops(1.0*N*a->nz);CHKERRQ(ierr); /* assumes 1/2 in upper */
+    }
+    its--;
+  }
+  while (its--) {
+    if (flag & SOR_FORWARD_SWEEP || flag & SOR_LOCAL_FORWARD_SWEEP) {
+      for (i=0; i<m; i++) {
+        for (c=0; c<N; c++) {
+          /* lower */
+          n   = diag[i] - a->i[i];
+          idx = a->j + a->i[i];
+          v   = a->a + a->i[i];
+          sum = b[i+c*ldb];
+          for (k=0; k<n; k++) sum -= v[k]*x[idx[k]+c*ldx];
+          t[i+c*m] = sum;
+          /* upper */
+          n   = a->i[i+1] - diag[i] - 1;
+          idx = a->j + diag[i] + 1;
+          v   = a->a + diag[i] + 1;
+          for (k=0; k<n; k++) sum -= v[k]*x[idx[k]+c*ldx];
+          x[i+c*ldx] = (1. - omega)*x[i+c*ldx] + sum*idiag[i]; /* omega in idiag */
+        }
+      }
+      xb   = t;
+      ldxb = m;
+      ierr = PetscLogFlops(2.0*N*a->nz);CHKERRQ(ierr);
+    } else {
+      xb   = b;
+      ldxb = ldb;
+    }
+    if (flag & SOR_BACKWARD_SWEEP || flag & SOR_LOCAL_BACKWARD_SWEEP) {
+      for (i=m-1; i>=0; i--) {
+        for (c=0; c<N; c++) {
+          sum = xb[i+c*ldxb];
+          if (xb == b) {
+            /* whole matrix (no checkpointing available) */
+            n   = a->i[i+1] - a->i[i];
+            idx = a->j + a->i[i];
+            v   = a->a + a->i[i];
+            for (k=0; k<n; k++) sum -= v[k]*x[idx[k]+c*ldx];
+            x[i+c*ldx] = (1. - omega)*x[i+c*ldx] + (sum + mdiag[i]*x[i+c*ldx])*idiag[i];
+          } else { /* lower-triangular part has been saved, so only apply upper-triangular */
+            n   = a->i[i+1] - diag[i] - 1;
+            idx = a->j + diag[i] + 1;
+            v   = a->a + diag[i] + 1;
+            for (k=0; k<n; k++) sum -= v[k]*x[idx[k]+c*ldx];
+            x[i+c*ldx] = (1. - omega)*x[i+c*ldx] + sum*idiag[i]; /* omega in idiag */
+          }
+        }
+      }
+      if (xb == b) {
+        ierr = PetscLogFlops(2.0*N*a->nz);CHKERRQ(ierr);
+      } else {
+        ierr = PetscLogFlops(1.0*N*a->nz);CHKERRQ(ierr); /* assumes 1/2 in upper */
+      }
+    }
+  }
+  ierr = MatDenseRestoreArray(X,&x);CHKERRQ(ierr);
+  ierr = MatDenseRestoreArrayRead(B,&b);CHKERRQ(ierr);
+  ierr = PetscFree(t);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
 
 PetscErrorCode MatGetInfo_SeqAIJ(Mat A,MatInfoType flag,MatInfo *info)
 {
@@ -3441,7 +4038,7 @@ static struct _MatOps MatOps_Values = { MatSetValues_SeqAIJ,
                                         0,
                                 /* 74*/ 0,
                                         MatFDColoringApply_AIJ,
-                                        0,
+                                        MatSetFromOptions_SeqAIJ,
                                         0,
                                         0,
                                 /* 79*/ MatFindZeroDiagonals_SeqAIJ,
@@ -4143,7 +4740,23 @@ PetscErrorCode MatMatMultSymbolic_SeqDense_SeqAIJ(Mat A,Mat B,PetscReal fill,Mat
    based on compressed sparse row format.
 
    Options Database Keys:
-. -mat_type seqaij - sets the matrix type to "seqaij" during a call to MatSetFromOptions()
++ -mat_type seqaij - sets the matrix type to "seqaij" during a call to MatSetFromOptions()
+. -mat_aij_threads <n> - number of OpenMP threads used in MatMult(), MatMultAdd() and the numeric phase of MatMatMult() and
+                         MatPtAP() with this matrix as first operand; the rows are split among the threads so that each gets
+                         about the same number of nonzeros. For the LU and ILU factors of the PETSc solver, MatSolve() then
+                         processes the independent rows of each level set of L and U concurrently (only available with --with-openmp)
+. -mat_aij_compress_indices - at assembly also store each column index as a 16-bit offset from the smallest column of its
+                              row and read these instead of the full indices in MatMult() and MatMultAdd(); this reduces
+                              the memory traffic of the products at the price of 2 bytes of storage per nonzero, and is
+                              skipped (see -info) if some row spans more than 65536 columns, in which case the inode
+                              MatMult() and MatMultAdd() are used as without this option
+. -mat_aij_autotune - at each assembly that changes the nonzero structure, time MatMult() with MATSEQAIJ, MATSEQAIJPERM
+                      and MATSEQAIJSELL and convert the matrix to the fastest; the choice is shown by -info and
+                      -mat_view ::ascii_info and the time spent by the MatAutotune event of -log_view
+. -mat_aij_autotune_its <10> - number of MatMult() timed for each candidate
+- -mat_use_hash_table - collect the entries set before the first assembly in a hash table and build the compressed rows
+                        from it at MatAssemblyEnd(), so assembly does no reallocation whatever the preallocation
+                        (same as MatSetOption(A,MAT_USE_HASH_TABLE,PETSC_TRUE))
 
    Level: beginner
 
@@ -4174,7 +4787,7 @@ M*/
 . -mat_type aij - sets the matrix type to "aij" during a call to MatSetFromOptions()
 
   Developer Notes:
-    Subclasses include MATAIJCUSPARSE, MATAIJPERM, MATAIJSELL, MATAIJMKL, MATAIJCRL, and also automatically switches over to use inodes when
+    Subclasses include MATAIJCUSPARSE, MATAIJPERM, MATAIJSELL, MATAIJSINGLE, MATAIJMKL, MATAIJCRL, and also automatically switches over to use inodes when
    enough exist.
 
   Level: beginner
@@ -4388,6 +5001,16 @@ PETSC_EXTERN PetscErrorCode MatCreate_SeqAIJ(Mat B)
   b->idiagvalid         = PETSC_FALSE;
   b->ibdiagvalid        = PETSC_FALSE;
   b->keepnonzeropattern = PETSC_FALSE;
+  b->nthreads           = 1;
+  b->threadrows         = NULL;
+  b->levelptr           = NULL;
+  b->levelrows          = NULL;
+  b->compressidx        = PETSC_FALSE;
+  b->cj                 = NULL;
+  b->cjbase             = NULL;
+  b->autotune           = PETSC_FALSE;
+  b->autotune_its       = 10;
+  b->autotuned          = NULL;
 
   ierr = PetscObjectChangeTypeName((PetscObject)B,MATSEQAIJ);CHKERRQ(ierr);
   ierr = PetscObjectComposeFunction((PetscObject)B,"MatSeqAIJGetArray_C",MatSeqAIJGetArray_SeqAIJ);CHKERRQ(ierr);
@@ -4405,6 +5028,7 @@ PETSC_EXTERN PetscErrorCode MatCreate_SeqAIJ(Mat B)
   ierr = PetscObjectComposeFunction((PetscObject)B,"MatConvert_seqaij_seqbaij_C",MatConvert_SeqAIJ_SeqBAIJ);CHKERRQ(ierr);
   ierr = PetscObjectComposeFunction((PetscObject)B,"MatConvert_seqaij_seqaijperm_C",MatConvert_SeqAIJ_SeqAIJPERM);CHKERRQ(ierr);
   ierr = PetscObjectComposeFunction((PetscObject)B,"MatConvert_seqaij_seqaijsell_C",MatConvert_SeqAIJ_SeqAIJSELL);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)B,"MatConvert_seqaij_seqaijsingle_C",MatConvert_SeqAIJ_SeqAIJSingle);CHKERRQ(ierr);
 #if defined(PETSC_HAVE_MKL_SPARSE)
   ierr = PetscObjectComposeFunction((PetscObject)B,"MatConvert_seqaij_seqaijmkl_C",MatConvert_SeqAIJ_SeqAIJMKL);CHKERRQ(ierr);
 #endif
@@ -4426,6 +5050,7 @@ PETSC_EXTERN PetscErrorCode MatCreate_SeqAIJ(Mat B)
   ierr = PetscObjectComposeFunction((PetscObject)B,"MatIsTranspose_C",MatIsTranspose_SeqAIJ);CHKERRQ(ierr);
   ierr = PetscObjectComposeFunction((PetscObject)B,"MatIsHermitianTranspose_C",MatIsTranspose_SeqAIJ);CHKERRQ(ierr);
   ierr = PetscObjectComposeFunction((PetscObject)B,"MatSeqAIJSetPreallocation_C",MatSeqAIJSetPreallocation_SeqAIJ);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)B,"MatSORDense_C",MatSORDense_SeqAIJ);CHKERRQ(ierr);
   ierr = PetscObjectComposeFunction((PetscObject)B,"MatResetPreallocation_C",MatResetPreallocation_SeqAIJ);CHKERRQ(ierr);
   ierr = PetscObjectComposeFunction((PetscObject)B,"MatSeqAIJSetPreallocationCSR_C",MatSeqAIJSetPreallocationCSR_SeqAIJ);CHKERRQ(ierr);
   ierr = PetscObjectComposeFunction((PetscObject)B,"MatReorderForNonzeroDiagonal_C",MatReorderForNonzeroDiagonal_SeqAIJ);CHKERRQ(ierr);
@@ -4523,6 +5148,13 @@ PetscErrorCode MatDuplicateNoCreate_SeqAIJ(Mat C,Mat A,MatDuplicateOption cpvalu
   }
   c->nonzerorowcnt = a->nonzerorowcnt;
   C->nonzerostate  = A->nonzerostate;
+  c->nthreads      = a->nthreads;
+  c->compressidx   = a->compressidx;
+  c->autotune      = a->autotune;
+  c->autotune_its  = a->autotune_its;
+  if (mallocmatspace) {
+    ierr = MatSeqAIJCompressIndices_Private(C);CHKERRQ(ierr);
+  }
 
   ierr = MatDuplicate_SeqAIJ_Inode(A,cpvalues,&C);CHKERRQ(ierr);
   ierr = PetscFunctionListDuplicate(((PetscObject)A)->qlist,&((PetscObject)C)->qlist);CHKERRQ(ierr);
@@ -5026,6 +5658,7 @@ PetscErrorCode  MatSeqAIJRegisterAll(void)
   ierr = MatSeqAIJRegister(MATSEQAIJCRL,      MatConvert_SeqAIJ_SeqAIJCRL);CHKERRQ(ierr);
   ierr = MatSeqAIJRegister(MATSEQAIJPERM,     MatConvert_SeqAIJ_SeqAIJPERM);CHKERRQ(ierr);
   ierr = MatSeqAIJRegister(MATSEQAIJSELL,     MatConvert_SeqAIJ_SeqAIJSELL);CHKERRQ(ierr);
+  ierr = MatSeqAIJRegister(MATSEQAIJSINGLE,   MatConvert_SeqAIJ_SeqAIJSingle);CHKERRQ(ierr);
 #if defined(PETSC_HAVE_MKL_SPARSE)
   ierr = MatSeqAIJRegister(MATSEQAIJMKL,      MatConvert_SeqAIJ_SeqAIJMKL);CHKERRQ(ierr);
 #endif
@@ -4,6 +4,7 @@
 
 #include <petsc/private/matimpl.h>
 #include <petscctable.h>
+#include <petsc/private/hashmapijv.h>
 
 /*
     Struct header shared by SeqAIJ, SeqBAIJ and SeqSBAIJ matrix formats
@@ -130,6 +131,24 @@ typedef struct {
   Mat_RARt            *rart;               /* used by MatRARt() */
   Mat_MatMatTransMult *abt;                /* used by MatMatTransposeMult() */
   Mat_MatTransMatMult *atb;                /* used by MatTransposeMatMult() */
+
+  PetscInt            nthreads;            /* number of OpenMP threads used by MatMult(), MatMultAdd() and products, set with -mat_aij_threads */
+  PetscInt            *threadrows;         /* rows [threadrows[t],threadrows[t+1]) are processed by thread t; balanced by number of nonzeros */
+  PetscObjectState    threadrows_state;    /* nonzero state of the matrix when threadrows[] was computed */
+  PetscInt            nlevels[2];          /* number of level sets of the L and U parts of a factor, used by the threaded MatSolve() */
+  PetscInt            *levelptr;           /* level l (those of L first, then those of U) is rows levelrows[levelptr[l]:levelptr[l+1]] */
+  PetscInt            *levelrows;          /* rows of L then rows of U, sorted by level; NULL if the solves are not threaded */
+
+  PetscBool           compressidx;         /* use 16-bit column offsets in MatMult() and MatMultAdd(), set with -mat_aij_compress_indices */
+  unsigned short      *cj;                 /* column of each nonzero minus cjbase[] of its row; NULL if some row spans too many columns */
+  PetscInt            *cjbase;             /* smallest column of each row */
+  PetscObjectState    cj_state;            /* nonzero state of the matrix when cj[] was built */
+
+  PetscBool           autotune;            /* select the fastest MatMult() format at assembly, set with -mat_aij_autotune */
+  PetscInt            autotune_its;        /* number of MatMult() timed for each candidate format */
+  MatType             autotuned;           /* format selected by the last autotuning, NULL if none */
+
+  PetscHMapIJV        ht;                  /* entries set before the first assembly with MAT_USE_HASH_TABLE, compressed at assembly */
 } Mat_SeqAIJ;
 
 /*
@@ -217,6 +236,8 @@ PETSC_STATIC_INLINE PetscErrorCode MatSeqXAIJFreeAIJ(Mat AA,MatScalar **a,PetscI
   } \
 
 PETSC_INTERN PetscErrorCode MatSeqAIJSetPreallocation_SeqAIJ(Mat,PetscInt,const PetscInt*);
+PETSC_INTERN PetscErrorCode MatGetFactor_seqaij_petsc(Mat,MatFactorType,Mat*);
+PETSC_INTERN PetscErrorCode MatGetFactor_SeqAIJ_Private(Mat,MatFactorType,Mat*);
 PETSC_INTERN PetscErrorCode MatILUFactorSymbolic_SeqAIJ_inplace(Mat,Mat,IS,IS,const MatFactorInfo*);
 PETSC_INTERN PetscErrorCode MatILUFactorSymbolic_SeqAIJ(Mat,Mat,IS,IS,const MatFactorInfo*);
 PETSC_INTERN PetscErrorCode MatILUFactorSymbolic_SeqAIJ_ilu0(Mat,Mat,IS,IS,const MatFactorInfo*);
@@ -233,11 +254,15 @@ PETSC_INTERN PetscErrorCode MatMissingDiagonal_SeqAIJ(Mat,PetscBool*,PetscInt*);
 PETSC_INTERN PetscErrorCode MatMarkDiagonal_SeqAIJ(Mat);
 PETSC_INTERN PetscErrorCode MatFindZeroDiagonals_SeqAIJ_Private(Mat,PetscInt*,PetscInt**);
 
+PETSC_INTERN PetscErrorCode MatSeqAIJPartitionRows_Private(PetscInt,const PetscInt[],PetscInt,PetscInt[]);
+PETSC_INTERN PetscErrorCode MatSeqAIJFactorLevels_Private(Mat);
 PETSC_INTERN PetscErrorCode MatMult_SeqAIJ(Mat A,Vec,Vec);
 PETSC_INTERN PetscErrorCode MatMultAdd_SeqAIJ(Mat A,Vec,Vec,Vec);
 PETSC_INTERN PetscErrorCode MatMultTranspose_SeqAIJ(Mat A,Vec,Vec);
 PETSC_INTERN PetscErrorCode MatMultTransposeAdd_SeqAIJ(Mat A,Vec,Vec,Vec);
 PETSC_INTERN PetscErrorCode MatSOR_SeqAIJ(Mat,Vec,PetscReal,MatSORType,PetscReal,PetscInt,PetscInt,Vec);
+PETSC_INTERN PetscErrorCode MatSORDense_SeqAIJ(Mat,Mat,PetscReal,MatSORType,PetscReal,PetscInt,PetscInt,Mat);
+PETSC_INTERN PetscErrorCode MatInvertDiagonal_SeqAIJ(Mat,PetscScalar,PetscScalar);
 
 PETSC_INTERN PetscErrorCode MatSetOption_SeqAIJ(Mat,MatOption,PetscBool);
 
@@ -306,6 +331,7 @@ PETSC_INTERN PetscErrorCode MatMatMultNumeric_SeqDense_SeqAIJ(Mat,Mat,Mat);
 PETSC_INTERN PetscErrorCode MatMatMultNumeric_SeqAIJ_SeqAIJ_Scalable(Mat,Mat,Mat);
 
 PETSC_INTERN PetscErrorCode MatPtAPSymbolic_SeqAIJ_SeqAIJ_SparseAxpy(Mat,Mat,PetscReal,Mat);
+PETSC_INTERN PetscErrorCode MatProductSymbolicCached_SeqAIJ_SeqAIJ(const char[],MatProductAlgorithm,Mat,Mat,PetscReal,Mat,PetscErrorCode (*)(Mat,Mat,PetscReal,Mat));
 PETSC_INTERN PetscErrorCode MatPtAPNumeric_SeqAIJ_SeqAIJ(Mat,Mat,Mat);
 PETSC_INTERN PetscErrorCode MatPtAPNumeric_SeqAIJ_SeqAIJ_SparseAxpy(Mat,Mat,Mat);
 
@@ -334,6 +360,9 @@ PETSC_INTERN PetscErrorCode MatMatMatMultNumeric_SeqAIJ_SeqAIJ_SeqAIJ(Mat,Mat,Ma
 
 PETSC_INTERN PetscErrorCode MatSetRandomSkipColumnRange_SeqAIJ_Private(Mat,PetscInt,PetscInt,PetscRandom);
 PETSC_INTERN PetscErrorCode MatSetValues_SeqAIJ(Mat,PetscInt,const PetscInt[],PetscInt,const PetscInt[],const PetscScalar[],InsertMode);
+PETSC_INTERN PetscErrorCode MatSetValues_SeqAIJ_Hash(Mat,PetscInt,const PetscInt[],PetscInt,const PetscInt[],const PetscScalar[],InsertMode);
+PETSC_INTERN PetscErrorCode MatSeqAIJSetUseHash_Private(Mat,PetscBool);
+PETSC_INTERN PetscErrorCode MatSeqAIJCompressHash_Private(Mat);
 PETSC_INTERN PetscErrorCode MatGetRow_SeqAIJ(Mat,PetscInt,PetscInt*,PetscInt**,PetscScalar**);
 PETSC_INTERN PetscErrorCode MatRestoreRow_SeqAIJ(Mat,PetscInt,PetscInt*,PetscInt**,PetscScalar**);
 PETSC_INTERN PetscErrorCode MatScale_SeqAIJ(Mat,PetscScalar);
@@ -369,6 +398,8 @@ PETSC_INTERN PetscErrorCode MatConvert_SeqAIJ_Elemental(Mat,MatType,MatReuse,Mat
 PETSC_INTERN PetscErrorCode MatConvert_AIJ_HYPRE(Mat,MatType,MatReuse,Mat*);
 PETSC_INTERN PetscErrorCode MatConvert_SeqAIJ_SeqAIJPERM(Mat,MatType,MatReuse,Mat*);
 PETSC_INTERN PetscErrorCode MatConvert_SeqAIJ_SeqAIJSELL(Mat,MatType,MatReuse,Mat*);
+PETSC_INTERN PetscErrorCode MatConvert_SeqAIJ_SeqAIJSingle(Mat,MatType,MatReuse,Mat*);
+PETSC_INTERN PetscErrorCode MatSeqAIJSingleConvertFactor_Private(Mat*);
 PETSC_INTERN PetscErrorCode MatConvert_SeqAIJ_SeqAIJMKL(Mat,MatType,MatReuse,Mat*);
 PETSC_INTERN PetscErrorCode MatConvert_SeqAIJ_SeqAIJViennaCL(Mat,MatType,MatReuse,Mat*);
 PETSC_INTERN PetscErrorCode MatReorderForNonzeroDiagonal_SeqAIJ(Mat,PetscReal,IS,IS);
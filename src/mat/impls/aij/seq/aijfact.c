@@ -89,7 +89,8 @@ PetscErrorCode MatGetOrdering_Flow_SeqAIJ(Mat mat,MatOrderingType type,IS *irow,
   PetscFunctionReturn(0);
 }
 
-PETSC_INTERN PetscErrorCode MatGetFactor_seqaij_petsc(Mat A,MatFactorType ftype,Mat *B)
+/* creates the SeqAIJ or SeqSBAIJ factor matrix, for factorization packages that build on the PETSc factorizations */
+PETSC_INTERN PetscErrorCode MatGetFactor_SeqAIJ_Private(Mat A,MatFactorType ftype,Mat *B)
 {
   PetscInt       n = A->rmap->n;
   PetscErrorCode ierr;
@@ -121,6 +122,21 @@ PETSC_INTERN PetscErrorCode MatGetFactor_seqaij_petsc(Mat A,MatFactorType ftype,
   PetscFunctionReturn(0);
 }
 
+PETSC_INTERN PetscErrorCode MatGetFactor_seqaij_petsc(Mat A,MatFactorType ftype,Mat *B)
+{
+  PetscBool      single;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MatGetFactor_SeqAIJ_Private(A,ftype,B);CHKERRQ(ierr);
+  /* MATSEQAIJSINGLE is found through its MATSEQAIJ registration; its LU and ILU factors keep a single precision copy */
+  ierr = PetscObjectTypeCompare((PetscObject)A,MATSEQAIJSINGLE,&single);CHKERRQ(ierr);
+  if (single && (ftype == MAT_FACTOR_LU || ftype == MAT_FACTOR_ILU)) {
+    ierr = MatSeqAIJSingleConvertFactor_Private(B);CHKERRQ(ierr);
+  }
+  PetscFunctionReturn(0);
+}
+
 PetscErrorCode MatLUFactorSymbolic_SeqAIJ_inplace(Mat B,Mat A,IS isrow,IS iscol,const MatFactorInfo *info)
 {
   Mat_SeqAIJ         *a = (Mat_SeqAIJ*)A->data,*b;
@@ -587,7 +603,8 @@ PetscErrorCode MatLUFactorNumeric_SeqAIJ(Mat B,Mat A,const MatFactorInfo *info)
 
   ierr = ISIdentity(isrow,&row_identity);CHKERRQ(ierr);
   ierr = ISIdentity(isicol,&col_identity);CHKERRQ(ierr);
-  if (b->inode.size) {
+  ierr = MatSeqAIJFactorLevels_Private(C);CHKERRQ(ierr);
+  if (b->inode.size && !b->levelrows) {
     C->ops->solve = MatSolve_SeqAIJ_Inode;
   } else if (row_identity && col_identity) {
     C->ops->solve = MatSolve_SeqAIJ_NaturalOrdering;
@@ -3108,6 +3125,132 @@ PetscErrorCode MatCholeskyFactorSymbolic_SeqAIJ_inplace(Mat fact,Mat A,IS perm,c
   PetscFunctionReturn(0);
 }
 
+/*
+    With -mat_aij_threads computes the level sets of the L and U parts of the factor A: a row of L is in
+    level 0 if it has no off-diagonal entries and otherwise one level after the last of the rows it references,
+    similarly for U going backward. The rows of one level do not depend on each other so MatSolve() can process
+    them concurrently. The levels are not used if they are too small to amortize the synchronization between them.
+*/
+PetscErrorCode MatSeqAIJFactorLevels_Private(Mat A)
+{
+  Mat_SeqAIJ     *a = (Mat_SeqAIJ*)A->data;
+  PetscErrorCode ierr;
+  PetscInt       n = A->rmap->n,*ai = a->i,*aj = a->j,*adiag = a->diag;
+  PetscInt       *level,*cnt,i,k,nl,nu,*lptr,*lrows;
+
+  PetscFunctionBegin;
+  ierr = PetscFree2(a->levelptr,a->levelrows);CHKERRQ(ierr);
+#if defined(PETSC_HAVE_OPENMP)
+  if (a->nthreads < 2 || !n) PetscFunctionReturn(0);
+  ierr = PetscMalloc2(n,&level,n+1,&cnt);CHKERRQ(ierr);
+  /* levels of L; the entries of row i are aj[ai[i]:ai[i+1]] */
+  nl = 0;
+  for (i=0; i<n; i++) {
+    level[i] = 0;
+    for (k=ai[i]; k<ai[i+1]; k++) level[i] = PetscMax(level[i],level[aj[k]]+1);
+    nl = PetscMax(nl,level[i]+1);
+  }
+  /* levels of U are stored after those of L; the off-diagonal entries of row i are aj[adiag[i+1]+1:adiag[i]] */
+  nu = 0;
+  for (i=n-1; i>=0; i--) {
+    PetscInt lev = 0;
+    for (k=adiag[i+1]+1; k<adiag[i]; k++) lev = PetscMax(lev,level[aj[k]]-nl+1);
+    level[i] = nl + lev;
+    nu = PetscMax(nu,lev+1);
+  }
+  if (n < 8*a->nthreads*PetscMax(nl,nu)) {
+    ierr = PetscInfo4(A,"Not threading the triangular solves: %D rows in %D levels for L and %D for U is too few for %D threads\n",n,nl,nu,a->nthreads);CHKERRQ(ierr);
+    ierr = PetscFree2(level,cnt);CHKERRQ(ierr);
+    PetscFunctionReturn(0);
+  }
+  ierr = PetscMalloc2(nl+nu+1,&lptr,2*n,&lrows);CHKERRQ(ierr);
+  ierr = PetscLogObjectMemory((PetscObject)A,(nl+nu+1+2*n)*sizeof(PetscInt));CHKERRQ(ierr);
+  /* bucket sort the rows by level, in increasing order within a level; the L levels are recomputed since level[] now holds those of U */
+  ierr = PetscArrayzero(lptr,nl+nu+1);CHKERRQ(ierr);
+  for (i=0; i<n; i++) {
+    cnt[i] = 0;
+    for (k=ai[i]; k<ai[i+1]; k++) cnt[i] = PetscMax(cnt[i],cnt[aj[k]]+1);
+    lptr[cnt[i]+1]++;
+    lptr[level[i]+1]++;
+  }
+  for (k=0; k<nl+nu; k++) lptr[k+1] += lptr[k];
+  for (i=0; i<n; i++) {
+    lrows[lptr[cnt[i]]++]   = i;
+    lrows[lptr[level[i]]++] = i;
+  }
+  for (k=nl+nu; k>0; k--) lptr[k] = lptr[k-1];
+  lptr[0] = 0;
+  ierr = PetscFree2(level,cnt);CHKERRQ(ierr);
+  a->nlevels[0] = nl;
+  a->nlevels[1] = nu;
+  a->levelptr   = lptr;
+  a->levelrows  = lrows;
+  ierr = PetscInfo4(A,"Threading the triangular solves over %D levels for L and %D for U of %D rows with %D threads\n",nl,nu,n,a->nthreads);CHKERRQ(ierr);
+#endif
+  PetscFunctionReturn(0);
+}
+
+#if defined(PETSC_HAVE_OPENMP)
+/*
+    MatSolve_SeqAIJ() and MatSolve_SeqAIJ_NaturalOrdering() (r and c NULL) with the rows of each level set,
+    see MatSeqAIJFactorLevels_Private(), split among the a->nthreads OpenMP threads
+*/
+static PetscErrorCode MatSolve_SeqAIJ_Levels_OpenMP(Mat A,const PetscInt *r,const PetscInt *c,Vec bb,Vec xx)
+{
+  Mat_SeqAIJ        *a = (Mat_SeqAIJ*)A->data;
+  PetscErrorCode    ierr;
+  const PetscInt    *ai = a->i,*aj = a->j,*adiag = a->diag,*lptr = a->levelptr,*lrows = a->levelrows;
+  PetscInt          nl = a->nlevels[0],nu = a->nlevels[1];
+  PetscScalar       *x,*tmp;
+  const PetscScalar *b;
+  const MatScalar   *aa = a->a;
+
+  PetscFunctionBegin;
+  ierr = VecGetArrayRead(bb,&b);CHKERRQ(ierr);
+  ierr = VecGetArrayWrite(xx,&x);CHKERRQ(ierr);
+  tmp  = r ? a->solve_work : x;
+#pragma omp parallel num_threads((int)a->nthreads)
+  {
+    const PetscInt  *vi;
+    const MatScalar *v;
+    PetscScalar     sum;
+    PetscInt        l,k,i,nz;
+
+    /* forward solve the lower triangular, one level after the other */
+    for (l=0; l<nl; l++) {
+#pragma omp for schedule(static)
+      for (k=lptr[l]; k<lptr[l+1]; k++) {
+        i   = lrows[k];
+        nz  = ai[i+1] - ai[i];
+        v   = aa + ai[i];
+        vi  = aj + ai[i];
+        sum = r ? b[r[i]] : b[i];
+        PetscSparseDenseMinusDot(sum,tmp,v,vi,nz);
+        tmp[i] = sum;
+      }
+    }
+    /* backward solve the upper triangular */
+    for (l=nl; l<nl+nu; l++) {
+#pragma omp for schedule(static)
+      for (k=lptr[l]; k<lptr[l+1]; k++) {
+        i   = lrows[k];
+        v   = aa + adiag[i+1] + 1;
+        vi  = aj + adiag[i+1] + 1;
+        nz  = adiag[i] - adiag[i+1] - 1;
+        sum = tmp[i];
+        PetscSparseDenseMinusDot(sum,tmp,v,vi,nz);
+        tmp[i] = sum*v[nz]; /* v[nz] = aa[adiag[i]] */
+        if (c) x[c[i]] = tmp[i];
+      }
+    }
+  }
+  ierr = PetscLogFlops(2.0*a->nz - A->cmap->n);CHKERRQ(ierr);
+  ierr = VecRestoreArrayRead(bb,&b);CHKERRQ(ierr);
+  ierr = VecRestoreArrayWrite(xx,&x);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+#endif
+
 PetscErrorCode MatSolve_SeqAIJ_NaturalOrdering(Mat A,Vec bb,Vec xx)
 {
   Mat_SeqAIJ        *a = (Mat_SeqAIJ*)A->data;
@@ -3121,6 +3264,12 @@ PetscErrorCode MatSolve_SeqAIJ_NaturalOrdering(Mat A,Vec bb,Vec xx)
 
   PetscFunctionBegin;
   if (!n) PetscFunctionReturn(0);
+#if defined(PETSC_HAVE_OPENMP)
+  if (a->levelrows) {
+    ierr = MatSolve_SeqAIJ_Levels_OpenMP(A,NULL,NULL,bb,xx);CHKERRQ(ierr);
+    PetscFunctionReturn(0);
+  }
+#endif
 
   ierr = VecGetArrayRead(bb,&b);CHKERRQ(ierr);
   ierr = VecGetArrayWrite(xx,&x);CHKERRQ(ierr);
@@ -3167,6 +3316,16 @@ PetscErrorCode MatSolve_SeqAIJ(Mat A,Vec bb,Vec xx)
 
   PetscFunctionBegin;
   if (!n) PetscFunctionReturn(0);
+#if defined(PETSC_HAVE_OPENMP)
+  if (a->levelrows) {
+    ierr = ISGetIndices(isrow,&r);CHKERRQ(ierr);
+    ierr = ISGetIndices(iscol,&c);CHKERRQ(ierr);
+    ierr = MatSolve_SeqAIJ_Levels_OpenMP(A,r,c,bb,xx);CHKERRQ(ierr);
+    ierr = ISRestoreIndices(isrow,&r);CHKERRQ(ierr);
+    ierr = ISRestoreIndices(iscol,&c);CHKERRQ(ierr);
+    PetscFunctionReturn(0);
+  }
+#endif
 
   ierr = VecGetArrayRead(bb,&b);CHKERRQ(ierr);
   ierr = VecGetArrayWrite(xx,&x);CHKERRQ(ierr);
@@ -3424,6 +3583,7 @@ PetscErrorCode MatILUDTFactor_SeqAIJ(Mat A,IS isrow,IS iscol,const MatFactorInfo
 
   ierr = ISIdentity(isrow,&row_identity);CHKERRQ(ierr);
   ierr = ISIdentity(isicol,&icol_identity);CHKERRQ(ierr);
+  ierr = MatSeqAIJFactorLevels_Private(B);CHKERRQ(ierr);
   if (row_identity && icol_identity) {
     B->ops->solve = MatSolve_SeqAIJ_NaturalOrdering;
   } else {
@@ -3546,6 +3706,7 @@ PetscErrorCode  MatILUDTFactorNumeric_SeqAIJ(Mat fact,Mat A,const MatFactorInfo
 
   ierr = ISIdentity(isrow,&row_identity);CHKERRQ(ierr);
   ierr = ISIdentity(isicol,&col_identity);CHKERRQ(ierr);
+  ierr = MatSeqAIJFactorLevels_Private(C);CHKERRQ(ierr);
   if (row_identity && col_identity) {
     C->ops->solve = MatSolve_SeqAIJ_NaturalOrdering;
   } else {
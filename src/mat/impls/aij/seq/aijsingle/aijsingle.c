@@ -0,0 +1,654 @@
+/*
+  Defines basic operations for the MATSEQAIJSINGLE matrix class.
+  This class is derived from the MATSEQAIJ class, but maintains a "shadow" copy
+  of the matrix values in single precision, which is used by the products, the
+  SOR sweeps and the triangular solves of its LU and ILU factors. These operations
+  read half as many bytes of matrix values, while the vectors and all sums remain
+  in PetscScalar precision.
+*/
+
+#include <../src/mat/impls/aij/seq/aij.h>
+
+#if defined(PETSC_USE_COMPLEX)
+typedef PetscScalar MatScalarSingle; /* the type is not available for complex scalars, this only lets the file compile */
+#else
+typedef float       MatScalarSingle;
+#endif
+
+typedef struct {
+  MatScalarSingle  *sa;     /* single precision copy of the values of the matrix, or of its factor */
+  PetscInt         nsa;     /* length of sa */
+  PetscObjectState state;   /* state of the matrix when sa was last built */
+  PetscErrorCode   (*lufactornumeric)(Mat,Mat,const MatFactorInfo*); /* numeric factorization of the SeqAIJ factor */
+} Mat_SeqAIJSingle;
+
+PETSC_INTERN PetscErrorCode MatConvert_SeqAIJSingle_SeqAIJ(Mat A,MatType type,MatReuse reuse,Mat *newmat)
+{
+  /* This routine is only called to convert a MATSEQAIJSINGLE to its base PETSc type, */
+  /* so we will ignore 'MatType type'. */
+  PetscErrorCode   ierr;
+  Mat              B = *newmat;
+  Mat_SeqAIJSingle *aijsingle;
+
+  PetscFunctionBegin;
+  if (reuse == MAT_INITIAL_MATRIX) {
+    ierr = MatDuplicate(A,MAT_COPY_VALUES,&B);CHKERRQ(ierr);
+  }
+
+  /* Reset the original function pointers. */
+  B->ops->duplicate        = MatDuplicate_SeqAIJ;
+  B->ops->destroy          = MatDestroy_SeqAIJ;
+  B->ops->mult             = MatMult_SeqAIJ;
+  B->ops->multtranspose    = MatMultTranspose_SeqAIJ;
+  B->ops->multadd          = MatMultAdd_SeqAIJ;
+  B->ops->multtransposeadd = MatMultTransposeAdd_SeqAIJ;
+  B->ops->sor              = MatSOR_SeqAIJ;
+
+  ierr = PetscObjectComposeFunction((PetscObject)B,"MatConvert_seqaijsingle_seqaij_C",NULL);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)B,"MatSORDense_C",MatSORDense_SeqAIJ);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)B,"MatMatMultSymbolic_seqdense_seqaijsingle_C",NULL);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)B,"MatMatMultNumeric_seqdense_seqaijsingle_C",NULL);CHKERRQ(ierr);
+
+  aijsingle = (Mat_SeqAIJSingle*)B->spptr;
+  ierr      = PetscFree(aijsingle->sa);CHKERRQ(ierr);
+  ierr      = PetscFree(B->spptr);CHKERRQ(ierr);
+
+  ierr = PetscObjectChangeTypeName((PetscObject)B,MATSEQAIJ);CHKERRQ(ierr);
+  *newmat = B;
+  PetscFunctionReturn(0);
+}
+
+PetscErrorCode MatDestroy_SeqAIJSingle(Mat A)
+{
+  PetscErrorCode   ierr;
+  Mat_SeqAIJSingle *aijsingle = (Mat_SeqAIJSingle*)A->spptr;
+
+  PetscFunctionBegin;
+  /* If MatHeaderMerge() was used, then this SeqAIJSingle matrix will not have an spptr pointer. */
+  if (aijsingle) {
+    ierr = PetscFree(aijsingle->sa);CHKERRQ(ierr);
+    ierr = PetscFree(A->spptr);CHKERRQ(ierr);
+  }
+  ierr = PetscObjectComposeFunction((PetscObject)A,"MatConvert_seqaijsingle_seqaij_C",NULL);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)A,"MatMatMultSymbolic_seqdense_seqaijsingle_C",NULL);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)A,"MatMatMultNumeric_seqdense_seqaijsingle_C",NULL);CHKERRQ(ierr);
+  ierr = PetscObjectChangeTypeName((PetscObject)A,MATSEQAIJ);CHKERRQ(ierr);
+  ierr = MatDestroy_SeqAIJ(A);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/* Copies the first n values of A (all of them for an assembled matrix, the L and U parts for a factor) into the single precision shadow */
+static PetscErrorCode MatSeqAIJSingle_copy_values(Mat A,PetscInt n)
+{
+  PetscErrorCode   ierr;
+  Mat_SeqAIJ       *a = (Mat_SeqAIJ*)A->data;
+  Mat_SeqAIJSingle *aijsingle = (Mat_SeqAIJSingle*)A->spptr;
+  PetscInt         k;
+
+  PetscFunctionBegin;
+  if (n > aijsingle->nsa) {
+    ierr = PetscFree(aijsingle->sa);CHKERRQ(ierr);
+    ierr = PetscMalloc1(n,&aijsingle->sa);CHKERRQ(ierr);
+    ierr = PetscLogObjectMemory((PetscObject)A,(n-aijsingle->nsa)*sizeof(MatScalarSingle));CHKERRQ(ierr);
+    aijsingle->nsa = n;
+  }
+  for (k=0; k<n; k++) aijsingle->sa[k] = (MatScalarSingle)a->a[k];
+  PetscFunctionReturn(0);
+}
+
+/* Build or update the shadow values if and only if needed.
+ * We track the ObjectState to determine when this needs to be done. */
+PETSC_INTERN PetscErrorCode MatSeqAIJSingle_build_shadow(Mat A)
+{
+  PetscErrorCode   ierr;
+  Mat_SeqAIJ       *a = (Mat_SeqAIJ*)A->data;
+  Mat_SeqAIJSingle *aijsingle = (Mat_SeqAIJSingle*)A->spptr;
+  PetscObjectState state;
+
+  PetscFunctionBegin;
+  ierr = PetscObjectStateGet((PetscObject)A,&state);CHKERRQ(ierr);
+  if (aijsingle->sa && aijsingle->state == state) PetscFunctionReturn(0);
+
+  ierr = PetscLogEventBegin(MAT_Convert,A,0,0,0);CHKERRQ(ierr);
+  ierr = MatSeqAIJSingle_copy_values(A,a->i[A->rmap->n]);CHKERRQ(ierr);
+  ierr = PetscLogEventEnd(MAT_Convert,A,0,0,0);CHKERRQ(ierr);
+  aijsingle->state = state;
+  PetscFunctionReturn(0);
+}
+
+PetscErrorCode MatDuplicate_SeqAIJSingle(Mat A,MatDuplicateOption op,Mat *M)
+{
+  PetscErrorCode   ierr;
+  Mat_SeqAIJSingle *aijsingle_dest;
+
+  PetscFunctionBegin;
+  ierr = MatDuplicate_SeqAIJ(A,op,M);CHKERRQ(ierr);
+  /* We don't duplicate the shadow values -- they will be constructed as needed. */
+  aijsingle_dest = (Mat_SeqAIJSingle*)(*M)->spptr;
+  ierr = PetscFree(aijsingle_dest->sa);CHKERRQ(ierr);
+  aijsingle_dest->nsa = 0;
+  PetscFunctionReturn(0);
+}
+
+PetscErrorCode MatMultAdd_SeqAIJSingle(Mat A,Vec xx,Vec yy,Vec zz)
+{
+  Mat_SeqAIJ            *a = (Mat_SeqAIJ*)A->data;
+  Mat_SeqAIJSingle      *aijsingle = (Mat_SeqAIJSingle*)A->spptr;
+  PetscErrorCode        ierr;
+  PetscScalar           *z,sum;
+  const PetscScalar     *x,*y;
+  const MatScalarSingle *aa;
+  const PetscInt        *aj,*ii,*ridx = NULL;
+  PetscInt              m = A->rmap->n,n,i,k;
+  PetscBool             usecprow = a->compressedrow.use;
+
+  PetscFunctionBegin;
+  ierr = MatSeqAIJSingle_build_shadow(A);CHKERRQ(ierr);
+  ierr = VecGetArrayRead(xx,&x);CHKERRQ(ierr);
+  if (yy) {
+    ierr = VecGetArrayPair(yy,zz,(PetscScalar**)&y,&z);CHKERRQ(ierr);
+  } else {
+    ierr = VecGetArray(zz,&z);CHKERRQ(ierr);
+    y    = NULL;
+  }
+  ii = a->i;
+  if (usecprow) { /* use compressed row format */
+    if (!y) {
+      ierr = PetscArrayzero(z,m);CHKERRQ(ierr);
+    } else if (zz != yy) {
+      ierr = PetscArraycpy(z,y,m);CHKERRQ(ierr);
+    }
+    m    = a->compressedrow.nrows;
+    ii   = a->compressedrow.i;
+    ridx = a->compressedrow.rindex;
+    for (i=0; i<m; i++) {
+      n   = ii[i+1] - ii[i];
+      aj  = a->j + ii[i];
+      aa  = aijsingle->sa + ii[i];
+      sum = y ? z[ridx[i]] : 0.0;
+      for (k=0; k<n; k++) sum += aa[k]*x[aj[k]];
+      z[ridx[i]] = sum;
+    }
+  } else {
+    for (i=0; i<m; i++) {
+      n   = ii[i+1] - ii[i];
+      aj  = a->j + ii[i];
+      aa  = aijsingle->sa + ii[i];
+      sum = y ? y[i] : 0.0;
+      for (k=0; k<n; k++) sum += aa[k]*x[aj[k]];
+      z[i] = sum;
+    }
+  }
+  ierr = PetscLogFlops(y ? 2.0*a->nz : 2.0*a->nz - a->nonzerorowcnt);CHKERRQ(ierr);
+  ierr = VecRestoreArrayRead(xx,&x);CHKERRQ(ierr);
+  if (yy) {
+    ierr = VecRestoreArrayPair(yy,zz,(PetscScalar**)&y,&z);CHKERRQ(ierr);
+  } else {
+    ierr = VecRestoreArray(zz,&z);CHKERRQ(ierr);
+  }
+  PetscFunctionReturn(0);
+}
+
+PetscErrorCode MatMult_SeqAIJSingle(Mat A,Vec xx,Vec yy)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MatMultAdd_SeqAIJSingle(A,xx,NULL,yy);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+PetscErrorCode MatMultTransposeAdd_SeqAIJSingle(Mat A,Vec xx,Vec zz,Vec yy)
+{
+  Mat_SeqAIJ            *a = (Mat_SeqAIJ*)A->data;
+  Mat_SeqAIJSingle      *aijsingle = (Mat_SeqAIJSingle*)A->spptr;
+  PetscErrorCode        ierr;
+  PetscScalar           *y,alpha;
+  const PetscScalar     *x;
+  const MatScalarSingle *v;
+  const PetscInt        *idx,*ii,*ridx = NULL;
+  PetscInt              m = A->rmap->n,n,i,j;
+  PetscBool             usecprow = a->compressedrow.use;
+
+  PetscFunctionBegin;
+  ierr = MatSeqAIJSingle_build_shadow(A);CHKERRQ(ierr);
+  if (zz != yy) {ierr = VecCopy(zz,yy);CHKERRQ(ierr);}
+  ierr = VecGetArrayRead(xx,&x);CHKERRQ(ierr);
+  ierr = VecGetArray(yy,&y);CHKERRQ(ierr);
+  if (usecprow) {
+    m    = a->compressedrow.nrows;
+    ii   = a->compressedrow.i;
+    ridx = a->compressedrow.rindex;
+  } else {
+    ii = a->i;
+  }
+  for (i=0; i<m; i++) {
+    idx   = a->j + ii[i];
+    v     = aijsingle->sa + ii[i];
+    n     = ii[i+1] - ii[i];
+    alpha = usecprow ? x[ridx[i]] : x[i];
+    for (j=0; j<n; j++) y[idx[j]] += alpha*v[j];
+  }
+  ierr = PetscLogFlops(2.0*a->nz);CHKERRQ(ierr);
+  ierr = VecRestoreArrayRead(xx,&x);CHKERRQ(ierr);
+  ierr = VecRestoreArray(yy,&y);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+PetscErrorCode MatMultTranspose_SeqAIJSingle(Mat A,Vec xx,Vec yy)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = VecSet(yy,0.0);CHKERRQ(ierr);
+  ierr = MatMultTransposeAdd_SeqAIJSingle(A,xx,yy,yy);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/*
+   Same sweeps as MatSOR_SeqAIJ(), with the off-diagonal values read from the single precision copy; the
+   diagonal and its inverse are kept in PetscScalar. SOR_APPLY_UPPER and SOR_EISENSTAT use MatSOR_SeqAIJ().
+*/
+PetscErrorCode MatSOR_SeqAIJSingle(Mat A,Vec bb,PetscReal omega,MatSORType flag,PetscReal fshift,PetscInt its,PetscInt lits,Vec xx)
+{
+  Mat_SeqAIJ            *a = (Mat_SeqAIJ*)A->data;
+  Mat_SeqAIJSingle      *aijsingle = (Mat_SeqAIJSingle*)A->spptr;
+  PetscScalar           *x,sum,*t;
+  const MatScalar       *idiag;
+  const MatScalarSingle *v;
+  const PetscScalar     *b,*xb;
+  PetscErrorCode        ierr;
+  PetscInt              n,m = A->rmap->n,i,k;
+  const PetscInt        *idx,*diag;
+
+  PetscFunctionBegin;
+  if (flag == SOR_APPLY_UPPER || flag == SOR_APPLY_LOWER || (flag & SOR_EISENSTAT)) {
+    ierr = MatSOR_SeqAIJ(A,bb,omega,flag,fshift,its,lits,xx);CHKERRQ(ierr);
+    PetscFunctionReturn(0);
+  }
+  its = its*lits;
+
+  ierr = MatSeqAIJSingle_build_shadow(A);CHKERRQ(ierr);
+  if (fshift != a->fshift || omega != a->omega) a->idiagvalid = PETSC_FALSE; /* must recompute idiag[] */
+  if (!a->idiagvalid) {ierr = MatInvertDiagonal_SeqAIJ(A,omega,fshift);CHKERRQ(ierr);}
+  a->fshift = fshift;
+  a->omega  = omega;
+
+  diag  = a->diag;
+  t     = a->ssor_work;
+  idiag = a->idiag;
+
+  ierr = VecGetArray(xx,&x);CHKERRQ(ierr);
+  ierr = VecGetArrayRead(bb,&b);CHKERRQ(ierr);
+  /* We count flops by assuming the upper triangular and lower triangular parts have the same number of nonzeros */
+  if (flag & SOR_ZERO_INITIAL_GUESS) {
+    if (flag & SOR_FORWARD_SWEEP || flag & SOR_LOCAL_FORWARD_SWEEP) {
+      for (i=0; i<m; i++) {
+        n   = diag[i] - a->i[i];
+        idx = a->j + a->i[i];
+        v   = aijsingle->sa + a->i[i];
+        sum = b[i];
+        for (k=0; k<n; k++) sum -= v[k]*x[idx[k]];
+        t[i] = sum;
+        x[i] = sum*idiag[i];
+      }
+      xb   = t;
+      ierr = PetscLogFlops(a->nz);CHKERRQ(ierr);
+    } else xb = b;
+    if (flag & SOR_BACKWARD_SWEEP || flag & SOR_LOCAL_BACKWARD_SWEEP) {
+      for (i=m-1; i>=0; i--) {
+        n   = a->i[i+1] - diag[i] - 1;
+        idx = a->j + diag[i] + 1;
+        v   = aijsingle->sa + diag[i] + 1;
+        sum = xb[i];
+        for (k=0; k<n; k++) sum -= v[k]*x[idx[k]];
+        if (xb == b) {
+          x[i] = sum*idiag[i];
+        } else {
+          x[i] = (1-omega)*x[i] + sum*idiag[i];  /* omega in idiag */
+        }
+      }
+      ierr = PetscLogFlops(a->nz);CHKERRQ(ierr); /* assumes 1/2 in upper */
+    }
+    its--;
+  }
+  while (its--) {
+    if (flag & SOR_FORWARD_SWEEP || flag & SOR_LOCAL_FORWARD_SWEEP) {
+      for (i=0; i<m; i++) {
+        /* lower */
+        n   = diag[i] - a->i[i];
+        idx = a->j + a->i[i];
+        v   = aijsingle->sa + a->i[i];
+        sum = b[i];
+        for (k=0; k<n; k++) sum -= v[k]*x[idx[k]];
+        t[i] = sum;             /* save application of the lower-triangular part */
+        /* upper */
+        n   = a->i[i+1] - diag[i] - 1;
+        idx = a->j + diag[i] + 1;
+        v   = aijsingle->sa + diag[i] + 1;
+        for (k=0; k<n; k++) sum -= v[k]*x[idx[k]];
+        x[i] = (1. - omega)*x[i] + sum*idiag[i]; /* omega in idiag */
+      }
+      xb   = t;
+      ierr = PetscLogFlops(2.0*a->nz);CHKERRQ(ierr);
+    } else xb = b;
+    if (flag & SOR_BACKWARD_SWEEP || flag & SOR_LOCAL_BACKWARD_SWEEP) {
+      for (i=m-1; i>=0; i--) {
+        sum = xb[i];
+        if (xb == b) {
+          /* whole matrix (no checkpointing available), skipping the diagonal rather than adding it back */
+          n   = diag[i] - a->i[i];
+          idx = a->j + a->i[i];
+          v   = aijsingle->sa + a->i[i];
+          for (k=0; k<n; k++) sum -= v[k]*x[idx[k]];
+          n   = a->i[i+1] - diag[i] - 1;
+          idx = a->j + diag[i] + 1;
+          v   = aijsingle->sa + diag[i] + 1;
+          for (k=0; k<n; k++) sum -= v[k]*x[idx[k]];
+          x[i] = (1. - omega)*x[i] + sum*idiag[i];
+        } else { /* lower-triangular part has been saved, so only apply upper-triangular */
+          n   = a->i[i+1] - diag[i] - 1;
+          idx = a->j + diag[i] + 1;
+          v   = aijsingle->sa + diag[i] + 1;
+          for (k=0; k<n; k++) sum -= v[k]*x[idx[k]];
+          x[i] = (1. - omega)*x[i] + sum*idiag[i];  /* omega in idiag */
+        }
+      }
+      if (xb == b) {
+        ierr = PetscLogFlops(2.0*a->nz);CHKERRQ(ierr);
+      } else {
+        ierr = PetscLogFlops(a->nz);CHKERRQ(ierr); /* assumes 1/2 in upper */
+      }
+    }
+  }
+  ierr = VecRestoreArray(xx,&x);CHKERRQ(ierr);
+  ierr = VecRestoreArrayRead(bb,&b);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+PetscErrorCode MatSolve_SeqAIJSingle_NaturalOrdering(Mat A,Vec bb,Vec xx)
+{
+  Mat_SeqAIJ            *a = (Mat_SeqAIJ*)A->data;
+  Mat_SeqAIJSingle      *aijsingle = (Mat_SeqAIJSingle*)A->spptr;
+  PetscErrorCode        ierr;
+  PetscInt              n   = A->rmap->n;
+  const PetscInt        *ai = a->i,*aj = a->j,*adiag = a->diag,*vi;
+  PetscScalar           *x,sum;
+  const PetscScalar     *b;
+  const MatScalarSingle *aa = aijsingle->sa,*v;
+  PetscInt              i,k,nz;
+
+  PetscFunctionBegin;
+  if (!n) PetscFunctionReturn(0);
+
+  ierr = VecGetArrayRead(bb,&b);CHKERRQ(ierr);
+  ierr = VecGetArrayWrite(xx,&x);CHKERRQ(ierr);
+
+  /* forward solve the lower triangular */
+  x[0] = b[0];
+  v    = aa;
+  vi   = aj;
+  for (i=1; i<n; i++) {
+    nz  = ai[i+1] - ai[i];
+    sum = b[i];
+    for (k=0; k<nz; k++) sum -= v[k]*x[vi[k]];
+    v   += nz;
+    vi  += nz;
+    x[i] = sum;
+  }
+
+  /* backward solve the upper triangular */
+  for (i=n-1; i>=0; i--) {
+    v   = aa + adiag[i+1] + 1;
+    vi  = aj + adiag[i+1] + 1;
+    nz  = adiag[i] - adiag[i+1]-1;
+    sum = x[i];
+    for (k=0; k<nz; k++) sum -= v[k]*x[vi[k]];
+    x[i] = sum*v[nz]; /* v[nz] = aa[adiag[i]] */
+  }
+
+  ierr = PetscLogFlops(2.0*a->nz - A->cmap->n);CHKERRQ(ierr);
+  ierr = VecRestoreArrayRead(bb,&b);CHKERRQ(ierr);
+  ierr = VecRestoreArrayWrite(xx,&x);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+PetscErrorCode MatSolve_SeqAIJSingle(Mat A,Vec bb,Vec xx)
+{
+  Mat_SeqAIJ            *a = (Mat_SeqAIJ*)A->data;
+  Mat_SeqAIJSingle      *aijsingle = (Mat_SeqAIJSingle*)A->spptr;
+  IS                    iscol = a->col,isrow = a->row;
+  PetscErrorCode        ierr;
+  PetscInt              i,k,n = A->rmap->n,nz;
+  const PetscInt        *ai = a->i,*aj = a->j,*adiag = a->diag,*vi;
+  const PetscInt        *rout,*cout,*r,*c;
+  PetscScalar           *x,*tmp,sum;
+  const PetscScalar     *b;
+  const MatScalarSingle *aa = aijsingle->sa,*v;
+
+  PetscFunctionBegin;
+  if (!n) PetscFunctionReturn(0);
+
+  ierr = VecGetArrayRead(bb,&b);CHKERRQ(ierr);
+  ierr = VecGetArrayWrite(xx,&x);CHKERRQ(ierr);
+  tmp  = a->solve_work;
+
+  ierr = ISGetIndices(isrow,&rout);CHKERRQ(ierr); r = rout;
+  ierr = ISGetIndices(iscol,&cout);CHKERRQ(ierr); c = cout;
+
+  /* forward solve the lower triangular */
+  tmp[0] = b[r[0]];
+  v      = aa;
+  vi     = aj;
+  for (i=1; i<n; i++) {
+    nz  = ai[i+1] - ai[i];
+    sum = b[r[i]];
+    for (k=0; k<nz; k++) sum -= v[k]*tmp[vi[k]];
+    tmp[i] = sum;
+    v     += nz; vi += nz;
+  }
+
+  /* backward solve the upper triangular */
+  for (i=n-1; i>=0; i--) {
+    v   = aa + adiag[i+1]+1;
+    vi  = aj + adiag[i+1]+1;
+    nz  = adiag[i]-adiag[i+1]-1;
+    sum = tmp[i];
+    for (k=0; k<nz; k++) sum -= v[k]*tmp[vi[k]];
+    x[c[i]] = tmp[i] = sum*v[nz]; /* v[nz] = aa[adiag[i]] */
+  }
+
+  ierr = ISRestoreIndices(isrow,&rout);CHKERRQ(ierr);
+  ierr = ISRestoreIndices(iscol,&cout);CHKERRQ(ierr);
+  ierr = VecRestoreArrayRead(bb,&b);CHKERRQ(ierr);
+  ierr = VecRestoreArrayWrite(xx,&x);CHKERRQ(ierr);
+  ierr = PetscLogFlops(2*a->nz - A->cmap->n);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/*
+   Runs the numeric factorization of MATSEQAIJ and then, for the factors in the (non inplace) format that
+   MatSolve_SeqAIJ() and MatSolve_SeqAIJ_NaturalOrdering() use, copies the values of L and U to single precision
+*/
+static PetscErrorCode MatLUFactorNumeric_SeqAIJSingle(Mat B,Mat A,const MatFactorInfo *info)
+{
+  PetscErrorCode   ierr;
+  Mat_SeqAIJ       *b = (Mat_SeqAIJ*)B->data;
+  Mat_SeqAIJSingle *aijsingle = (Mat_SeqAIJSingle*)B->spptr;
+
+  PetscFunctionBegin;
+  ierr = (*aijsingle->lufactornumeric)(B,A,info);CHKERRQ(ierr);
+  if (B->ops->solve == MatSolve_SeqAIJ_NaturalOrdering) {
+    B->ops->solve = MatSolve_SeqAIJSingle_NaturalOrdering;
+  } else if (B->ops->solve == MatSolve_SeqAIJ) {
+    B->ops->solve = MatSolve_SeqAIJSingle;
+  }
+  if (B->ops->solve == MatSolve_SeqAIJSingle_NaturalOrdering || B->ops->solve == MatSolve_SeqAIJSingle) {
+    ierr = MatSeqAIJSingle_copy_values(B,B->rmap->n ? b->diag[0]+1 : 0);CHKERRQ(ierr);
+  } else {
+    ierr = PetscInfo(B,"Factor is not in a format with a single precision triangular solve, using the PetscScalar one\n");CHKERRQ(ierr);
+  }
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode MatLUFactorSymbolic_SeqAIJSingle(Mat B,Mat A,IS isrow,IS iscol,const MatFactorInfo *info)
+{
+  PetscErrorCode   ierr;
+  Mat_SeqAIJSingle *aijsingle = (Mat_SeqAIJSingle*)B->spptr;
+
+  PetscFunctionBegin;
+  ierr = MatLUFactorSymbolic_SeqAIJ(B,A,isrow,iscol,info);CHKERRQ(ierr);
+  aijsingle->lufactornumeric = B->ops->lufactornumeric;
+  B->ops->lufactornumeric    = MatLUFactorNumeric_SeqAIJSingle;
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode MatILUFactorSymbolic_SeqAIJSingle(Mat B,Mat A,IS isrow,IS iscol,const MatFactorInfo *info)
+{
+  PetscErrorCode   ierr;
+  Mat_SeqAIJSingle *aijsingle = (Mat_SeqAIJSingle*)B->spptr;
+
+  PetscFunctionBegin;
+  ierr = MatILUFactorSymbolic_SeqAIJ(B,A,isrow,iscol,info);CHKERRQ(ierr);
+  aijsingle->lufactornumeric = B->ops->lufactornumeric;
+  B->ops->lufactornumeric    = MatLUFactorNumeric_SeqAIJSingle;
+  PetscFunctionReturn(0);
+}
+
+/* The LU and ILU factors of MATSEQAIJSINGLE matrices are MATSEQAIJSINGLE matrices whose triangular solves use single precision values,
+   called by MatGetFactor_seqaij_petsc() on the unfactored SeqAIJ factor matrix */
+PETSC_INTERN PetscErrorCode MatSeqAIJSingleConvertFactor_Private(Mat *B)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MatConvert_SeqAIJ_SeqAIJSingle(*B,MATSEQAIJSINGLE,MAT_INPLACE_MATRIX,B);CHKERRQ(ierr);
+  (*B)->ops->lufactorsymbolic  = MatLUFactorSymbolic_SeqAIJSingle;
+  (*B)->ops->ilufactorsymbolic = MatILUFactorSymbolic_SeqAIJSingle;
+  PetscFunctionReturn(0);
+}
+
+/* MatConvert_SeqAIJ_SeqAIJSingle converts a SeqAIJ matrix into a
+ * SeqAIJSingle matrix.  This routine is called by the MatCreate_SeqAIJSingle()
+ * routine, but can also be used to convert an assembled SeqAIJ matrix
+ * into a SeqAIJSingle one. */
+PETSC_INTERN PetscErrorCode MatConvert_SeqAIJ_SeqAIJSingle(Mat A,MatType type,MatReuse reuse,Mat *newmat)
+{
+  PetscErrorCode   ierr;
+  Mat              B = *newmat;
+  Mat_SeqAIJ       *b;
+  Mat_SeqAIJSingle *aijsingle;
+  PetscBool        sametype;
+
+  PetscFunctionBegin;
+#if defined(PETSC_USE_COMPLEX)
+  SETERRQ(PetscObjectComm((PetscObject)A),PETSC_ERR_SUP,"MATSEQAIJSINGLE is not available for complex scalars");
+#endif
+  if (reuse == MAT_INITIAL_MATRIX) {
+    ierr = MatDuplicate(A,MAT_COPY_VALUES,&B);CHKERRQ(ierr);
+  }
+
+  ierr = PetscObjectTypeCompare((PetscObject)A,type,&sametype);CHKERRQ(ierr);
+  if (sametype) PetscFunctionReturn(0);
+
+  ierr     = PetscNewLog(B,&aijsingle);CHKERRQ(ierr);
+  b        = (Mat_SeqAIJ*)B->data;
+  B->spptr = (void*)aijsingle;
+
+  /* Disable use of the inode routines, including the inode triangular solves of the factors, so that the
+   * single precision ones are used instead. */
+  b->inode.use = PETSC_FALSE;
+
+  /* Set function pointers for methods that we inherit from AIJ but override. */
+  B->ops->duplicate        = MatDuplicate_SeqAIJSingle;
+  B->ops->destroy          = MatDestroy_SeqAIJSingle;
+  B->ops->mult             = MatMult_SeqAIJSingle;
+  B->ops->multtranspose    = MatMultTranspose_SeqAIJSingle;
+  B->ops->multadd          = MatMultAdd_SeqAIJSingle;
+  B->ops->multtransposeadd = MatMultTransposeAdd_SeqAIJSingle;
+  B->ops->sor              = MatSOR_SeqAIJSingle;
+
+  ierr = PetscObjectComposeFunction((PetscObject)B,"MatConvert_seqaijsingle_seqaij_C",MatConvert_SeqAIJSingle_SeqAIJ);CHKERRQ(ierr);
+  /* the sweeps on several vectors would use the double precision values */
+  ierr = PetscObjectComposeFunction((PetscObject)B,"MatSORDense_C",NULL);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)B,"MatMatMultSymbolic_seqdense_seqaijsingle_C",MatMatMultSymbolic_SeqDense_SeqAIJ);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)B,"MatMatMultNumeric_seqdense_seqaijsingle_C",MatMatMultNumeric_SeqDense_SeqAIJ);CHKERRQ(ierr);
+
+  ierr    = PetscObjectChangeTypeName((PetscObject)B,MATSEQAIJSINGLE);CHKERRQ(ierr);
+  *newmat = B;
+  PetscFunctionReturn(0);
+}
+
+/*@C
+   MatCreateSeqAIJSingle - Creates a sparse matrix of type SEQAIJSINGLE.
+   This type inherits from AIJ and is largely identical, but keeps a "shadow"
+   copy of the matrix values in single precision, which is used for MatMult, MatMultTranspose,
+   MatMultAdd, MatMultTransposeAdd and MatSOR, and in the triangular solves of its LU and ILU
+   factors. Vectors and sums remain in PetscScalar precision. It is meant for matrices that
+   are only needed to single precision accuracy, such as the matrix from which a preconditioner
+   is built.
+   Because SEQAIJSINGLE is a subtype of SEQAIJ, the option "-mat_seqaij_type seqaijsingle" can be used to make
+   sequential AIJ matrices default to being instances of MATSEQAIJSINGLE.
+
+   Collective
+
+   Input Parameters:
++  comm - MPI communicator, set to PETSC_COMM_SELF
+.  m - number of rows
+.  n - number of columns
+.  nz - number of nonzeros per row (same for all rows)
+-  nnz - array containing the number of nonzeros in the various rows
+         (possibly different for each row) or NULL
+
+   Output Parameter:
+.  A - the matrix
+
+   Notes:
+   If nnz is given then nz is ignored
+
+   The PetscScalar values are kept, and used by all other operations, so this format uses more
+   memory than MATSEQAIJ: with double precision scalars and 32 bit indices each nonzero takes 16
+   bytes instead of 12, and the values alone 1.5 times as much. What is saved is the memory traffic
+   of the operations above. Values outside the range of single precision overflow in these operations.
+
+   This type is not available for complex scalars.
+
+   Level: intermediate
+
+.seealso: MatCreate(), MatCreateMPIAIJSingle(), MatSetValues(), MATSEQAIJSINGLE
+@*/
+PetscErrorCode  MatCreateSeqAIJSingle(MPI_Comm comm,PetscInt m,PetscInt n,PetscInt nz,const PetscInt nnz[],Mat *A)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MatCreate(comm,A);CHKERRQ(ierr);
+  ierr = MatSetSizes(*A,m,n,m,n);CHKERRQ(ierr);
+  ierr = MatSetType(*A,MATSEQAIJSINGLE);CHKERRQ(ierr);
+  ierr = MatSeqAIJSetPreallocation_SeqAIJ(*A,nz,nnz);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/*MC
+   MATSEQAIJSINGLE - MATSEQAIJSINGLE = "seqaijsingle" - A sequential AIJ matrix whose products, SOR sweeps, and LU and ILU
+   triangular solves read a single precision copy of its values, while vectors and sums stay in PetscScalar precision.
+   The copy is kept in addition to the PetscScalar values, so the matrix needs about 1.5 times the memory of the values
+   of MATSEQAIJ. Not available for complex scalars.
+
+   Options Database Keys:
++ -mat_type seqaijsingle - sets the matrix type to "seqaijsingle" during a call to MatSetFromOptions()
+- -mat_seqaij_type seqaijsingle - makes the sequential AIJ matrices, for example the diagonal blocks of MATMPIAIJ, of this type
+
+  Level: intermediate
+
+.seealso: MatCreateSeqAIJSingle(), MATAIJSINGLE, MATMPIAIJSINGLE, MATSEQAIJ
+M*/
+PETSC_EXTERN PetscErrorCode MatCreate_SeqAIJSingle(Mat A)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MatSetType(A,MATSEQAIJ);CHKERRQ(ierr);
+  ierr = MatConvert_SeqAIJ_SeqAIJSingle(A,MATSEQAIJSINGLE,MAT_INPLACE_MATRIX,&A);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
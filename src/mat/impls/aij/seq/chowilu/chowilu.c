@@ -0,0 +1,354 @@
+/*
+   Fine-grained parallel incomplete LU factorization of Chow and Patel,
+
+     E. Chow and A. Patel, Fine-grained parallel incomplete LU factorization, SIAM J. Sci. Comput. 37 (2015).
+
+   The nonzeros of the incomplete factors L and U, on the sparsity pattern S computed by the usual
+   PETSc ILU(k) symbolic factorization, are the solution of the nonlinear equations
+
+       l_ij = (a_ij - sum_{k<j} l_ik u_kj)/u_jj    (i,j) in S, i > j
+       u_ij =  a_ij - sum_{k<i} l_ik u_kj          (i,j) in S, i <= j
+
+   which are solved with a few fixed-point sweeps in which every nonzero is updated independently.
+   The triangular solves are likewise replaced by a fixed number of Jacobi sweeps so that both the
+   numeric factorization and the application of the preconditioner are parallel over the rows.
+*/
+#include <../src/mat/impls/aij/seq/aij.h>
+
+typedef struct {
+  PetscInt  sweeps;          /* fixed-point sweeps in the numeric factorization */
+  PetscInt  solvesweeps;     /* Jacobi sweeps in each triangular solve, 0 means exact triangular solves */
+  PetscBool warmstart;       /* start the sweeps of a refactorization from the previous factors */
+  PetscBool factored;        /* the factors in a[] come from a previous numeric factorization */
+  PetscInt  nz;              /* number of nonzeros in the factors */
+  PetscInt  *apos;           /* location in the factors of each nonzero of A */
+  PetscInt  *ucolptr,*ucolrow,*ucolpos; /* U (with diagonal) stored by columns, ucolpos[] is the location in the factors */
+  MatScalar *aval;           /* A scattered into the nonzero pattern of the factors */
+  MatScalar *a,*anew;        /* current and next iterate of the factors, with the diagonal of U not inverted */
+  PetscScalar *work;
+} Mat_ChowILU;
+
+static PetscErrorCode MatChowILUReset_Private(Mat_ChowILU *chow)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscFree(chow->apos);CHKERRQ(ierr);
+  ierr = PetscFree3(chow->ucolptr,chow->ucolrow,chow->ucolpos);CHKERRQ(ierr);
+  ierr = PetscFree3(chow->aval,chow->a,chow->anew);CHKERRQ(ierr);
+  ierr = PetscFree(chow->work);CHKERRQ(ierr);
+  chow->factored = PETSC_FALSE;
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode MatDestroy_SeqAIJ_ChowILU(Mat A)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MatChowILUReset_Private((Mat_ChowILU*)A->spptr);CHKERRQ(ierr);
+  ierr = PetscFree(A->spptr);CHKERRQ(ierr);
+  ierr = PetscObjectComposeFunction((PetscObject)A,"MatFactorGetSolverType_C",NULL);CHKERRQ(ierr);
+  ierr = MatDestroy_SeqAIJ(A);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/*
+   sum_{k<kmax} l_ik u_kj from the current iterate x, merging row i of L with column j of U
+*/
+PETSC_STATIC_INLINE MatScalar MatChowILUDot_Private(PetscInt i,PetscInt j,PetscInt kmax,const PetscInt *bi,const PetscInt *bj,const PetscInt *ucolptr,const PetscInt *ucolrow,const PetscInt *ucolpos,const MatScalar *x)
+{
+  PetscInt  p = bi[i],pend = bi[i+1],q = ucolptr[j],qend = ucolptr[j+1],kl,ku;
+  MatScalar sum = 0.0;
+
+  while (p < pend && q < qend) {
+    kl = bj[p]; ku = ucolrow[q];
+    if (kl >= kmax || ku >= kmax) break;
+    if (kl == ku) {
+      sum += x[p]*x[ucolpos[q]];
+      p++; q++;
+    } else if (kl < ku) p++;
+    else q++;
+  }
+  return sum;
+}
+
+/*
+   One fixed-point update of all nonzeros in row i of L and U, reading the iterate x and writing y
+*/
+PETSC_STATIC_INLINE void MatChowILUSweepRow_Private(PetscInt i,const PetscInt *bi,const PetscInt *bj,const PetscInt *bdiag,const PetscInt *ucolptr,const PetscInt *ucolrow,const PetscInt *ucolpos,const MatScalar *aval,const MatScalar *x,MatScalar *y)
+{
+  PetscInt p,j;
+
+  for (p=bi[i]; p<bi[i+1]; p++) {
+    j    = bj[p];
+    y[p] = (aval[p] - MatChowILUDot_Private(i,j,j,bi,bj,ucolptr,ucolrow,ucolpos,x))/x[bdiag[j]];
+  }
+  for (p=bdiag[i+1]+1; p<=bdiag[i]; p++) {
+    y[p] = aval[p] - MatChowILUDot_Private(i,bj[p],i,bi,bj,ucolptr,ucolrow,ucolpos,x);
+  }
+}
+
+/*
+   Applies the factors with solvesweeps Jacobi sweeps for each of the unit lower triangular L and the upper triangular U;
+   this is the truncated Neumann series of the triangular inverses and hence a fixed linear operator.
+*/
+static PetscErrorCode MatSolve_SeqAIJ_ChowILU(Mat A,Vec bb,Vec xx)
+{
+  Mat_SeqAIJ        *b     = (Mat_SeqAIJ*)A->data;
+  Mat_ChowILU       *chow  = (Mat_ChowILU*)A->spptr;
+  const PetscInt    n      = A->rmap->n,*bi = b->i,*bj = b->j,*bdiag = b->diag,nsweeps = chow->solvesweeps;
+  const MatScalar   *aa    = b->a;
+  PetscInt          i,p,k;
+  PetscScalar       *t = b->solve_work,*y = chow->work,*ynew = chow->work+n,*swap,*x,sum;
+  const PetscScalar *bv;
+  const PetscInt    *r,*c;
+  PetscErrorCode    ierr;
+
+  PetscFunctionBegin;
+  if (!n) PetscFunctionReturn(0);
+  ierr = VecGetArrayRead(bb,&bv);CHKERRQ(ierr);
+  ierr = VecGetArrayWrite(xx,&x);CHKERRQ(ierr);
+  ierr = ISGetIndices(b->row,&r);CHKERRQ(ierr);
+  ierr = ISGetIndices(b->col,&c);CHKERRQ(ierr);
+
+  for (i=0; i<n; i++) y[i] = t[i] = bv[r[i]];
+  /* L y = t */
+  for (k=0; k<nsweeps; k++) {
+#if defined(PETSC_HAVE_OPENMP)
+#pragma omp parallel for num_threads((int)b->nthreads) schedule(static) private(p,sum) if(b->nthreads > 1)
+#endif
+    for (i=0; i<n; i++) {
+      sum = t[i];
+      for (p=bi[i]; p<bi[i+1]; p++) sum -= aa[p]*y[bj[p]];
+      ynew[i] = sum;
+    }
+    swap = y; y = ynew; ynew = swap;
+  }
+  /* U x = y, the iterates go into t and ynew which are no longer needed */
+  for (i=0; i<n; i++) t[i] = aa[bdiag[i]]*y[i];
+  for (k=0; k<nsweeps; k++) {
+#if defined(PETSC_HAVE_OPENMP)
+#pragma omp parallel for num_threads((int)b->nthreads) schedule(static) private(p,sum) if(b->nthreads > 1)
+#endif
+    for (i=0; i<n; i++) {
+      sum = y[i];
+      for (p=bdiag[i+1]+1; p<bdiag[i]; p++) sum -= aa[p]*t[bj[p]];
+      ynew[i] = aa[bdiag[i]]*sum;
+    }
+    swap = t; t = ynew; ynew = swap;
+  }
+  for (i=0; i<n; i++) x[c[i]] = t[i];
+
+  ierr = ISRestoreIndices(b->row,&r);CHKERRQ(ierr);
+  ierr = ISRestoreIndices(b->col,&c);CHKERRQ(ierr);
+  ierr = VecRestoreArrayRead(bb,&bv);CHKERRQ(ierr);
+  ierr = VecRestoreArrayWrite(xx,&x);CHKERRQ(ierr);
+  ierr = PetscLogFlops(nsweeps*(2.0*chow->nz - n) + n);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode MatLUFactorNumeric_SeqAIJ_ChowILU(Mat B,Mat A,const MatFactorInfo *info)
+{
+  Mat_SeqAIJ      *a = (Mat_SeqAIJ*)A->data,*b = (Mat_SeqAIJ*)B->data;
+  Mat_ChowILU     *chow = (Mat_ChowILU*)B->spptr;
+  const PetscInt  n = A->rmap->n,nz = chow->nz,*bi = b->i,*bj = b->j,*bdiag = b->diag,*apos = chow->apos;
+  const PetscInt  *ucolptr = chow->ucolptr,*ucolrow = chow->ucolrow,*ucolpos = chow->ucolpos;
+  const MatScalar *aa = a->a;
+  MatScalar       *aval = chow->aval,*x = chow->a,*y = chow->anew,*swap;
+  PetscInt        i,p,k;
+  PetscBool       row_identity,col_identity;
+  FactorShiftCtx  sctx;
+  PetscErrorCode  ierr;
+
+  PetscFunctionBegin;
+  ierr = PetscMemzero(&sctx,sizeof(FactorShiftCtx));CHKERRQ(ierr);
+
+  /* scatter the (permuted) values of A into the pattern of the factors */
+  ierr = PetscArrayzero(aval,nz);CHKERRQ(ierr);
+  for (p=0; p<a->i[n]; p++) aval[apos[p]] = aa[p];
+  for (i=0; i<n; i++) {
+    sctx.pv = aval[bdiag[i]];
+    ierr    = MatPivotCheck_none(B,A,info,&sctx,i);CHKERRQ(ierr);
+    if (B->factorerrortype) PetscFunctionReturn(0);
+  }
+
+  /* initial guess L = (lower part of A) diag(A)^{-1}, U = upper part of A, unless the previous factors are reused */
+  if (!chow->warmstart || !chow->factored) {
+    for (i=0; i<n; i++) {
+      for (p=bi[i]; p<bi[i+1]; p++) x[p] = aval[p]/aval[bdiag[bj[p]]];
+      for (p=bdiag[i+1]+1; p<=bdiag[i]; p++) x[p] = aval[p];
+    }
+  }
+
+  for (k=0; k<chow->sweeps; k++) {
+#if defined(PETSC_HAVE_OPENMP)
+#pragma omp parallel for num_threads((int)b->nthreads) schedule(dynamic,64) if(b->nthreads > 1)
+#endif
+    for (i=0; i<n; i++) MatChowILUSweepRow_Private(i,bi,bj,bdiag,ucolptr,ucolrow,ucolpos,aval,x,y);
+    swap = x; x = y; y = swap;
+  }
+  chow->a    = x;
+  chow->anew = y;
+
+  /* store the factors in the usual SeqAIJ factored format, with the inverted diagonal of U */
+  ierr = PetscArraycpy(b->a,x,nz);CHKERRQ(ierr);
+  for (i=0; i<n; i++) {
+    sctx.pv = PetscIsInfOrNanScalar(x[bdiag[i]]) ? 0.0 : x[bdiag[i]]; /* the sweeps diverged */
+    ierr    = MatPivotCheck_none(B,A,info,&sctx,i);CHKERRQ(ierr);
+    if (B->factorerrortype) PetscFunctionReturn(0);
+    b->a[bdiag[i]] = 1.0/x[bdiag[i]];
+  }
+  chow->factored = PETSC_TRUE;
+
+  if (chow->solvesweeps) {
+    B->ops->solve    = MatSolve_SeqAIJ_ChowILU;
+    B->ops->solveadd = NULL;
+    B->ops->matsolve = NULL;
+  } else {
+    ierr = ISIdentity(b->row,&row_identity);CHKERRQ(ierr);
+    ierr = ISIdentity(b->icol,&col_identity);CHKERRQ(ierr);
+    ierr = MatSeqAIJFactorLevels_Private(B);CHKERRQ(ierr);
+    if (row_identity && col_identity) B->ops->solve = MatSolve_SeqAIJ_NaturalOrdering;
+    else B->ops->solve = MatSolve_SeqAIJ;
+    B->ops->solveadd = MatSolveAdd_SeqAIJ;
+    B->ops->matsolve = MatMatSolve_SeqAIJ;
+  }
+  B->ops->solvetranspose    = MatSolveTranspose_SeqAIJ;
+  B->ops->solvetransposeadd = MatSolveTransposeAdd_SeqAIJ;
+  B->assembled              = PETSC_TRUE;
+  B->preallocated           = PETSC_TRUE;
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode MatILUFactorSymbolic_SeqAIJ_ChowILU(Mat fact,Mat A,IS isrow,IS iscol,const MatFactorInfo *info)
+{
+  Mat_SeqAIJ     *a = (Mat_SeqAIJ*)A->data,*b;
+  Mat_ChowILU    *chow = (Mat_ChowILU*)fact->spptr;
+  const PetscInt n = A->rmap->n,*ai = a->i,*aj = a->j,*r,*ic;
+  PetscInt       i,j,p,q,nz,*bi,*bj,*bdiag,*mark;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MatILUFactorSymbolic_SeqAIJ(fact,A,isrow,iscol,info);CHKERRQ(ierr);
+  fact->ops->lufactornumeric = MatLUFactorNumeric_SeqAIJ_ChowILU;
+
+  ierr = PetscOptionsBegin(PetscObjectComm((PetscObject)A),((PetscObject)A)->prefix,"ChowILU Options","Mat");CHKERRQ(ierr);
+  ierr = PetscOptionsInt("-mat_chowilu_sweeps","Number of fixed-point sweeps in the numeric factorization","None",chow->sweeps,&chow->sweeps,NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsInt("-mat_chowilu_solve_sweeps","Number of Jacobi sweeps in each triangular solve, 0 for exact solves","None",chow->solvesweeps,&chow->solvesweeps,NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsBool("-mat_chowilu_warm_start","Start the sweeps of a refactorization from the previous factors","None",chow->warmstart,&chow->warmstart,NULL);CHKERRQ(ierr);
+  ierr = PetscOptionsEnd();CHKERRQ(ierr);
+  if (chow->sweeps < 0) SETERRQ1(PETSC_COMM_SELF,PETSC_ERR_ARG_OUTOFRANGE,"Number of sweeps %D cannot be negative",chow->sweeps);
+  if (chow->solvesweeps < 0) SETERRQ1(PETSC_COMM_SELF,PETSC_ERR_ARG_OUTOFRANGE,"Number of solve sweeps %D cannot be negative",chow->solvesweeps);
+
+  ierr     = MatChowILUReset_Private(chow);CHKERRQ(ierr);
+  b        = (Mat_SeqAIJ*)fact->data;
+  bi       = b->i;
+  bj       = b->j;
+  bdiag    = b->diag;
+  nz       = bdiag[0]+1;
+  chow->nz = nz;
+
+  /* location in the factors of each nonzero of A, rows are permuted by isrow and columns by iscol */
+  ierr = PetscMalloc1(ai[n]+1,&chow->apos);CHKERRQ(ierr);
+  ierr = PetscMalloc1(n,&mark);CHKERRQ(ierr);
+  for (i=0; i<n; i++) mark[i] = -1;
+  ierr = ISGetIndices(isrow,&r);CHKERRQ(ierr);
+  ierr = ISGetIndices(b->icol,&ic);CHKERRQ(ierr);
+  for (i=0; i<n; i++) {
+    for (p=bi[i]; p<bi[i+1]; p++) mark[bj[p]] = p;
+    for (p=bdiag[i+1]+1; p<=bdiag[i]; p++) mark[bj[p]] = p;
+    for (q=ai[r[i]]; q<ai[r[i]+1]; q++) {
+      j = ic[aj[q]];
+      if (mark[j] < 0) SETERRQ2(PETSC_COMM_SELF,PETSC_ERR_PLIB,"Nonzero (%D,%D) of the matrix is not in the factors",r[i],aj[q]);
+      chow->apos[q] = mark[j];
+    }
+    for (p=bi[i]; p<bi[i+1]; p++) mark[bj[p]] = -1;
+    for (p=bdiag[i+1]+1; p<=bdiag[i]; p++) mark[bj[p]] = -1;
+  }
+  ierr = ISRestoreIndices(isrow,&r);CHKERRQ(ierr);
+  ierr = ISRestoreIndices(b->icol,&ic);CHKERRQ(ierr);
+
+  /* U by columns, rows within a column are increasing */
+  ierr = PetscMalloc3(n+1,&chow->ucolptr,bdiag[0]-bdiag[n],&chow->ucolrow,bdiag[0]-bdiag[n],&chow->ucolpos);CHKERRQ(ierr);
+  ierr = PetscArrayzero(chow->ucolptr,n+1);CHKERRQ(ierr);
+  for (i=0; i<n; i++) {
+    for (p=bdiag[i+1]+1; p<=bdiag[i]; p++) chow->ucolptr[bj[p]+1]++;
+  }
+  for (i=0; i<n; i++) {
+    chow->ucolptr[i+1] += chow->ucolptr[i];
+    mark[i]             = chow->ucolptr[i];
+  }
+  for (i=0; i<n; i++) {
+    for (p=bdiag[i+1]+1; p<=bdiag[i]; p++) {
+      j                       = bj[p];
+      chow->ucolrow[mark[j]]  = i;
+      chow->ucolpos[mark[j]++] = p;
+    }
+  }
+  ierr = PetscFree(mark);CHKERRQ(ierr);
+
+  ierr = PetscMalloc3(nz,&chow->aval,nz,&chow->a,nz,&chow->anew);CHKERRQ(ierr);
+  ierr = PetscMalloc1(2*n+1,&chow->work);CHKERRQ(ierr);
+  ierr = PetscLogObjectMemory((PetscObject)fact,3*nz*sizeof(MatScalar)+(ai[n]+3*n+2*nz)*sizeof(PetscInt)+2*n*sizeof(PetscScalar));CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode MatFactorGetSolverType_seqaij_chowilu(Mat A,MatSolverType *type)
+{
+  PetscFunctionBegin;
+  *type = MATSOLVERCHOWILU;
+  PetscFunctionReturn(0);
+}
+
+/*MC
+  MATSOLVERCHOWILU = "chowilu" - A solver package providing the fine-grained parallel incomplete LU factorization
+  of Chow and Patel for sequential AIJ matrices.
+
+  The nonzeros of the factors, on the ILU(k) sparsity pattern, are computed with a fixed number of sweeps of a
+  fixed-point iteration in which all nonzeros are updated independently, and the triangular solves are done with
+  a fixed number of Jacobi sweeps, so both are parallel over the rows; use -mat_aij_threads to run them with OpenMP threads.
+  This is useful for matrices that are refactored often with the same nonzero pattern, for example at every Newton step,
+  where each refactorization starts from the previous factors.
+
+  Use -pc_type ilu -pc_factor_mat_solver_type chowilu to use this preconditioner, or -sub_pc_type ilu -sub_pc_factor_mat_solver_type chowilu
+  for the blocks of PCBJACOBI or PCASM
+
+  Options Database Keys:
++ -mat_chowilu_sweeps <3>          - number of fixed-point sweeps in the numeric factorization
+. -mat_chowilu_solve_sweeps <3>    - number of Jacobi sweeps in each triangular solve, 0 uses exact triangular solves
+- -mat_chowilu_warm_start <true>   - start the sweeps of a refactorization from the previous factors
+
+  Notes:
+    The sweeps are synchronous (each sweep only reads the previous iterate) so the factors do not depend on the number of threads.
+    Zero pivots are detected but shifts (PCFactorSetShiftType()) are not applied. The transpose solves are exact triangular solves
+    with the computed factors.
+
+  Level: intermediate
+
+.seealso: PCILU, PCCHOWILUVIENNACL, MATSOLVERPETSC, PCFactorSetMatSolverType(), MatSolverType, MatSeqAIJSetTypeFromOptions()
+M*/
+
+PETSC_INTERN PetscErrorCode MatGetFactor_seqaij_chowilu(Mat A,MatFactorType ftype,Mat *B)
+{
+  Mat_ChowILU    *chow;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  if (ftype != MAT_FACTOR_ILU) SETERRQ(PETSC_COMM_SELF,PETSC_ERR_SUP,"Factor type not supported");
+  ierr = MatGetFactor_SeqAIJ_Private(A,ftype,B);CHKERRQ(ierr);
+  ierr = PetscNewLog(*B,&chow);CHKERRQ(ierr);
+  chow->sweeps      = 3;
+  chow->solvesweeps = 3;
+  chow->warmstart   = PETSC_TRUE;
+  (*B)->spptr       = (void*)chow;
+
+  (*B)->ops->ilufactorsymbolic = MatILUFactorSymbolic_SeqAIJ_ChowILU;
+  (*B)->ops->lufactorsymbolic  = NULL;
+  (*B)->ops->destroy           = MatDestroy_SeqAIJ_ChowILU;
+  ierr = PetscObjectComposeFunction((PetscObject)*B,"MatFactorGetSolverType_C",MatFactorGetSolverType_seqaij_chowilu);CHKERRQ(ierr);
+
+  ierr = PetscFree((*B)->solvertype);CHKERRQ(ierr);
+  ierr = PetscStrallocpy(MATSOLVERCHOWILU,&(*B)->solvertype);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
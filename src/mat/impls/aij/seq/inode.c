@@ -1831,7 +1831,8 @@ PetscErrorCode MatLUFactorNumeric_SeqAIJ_Inode(Mat B,Mat A,const MatFactorInfo *
   ierr = ISRestoreIndices(isicol,&ic);CHKERRQ(ierr);
   ierr = ISRestoreIndices(isrow,&r);CHKERRQ(ierr);
 
-  if (b->inode.size) {
+  ierr = MatSeqAIJFactorLevels_Private(C);CHKERRQ(ierr);
+  if (b->inode.size && !b->levelrows) {
     C->ops->solve           = MatSolve_SeqAIJ_Inode;
   } else {
     C->ops->solve           = MatSolve_SeqAIJ;
@@ -4109,9 +4110,11 @@ PetscErrorCode MatSeqAIJCheckInode(Mat A)
     ierr = PetscInfo2(A,"Found %D nodes out of %D rows. Not using Inode routines\n",node_count,m);CHKERRQ(ierr);
   } else {
     if (!A->factortype) {
-      A->ops->mult              = MatMult_SeqAIJ_Inode;
+      if (a->nthreads == 1 && !a->cj) { /* the threaded MatMult_SeqAIJ(), and the compressed index one if compression ran, take precedence over the inode kernels */
+        A->ops->mult            = MatMult_SeqAIJ_Inode;
+        A->ops->multadd         = MatMultAdd_SeqAIJ_Inode;
+      }
       A->ops->sor               = MatSOR_SeqAIJ_Inode;
-      A->ops->multadd           = MatMultAdd_SeqAIJ_Inode;
       A->ops->multdiagonalblock = MatMultDiagonalBlock_SeqAIJ_Inode;
       if (A->rmap->n == A->cmap->n) {
         A->ops->getrowij          = MatGetRowIJ_SeqAIJ_Inode;
@@ -4149,9 +4152,11 @@ PetscErrorCode MatDuplicate_SeqAIJ_Inode(Mat A,MatDuplicateOption cpvalues,Mat *
     ierr                = PetscArraycpy(c->inode.size,a->inode.size,m+1);CHKERRQ(ierr);
     /* note the table of functions below should match that in MatSeqAIJCheckInode() */
     if (!B->factortype) {
-      B->ops->mult              = MatMult_SeqAIJ_Inode;
+      if (c->nthreads == 1 && !c->cj) {
+        B->ops->mult            = MatMult_SeqAIJ_Inode;
+        B->ops->multadd         = MatMultAdd_SeqAIJ_Inode;
+      }
       B->ops->sor               = MatSOR_SeqAIJ_Inode;
-      B->ops->multadd           = MatMultAdd_SeqAIJ_Inode;
       B->ops->getrowij          = MatGetRowIJ_SeqAIJ_Inode;
       B->ops->restorerowij      = MatRestoreRowIJ_SeqAIJ_Inode;
       B->ops->getcolumnij       = MatGetColumnIJ_SeqAIJ_Inode;
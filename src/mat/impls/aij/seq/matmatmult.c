@@ -77,49 +77,49 @@ PetscErrorCode MatMatMultSymbolic_SeqAIJ_SeqAIJ(Mat A,Mat B,PetscReal fill,Mat C
   /* sorted */
   ierr = PetscStrcmp(alg,"sorted",&flg);CHKERRQ(ierr);
   if (flg) {
-    ierr = MatMatMultSymbolic_SeqAIJ_SeqAIJ_Sorted(A,B,fill,C);CHKERRQ(ierr);
+    ierr = MatProductSymbolicCached_SeqAIJ_SeqAIJ("AB",alg,A,B,fill,C,MatMatMultSymbolic_SeqAIJ_SeqAIJ_Sorted);CHKERRQ(ierr);
     PetscFunctionReturn(0);
   }
 
   /* scalable */
   ierr = PetscStrcmp(alg,"scalable",&flg);CHKERRQ(ierr);
   if (flg) {
-    ierr = MatMatMultSymbolic_SeqAIJ_SeqAIJ_Scalable(A,B,fill,C);CHKERRQ(ierr);
+    ierr = MatProductSymbolicCached_SeqAIJ_SeqAIJ("AB",alg,A,B,fill,C,MatMatMultSymbolic_SeqAIJ_SeqAIJ_Scalable);CHKERRQ(ierr);
     PetscFunctionReturn(0);
   }
 
   /* scalable_fast */
   ierr = PetscStrcmp(alg,"scalable_fast",&flg);CHKERRQ(ierr);
   if (flg) {
-    ierr = MatMatMultSymbolic_SeqAIJ_SeqAIJ_Scalable_fast(A,B,fill,C);CHKERRQ(ierr);
+    ierr = MatProductSymbolicCached_SeqAIJ_SeqAIJ("AB",alg,A,B,fill,C,MatMatMultSymbolic_SeqAIJ_SeqAIJ_Scalable_fast);CHKERRQ(ierr);
     PetscFunctionReturn(0);
   }
 
   /* heap */
   ierr = PetscStrcmp(alg,"heap",&flg);CHKERRQ(ierr);
   if (flg) {
-    ierr = MatMatMultSymbolic_SeqAIJ_SeqAIJ_Heap(A,B,fill,C);CHKERRQ(ierr);
+    ierr = MatProductSymbolicCached_SeqAIJ_SeqAIJ("AB",alg,A,B,fill,C,MatMatMultSymbolic_SeqAIJ_SeqAIJ_Heap);CHKERRQ(ierr);
     PetscFunctionReturn(0);
   }
 
   /* btheap */
   ierr = PetscStrcmp(alg,"btheap",&flg);CHKERRQ(ierr);
   if (flg) {
-    ierr = MatMatMultSymbolic_SeqAIJ_SeqAIJ_BTHeap(A,B,fill,C);CHKERRQ(ierr);
+    ierr = MatProductSymbolicCached_SeqAIJ_SeqAIJ("AB",alg,A,B,fill,C,MatMatMultSymbolic_SeqAIJ_SeqAIJ_BTHeap);CHKERRQ(ierr);
     PetscFunctionReturn(0);
   }
 
   /* llcondensed */
   ierr = PetscStrcmp(alg,"llcondensed",&flg);CHKERRQ(ierr);
   if (flg) {
-    ierr = MatMatMultSymbolic_SeqAIJ_SeqAIJ_LLCondensed(A,B,fill,C);CHKERRQ(ierr);
+    ierr = MatProductSymbolicCached_SeqAIJ_SeqAIJ("AB",alg,A,B,fill,C,MatMatMultSymbolic_SeqAIJ_SeqAIJ_LLCondensed);CHKERRQ(ierr);
     PetscFunctionReturn(0);
   }
 
   /* rowmerge */
   ierr = PetscStrcmp(alg,"rowmerge",&flg);CHKERRQ(ierr);
   if (flg) {
-    ierr = MatMatMultSymbolic_SeqAIJ_SeqAIJ_RowMerge(A,B,fill,C);CHKERRQ(ierr);
+    ierr = MatProductSymbolicCached_SeqAIJ_SeqAIJ("AB",alg,A,B,fill,C,MatMatMultSymbolic_SeqAIJ_SeqAIJ_RowMerge);CHKERRQ(ierr);
     PetscFunctionReturn(0);
   }
 
@@ -239,6 +239,109 @@ PetscErrorCode MatMatMultSymbolic_SeqAIJ_SeqAIJ_LLCondensed(Mat A,Mat B,PetscRea
   PetscFunctionReturn(0);
 }
 
+#if defined(PETSC_HAVE_OPENMP)
+/*
+    MatMatMultNumeric_SeqAIJ_SeqAIJ_Sorted() with the rows of C split among the a->nthreads OpenMP threads of A,
+    each thread using its own dense accumulator; every entry of C is summed in the same order as in the serial code
+*/
+static PetscErrorCode MatMatMultNumeric_SeqAIJ_SeqAIJ_Sorted_OpenMP(Mat A,Mat B,Mat C)
+{
+  PetscErrorCode    ierr;
+  PetscLogDouble    flops=0.0;
+  Mat_SeqAIJ        *a = (Mat_SeqAIJ*)A->data,*b = (Mat_SeqAIJ*)B->data,*c = (Mat_SeqAIJ*)C->data;
+  const PetscInt    *ai = a->i,*aj = a->j,*bi = b->i,*bj = b->j,*ci = c->i,*cj = c->j;
+  const PetscScalar *aa = a->a,*ba = b->a;
+  PetscInt          cm = C->rmap->n,bn = B->cmap->N,nthreads = a->nthreads,*rows,t;
+  PetscScalar       *ca,*work;
+
+  PetscFunctionBegin;
+  if (!c->a) {
+    ierr      = PetscMalloc1(ci[cm]+1,&c->a);CHKERRQ(ierr);
+    c->free_a = PETSC_TRUE;
+  }
+  ca   = c->a;
+  ierr = PetscMalloc2(nthreads+1,&rows,nthreads*bn,&work);CHKERRQ(ierr);
+  ierr = MatSeqAIJPartitionRows_Private(cm,ci,nthreads,rows);CHKERRQ(ierr);
+  ierr = PetscInfo2(C,"Split %D rows of the product among %D threads by number of nonzeros\n",cm,nthreads);CHKERRQ(ierr);
+#pragma omp parallel for num_threads((int)nthreads) schedule(static,1) reduction(+:flops)
+  for (t=0; t<nthreads; t++) {
+    PetscScalar *ab_dense = work + t*bn;
+    PetscInt    i,j,k;
+
+    for (k=0; k<bn; k++) ab_dense[k] = 0.0;
+    for (i=rows[t]; i<rows[t+1]; i++) {
+      for (j=ai[i]; j<ai[i+1]; j++) {
+        const PetscInt    brow = aj[j],bnzi = bi[brow+1] - bi[brow];
+        const PetscInt    *bjj = bj + bi[brow];
+        const PetscScalar *baj = ba + bi[brow],valtmp = aa[j];
+
+        for (k=0; k<bnzi; k++) ab_dense[bjj[k]] += valtmp*baj[k];
+        flops += 2*bnzi;
+      }
+      for (k=ci[i]; k<ci[i+1]; k++) {
+        ca[k]           = ab_dense[cj[k]];
+        ab_dense[cj[k]] = 0.0;
+      }
+      flops += ci[i+1] - ci[i];
+    }
+  }
+  ierr = PetscFree2(rows,work);CHKERRQ(ierr);
+  ierr = MatAssemblyBegin(C,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  ierr = MatAssemblyEnd(C,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  ierr = PetscLogFlops(flops);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/* MatMatMultNumeric_SeqAIJ_SeqAIJ_Scalable() with the rows of C split among the a->nthreads OpenMP threads of A */
+static PetscErrorCode MatMatMultNumeric_SeqAIJ_SeqAIJ_Scalable_OpenMP(Mat A,Mat B,Mat C)
+{
+  PetscErrorCode    ierr;
+  PetscLogDouble    flops=0.0;
+  Mat_SeqAIJ        *a = (Mat_SeqAIJ*)A->data,*b = (Mat_SeqAIJ*)B->data,*c = (Mat_SeqAIJ*)C->data;
+  const PetscInt    *ai = a->i,*aj = a->j,*bi = b->i,*bj = b->j,*ci = c->i,*cj = c->j;
+  const PetscScalar *aa = a->a,*ba = b->a;
+  PetscInt          cm = C->rmap->n,nthreads = a->nthreads,*rows,t;
+  PetscScalar       *ca;
+
+  PetscFunctionBegin;
+  if (!c->a) {
+    ierr      = PetscMalloc1(ci[cm]+1,&c->a);CHKERRQ(ierr);
+    c->free_a = PETSC_TRUE;
+  }
+  ca   = c->a;
+  ierr = PetscMalloc1(nthreads+1,&rows);CHKERRQ(ierr);
+  ierr = MatSeqAIJPartitionRows_Private(cm,ci,nthreads,rows);CHKERRQ(ierr);
+  ierr = PetscInfo2(C,"Split %D rows of the product among %D threads by number of nonzeros\n",cm,nthreads);CHKERRQ(ierr);
+#pragma omp parallel for num_threads((int)nthreads) schedule(static,1) reduction(+:flops)
+  for (t=0; t<nthreads; t++) {
+    PetscInt i,j,k;
+
+    for (k=ci[rows[t]]; k<ci[rows[t+1]]; k++) ca[k] = 0.0;
+    for (i=rows[t]; i<rows[t+1]; i++) {
+      const PetscInt *cjj = cj + ci[i];
+      PetscScalar    *caj = ca + ci[i];
+
+      for (j=ai[i]; j<ai[i+1]; j++) {
+        const PetscInt    brow = aj[j],bnzi = bi[brow+1] - bi[brow];
+        const PetscInt    *bjj = bj + bi[brow];
+        const PetscScalar *baj = ba + bi[brow],valtmp = aa[j];
+        PetscInt          nextb = 0;
+
+        for (k=0; nextb<bnzi; k++) {
+          if (cjj[k] == bjj[nextb]) caj[k] += valtmp*baj[nextb++];
+        }
+        flops += 2*bnzi;
+      }
+    }
+  }
+  ierr = PetscFree(rows);CHKERRQ(ierr);
+  ierr = MatAssemblyBegin(C,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  ierr = MatAssemblyEnd(C,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  ierr = PetscLogFlops(flops);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+#endif
+
 PetscErrorCode MatMatMultNumeric_SeqAIJ_SeqAIJ_Sorted(Mat A,Mat B,Mat C)
 {
   PetscErrorCode ierr;
@@ -253,6 +356,12 @@ PetscErrorCode MatMatMultNumeric_SeqAIJ_SeqAIJ_Sorted(Mat A,Mat B,Mat C)
   PetscScalar    *ab_dense;
 
   PetscFunctionBegin;
+#if defined(PETSC_HAVE_OPENMP)
+  if (a->nthreads > 1) {
+    ierr = MatMatMultNumeric_SeqAIJ_SeqAIJ_Sorted_OpenMP(A,B,C);CHKERRQ(ierr);
+    PetscFunctionReturn(0);
+  }
+#endif
   if (!c->a) { /* first call of MatMatMultNumeric_SeqAIJ_SeqAIJ, allocate ca and matmult_abdense */
     ierr      = PetscMalloc1(ci[cm]+1,&ca);CHKERRQ(ierr);
     c->a      = ca;
@@ -316,6 +425,12 @@ PetscErrorCode MatMatMultNumeric_SeqAIJ_SeqAIJ_Scalable(Mat A,Mat B,Mat C)
   PetscInt       nextb;
 
   PetscFunctionBegin;
+#if defined(PETSC_HAVE_OPENMP)
+  if (a->nthreads > 1) {
+    ierr = MatMatMultNumeric_SeqAIJ_SeqAIJ_Scalable_OpenMP(A,B,C);CHKERRQ(ierr);
+    PetscFunctionReturn(0);
+  }
+#endif
   if (!ca) { /* first call of MatMatMultNumeric_SeqAIJ_SeqAIJ, allocate ca and matmult_abdense */
     ierr      = PetscMalloc1(ci[cm]+1,&ca);CHKERRQ(ierr);
     c->a      = ca;
@@ -1451,59 +1566,89 @@ PetscErrorCode MatMatMultSymbolic_SeqAIJ_SeqDense(Mat A,Mat B,PetscReal fill,Mat
   PetscFunctionReturn(0);
 }
 
+/*
+    Adds to the k <= w columns of C (leading dimension ldc) the product of the rows [rstart,rend) of A with
+    the columns of B stored row by row, w entries per row, in bt[]. Each row of A is read once for all the
+    columns and, w being a compile time constant, the w sums stay in (vector) registers.
+*/
+#define MatMatMultNumericAddRows_SeqAIJ_SeqDense(w,rstart,rend,ai,aj,aa,k,bt,c,ldc) do { \
+    PetscScalar       _r[w],_v;                                                         \
+    const PetscScalar *_btj;                                                            \
+    PetscInt          _i,_j,_l;                                                         \
+    for (_i=rstart; _i<rend; _i++) {                                                    \
+      for (_l=0; _l<w; _l++) _r[_l] = 0.0;                                              \
+      for (_j=ai[_i]; _j<ai[_i+1]; _j++) {                                              \
+        _v   = aa[_j];                                                                  \
+        _btj = bt + aj[_j]*w;                                                           \
+        for (_l=0; _l<w; _l++) _r[_l] += _v*_btj[_l];                                   \
+      }                                                                                 \
+      for (_l=0; _l<k; _l++) c[_l*ldc+_i] += _r[_l];                                    \
+    }                                                                                   \
+  } while (0)
+
+static void MatMatMultNumericAddBlock_SeqAIJ_SeqDense(PetscInt w,PetscInt rstart,PetscInt rend,const PetscInt *ai,const PetscInt *aj,const PetscScalar *aa,PetscInt k,const PetscScalar *bt,PetscScalar *c,PetscInt ldc)
+{
+  switch (w) {
+  case 1: MatMatMultNumericAddRows_SeqAIJ_SeqDense(1,rstart,rend,ai,aj,aa,k,bt,c,ldc); break;
+  case 2: MatMatMultNumericAddRows_SeqAIJ_SeqDense(2,rstart,rend,ai,aj,aa,k,bt,c,ldc); break;
+  case 4: MatMatMultNumericAddRows_SeqAIJ_SeqDense(4,rstart,rend,ai,aj,aa,k,bt,c,ldc); break;
+  default: MatMatMultNumericAddRows_SeqAIJ_SeqDense(8,rstart,rend,ai,aj,aa,k,bt,c,ldc);
+  }
+}
+
+/*
+    C += A*B, reading A once for every 8 columns of B: the columns are copied row by row into a work array
+    so that each nonzero of A multiplies 8 consecutive entries. The last (k < 8) columns are padded to the
+    next power of 2. With -mat_aij_threads the rows of A are split among the OpenMP threads.
+*/
 PetscErrorCode MatMatMultNumericAdd_SeqAIJ_SeqDense(Mat A,Mat B,Mat C)
 {
-  Mat_SeqAIJ        *a=(Mat_SeqAIJ*)A->data;
-  Mat_SeqDense      *bd = (Mat_SeqDense*)B->data;
+  Mat_SeqAIJ        *a = (Mat_SeqAIJ*)A->data;
+  Mat_SeqDense      *bd = (Mat_SeqDense*)B->data,*cd = (Mat_SeqDense*)C->data;
   PetscErrorCode    ierr;
-  PetscScalar       *c,r1,r2,r3,r4,*c1,*c2,*c3,*c4,aatmp;
-  const PetscScalar *aa,*b,*b1,*b2,*b3,*b4,*av;
-  const PetscInt    *aj;
-  PetscInt          cm=C->rmap->n,cn=B->cmap->n,bm=bd->lda,am=A->rmap->n;
-  PetscInt          am4=4*am,bm4=4*bm,col,i,j,n,ajtmp;
+  PetscScalar       *c,*bt;
+  const PetscScalar *b,*av;
+  PetscInt          cm = C->rmap->n,cn = B->cmap->n,bm = B->rmap->n,ldb = bd->lda,ldc = cd->lda;
+  PetscInt          col,j,k,l,w;
+#if defined(PETSC_HAVE_OPENMP)
+  PetscInt          *rows = NULL,t;
+#endif
 
   PetscFunctionBegin;
   if (!cm || !cn) PetscFunctionReturn(0);
   ierr = MatSeqAIJGetArrayRead(A,&av);CHKERRQ(ierr);
   ierr = MatDenseGetArray(C,&c);CHKERRQ(ierr);
   ierr = MatDenseGetArrayRead(B,&b);CHKERRQ(ierr);
-  b1 = b; b2 = b1 + bm; b3 = b2 + bm; b4 = b3 + bm;
-  c1 = c; c2 = c1 + am; c3 = c2 + am; c4 = c3 + am;
-  for (col=0; col<cn-4; col += 4) {  /* over columns of C */
-    for (i=0; i<am; i++) {        /* over rows of C in those columns */
-      r1 = r2 = r3 = r4 = 0.0;
-      n  = a->i[i+1] - a->i[i];
-      aj = a->j + a->i[i];
-      aa = av + a->i[i];
-      for (j=0; j<n; j++) {
-        aatmp = aa[j]; ajtmp = aj[j];
-        r1 += aatmp*b1[ajtmp];
-        r2 += aatmp*b2[ajtmp];
-        r3 += aatmp*b3[ajtmp];
-        r4 += aatmp*b4[ajtmp];
-      }
-      c1[i] += r1;
-      c2[i] += r2;
-      c3[i] += r3;
-      c4[i] += r4;
+  ierr = PetscMalloc1(8*bm,&bt);CHKERRQ(ierr);
+#if defined(PETSC_HAVE_OPENMP)
+  if (a->nthreads > 1) {
+    ierr = PetscMalloc1(a->nthreads+1,&rows);CHKERRQ(ierr);
+    ierr = MatSeqAIJPartitionRows_Private(cm,a->i,a->nthreads,rows);CHKERRQ(ierr);
+    ierr = PetscInfo2(C,"Split %D rows of the product among %D threads by number of nonzeros\n",cm,a->nthreads);CHKERRQ(ierr);
+  }
+#endif
+  for (col=0; col<cn; col+=k) {
+    k = PetscMin(cn-col,8);
+    for (w=1; w<k; w*=2) ;
+    for (j=0; j<bm; j++) {
+      for (l=0; l<k; l++) bt[j*w+l] = b[(col+l)*ldb+j];
+      for (; l<w; l++) bt[j*w+l] = 0.0;
     }
-    b1 += bm4; b2 += bm4; b3 += bm4; b4 += bm4;
-    c1 += am4; c2 += am4; c3 += am4; c4 += am4;
-  }
-  for (; col<cn; col++) {   /* over extra columns of C */
-    for (i=0; i<am; i++) {  /* over rows of C in those columns */
-      r1 = 0.0;
-      n  = a->i[i+1] - a->i[i];
-      aj = a->j + a->i[i];
-      aa = av + a->i[i];
-      for (j=0; j<n; j++) {
-        r1 += aa[j]*b1[aj[j]];
+#if defined(PETSC_HAVE_OPENMP)
+    if (rows) {
+#pragma omp parallel for num_threads((int)a->nthreads) schedule(static,1)
+      for (t=0; t<a->nthreads; t++) {
+        MatMatMultNumericAddBlock_SeqAIJ_SeqDense(w,rows[t],rows[t+1],a->i,a->j,av,k,bt,c+col*ldc,ldc);
       }
-      c1[i] += r1;
+      continue;
     }
-    b1 += bm;
-    c1 += am;
+#endif
+    MatMatMultNumericAddBlock_SeqAIJ_SeqDense(w,0,cm,a->i,a->j,av,k,bt,c+col*ldc,ldc);
   }
+#if defined(PETSC_HAVE_OPENMP)
+  ierr = PetscFree(rows);CHKERRQ(ierr);
+#endif
+  ierr = PetscFree(bt);CHKERRQ(ierr);
   ierr = PetscLogFlops(cn*(2.0*a->nz));CHKERRQ(ierr);
   ierr = MatDenseRestoreArray(C,&c);CHKERRQ(ierr);
   ierr = MatDenseRestoreArrayRead(B,&b);CHKERRQ(ierr);
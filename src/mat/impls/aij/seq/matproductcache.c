@@ -0,0 +1,206 @@
+/*
+  Cache of the nonzero structure of products of SeqAIJ matrices, keyed on the nonzero structure of the
+  operands; a fingerprint selects the candidates, which are then compared entry by entry. It lets the symbolic phase of MatMatMult() and MatPtAP() be skipped
+  for new matrices that have the same nonzero structure as operands seen before, for example the
+  operators that GAMG builds from scratch at each setup of an adaptive time stepping run.
+*/
+
+#include <../src/mat/impls/aij/seq/aij.h>   /*I "petscmat.h" I*/
+#include <petsc/private/hashtable.h>
+
+typedef struct _MatProductCacheLink *MatProductCacheLink;
+struct _MatProductCacheLink {
+  char                kind[8];             /* "AB" or "PtAP" */
+  char                *alg;                /* algorithm of the symbolic phase */
+  PetscInt            am,an,anz,bm,bn,bnz; /* sizes of the operands */
+  PetscHash64_t       ahash,bhash;         /* fingerprints of the nonzero structure of the operands */
+  PetscInt            *ai,*aj,*bi,*bj;     /* nonzero structure of the operands */
+  PetscInt            m,n,rbs,cbs;         /* sizes of the product */
+  PetscInt            *i,*j;               /* nonzero structure of the product */
+  PetscReal           fill;                /* fill ratio needed */
+  PetscErrorCode      (*matmultnumeric)(Mat,Mat,Mat);
+  PetscErrorCode      (*ptapnumeric)(Mat,Mat,Mat);
+  MatProductCacheLink next;
+};
+
+static MatProductCacheLink MatProductCache   = NULL;
+static PetscBool           MatProductCacheRF = PETSC_FALSE;
+
+/* Destroys link and all links after it */
+static PetscErrorCode MatProductCacheLinkDestroy_Private(MatProductCacheLink link)
+{
+  PetscErrorCode      ierr;
+  MatProductCacheLink next;
+
+  PetscFunctionBegin;
+  while (link) {
+    next = link->next;
+    ierr = PetscFree(link->alg);CHKERRQ(ierr);
+    ierr = PetscFree2(link->i,link->j);CHKERRQ(ierr);
+    ierr = PetscFree4(link->ai,link->aj,link->bi,link->bj);CHKERRQ(ierr);
+    ierr = PetscFree(link);CHKERRQ(ierr);
+    link = next;
+  }
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode MatProductCacheDestroy_Private(void)
+{
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = MatProductCacheLinkDestroy_Private(MatProductCache);CHKERRQ(ierr);
+  MatProductCache   = NULL;
+  MatProductCacheRF = PETSC_FALSE;
+  PetscFunctionReturn(0);
+}
+
+/* FNV-1a over the row offsets and column indices, followed by a final mix */
+static PetscHash64_t MatSeqAIJPatternHash_Private(Mat A)
+{
+  Mat_SeqAIJ     *a = (Mat_SeqAIJ*)A->data;
+  PetscInt       m  = A->rmap->n,nz = a->i[m],k;
+  const PetscInt *ai = a->i,*aj = a->j;
+  PetscHash64_t  h = 14695981039346656037ULL;
+
+  h = (h ^ (PetscHash64_t)m) * 1099511628211ULL;
+  h = (h ^ (PetscHash64_t)A->cmap->n) * 1099511628211ULL;
+  for (k=0; k<=m; k++) h = (h ^ (PetscHash64_t)ai[k]) * 1099511628211ULL;
+  for (k=0; k<nz; k++) h = (h ^ (PetscHash64_t)aj[k]) * 1099511628211ULL;
+  return PetscHash_UInt64_64(h);
+}
+
+/*
+   MatProductSymbolicCached_SeqAIJ_SeqAIJ - Runs the symbolic phase of a product of two SeqAIJ matrices, or reuses the
+   nonzero structure of an earlier product whose operands had the same nonzero structure.
+
+   Input Parameters:
++  kind     - "AB" for C = A*B or "PtAP" for C = B^T*A*B
+.  alg      - the algorithm of the symbolic phase, part of the key since it decides the numeric phase
+.  A,B      - the operands
+.  fill     - expected fill, passed to symbolic
+-  symbolic - the symbolic phase to run on a miss; it must only set the nonzero structure of C, the block sizes,
+              MatInfo and C->ops->matmultnumeric or C->ops->ptapnumeric
+
+   Output Parameter:
+.  C - the product, ready for the numeric phase
+
+   Options Database Keys:
+.  -matproduct_pattern_cache <n> - number of product patterns kept (default 0, no cache)
+*/
+PetscErrorCode MatProductSymbolicCached_SeqAIJ_SeqAIJ(const char kind[],MatProductAlgorithm alg,Mat A,Mat B,PetscReal fill,Mat C,PetscErrorCode (*symbolic)(Mat,Mat,PetscReal,Mat))
+{
+  PetscErrorCode      ierr;
+  Mat_SeqAIJ          *a = (Mat_SeqAIJ*)A->data,*b = (Mat_SeqAIJ*)B->data,*c;
+  PetscInt            maxlen = 0,len = 0,nz;
+  PetscHash64_t       ahash,bhash;
+  PetscBool           flg;
+  MatProductCacheLink link,prev = NULL;
+  PetscInt            *ci,*cj;
+  PetscScalar         *ca;
+
+  PetscFunctionBegin;
+  ierr = PetscOptionsGetInt(NULL,NULL,"-matproduct_pattern_cache",&maxlen,NULL);CHKERRQ(ierr);
+  if (maxlen <= 0) {
+    ierr = (*symbolic)(A,B,fill,C);CHKERRQ(ierr);
+    PetscFunctionReturn(0);
+  }
+
+  ahash = MatSeqAIJPatternHash_Private(A);
+  bhash = MatSeqAIJPatternHash_Private(B);
+  for (link=MatProductCache; link; prev=link,link=link->next) {
+    if (link->ahash != ahash || link->bhash != bhash) continue;
+    if (link->am != A->rmap->n || link->an != A->cmap->n || link->anz != a->i[A->rmap->n]) continue;
+    if (link->bm != B->rmap->n || link->bn != B->cmap->n || link->bnz != b->i[B->rmap->n]) continue;
+    ierr = PetscStrcmp(link->kind,kind,&flg);CHKERRQ(ierr);
+    if (!flg) continue;
+    ierr = PetscStrcmp(link->alg,alg,&flg);CHKERRQ(ierr);
+    if (!flg) continue;
+    /* equal fingerprints do not guarantee equal structures */
+    ierr = PetscArraycmp(link->ai,a->i,link->am+1,&flg);CHKERRQ(ierr);
+    if (!flg) continue;
+    ierr = PetscArraycmp(link->aj,a->j,link->anz,&flg);CHKERRQ(ierr);
+    if (!flg) continue;
+    ierr = PetscArraycmp(link->bi,b->i,link->bm+1,&flg);CHKERRQ(ierr);
+    if (!flg) continue;
+    ierr = PetscArraycmp(link->bj,b->j,link->bnz,&flg);CHKERRQ(ierr);
+    if (flg) break;
+  }
+
+  if (link) { /* Hit: copy the cached nonzero structure into C and move the entry to the front */
+    if (prev) {
+      prev->next      = link->next;
+      link->next      = MatProductCache;
+      MatProductCache = link;
+    }
+    nz   = link->i[link->m];
+    ierr = PetscMalloc1(link->m+1,&ci);CHKERRQ(ierr);
+    ierr = PetscMalloc1(nz+1,&cj);CHKERRQ(ierr);
+    ierr = PetscCalloc1(nz+1,&ca);CHKERRQ(ierr);
+    ierr = PetscArraycpy(ci,link->i,link->m+1);CHKERRQ(ierr);
+    ierr = PetscArraycpy(cj,link->j,nz);CHKERRQ(ierr);
+    ierr = MatSetSeqAIJWithArrays_private(PetscObjectComm((PetscObject)A),link->m,link->n,ci,cj,ca,((PetscObject)A)->type_name,C);CHKERRQ(ierr);
+    ierr = MatSetBlockSizes(C,link->rbs,link->cbs);CHKERRQ(ierr);
+
+    c          = (Mat_SeqAIJ*)C->data;
+    c->free_a  = PETSC_TRUE;
+    c->free_ij = PETSC_TRUE;
+    c->nonew   = 0;
+    c->maxnz   = nz;
+    c->nz      = nz;
+    C->ops->matmultnumeric    = link->matmultnumeric;
+    C->ops->ptapnumeric       = link->ptapnumeric;
+    C->info.mallocs           = 0;
+    C->info.fill_ratio_given  = fill;
+    C->info.fill_ratio_needed = link->fill;
+    ierr = PetscInfo2(C,"Reusing the nonzero structure of a cached %s product (%s)\n",kind,alg);CHKERRQ(ierr);
+    PetscFunctionReturn(0);
+  }
+
+  /* Miss: run the symbolic phase and remember its result */
+  ierr = (*symbolic)(A,B,fill,C);CHKERRQ(ierr);
+  c    = (Mat_SeqAIJ*)C->data;
+  nz   = c->i[C->rmap->n];
+  ierr = PetscNew(&link);CHKERRQ(ierr);
+  ierr = PetscStrncpy(link->kind,kind,sizeof(link->kind));CHKERRQ(ierr);
+  ierr = PetscStrallocpy(alg,&link->alg);CHKERRQ(ierr);
+  link->am             = A->rmap->n;
+  link->an             = A->cmap->n;
+  link->anz            = a->i[A->rmap->n];
+  link->bm             = B->rmap->n;
+  link->bn             = B->cmap->n;
+  link->bnz            = b->i[B->rmap->n];
+  link->ahash          = ahash;
+  link->bhash          = bhash;
+  link->m              = C->rmap->n;
+  link->n              = C->cmap->n;
+  link->rbs            = PetscAbs(C->rmap->bs);
+  link->cbs            = PetscAbs(C->cmap->bs);
+  link->fill           = C->info.fill_ratio_needed;
+  link->matmultnumeric = C->ops->matmultnumeric;
+  link->ptapnumeric    = C->ops->ptapnumeric;
+  ierr = PetscMalloc2(link->m+1,&link->i,nz,&link->j);CHKERRQ(ierr);
+  ierr = PetscArraycpy(link->i,c->i,link->m+1);CHKERRQ(ierr);
+  ierr = PetscArraycpy(link->j,c->j,nz);CHKERRQ(ierr);
+  ierr = PetscMalloc4(link->am+1,&link->ai,link->anz,&link->aj,link->bm+1,&link->bi,link->bnz,&link->bj);CHKERRQ(ierr);
+  ierr = PetscArraycpy(link->ai,a->i,link->am+1);CHKERRQ(ierr);
+  ierr = PetscArraycpy(link->aj,a->j,link->anz);CHKERRQ(ierr);
+  ierr = PetscArraycpy(link->bi,b->i,link->bm+1);CHKERRQ(ierr);
+  ierr = PetscArraycpy(link->bj,b->j,link->bnz);CHKERRQ(ierr);
+  link->next      = MatProductCache;
+  MatProductCache = link;
+  if (!MatProductCacheRF) {
+    ierr = PetscRegisterFinalize(MatProductCacheDestroy_Private);CHKERRQ(ierr);
+    MatProductCacheRF = PETSC_TRUE;
+  }
+
+  /* Drop the least recently used entries */
+  for (link=MatProductCache,prev=NULL; link; prev=link,link=link->next) {
+    if (++len > maxlen) break;
+  }
+  if (link) {
+    prev->next = NULL;
+    ierr = MatProductCacheLinkDestroy_Private(link);CHKERRQ(ierr);
+  }
+  PetscFunctionReturn(0);
+}
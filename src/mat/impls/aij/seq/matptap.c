@@ -29,7 +29,7 @@ PetscErrorCode MatProductSymbolic_PtAP_SeqAIJ_SeqAIJ(Mat C)
   /* "scalable" */
   ierr = PetscStrcmp(alg,"scalable",&flg);CHKERRQ(ierr);
   if (flg) {
-    ierr = MatPtAPSymbolic_SeqAIJ_SeqAIJ_SparseAxpy(A,P,fill,C);CHKERRQ(ierr);
+    ierr = MatProductSymbolicCached_SeqAIJ_SeqAIJ("PtAP",alg,A,P,fill,C,MatPtAPSymbolic_SeqAIJ_SeqAIJ_SparseAxpy);CHKERRQ(ierr);
     C->ops->productnumeric = MatProductNumeric_PtAP;
     PetscFunctionReturn(0);
   }
@@ -205,6 +205,82 @@ PetscErrorCode MatPtAPSymbolic_SeqAIJ_SeqAIJ_SparseAxpy(Mat A,Mat P,PetscReal fi
   PetscFunctionReturn(0);
 }
 
+#if defined(PETSC_HAVE_OPENMP)
+/*
+    MatPtAPNumeric_SeqAIJ_SeqAIJ_SparseAxpy() with the rows of C split among the a->nthreads OpenMP threads of A.
+    Each thread runs through all rows i of A, but only forms the row of A*P, in its own dense accumulator, when
+    P[i,:] has a column in its range of rows of C, and only adds to those rows. Every entry of C is thus summed
+    in the same order as in the serial code, at the price of forming some rows of A*P in more than one thread.
+*/
+static PetscErrorCode MatPtAPNumeric_SeqAIJ_SeqAIJ_SparseAxpy_OpenMP(Mat A,Mat P,Mat C)
+{
+  PetscErrorCode    ierr;
+  PetscLogDouble    flops = 0.0;
+  Mat_SeqAIJ        *a = (Mat_SeqAIJ*)A->data,*p = (Mat_SeqAIJ*)P->data,*c = (Mat_SeqAIJ*)C->data;
+  const PetscInt    *ai = a->i,*aj = a->j,*pi = p->i,*pj = p->j,*ci = c->i,*cj = c->j;
+  const MatScalar   *aa = a->a,*pa = p->a;
+  MatScalar         *ca = c->a;
+  PetscInt          am = A->rmap->N,cn = C->cmap->N,cm = C->rmap->N,nthreads = a->nthreads,*rows,*iwork,t;
+  PetscScalar       *work;
+
+  PetscFunctionBegin;
+  ierr = PetscMalloc3(nthreads+1,&rows,nthreads*cn,&work,2*nthreads*cn,&iwork);CHKERRQ(ierr);
+  ierr = MatSeqAIJPartitionRows_Private(cm,ci,nthreads,rows);CHKERRQ(ierr);
+  ierr = PetscInfo2(C,"Split %D rows of the product among %D threads by number of nonzeros\n",cm,nthreads);CHKERRQ(ierr);
+#pragma omp parallel for num_threads((int)nthreads) schedule(static,1) reduction(+:flops)
+  for (t=0; t<nthreads; t++) {
+    const PetscInt r0 = rows[t],r1 = rows[t+1];
+    PetscScalar    *apa = work + t*cn;
+    PetscInt       *apjdense = iwork + 2*t*cn,*apj = apjdense + cn;
+    PetscInt       i,j,k,l,apnzj;
+
+    for (k=0; k<cn; k++) {apa[k] = 0.0; apjdense[k] = 0;}
+    for (k=ci[r0]; k<ci[r1]; k++) ca[k] = 0.0;
+    for (i=0; i<am; i++) {
+      const PetscInt pnzi = pi[i+1] - pi[i],*pJ = pj + pi[i];
+      const MatScalar *pA = pa + pi[i];
+
+      if (!pnzi || pJ[pnzi-1] < r0 || pJ[0] >= r1) continue;
+      /* Form sparse row of A*P */
+      apnzj = 0;
+      for (j=ai[i]; j<ai[i+1]; j++) {
+        const PetscInt  prow = aj[j],pnzj = pi[prow+1] - pi[prow],*pjj = pj + pi[prow];
+        const MatScalar *paj = pa + pi[prow];
+
+        for (k=0; k<pnzj; k++) {
+          if (!apjdense[pjj[k]]) {
+            apjdense[pjj[k]] = -1;
+            apj[apnzj++]     = pjj[k];
+          }
+          apa[pjj[k]] += aa[j]*paj[k];
+        }
+        if (pJ[0] >= r0) flops += 2.0*pnzj; /* counted by the thread owning the first row of C it updates */
+      }
+      /* Add P[i,crow]*(A*P)[i,:] to the rows crow of C in this thread's range */
+      for (j=0; j<pnzi; j++) {
+        const PetscInt crow = pJ[j],*cjj = cj + ci[crow];
+        MatScalar      *caj = ca + ci[crow];
+
+        if (crow < r0 || crow >= r1) continue;
+        for (k=0; k<ci[crow+1]-ci[crow]; k++) {
+          if (apjdense[cjj[k]]) caj[k] += pA[j]*apa[cjj[k]];
+        }
+        flops += 2.0*apnzj;
+      }
+      for (l=0; l<apnzj; l++) {
+        apa[apj[l]]      = 0.0;
+        apjdense[apj[l]] = 0;
+      }
+    }
+  }
+  ierr = PetscFree3(rows,work,iwork);CHKERRQ(ierr);
+  ierr = MatAssemblyBegin(C,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  ierr = MatAssemblyEnd(C,MAT_FINAL_ASSEMBLY);CHKERRQ(ierr);
+  ierr = PetscLogFlops(flops);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+#endif
+
 PetscErrorCode MatPtAPNumeric_SeqAIJ_SeqAIJ_SparseAxpy(Mat A,Mat P,Mat C)
 {
   PetscErrorCode ierr;
@@ -218,6 +294,12 @@ PetscErrorCode MatPtAPNumeric_SeqAIJ_SeqAIJ_SparseAxpy(Mat A,Mat P,Mat C)
   MatScalar      *aa=a->a,*apa,*pa=p->a,*pA=p->a,*paj,*ca=c->a,*caj;
 
   PetscFunctionBegin;
+#if defined(PETSC_HAVE_OPENMP)
+  if (a->nthreads > 1) {
+    ierr = MatPtAPNumeric_SeqAIJ_SeqAIJ_SparseAxpy_OpenMP(A,P,C);CHKERRQ(ierr);
+    PetscFunctionReturn(0);
+  }
+#endif
   /* Allocate temporary array for storage of one row of A*P (cn: non-scalable) */
   ierr = PetscCalloc2(cn,&apa,cn,&apjdense);CHKERRQ(ierr);
   ierr = PetscMalloc1(cn,&apj);CHKERRQ(ierr);
@@ -15,7 +15,8 @@
   the above preallocation routines for simplicity.
 
    Options Database Keys:
-. -mat_type sell - sets the matrix type to "sell" during a call to MatSetFromOptions()
++ -mat_type sell - sets the matrix type to "sell" during a call to MatSetFromOptions()
+- -mat_sell_simd <generic,avx,avx2,avx512> - SIMD instruction set used by MatMult(), MatMultAdd() and MatMultTranspose(); defaults to the widest one supported by the CPU
 
   Developer Notes:
     Subclasses include MATSELLCUSP, MATSELLCUSPARSE, MATSELLPERM, MATSELLCRL, and also automatically switches over to use inodes when
@@ -5,7 +5,24 @@
 #include <../src/mat/impls/sell/seq/sell.h>  /*I   "petscmat.h"  I*/
 #include <petscblaslapack.h>
 #include <petsc/private/kernels/blocktranspose.h>
-#if defined(PETSC_HAVE_IMMINTRIN_H) && (defined(__AVX512F__) || (defined(__AVX2__) && defined(__FMA__)) || defined(__AVX__)) && defined(PETSC_USE_REAL_DOUBLE) && !defined(PETSC_USE_COMPLEX) && !defined(PETSC_USE_64BIT_INDICES)
+#if defined(PETSC_HAVE_IMMINTRIN_H) && defined(PETSC_USE_REAL_DOUBLE) && !defined(PETSC_USE_COMPLEX) && !defined(PETSC_USE_64BIT_INDICES)
+  /*
+     With PETSC_HAVE_X86_CPU_DISPATCH every SIMD variant of the kernels is compiled (each function for its own instruction
+     set with __attribute((target))) and the one used is selected at runtime from the instruction sets the CPU supports;
+     otherwise only the variants allowed by the compiler flags are compiled.
+  */
+  #if defined(__AVX512F__) || defined(PETSC_HAVE_X86_CPU_DISPATCH)
+    #define MATSELL_HAVE_AVX512
+  #endif
+  #if (defined(__AVX2__) && defined(__FMA__)) || defined(PETSC_HAVE_X86_CPU_DISPATCH)
+    #define MATSELL_HAVE_AVX2
+  #endif
+  #if defined(__AVX__) || defined(PETSC_HAVE_X86_CPU_DISPATCH)
+    #define MATSELL_HAVE_AVX
+  #endif
+#endif
+
+#if defined(MATSELL_HAVE_AVX)
 
   #include <immintrin.h>
 
@@ -13,7 +30,13 @@
   #define _MM_SCALE_8    8
   #endif
 
-  #if defined(__AVX512F__)
+  #if defined(PETSC_HAVE_X86_CPU_DISPATCH)
+    #define MATSELL_TARGET(isa) __attribute((target(isa)))
+  #else
+    #define MATSELL_TARGET(isa)
+  #endif
+
+  #if defined(MATSELL_HAVE_AVX512)
   /* these do not work
    vec_idx  = _mm512_loadunpackhi_epi32(vec_idx,acolidx);
    vec_vals = _mm512_loadunpackhi_pd(vec_vals,aval);
@@ -24,14 +47,15 @@
     vec_vals = _mm512_loadu_pd(aval); \
     vec_x    = _mm512_i32gather_pd(vec_idx,x,_MM_SCALE_8); \
     vec_y    = _mm512_fmadd_pd(vec_x,vec_vals,vec_y)
-  #elif defined(__AVX2__) && defined(__FMA__)
+  #endif
+  #if defined(MATSELL_HAVE_AVX2)
     #define AVX2_Mult_Private(vec_idx,vec_x,vec_vals,vec_y) \
     vec_vals = _mm256_loadu_pd(aval); \
     vec_idx  = _mm_loadu_si128((__m128i const*)acolidx); /* SSE2 */ \
     vec_x    = _mm256_i32gather_pd(x,vec_idx,_MM_SCALE_8); \
     vec_y    = _mm256_fmadd_pd(vec_x,vec_vals,vec_y)
   #endif
-#endif  /* PETSC_HAVE_IMMINTRIN_H */
+#endif  /* MATSELL_HAVE_AVX */
 
 /*@C
  MatSeqSELLSetPreallocation - For good matrix assembly performance
@@ -292,7 +316,8 @@ PetscErrorCode MatConvert_SeqAIJ_SeqSELL(Mat A,MatType newtype,MatReuse reuse,Ma
   PetscFunctionReturn(0);
 }
 
-PetscErrorCode MatMult_SeqSELL(Mat A,Vec xx,Vec yy)
+#if defined(MATSELL_HAVE_AVX512)
+MATSELL_TARGET("avx512f") static PetscErrorCode MatMult_SeqSELL_AVX512(Mat A,Vec xx,Vec yy)
 {
   Mat_SeqSELL       *a=(Mat_SeqSELL*)A->data;
   PetscScalar       *y;
@@ -302,25 +327,11 @@ PetscErrorCode MatMult_SeqSELL(Mat A,Vec xx,Vec yy)
   const PetscInt    *acolidx=a->colidx;
   PetscInt          i,j;
   PetscErrorCode    ierr;
-#if defined(PETSC_HAVE_IMMINTRIN_H) && defined(__AVX512F__) && defined(PETSC_USE_REAL_DOUBLE) && !defined(PETSC_USE_COMPLEX) && !defined(PETSC_USE_64BIT_INDICES)
   __m512d           vec_x,vec_y,vec_vals;
   __m256i           vec_idx;
-  __mmask8          mask;
+  __mmask8          mask = (__mmask8)(0xff >> (8-(A->rmap->n & 0x07)));
   __m512d           vec_x2,vec_y2,vec_vals2,vec_x3,vec_y3,vec_vals3,vec_x4,vec_y4,vec_vals4;
   __m256i           vec_idx2,vec_idx3,vec_idx4;
-#elif defined(PETSC_HAVE_IMMINTRIN_H) && defined(__AVX2__) && defined(__FMA__) && defined(PETSC_USE_REAL_DOUBLE) && !defined(PETSC_USE_COMPLEX) && !defined(PETSC_USE_64BIT_INDICES)
-  __m128i           vec_idx;
-  __m256d           vec_x,vec_y,vec_y2,vec_vals;
-  MatScalar         yval;
-  PetscInt          r,rows_left,row,nnz_in_row;
-#elif defined(PETSC_HAVE_IMMINTRIN_H) && defined(__AVX__) && defined(PETSC_USE_REAL_DOUBLE) && !defined(PETSC_USE_COMPLEX) && !defined(PETSC_USE_64BIT_INDICES)
-  __m128d           vec_x_tmp;
-  __m256d           vec_x,vec_y,vec_y2,vec_vals;
-  MatScalar         yval;
-  PetscInt          r,rows_left,row,nnz_in_row;
-#else
-  PetscScalar       sum[8];
-#endif
 
 #if defined(PETSC_HAVE_PRAGMA_DISJOINT)
 #pragma disjoint(*x,*y,*aval)
@@ -329,7 +340,6 @@ PetscErrorCode MatMult_SeqSELL(Mat A,Vec xx,Vec yy)
   PetscFunctionBegin;
   ierr = VecGetArrayRead(xx,&x);CHKERRQ(ierr);
   ierr = VecGetArray(yy,&y);CHKERRQ(ierr);
-#if defined(PETSC_HAVE_IMMINTRIN_H) && defined(__AVX512F__) && defined(PETSC_USE_REAL_DOUBLE) && !defined(PETSC_USE_COMPLEX) && !defined(PETSC_USE_64BIT_INDICES)
   for (i=0; i<totalslices; i++) { /* loop over slices */
     PetscPrefetchBlock(acolidx,a->sliidx[i+1]-a->sliidx[i],0,PETSC_PREFETCH_HINT_T0);
     PetscPrefetchBlock(aval,a->sliidx[i+1]-a->sliidx[i],0,PETSC_PREFETCH_HINT_T0);
@@ -379,13 +389,180 @@ PetscErrorCode MatMult_SeqSELL(Mat A,Vec xx,Vec yy)
     vec_y = _mm512_add_pd(vec_y,vec_y3);
     vec_y = _mm512_add_pd(vec_y,vec_y4);
     if (i == totalslices-1 && A->rmap->n & 0x07) { /* if last slice has padding rows */
-      mask = (__mmask8)(0xff >> (8-(A->rmap->n & 0x07)));
       _mm512_mask_storeu_pd(&y[8*i],mask,vec_y);
     } else {
       _mm512_storeu_pd(&y[8*i],vec_y);
     }
   }
-#elif defined(PETSC_HAVE_IMMINTRIN_H) && defined(__AVX2__) && defined(__FMA__) && defined(PETSC_USE_REAL_DOUBLE) && !defined(PETSC_USE_COMPLEX) && !defined(PETSC_USE_64BIT_INDICES)
+  ierr = PetscLogFlops(2.0*a->nz-a->nonzerorowcnt);CHKERRQ(ierr); /* theoretical minimal FLOPs */
+  ierr = VecRestoreArrayRead(xx,&x);CHKERRQ(ierr);
+  ierr = VecRestoreArray(yy,&y);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+MATSELL_TARGET("avx512f") static PetscErrorCode MatMultAdd_SeqSELL_AVX512(Mat A,Vec xx,Vec yy,Vec zz)
+{
+  Mat_SeqSELL       *a=(Mat_SeqSELL*)A->data;
+  PetscScalar       *y,*z;
+  const PetscScalar *x;
+  const MatScalar   *aval=a->val;
+  PetscInt          totalslices=a->totalslices;
+  const PetscInt    *acolidx=a->colidx;
+  PetscInt          i,j;
+  PetscErrorCode    ierr;
+  __m512d           vec_x,vec_y,vec_vals;
+  __m256i           vec_idx;
+  __mmask8          mask = (__mmask8)(0xff >> (8-(A->rmap->n & 0x07)));
+  __m512d           vec_x2,vec_y2,vec_vals2,vec_x3,vec_y3,vec_vals3,vec_x4,vec_y4,vec_vals4;
+  __m256i           vec_idx2,vec_idx3,vec_idx4;
+
+#if defined(PETSC_HAVE_PRAGMA_DISJOINT)
+#pragma disjoint(*x,*y,*aval)
+#endif
+
+  PetscFunctionBegin;
+  ierr = VecGetArrayRead(xx,&x);CHKERRQ(ierr);
+  ierr = VecGetArrayPair(yy,zz,&y,&z);CHKERRQ(ierr);
+  for (i=0; i<totalslices; i++) { /* loop over slices */
+    PetscPrefetchBlock(acolidx,a->sliidx[i+1]-a->sliidx[i],0,PETSC_PREFETCH_HINT_T0);
+    PetscPrefetchBlock(aval,a->sliidx[i+1]-a->sliidx[i],0,PETSC_PREFETCH_HINT_T0);
+
+    if (i == totalslices-1 && A->rmap->n & 0x07) { /* if last slice has padding rows */
+      vec_y  = _mm512_maskz_loadu_pd(mask,&y[8*i]);
+    } else {
+      vec_y  = _mm512_loadu_pd(&y[8*i]);
+    }
+    vec_y2 = _mm512_setzero_pd();
+    vec_y3 = _mm512_setzero_pd();
+    vec_y4 = _mm512_setzero_pd();
+
+    j = a->sliidx[i]>>3; /* 8 bytes are read at each time, corresponding to a slice columnn */
+    switch ((a->sliidx[i+1]-a->sliidx[i])/8 & 3) {
+    case 3:
+      AVX512_Mult_Private(vec_idx,vec_x,vec_vals,vec_y);
+      acolidx += 8; aval += 8;
+      AVX512_Mult_Private(vec_idx2,vec_x2,vec_vals2,vec_y2);
+      acolidx += 8; aval += 8;
+      AVX512_Mult_Private(vec_idx3,vec_x3,vec_vals3,vec_y3);
+      acolidx += 8; aval += 8;
+      j += 3;
+      break;
+    case 2:
+      AVX512_Mult_Private(vec_idx,vec_x,vec_vals,vec_y);
+      acolidx += 8; aval += 8;
+      AVX512_Mult_Private(vec_idx2,vec_x2,vec_vals2,vec_y2);
+      acolidx += 8; aval += 8;
+      j += 2;
+      break;
+    case 1:
+      AVX512_Mult_Private(vec_idx,vec_x,vec_vals,vec_y);
+      acolidx += 8; aval += 8;
+      j += 1;
+      break;
+    }
+    #pragma novector
+    for (; j<(a->sliidx[i+1]>>3); j+=4) {
+      AVX512_Mult_Private(vec_idx,vec_x,vec_vals,vec_y);
+      acolidx += 8; aval += 8;
+      AVX512_Mult_Private(vec_idx2,vec_x2,vec_vals2,vec_y2);
+      acolidx += 8; aval += 8;
+      AVX512_Mult_Private(vec_idx3,vec_x3,vec_vals3,vec_y3);
+      acolidx += 8; aval += 8;
+      AVX512_Mult_Private(vec_idx4,vec_x4,vec_vals4,vec_y4);
+      acolidx += 8; aval += 8;
+    }
+
+    vec_y = _mm512_add_pd(vec_y,vec_y2);
+    vec_y = _mm512_add_pd(vec_y,vec_y3);
+    vec_y = _mm512_add_pd(vec_y,vec_y4);
+    if (i == totalslices-1 && A->rmap->n & 0x07) { /* if last slice has padding rows */
+      _mm512_mask_storeu_pd(&z[8*i],mask,vec_y);
+    } else {
+      _mm512_storeu_pd(&z[8*i],vec_y);
+    }
+  }
+  ierr = PetscLogFlops(2.0*a->nz);CHKERRQ(ierr);
+  ierr = VecRestoreArrayRead(xx,&x);CHKERRQ(ierr);
+  ierr = VecRestoreArrayPair(yy,zz,&y,&z);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+/*
+   The products of a slice column with the 8 entries of x belonging to the slice are formed with one vector
+   multiply; the scatter into y stays scalar since rows of a slice may share columns.
+*/
+MATSELL_TARGET("avx512f") static PetscErrorCode MatMultTransposeAdd_SeqSELL_AVX512(Mat A,Vec xx,Vec zz,Vec yy)
+{
+  Mat_SeqSELL       *a=(Mat_SeqSELL*)A->data;
+  PetscScalar       *y;
+  const PetscScalar *x;
+  const MatScalar   *aval=a->val;
+  const PetscInt    *acolidx=a->colidx;
+  PetscInt          i,j,r,row,nnz_in_row,totalslices=a->totalslices;
+  PetscErrorCode    ierr;
+  __m512d           vec_x;
+  PetscScalar       prod[8];
+
+#if defined(PETSC_HAVE_PRAGMA_DISJOINT)
+#pragma disjoint(*x,*y,*aval)
+#endif
+
+  PetscFunctionBegin;
+  if (zz != yy) { ierr = VecCopy(zz,yy);CHKERRQ(ierr); }
+  ierr = VecGetArrayRead(xx,&x);CHKERRQ(ierr);
+  ierr = VecGetArray(yy,&y);CHKERRQ(ierr);
+  for (i=0; i<totalslices; i++) { /* loop over slices */
+    if (i == totalslices-1 && (A->rmap->n & 0x07)) {
+      for (r=0; r<(A->rmap->n & 0x07); ++r) {
+        row        = 8*i + r;
+        nnz_in_row = a->rlen[row];
+        for (j=0; j<nnz_in_row; ++j) y[acolidx[a->sliidx[i]+8*j+r]] += aval[a->sliidx[i]+8*j+r] * x[row];
+      }
+      break;
+    }
+    vec_x = _mm512_loadu_pd(&x[8*i]);
+    for (j=a->sliidx[i]; j<a->sliidx[i+1]; j+=8) {
+      _mm512_storeu_pd(prod,_mm512_mul_pd(_mm512_loadu_pd(&aval[j]),vec_x));
+      y[acolidx[j]]   += prod[0];
+      y[acolidx[j+1]] += prod[1];
+      y[acolidx[j+2]] += prod[2];
+      y[acolidx[j+3]] += prod[3];
+      y[acolidx[j+4]] += prod[4];
+      y[acolidx[j+5]] += prod[5];
+      y[acolidx[j+6]] += prod[6];
+      y[acolidx[j+7]] += prod[7];
+    }
+  }
+  ierr = PetscLogFlops(2.0*a->sliidx[a->totalslices]);CHKERRQ(ierr);
+  ierr = VecRestoreArrayRead(xx,&x);CHKERRQ(ierr);
+  ierr = VecRestoreArray(yy,&y);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+#endif
+
+#if defined(MATSELL_HAVE_AVX2)
+MATSELL_TARGET("avx2,fma") static PetscErrorCode MatMult_SeqSELL_AVX2(Mat A,Vec xx,Vec yy)
+{
+  Mat_SeqSELL       *a=(Mat_SeqSELL*)A->data;
+  PetscScalar       *y;
+  const PetscScalar *x;
+  const MatScalar   *aval=a->val;
+  PetscInt          totalslices=a->totalslices;
+  const PetscInt    *acolidx=a->colidx;
+  PetscInt          i,j;
+  PetscErrorCode    ierr;
+  __m128i           vec_idx;
+  __m256d           vec_x,vec_y,vec_y2,vec_vals;
+  MatScalar         yval;
+  PetscInt          r,rows_left,row,nnz_in_row;
+
+#if defined(PETSC_HAVE_PRAGMA_DISJOINT)
+#pragma disjoint(*x,*y,*aval)
+#endif
+
+  PetscFunctionBegin;
+  ierr = VecGetArrayRead(xx,&x);CHKERRQ(ierr);
+  ierr = VecGetArray(yy,&y);CHKERRQ(ierr);
   for (i=0; i<totalslices; i++) { /* loop over full slices */
     PetscPrefetchBlock(acolidx,a->sliidx[i+1]-a->sliidx[i],0,PETSC_PREFETCH_HINT_T0);
     PetscPrefetchBlock(aval,a->sliidx[i+1]-a->sliidx[i],0,PETSC_PREFETCH_HINT_T0);
@@ -419,7 +596,146 @@ PetscErrorCode MatMult_SeqSELL(Mat A,Vec xx,Vec yy)
     _mm256_storeu_pd(y+i*8,vec_y);
     _mm256_storeu_pd(y+i*8+4,vec_y2);
   }
-#elif defined(PETSC_HAVE_IMMINTRIN_H) && defined(__AVX__) && defined(PETSC_USE_REAL_DOUBLE) && !defined(PETSC_USE_COMPLEX) && !defined(PETSC_USE_64BIT_INDICES)
+  ierr = PetscLogFlops(2.0*a->nz-a->nonzerorowcnt);CHKERRQ(ierr); /* theoretical minimal FLOPs */
+  ierr = VecRestoreArrayRead(xx,&x);CHKERRQ(ierr);
+  ierr = VecRestoreArray(yy,&y);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+MATSELL_TARGET("avx2,fma") static PetscErrorCode MatMultAdd_SeqSELL_AVX2(Mat A,Vec xx,Vec yy,Vec zz)
+{
+  Mat_SeqSELL       *a=(Mat_SeqSELL*)A->data;
+  PetscScalar       *y,*z;
+  const PetscScalar *x;
+  const MatScalar   *aval=a->val;
+  PetscInt          totalslices=a->totalslices;
+  const PetscInt    *acolidx=a->colidx;
+  PetscInt          i,j;
+  PetscErrorCode    ierr;
+  __m128i           vec_idx;
+  __m256d           vec_x,vec_y,vec_y2,vec_vals;
+  MatScalar         yval;
+  PetscInt          r,row,nnz_in_row;
+
+#if defined(PETSC_HAVE_PRAGMA_DISJOINT)
+#pragma disjoint(*x,*y,*aval)
+#endif
+
+  PetscFunctionBegin;
+  ierr = VecGetArrayRead(xx,&x);CHKERRQ(ierr);
+  ierr = VecGetArrayPair(yy,zz,&y,&z);CHKERRQ(ierr);
+  for (i=0; i<totalslices; i++) { /* loop over full slices */
+    PetscPrefetchBlock(acolidx,a->sliidx[i+1]-a->sliidx[i],0,PETSC_PREFETCH_HINT_T0);
+    PetscPrefetchBlock(aval,a->sliidx[i+1]-a->sliidx[i],0,PETSC_PREFETCH_HINT_T0);
+
+    /* last slice may have padding rows. Don't use vectorization. */
+    if (i == totalslices-1 && (A->rmap->n & 0x07)) {
+      for (r=0; r<(A->rmap->n & 0x07); ++r) {
+        row        = 8*i + r;
+        yval       = (MatScalar)0.0;
+        nnz_in_row = a->rlen[row];
+        for (j=0; j<nnz_in_row; ++j) yval += aval[8*j+r] * x[acolidx[8*j+r]];
+        z[row] = y[row] + yval;
+      }
+      break;
+    }
+
+    vec_y  = _mm256_loadu_pd(y+8*i);
+    vec_y2 = _mm256_loadu_pd(y+8*i+4);
+
+    /* Process slice of height 8 (512 bits) via two subslices of height 4 (256 bits) via AVX */
+    #pragma novector
+    #pragma unroll(2)
+    for (j=a->sliidx[i]; j<a->sliidx[i+1]; j+=8) {
+      AVX2_Mult_Private(vec_idx,vec_x,vec_vals,vec_y);
+      aval += 4; acolidx += 4;
+      AVX2_Mult_Private(vec_idx,vec_x,vec_vals,vec_y2);
+      aval += 4; acolidx += 4;
+    }
+
+    _mm256_storeu_pd(z+i*8,vec_y);
+    _mm256_storeu_pd(z+i*8+4,vec_y2);
+  }
+  ierr = PetscLogFlops(2.0*a->nz);CHKERRQ(ierr);
+  ierr = VecRestoreArrayRead(xx,&x);CHKERRQ(ierr);
+  ierr = VecRestoreArrayPair(yy,zz,&y,&z);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+MATSELL_TARGET("avx2,fma") static PetscErrorCode MatMultTransposeAdd_SeqSELL_AVX2(Mat A,Vec xx,Vec zz,Vec yy)
+{
+  Mat_SeqSELL       *a=(Mat_SeqSELL*)A->data;
+  PetscScalar       *y;
+  const PetscScalar *x;
+  const MatScalar   *aval=a->val;
+  const PetscInt    *acolidx=a->colidx;
+  PetscInt          i,j,r,row,nnz_in_row,totalslices=a->totalslices;
+  PetscErrorCode    ierr;
+  __m256d           vec_x,vec_x2;
+  PetscScalar       prod[8];
+
+#if defined(PETSC_HAVE_PRAGMA_DISJOINT)
+#pragma disjoint(*x,*y,*aval)
+#endif
+
+  PetscFunctionBegin;
+  if (zz != yy) { ierr = VecCopy(zz,yy);CHKERRQ(ierr); }
+  ierr = VecGetArrayRead(xx,&x);CHKERRQ(ierr);
+  ierr = VecGetArray(yy,&y);CHKERRQ(ierr);
+  for (i=0; i<totalslices; i++) { /* loop over slices */
+    if (i == totalslices-1 && (A->rmap->n & 0x07)) {
+      for (r=0; r<(A->rmap->n & 0x07); ++r) {
+        row        = 8*i + r;
+        nnz_in_row = a->rlen[row];
+        for (j=0; j<nnz_in_row; ++j) y[acolidx[a->sliidx[i]+8*j+r]] += aval[a->sliidx[i]+8*j+r] * x[row];
+      }
+      break;
+    }
+    vec_x  = _mm256_loadu_pd(&x[8*i]);
+    vec_x2 = _mm256_loadu_pd(&x[8*i+4]);
+    for (j=a->sliidx[i]; j<a->sliidx[i+1]; j+=8) {
+      _mm256_storeu_pd(prod,_mm256_mul_pd(_mm256_loadu_pd(&aval[j]),vec_x));
+      _mm256_storeu_pd(prod+4,_mm256_mul_pd(_mm256_loadu_pd(&aval[j+4]),vec_x2));
+      y[acolidx[j]]   += prod[0];
+      y[acolidx[j+1]] += prod[1];
+      y[acolidx[j+2]] += prod[2];
+      y[acolidx[j+3]] += prod[3];
+      y[acolidx[j+4]] += prod[4];
+      y[acolidx[j+5]] += prod[5];
+      y[acolidx[j+6]] += prod[6];
+      y[acolidx[j+7]] += prod[7];
+    }
+  }
+  ierr = PetscLogFlops(2.0*a->sliidx[a->totalslices]);CHKERRQ(ierr);
+  ierr = VecRestoreArrayRead(xx,&x);CHKERRQ(ierr);
+  ierr = VecRestoreArray(yy,&y);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+#endif
+
+#if defined(MATSELL_HAVE_AVX)
+MATSELL_TARGET("avx") static PetscErrorCode MatMult_SeqSELL_AVX(Mat A,Vec xx,Vec yy)
+{
+  Mat_SeqSELL       *a=(Mat_SeqSELL*)A->data;
+  PetscScalar       *y;
+  const PetscScalar *x;
+  const MatScalar   *aval=a->val;
+  PetscInt          totalslices=a->totalslices;
+  const PetscInt    *acolidx=a->colidx;
+  PetscInt          i,j;
+  PetscErrorCode    ierr;
+  __m128d           vec_x_tmp = _mm_setzero_pd();
+  __m256d           vec_x = _mm256_setzero_pd(),vec_y,vec_y2,vec_vals;
+  MatScalar         yval;
+  PetscInt          r,rows_left,row,nnz_in_row;
+
+#if defined(PETSC_HAVE_PRAGMA_DISJOINT)
+#pragma disjoint(*x,*y,*aval)
+#endif
+
+  PetscFunctionBegin;
+  ierr = VecGetArrayRead(xx,&x);CHKERRQ(ierr);
+  ierr = VecGetArray(yy,&y);CHKERRQ(ierr);
   for (i=0; i<totalslices; i++) { /* loop over full slices */
     PetscPrefetchBlock(acolidx,a->sliidx[i+1]-a->sliidx[i],0,PETSC_PREFETCH_HINT_T0);
     PetscPrefetchBlock(aval,a->sliidx[i+1]-a->sliidx[i],0,PETSC_PREFETCH_HINT_T0);
@@ -468,35 +784,13 @@ PetscErrorCode MatMult_SeqSELL(Mat A,Vec xx,Vec yy)
     _mm256_storeu_pd(y + i*8,     vec_y);
     _mm256_storeu_pd(y + i*8 + 4, vec_y2);
   }
-#else
-  for (i=0; i<totalslices; i++) { /* loop over slices */
-    for (j=0; j<8; j++) sum[j] = 0.0;
-    for (j=a->sliidx[i]; j<a->sliidx[i+1]; j+=8) {
-      sum[0] += aval[j] * x[acolidx[j]];
-      sum[1] += aval[j+1] * x[acolidx[j+1]];
-      sum[2] += aval[j+2] * x[acolidx[j+2]];
-      sum[3] += aval[j+3] * x[acolidx[j+3]];
-      sum[4] += aval[j+4] * x[acolidx[j+4]];
-      sum[5] += aval[j+5] * x[acolidx[j+5]];
-      sum[6] += aval[j+6] * x[acolidx[j+6]];
-      sum[7] += aval[j+7] * x[acolidx[j+7]];
-    }
-    if (i == totalslices-1 && (A->rmap->n & 0x07)) { /* if last slice has padding rows */
-      for(j=0; j<(A->rmap->n & 0x07); j++) y[8*i+j] = sum[j];
-    } else {
-      for(j=0; j<8; j++) y[8*i+j] = sum[j];
-    }
-  }
-#endif
-
   ierr = PetscLogFlops(2.0*a->nz-a->nonzerorowcnt);CHKERRQ(ierr); /* theoretical minimal FLOPs */
   ierr = VecRestoreArrayRead(xx,&x);CHKERRQ(ierr);
   ierr = VecRestoreArray(yy,&y);CHKERRQ(ierr);
   PetscFunctionReturn(0);
 }
 
-#include <../src/mat/impls/aij/seq/ftn-kernels/fmultadd.h>
-PetscErrorCode MatMultAdd_SeqSELL(Mat A,Vec xx,Vec yy,Vec zz)
+MATSELL_TARGET("avx") static PetscErrorCode MatMultAdd_SeqSELL_AVX(Mat A,Vec xx,Vec yy,Vec zz)
 {
   Mat_SeqSELL       *a=(Mat_SeqSELL*)A->data;
   PetscScalar       *y,*z;
@@ -506,20 +800,10 @@ PetscErrorCode MatMultAdd_SeqSELL(Mat A,Vec xx,Vec yy,Vec zz)
   const PetscInt    *acolidx=a->colidx;
   PetscInt          i,j;
   PetscErrorCode    ierr;
-#if defined(PETSC_HAVE_IMMINTRIN_H) && defined(__AVX512F__) && defined(PETSC_USE_REAL_DOUBLE) && !defined(PETSC_USE_COMPLEX) && !defined(PETSC_USE_64BIT_INDICES)
-  __m512d           vec_x,vec_y,vec_vals;
-  __m256i           vec_idx;
-  __mmask8          mask;
-  __m512d           vec_x2,vec_y2,vec_vals2,vec_x3,vec_y3,vec_vals3,vec_x4,vec_y4,vec_vals4;
-  __m256i           vec_idx2,vec_idx3,vec_idx4;
-#elif defined(PETSC_HAVE_IMMINTRIN_H) && defined(__AVX__) && defined(PETSC_USE_REAL_DOUBLE) && !defined(PETSC_USE_COMPLEX) && !defined(PETSC_USE_64BIT_INDICES)
-  __m128d           vec_x_tmp;
-  __m256d           vec_x,vec_y,vec_y2,vec_vals;
+  __m128d           vec_x_tmp = _mm_setzero_pd();
+  __m256d           vec_x = _mm256_setzero_pd(),vec_y,vec_y2,vec_vals;
   MatScalar         yval;
   PetscInt          r,row,nnz_in_row;
-#else
-  PetscScalar       sum[8];
-#endif
 
 #if defined(PETSC_HAVE_PRAGMA_DISJOINT)
 #pragma disjoint(*x,*y,*aval)
@@ -528,67 +812,6 @@ PetscErrorCode MatMultAdd_SeqSELL(Mat A,Vec xx,Vec yy,Vec zz)
   PetscFunctionBegin;
   ierr = VecGetArrayRead(xx,&x);CHKERRQ(ierr);
   ierr = VecGetArrayPair(yy,zz,&y,&z);CHKERRQ(ierr);
-#if defined(PETSC_HAVE_IMMINTRIN_H) && defined(__AVX512F__) && defined(PETSC_USE_REAL_DOUBLE) && !defined(PETSC_USE_COMPLEX) && !defined(PETSC_USE_64BIT_INDICES)
-  for (i=0; i<totalslices; i++) { /* loop over slices */
-    PetscPrefetchBlock(acolidx,a->sliidx[i+1]-a->sliidx[i],0,PETSC_PREFETCH_HINT_T0);
-    PetscPrefetchBlock(aval,a->sliidx[i+1]-a->sliidx[i],0,PETSC_PREFETCH_HINT_T0);
-
-    if (i == totalslices-1 && A->rmap->n & 0x07) { /* if last slice has padding rows */
-      mask   = (__mmask8)(0xff >> (8-(A->rmap->n & 0x07)));
-      vec_y  = _mm512_mask_loadu_pd(vec_y,mask,&y[8*i]);
-    } else {
-      vec_y  = _mm512_loadu_pd(&y[8*i]);
-    }
-    vec_y2 = _mm512_setzero_pd();
-    vec_y3 = _mm512_setzero_pd();
-    vec_y4 = _mm512_setzero_pd();
-
-    j = a->sliidx[i]>>3; /* 8 bytes are read at each time, corresponding to a slice columnn */
-    switch ((a->sliidx[i+1]-a->sliidx[i])/8 & 3) {
-    case 3:
-      AVX512_Mult_Private(vec_idx,vec_x,vec_vals,vec_y);
-      acolidx += 8; aval += 8;
-      AVX512_Mult_Private(vec_idx2,vec_x2,vec_vals2,vec_y2);
-      acolidx += 8; aval += 8;
-      AVX512_Mult_Private(vec_idx3,vec_x3,vec_vals3,vec_y3);
-      acolidx += 8; aval += 8;
-      j += 3;
-      break;
-    case 2:
-      AVX512_Mult_Private(vec_idx,vec_x,vec_vals,vec_y);
-      acolidx += 8; aval += 8;
-      AVX512_Mult_Private(vec_idx2,vec_x2,vec_vals2,vec_y2);
-      acolidx += 8; aval += 8;
-      j += 2;
-      break;
-    case 1:
-      AVX512_Mult_Private(vec_idx,vec_x,vec_vals,vec_y);
-      acolidx += 8; aval += 8;
-      j += 1;
-      break;
-    }
-    #pragma novector
-    for (; j<(a->sliidx[i+1]>>3); j+=4) {
-      AVX512_Mult_Private(vec_idx,vec_x,vec_vals,vec_y);
-      acolidx += 8; aval += 8;
-      AVX512_Mult_Private(vec_idx2,vec_x2,vec_vals2,vec_y2);
-      acolidx += 8; aval += 8;
-      AVX512_Mult_Private(vec_idx3,vec_x3,vec_vals3,vec_y3);
-      acolidx += 8; aval += 8;
-      AVX512_Mult_Private(vec_idx4,vec_x4,vec_vals4,vec_y4);
-      acolidx += 8; aval += 8;
-    }
-
-    vec_y = _mm512_add_pd(vec_y,vec_y2);
-    vec_y = _mm512_add_pd(vec_y,vec_y3);
-    vec_y = _mm512_add_pd(vec_y,vec_y4);
-    if (i == totalslices-1 && A->rmap->n & 0x07) { /* if last slice has padding rows */
-      _mm512_mask_storeu_pd(&z[8*i],mask,vec_y);
-    } else {
-      _mm512_storeu_pd(&z[8*i],vec_y);
-    }
-  }
-#elif defined(PETSC_HAVE_IMMINTRIN_H) && defined(__AVX__) && defined(PETSC_USE_REAL_DOUBLE) && !defined(PETSC_USE_COMPLEX) && !defined(PETSC_USE_64BIT_INDICES)
   for (i=0; i<totalslices; i++) { /* loop over full slices */
     PetscPrefetchBlock(acolidx,a->sliidx[i+1]-a->sliidx[i],0,PETSC_PREFETCH_HINT_T0);
     PetscPrefetchBlock(aval,a->sliidx[i+1]-a->sliidx[i],0,PETSC_PREFETCH_HINT_T0);
@@ -634,7 +857,75 @@ PetscErrorCode MatMultAdd_SeqSELL(Mat A,Vec xx,Vec yy,Vec zz)
     _mm256_storeu_pd(z+i*8,vec_y);
     _mm256_storeu_pd(z+i*8+4,vec_y2);
   }
-#else
+  ierr = PetscLogFlops(2.0*a->nz);CHKERRQ(ierr);
+  ierr = VecRestoreArrayRead(xx,&x);CHKERRQ(ierr);
+  ierr = VecRestoreArrayPair(yy,zz,&y,&z);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+#endif
+
+static PetscErrorCode MatMult_SeqSELL_Generic(Mat A,Vec xx,Vec yy)
+{
+  Mat_SeqSELL       *a=(Mat_SeqSELL*)A->data;
+  PetscScalar       *y;
+  const PetscScalar *x;
+  const MatScalar   *aval=a->val;
+  PetscInt          totalslices=a->totalslices;
+  const PetscInt    *acolidx=a->colidx;
+  PetscInt          i,j;
+  PetscErrorCode    ierr;
+  PetscScalar       sum[8];
+
+#if defined(PETSC_HAVE_PRAGMA_DISJOINT)
+#pragma disjoint(*x,*y,*aval)
+#endif
+
+  PetscFunctionBegin;
+  ierr = VecGetArrayRead(xx,&x);CHKERRQ(ierr);
+  ierr = VecGetArray(yy,&y);CHKERRQ(ierr);
+  for (i=0; i<totalslices; i++) { /* loop over slices */
+    for (j=0; j<8; j++) sum[j] = 0.0;
+    for (j=a->sliidx[i]; j<a->sliidx[i+1]; j+=8) {
+      sum[0] += aval[j] * x[acolidx[j]];
+      sum[1] += aval[j+1] * x[acolidx[j+1]];
+      sum[2] += aval[j+2] * x[acolidx[j+2]];
+      sum[3] += aval[j+3] * x[acolidx[j+3]];
+      sum[4] += aval[j+4] * x[acolidx[j+4]];
+      sum[5] += aval[j+5] * x[acolidx[j+5]];
+      sum[6] += aval[j+6] * x[acolidx[j+6]];
+      sum[7] += aval[j+7] * x[acolidx[j+7]];
+    }
+    if (i == totalslices-1 && (A->rmap->n & 0x07)) { /* if last slice has padding rows */
+      for(j=0; j<(A->rmap->n & 0x07); j++) y[8*i+j] = sum[j];
+    } else {
+      for(j=0; j<8; j++) y[8*i+j] = sum[j];
+    }
+  }
+  ierr = PetscLogFlops(2.0*a->nz-a->nonzerorowcnt);CHKERRQ(ierr); /* theoretical minimal FLOPs */
+  ierr = VecRestoreArrayRead(xx,&x);CHKERRQ(ierr);
+  ierr = VecRestoreArray(yy,&y);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode MatMultAdd_SeqSELL_Generic(Mat A,Vec xx,Vec yy,Vec zz)
+{
+  Mat_SeqSELL       *a=(Mat_SeqSELL*)A->data;
+  PetscScalar       *y,*z;
+  const PetscScalar *x;
+  const MatScalar   *aval=a->val;
+  PetscInt          totalslices=a->totalslices;
+  const PetscInt    *acolidx=a->colidx;
+  PetscInt          i,j;
+  PetscErrorCode    ierr;
+  PetscScalar       sum[8];
+
+#if defined(PETSC_HAVE_PRAGMA_DISJOINT)
+#pragma disjoint(*x,*y,*aval)
+#endif
+
+  PetscFunctionBegin;
+  ierr = VecGetArrayRead(xx,&x);CHKERRQ(ierr);
+  ierr = VecGetArrayPair(yy,zz,&y,&z);CHKERRQ(ierr);
   for (i=0; i<totalslices; i++) { /* loop over slices */
     for (j=0; j<8; j++) sum[j] = 0.0;
     for (j=a->sliidx[i]; j<a->sliidx[i+1]; j+=8) {
@@ -653,15 +944,13 @@ PetscErrorCode MatMultAdd_SeqSELL(Mat A,Vec xx,Vec yy,Vec zz)
       for (j=0; j<8; j++) z[8*i+j] = y[8*i+j] + sum[j];
     }
   }
-#endif
-
   ierr = PetscLogFlops(2.0*a->nz);CHKERRQ(ierr);
   ierr = VecRestoreArrayRead(xx,&x);CHKERRQ(ierr);
   ierr = VecRestoreArrayPair(yy,zz,&y,&z);CHKERRQ(ierr);
   PetscFunctionReturn(0);
 }
 
-PetscErrorCode MatMultTransposeAdd_SeqSELL(Mat A,Vec xx,Vec zz,Vec yy)
+static PetscErrorCode MatMultTransposeAdd_SeqSELL_Generic(Mat A,Vec xx,Vec zz,Vec yy)
 {
   Mat_SeqSELL       *a=(Mat_SeqSELL*)A->data;
   PetscScalar       *y;
@@ -676,10 +965,6 @@ PetscErrorCode MatMultTransposeAdd_SeqSELL(Mat A,Vec xx,Vec zz,Vec yy)
 #endif
 
   PetscFunctionBegin;
-  if (A->symmetric) {
-    ierr = MatMultAdd_SeqSELL(A,xx,zz,yy);CHKERRQ(ierr);
-    PetscFunctionReturn(0);
-  }
   if (zz != yy) { ierr = VecCopy(zz,yy);CHKERRQ(ierr); }
   ierr = VecGetArrayRead(xx,&x);CHKERRQ(ierr);
   ierr = VecGetArray(yy,&y);CHKERRQ(ierr);
@@ -688,7 +973,7 @@ PetscErrorCode MatMultTransposeAdd_SeqSELL(Mat A,Vec xx,Vec zz,Vec yy)
       for (r=0; r<(A->rmap->n & 0x07); ++r) {
         row        = 8*i + r;
         nnz_in_row = a->rlen[row];
-        for (j=0; j<nnz_in_row; ++j) y[acolidx[8*j+r]] += aval[8*j+r] * x[row];
+        for (j=0; j<nnz_in_row; ++j) y[acolidx[a->sliidx[i]+8*j+r]] += aval[a->sliidx[i]+8*j+r] * x[row];
       }
       break;
     }
@@ -709,6 +994,105 @@ PetscErrorCode MatMultTransposeAdd_SeqSELL(Mat A,Vec xx,Vec zz,Vec yy)
   PetscFunctionReturn(0);
 }
 
+static const char *const MatSeqSELLSIMDTypes[] = {"generic","avx","avx2","avx512"};
+
+/*
+   Selects the SIMD variant of the MatMult(), MatMultAdd() and MatMultTransposeAdd() kernels: by default the widest
+   instruction set supported by the CPU (or by the compiler flags when the kernels cannot be dispatched at runtime);
+   -mat_sell_simd can select a narrower one. The slice height of 8 fills one 512-bit register (two 256-bit registers)
+   with double precision values.
+*/
+static PetscErrorCode MatSeqSELLSetKernels_Private(Mat A)
+{
+  Mat_SeqSELL    *a = (Mat_SeqSELL*)A->data;
+  PetscInt       simd = 0,maxsimd = 0;
+  PetscBool      flg;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+#if defined(PETSC_HAVE_X86_CPU_DISPATCH) && defined(MATSELL_HAVE_AVX)
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f")) maxsimd = 3;
+  else if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) maxsimd = 2;
+  else if (__builtin_cpu_supports("avx")) maxsimd = 1;
+#elif defined(MATSELL_HAVE_AVX512)
+  maxsimd = 3;
+#elif defined(MATSELL_HAVE_AVX2)
+  maxsimd = 2;
+#elif defined(MATSELL_HAVE_AVX)
+  maxsimd = 1;
+#endif
+  simd = maxsimd;
+  ierr = PetscObjectOptionsBegin((PetscObject)A);CHKERRQ(ierr);
+  ierr = PetscOptionsEList("-mat_sell_simd","SIMD instruction set used by the SELL kernels","None",MatSeqSELLSIMDTypes,4,MatSeqSELLSIMDTypes[simd],&simd,&flg);CHKERRQ(ierr);
+  ierr = PetscOptionsEnd();CHKERRQ(ierr);
+  if (flg && simd > maxsimd) SETERRQ2(PetscObjectComm((PetscObject)A),PETSC_ERR_SUP,"SIMD instruction set %s is not supported, the widest available is %s",MatSeqSELLSIMDTypes[simd],MatSeqSELLSIMDTypes[maxsimd]);
+
+  a->mult             = MatMult_SeqSELL_Generic;
+  a->multadd          = MatMultAdd_SeqSELL_Generic;
+  a->multtransposeadd = MatMultTransposeAdd_SeqSELL_Generic;
+  switch (simd) {
+#if defined(MATSELL_HAVE_AVX512)
+  case 3:
+    a->mult             = MatMult_SeqSELL_AVX512;
+    a->multadd          = MatMultAdd_SeqSELL_AVX512;
+    a->multtransposeadd = MatMultTransposeAdd_SeqSELL_AVX512;
+    break;
+#endif
+#if defined(MATSELL_HAVE_AVX2)
+  case 2:
+    a->mult             = MatMult_SeqSELL_AVX2;
+    a->multadd          = MatMultAdd_SeqSELL_AVX2;
+    a->multtransposeadd = MatMultTransposeAdd_SeqSELL_AVX2;
+    break;
+#endif
+#if defined(MATSELL_HAVE_AVX)
+  case 1:
+    a->mult             = MatMult_SeqSELL_AVX;
+    a->multadd          = MatMultAdd_SeqSELL_AVX;
+    break;
+#endif
+  default:
+    break;
+  }
+  ierr = PetscInfo1(A,"Using %s SELL kernels\n",MatSeqSELLSIMDTypes[simd]);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+PetscErrorCode MatMult_SeqSELL(Mat A,Vec xx,Vec yy)
+{
+  Mat_SeqSELL    *a=(Mat_SeqSELL*)A->data;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = (*a->mult)(A,xx,yy);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+PetscErrorCode MatMultAdd_SeqSELL(Mat A,Vec xx,Vec yy,Vec zz)
+{
+  Mat_SeqSELL    *a=(Mat_SeqSELL*)A->data;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  ierr = (*a->multadd)(A,xx,yy,zz);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
+PetscErrorCode MatMultTransposeAdd_SeqSELL(Mat A,Vec xx,Vec zz,Vec yy)
+{
+  Mat_SeqSELL    *a=(Mat_SeqSELL*)A->data;
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  if (A->symmetric) {
+    ierr = MatMultAdd_SeqSELL(A,xx,zz,yy);CHKERRQ(ierr);
+    PetscFunctionReturn(0);
+  }
+  ierr = (*a->multtransposeadd)(A,xx,zz,yy);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
 PetscErrorCode MatMultTranspose_SeqSELL(Mat A,Vec xx,Vec yy)
 {
   PetscErrorCode ierr;
@@ -1971,6 +2355,7 @@ PETSC_EXTERN PetscErrorCode MatCreate_SeqSELL(Mat B)
   b->idiagvalid         = PETSC_FALSE;
   b->keepnonzeropattern = PETSC_FALSE;
 
+  ierr = MatSeqSELLSetKernels_Private(B);CHKERRQ(ierr);
   ierr = PetscObjectChangeTypeName((PetscObject)B,MATSEQSELL);CHKERRQ(ierr);
   ierr = PetscObjectComposeFunction((PetscObject)B,"MatSeqSELLGetArray_C",MatSeqSELLGetArray_SeqSELL);CHKERRQ(ierr);
   ierr = PetscObjectComposeFunction((PetscObject)B,"MatSeqSELLRestoreArray_C",MatSeqSELLRestoreArray_SeqSELL);CHKERRQ(ierr);
@@ -2000,6 +2385,10 @@ PetscErrorCode MatDuplicateNoCreate_SeqSELL(Mat C,Mat A,MatDuplicateOption cpval
   c->icol       = 0;
   c->reallocs   = 0;
 
+  c->mult             = a->mult;
+  c->multadd          = a->multadd;
+  c->multtransposeadd = a->multtransposeadd;
+
   C->assembled = PETSC_TRUE;
 
   ierr = PetscLayoutReference(A->rmap,&C->rmap);CHKERRQ(ierr);
@@ -47,6 +47,9 @@ typedef struct {
   PetscBool   idiagvalid;                /* current idiag[] and mdiag[] are valid */
   PetscScalar fshift,omega;              /* last used omega and fshift */
   ISColoring  coloring;                  /* set with MatADSetColoring() used by MatADSetValues() */
+  PetscErrorCode (*mult)(Mat,Vec,Vec);   /* MatMult() kernel for the selected SIMD instruction set */
+  PetscErrorCode (*multadd)(Mat,Vec,Vec,Vec);
+  PetscErrorCode (*multtransposeadd)(Mat,Vec,Vec,Vec);
 } Mat_SeqSELL;
 
 /*
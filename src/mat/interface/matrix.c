@@ -34,7 +34,7 @@ PetscLogEvent MAT_GetMultiProcBlock;
 PetscLogEvent MAT_CUSPARSECopyToGPU, MAT_SetValuesBatch;
 PetscLogEvent MAT_ViennaCLCopyToGPU;
 PetscLogEvent MAT_DenseCopyToGPU, MAT_DenseCopyFromGPU;
-PetscLogEvent MAT_Merge,MAT_Residual,MAT_SetRandom;
+PetscLogEvent MAT_Merge,MAT_Residual,MAT_SetRandom,MAT_Autotune;
 PetscLogEvent MAT_FactorFactS,MAT_FactorInvS;
 PetscLogEvent MATCOLORING_Apply,MATCOLORING_Comm,MATCOLORING_Local,MATCOLORING_ISCreate,MATCOLORING_SetUp,MATCOLORING_Weights;
 
@@ -5220,6 +5220,13 @@ static PetscInt MatAssemblyEnd_InUse = 0;
    out by assembly. If you intend to use that extra space on a subsequent assembly, be sure to insert explicit zeros
    before MAT_FINAL_ASSEMBLY so the space is not compressed out.
 
+   For MATMPIAIJ the option -matstash_stream <n> sends the cached off-process values to their owners in the background
+   whenever n of them have accumulated, and merges values received from other processes during later calls to
+   MatSetValues(), so that most of the assembly communication overlaps with the computation of the entries.
+
+   Options Database Keys:
+.  -matstash_stream <n> - send off-process values while they are being set, in segments of n entries
+
    Level: beginner
 
 .seealso: MatAssemblyEnd(), MatSetValues(), MatAssembled()
@@ -5458,6 +5465,10 @@ PetscErrorCode MatAssemblyEnd(Mat mat,MatAssemblyType type)
    to improve the searching of indices. MAT_NEW_NONZERO_LOCATIONS flag
    should be used with MAT_USE_HASH_TABLE flag. This option is currently
    supported by MATMPIBAIJ format only.
+   For MATSEQAIJ and MATMPIAIJ MAT_USE_HASH_TABLE has a different meaning: it must be set before the first assembly
+   and the entries are then collected in a hash table and compressed into exactly preallocated rows during
+   the first MatAssemblyEnd(), so the assembly time does not depend on the preallocation. It is not supported for
+   matrices using arrays provided by the user, such as those from MatCreateSeqAIJWithArrays().
 
    MAT_KEEP_NONZERO_PATTERN indicates when MatZeroRows() is called the zeroed entries
    are kept in the nonzero structure
@@ -177,4 +177,16 @@ int main(int argc,char **argv)
       args: -test_userAPI
       output_file: output/ex109.out
 
+   test:
+      suffix: 6
+      args: -m 3 -n 5
+      output_file: output/ex109.out
+
+   test:
+      suffix: threads
+      nsize: 2
+      args: -m 5 -n 7 -mat_aij_threads 2
+      output_file: output/ex109.out
+      requires: openmp
+
 TEST*/
@@ -130,4 +130,10 @@ int main(int argc,char **args)
    test:
       nsize: 4
 
+   test:
+      suffix: stream
+      nsize: 4
+      args: -m 12 -matstash_stream 8
+      output_file: output/ex19_1.out
+
 TEST*/
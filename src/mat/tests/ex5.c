@@ -62,6 +62,8 @@ int main(int argc,char **args)
   }
 
   /* Flush off proc Mat values and do more assembly */
+  ierr = PetscOptionsHasName(NULL,NULL,"-hash_after_values",&flg);CHKERRQ(ierr);
+  if (flg) {ierr = MatSetOption(C,MAT_USE_HASH_TABLE,PETSC_TRUE);CHKERRQ(ierr);}
   ierr = MatAssemblyBegin(C,MAT_FLUSH_ASSEMBLY);CHKERRQ(ierr);
   for (i=rstart; i<rend; i++) {
     for (j=0; j<n; j++) {
@@ -264,6 +266,73 @@ int main(int argc,char **args)
       output_file: output/ex5_11_B.out
       requires: cuda
 
+   test:
+      suffix: threads_1
+      args: -mat_type seqaij -rectA -mat_aij_threads 3
+      filter: grep -v type
+      output_file: output/ex5_11_A.out
+      requires: openmp
+
+   test:
+      suffix: threads_2
+      nsize: 3
+      args: -mat_type mpiaij -mat_aij_threads 2
+      filter: grep -v type
+      output_file: output/ex5_23.out
+      requires: openmp
+
+   test:
+      suffix: compress_indices_1
+      args: -mat_type seqaij -rectA -mat_aij_compress_indices
+      filter: grep -v type
+      output_file: output/ex5_11_A.out
+
+   test:
+      suffix: compress_indices_2
+      nsize: 3
+      args: -mat_type mpiaij -mat_aij_compress_indices
+      filter: grep -v type
+      output_file: output/ex5_23.out
+
+   test:
+      suffix: hash_1
+      args: -mat_type seqaij -rectA -mat_use_hash_table
+      filter: grep -v type
+      output_file: output/ex5_11_A.out
+
+   test:
+      suffix: hash_2
+      nsize: 3
+      args: -mat_type mpiaij -mat_use_hash_table
+      filter: grep -v type
+      output_file: output/ex5_23.out
+
+   test:
+      suffix: hash_3
+      args: -mat_type seqaij -rectA -hash_after_values
+      filter: grep -v type
+      output_file: output/ex5_11_A.out
+
+   test:
+      suffix: hash_4
+      nsize: 3
+      args: -mat_type mpiaij -hash_after_values
+      filter: grep -v type
+      output_file: output/ex5_23.out
+
+   test:
+      suffix: autotune_1
+      args: -mat_type seqaij -rectA -mat_aij_autotune -mat_aij_autotune_its 2
+      filter: grep -v type
+      output_file: output/ex5_11_A.out
+
+   test:
+      suffix: autotune_2
+      nsize: 3
+      args: -mat_type mpiaij -mat_aij_autotune -mat_aij_autotune_its 2
+      filter: grep -v type
+      output_file: output/ex5_23.out
+
    test:
       suffix: sell_1
       args: -mat_type sell
@@ -286,4 +355,17 @@ int main(int argc,char **args)
       args: -mat_type sell -test_diagonalscale
       output_file: output/ex5_53.out
 
+   test:
+      suffix: sell_simd_1
+      requires: define(PETSC_HAVE_X86_CPU_DISPATCH) double !complex
+      args: -mat_type sell -mat_sell_simd {{generic avx avx2}}
+      output_file: output/ex5_41.out
+
+   test:
+      suffix: sell_simd_2
+      nsize: 3
+      requires: define(PETSC_HAVE_X86_CPU_DISPATCH) double !complex
+      args: -mat_type sell -test_diagonalscale -mat_sell_simd {{generic avx avx2}}
+      output_file: output/ex5_53.out
+
 TEST*/
@@ -50,6 +50,12 @@ int main(int argc,char **argv)
   ierr = MatMatMultEqual(C,A,D,10,&isequal);CHKERRQ(ierr);
   if (!isequal) SETERRQ(PETSC_COMM_WORLD,PETSC_ERR_ARG_INCOMP,"MatMatMult: D != C*A");
 
+  /* Compute D = C*A into a new matrix, with -matproduct_pattern_cache its symbolic product is not recomputed */
+  ierr = MatDestroy(&D);CHKERRQ(ierr);
+  ierr = MatMatMult(C,A,MAT_INITIAL_MATRIX,fill,&D);CHKERRQ(ierr);
+  ierr = MatMatMultEqual(C,A,D,10,&isequal);CHKERRQ(ierr);
+  if (!isequal) SETERRQ(PETSC_COMM_WORLD,PETSC_ERR_ARG_INCOMP,"MatMatMult(new): D != C*A");
+
   ierr = MatDestroy(&B);CHKERRQ(ierr);
   ierr = MatDestroy(&C);CHKERRQ(ierr);
   ierr = MatDestroy(&D);CHKERRQ(ierr);
@@ -65,6 +71,12 @@ int main(int argc,char **argv)
   ierr = MatPtAPMultEqual(A,B,C,10,&isequal);CHKERRQ(ierr);
   if (!isequal) SETERRQ(PETSC_COMM_WORLD,PETSC_ERR_ARG_INCOMP,"MatPtAP(reuse): C != B^T*A*B");
 
+  /* Compute C = B^T*A*B into a new matrix, with -matproduct_pattern_cache its symbolic product is not recomputed */
+  ierr = MatDestroy(&C);CHKERRQ(ierr);
+  ierr = MatPtAP(A,B,MAT_INITIAL_MATRIX,fill,&C);CHKERRQ(ierr);
+  ierr = MatPtAPMultEqual(A,B,C,10,&isequal);CHKERRQ(ierr);
+  if (!isequal) SETERRQ(PETSC_COMM_WORLD,PETSC_ERR_ARG_INCOMP,"MatPtAP(new): C != B^T*A*B");
+
   ierr = MatDestroy(&C);CHKERRQ(ierr);
   ierr = MatDestroy(&B);CHKERRQ(ierr);
 
@@ -227,4 +239,16 @@ PetscErrorCode testPTAPRectangular(void)
       args: -matmatmult_via scalable_fast
       output_file: output/ex93_1.out
 
+   test:
+      suffix: pattern_cache
+      nsize: {{1 2}}
+      args: -matproduct_pattern_cache 4
+      output_file: output/ex93_1.out
+
+   test:
+      suffix: threads
+      requires: openmp
+      args: -mat_aij_threads 3 -matmatmult_via {{sorted scalable}} -matptap_via scalable
+      output_file: output/ex93_1.out
+
 TEST*/
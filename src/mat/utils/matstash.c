@@ -10,6 +10,10 @@ static PetscErrorCode MatStashScatterEnd_Ref(MatStash*);
 static PetscErrorCode MatStashScatterBegin_BTS(Mat,MatStash*,PetscInt*);
 static PetscErrorCode MatStashScatterGetMesg_BTS(MatStash*,PetscMPIInt*,PetscInt**,PetscInt**,PetscScalar**,PetscInt*);
 static PetscErrorCode MatStashScatterEnd_BTS(MatStash*);
+static PetscErrorCode MatStashScatterBegin_Stream(Mat,MatStash*,PetscInt*);
+static PetscErrorCode MatStashScatterGetMesg_Stream(MatStash*,PetscMPIInt*,PetscInt**,PetscInt**,PetscScalar**,PetscInt*);
+static PetscErrorCode MatStashScatterEnd_Stream(MatStash*);
+static PetscErrorCode MatStashScatterDestroy_Stream(MatStash*);
 #endif
 
 /*
@@ -83,12 +87,23 @@ PetscErrorCode MatStashCreate_Private(MPI_Comm comm,PetscInt bs,MatStash *stash)
 #if !defined(PETSC_HAVE_MPIUNI)
   flg  = PETSC_FALSE;
   ierr = PetscOptionsGetBool(NULL,NULL,"-matstash_legacy",&flg,NULL);CHKERRQ(ierr);
-  if (!flg) {
+  stash->stream = 0;
+  ierr = PetscOptionsGetInt(NULL,NULL,"-matstash_stream",&stash->stream,NULL);CHKERRQ(ierr);
+  if (!flg && stash->stream > 0) {
+    ierr = PetscCommGetNewTag(stash->comm,&stash->tag_stream);CHKERRQ(ierr);
+    ierr = PetscCalloc2(stash->size,&stash->streamsent,stash->size,&stash->streamrecvd);CHKERRQ(ierr);
+    stash->ScatterBegin   = MatStashScatterBegin_Stream;
+    stash->ScatterGetMesg = MatStashScatterGetMesg_Stream;
+    stash->ScatterEnd     = MatStashScatterEnd_Stream;
+    stash->ScatterDestroy = MatStashScatterDestroy_Stream;
+  } else if (!flg) {
+    stash->stream         = 0;
     stash->ScatterBegin   = MatStashScatterBegin_BTS;
     stash->ScatterGetMesg = MatStashScatterGetMesg_BTS;
     stash->ScatterEnd     = MatStashScatterEnd_BTS;
     stash->ScatterDestroy = MatStashScatterDestroy_BTS;
   } else {
+    stash->stream         = 0;
 #endif
     stash->ScatterBegin   = MatStashScatterBegin_Ref;
     stash->ScatterGetMesg = MatStashScatterGetMesg_Ref;
@@ -1037,4 +1052,245 @@ PetscErrorCode MatStashScatterDestroy_BTS(MatStash *stash)
   ierr = PetscFree2(stash->some_indices,stash->some_statuses);CHKERRQ(ierr);
   PetscFunctionReturn(0);
 }
+/*
+   The streaming variant (-matstash_stream <n>) sends the stash to the owning processes in segments as soon as it
+   holds n blocks, so that most of the assembly communication overlaps with the calls to MatSetValues(). Segments
+   that have already arrived are merged into the local part of the matrix whenever the stash is flushed, the rest are
+   received during MatStashScatterGetMesg_Private(). MatStashScatterBegin_Stream() only needs to tell every process
+   how many segments to expect from whom, which is done with PetscCommBuildTwoSided().
+
+   No process can leave PetscCommBuildTwoSided() before all processes have entered it, so segments of the next
+   assembly cycle can only be in flight once all processes are receiving those of the current cycle; receiving them
+   by source preserves the MPI ordering guarantee.
+*/
+static PetscErrorCode MatStashStreamRecv_Private(MatStash *stash,PetscMPIInt source,PetscMPIInt *count)
+{
+  PetscErrorCode ierr;
+  MPI_Status     status;
+
+  PetscFunctionBegin;
+  ierr = MPI_Probe(source,stash->tag_stream,stash->comm,&status);CHKERRQ(ierr);
+  ierr = MPI_Get_count(&status,stash->blocktype,count);CHKERRQ(ierr);
+  if (*count > stash->streamrecvmax) {
+    ierr = PetscFree(stash->streamrecvbuf);CHKERRQ(ierr);
+    stash->streamrecvmax = PetscMax(*count,2*stash->streamrecvmax);
+    ierr = PetscMalloc(stash->streamrecvmax*stash->blocktype_size,&stash->streamrecvbuf);CHKERRQ(ierr);
+  }
+  ierr = MPI_Recv(stash->streamrecvbuf,*count,stash->blocktype,status.MPI_SOURCE,stash->tag_stream,stash->comm,MPI_STATUS_IGNORE);CHKERRQ(ierr);
+  if (*count > 0) { /* Check for InsertMode consistency */
+    MatStashBlock *block = (MatStashBlock*)stash->streamrecvbuf;
+    if (PetscUnlikely(*stash->insertmode == NOT_SET_VALUES)) *stash->insertmode = block->row < 0 ? INSERT_VALUES : ADD_VALUES;
+    if (PetscUnlikely(*stash->insertmode == INSERT_VALUES && block->row >= 0)) SETERRQ1(PETSC_COMM_SELF,PETSC_ERR_ARG_WRONGSTATE,"Assembling INSERT_VALUES, but rank %d requested ADD_VALUES",status.MPI_SOURCE);
+    if (PetscUnlikely(*stash->insertmode == ADD_VALUES && block->row < 0)) SETERRQ1(PETSC_COMM_SELF,PETSC_ERR_ARG_WRONGSTATE,"Assembling ADD_VALUES, but rank %d requested INSERT_VALUES",status.MPI_SOURCE);
+  }
+  PetscFunctionReturn(0);
+}
+
+/* Sends the current content of the stash to its owners and empties the stash */
+static PetscErrorCode MatStashStreamSend_Private(Mat mat,MatStash *stash,PetscInt owners[])
+{
+  PetscErrorCode ierr;
+  size_t         nblocks,i,rowstart;
+  char           *sendblocks;
+
+  PetscFunctionBegin;
+  if (!stash->n) PetscFunctionReturn(0);
+  ierr = MatStashBlockTypeSetUp(stash);CHKERRQ(ierr);
+  ierr = MatStashSortCompress_Private(stash,mat->insertmode);CHKERRQ(ierr);
+  ierr = PetscSegBufferGetSize(stash->segsendblocks,&nblocks);CHKERRQ(ierr);
+  /* Pending sends point into this buffer, so it is extracted into its own allocation rather than in place */
+  ierr = PetscSegBufferExtractAlloc(stash->segsendblocks,&sendblocks);CHKERRQ(ierr);
+  if (stash->nstreambufs == stash->maxstreambufs) {
+    stash->maxstreambufs = PetscMax(8,2*stash->maxstreambufs);
+    ierr = PetscRealloc(stash->maxstreambufs*sizeof(char*),&stash->streambufs);CHKERRQ(ierr);
+  }
+  stash->streambufs[stash->nstreambufs++] = sendblocks;
+
+  for (rowstart=0; rowstart<nblocks; ) {
+    PetscInt    owner;
+    PetscMPIInt count;
+    MatStashBlock *sendblock_rowstart = (MatStashBlock*)&sendblocks[rowstart*stash->blocktype_size];
+    ierr = PetscFindInt(sendblock_rowstart->row,stash->size+1,owners,&owner);CHKERRQ(ierr);
+    if (owner < 0) owner = -(owner+2);
+    for (i=rowstart; i<nblocks; i++) { /* Move forward through a run of blocks with the same owner, encoding insertmode */
+      MatStashBlock *sendblock_i = (MatStashBlock*)&sendblocks[i*stash->blocktype_size];
+      if (sendblock_i->row >= owners[owner+1]) break;
+      if (mat->insertmode == INSERT_VALUES) sendblock_i->row = -(sendblock_i->row+1);
+    }
+    if (stash->nstreamreqs == stash->maxstreamreqs) {
+      stash->maxstreamreqs = PetscMax(stash->size,2*stash->maxstreamreqs);
+      ierr = PetscRealloc(stash->maxstreamreqs*sizeof(MPI_Request),&stash->streamreqs);CHKERRQ(ierr);
+    }
+    ierr = PetscMPIIntCast(i-rowstart,&count);CHKERRQ(ierr);
+    ierr = MPI_Isend(sendblock_rowstart,count,stash->blocktype,(PetscMPIInt)owner,stash->tag_stream,stash->comm,&stash->streamreqs[stash->nstreamreqs++]);CHKERRQ(ierr);
+    stash->streamsent[owner]++;
+    rowstart = i;
+  }
+
+  if (stash->n) {
+    PetscInt bs2     = stash->bs*stash->bs;
+    PetscInt oldnmax = ((int)(stash->n * 1.1) + 5)*bs2;
+    if (oldnmax > stash->oldnmax) stash->oldnmax = oldnmax;
+  }
+  stash->nmax     = 0;
+  stash->n        = 0;
+  stash->reallocs = -1;
+  ierr = PetscMatStashSpaceDestroy(&stash->space_head);CHKERRQ(ierr);
+  stash->space    = 0;
+  PetscFunctionReturn(0);
+}
+
+/* Flushes a full stash and merges the segments that have already arrived, see MatStashStreamFlush_Private() */
+static PetscErrorCode MatStashStreamFlush_Stream(Mat mat,MatStash *stash,PetscInt owners[])
+{
+  PetscErrorCode ierr;
+  PetscMPIInt    flag,count,i;
+  MPI_Status     status;
+
+  PetscFunctionBegin;
+  if (stash->n < stash->stream) PetscFunctionReturn(0);
+  ierr = MatStashStreamSend_Private(mat,stash,owners);CHKERRQ(ierr);
+  ierr = MPI_Testall(stash->nstreamreqs,stash->streamreqs,&flag,MPI_STATUSES_IGNORE);CHKERRQ(ierr); /* progress */
+
+  stash->insertmode = &mat->insertmode;
+  while (1) {
+    ierr = MPI_Iprobe(MPI_ANY_SOURCE,stash->tag_stream,stash->comm,&flag,&status);CHKERRQ(ierr);
+    if (!flag) break;
+    ierr = MatStashStreamRecv_Private(stash,status.MPI_SOURCE,&count);CHKERRQ(ierr);
+    stash->streamrecvd[status.MPI_SOURCE]++;
+    for (i=0; i<count; i++) {
+      MatStashBlock *block = (MatStashBlock*)&stash->streamrecvbuf[i*stash->blocktype_size];
+      PetscInt      row    = block->row < 0 ? -(block->row+1) : block->row;
+      if (stash->bs == 1) {
+        ierr = (*mat->ops->setvalues)(mat,1,&row,1,&block->col,block->vals,mat->insertmode);CHKERRQ(ierr);
+      } else {
+        ierr = (*mat->ops->setvaluesblocked)(mat,1,&row,1,&block->col,block->vals,mat->insertmode);CHKERRQ(ierr);
+      }
+    }
+  }
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode MatStashScatterBegin_Stream(Mat mat,MatStash *stash,PetscInt owners[])
+{
+  PetscErrorCode ierr;
+  PetscMPIInt    nto,i,*toranks,*todata,*fromdata;
+
+  PetscFunctionBegin;
+  if (PetscDefined(USE_DEBUG)) { /* make sure all processors are either in INSERTMODE or ADDMODE */
+    InsertMode addv;
+    ierr = MPIU_Allreduce((PetscEnum*)&mat->insertmode,(PetscEnum*)&addv,1,MPIU_ENUM,MPI_BOR,PetscObjectComm((PetscObject)mat));CHKERRQ(ierr);
+    if (addv == (ADD_VALUES|INSERT_VALUES)) SETERRQ(PetscObjectComm((PetscObject)mat),PETSC_ERR_ARG_WRONGSTATE,"Some processors inserted others added");
+  }
+  ierr = MatStashBlockTypeSetUp(stash);CHKERRQ(ierr);
+  ierr = MatStashStreamSend_Private(mat,stash,owners);CHKERRQ(ierr);
+
+  /* Tell the receivers how many segments to expect */
+  for (i=0,nto=0; i<stash->size; i++) if (stash->streamsent[i]) nto++;
+  ierr = PetscMalloc2(nto,&toranks,nto,&todata);CHKERRQ(ierr);
+  for (i=0,nto=0; i<stash->size; i++) {
+    if (stash->streamsent[i]) {
+      toranks[nto] = i;
+      todata[nto]  = stash->streamsent[i];
+      nto++;
+    }
+    stash->streamsent[i] = 0;
+  }
+  ierr = PetscCommBuildTwoSided(stash->comm,1,MPI_INT,nto,toranks,todata,&stash->nstreamfrom,&stash->streamfrom,&fromdata);CHKERRQ(ierr);
+  ierr = PetscFree2(toranks,todata);CHKERRQ(ierr);
+  stash->streamleft = fromdata;
+  for (i=0; i<stash->nstreamfrom; i++) {
+    stash->streamleft[i] -= stash->streamrecvd[stash->streamfrom[i]];
+    stash->streamrecvd[stash->streamfrom[i]] = 0;
+  }
+  stash->streamfrom_i     = 0;
+  stash->recvframe_i      = 0;
+  stash->recvframe_count  = 0;
+  stash->insertmode       = &mat->insertmode;
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode MatStashScatterGetMesg_Stream(MatStash *stash,PetscMPIInt *n,PetscInt **row,PetscInt **col,PetscScalar **val,PetscInt *flg)
+{
+  PetscErrorCode ierr;
+  MatStashBlock  *block;
+
+  PetscFunctionBegin;
+  *flg = 0;
+  while (stash->recvframe_i == stash->recvframe_count) {
+    while (stash->streamfrom_i < stash->nstreamfrom && !stash->streamleft[stash->streamfrom_i]) stash->streamfrom_i++;
+    if (stash->streamfrom_i == stash->nstreamfrom) PetscFunctionReturn(0); /* Done */
+    ierr = MatStashStreamRecv_Private(stash,stash->streamfrom[stash->streamfrom_i],&stash->recvframe_count);CHKERRQ(ierr);
+    stash->streamleft[stash->streamfrom_i]--;
+    stash->recvframe_i = 0;
+  }
+  *n = 1;
+  block = (MatStashBlock*)&stash->streamrecvbuf[stash->recvframe_i*stash->blocktype_size];
+  if (block->row < 0) block->row = -(block->row + 1);
+  *row = &block->row;
+  *col = &block->col;
+  *val = block->vals;
+  stash->recvframe_i++;
+  *flg = 1;
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode MatStashScatterEnd_Stream(MatStash *stash)
+{
+  PetscErrorCode ierr;
+  PetscInt       i;
+
+  PetscFunctionBegin;
+  ierr = MPI_Waitall(stash->nstreamreqs,stash->streamreqs,MPI_STATUSES_IGNORE);CHKERRQ(ierr);
+  for (i=0; i<stash->nstreambufs; i++) {ierr = PetscFree(stash->streambufs[i]);CHKERRQ(ierr);}
+  stash->nstreamreqs = 0;
+  stash->nstreambufs = 0;
+  /* The streamrecvd[] of ranks that sent us segments were reset in MatStashScatterBegin_Stream() */
+  ierr = PetscFree(stash->streamfrom);CHKERRQ(ierr);
+  ierr = PetscFree(stash->streamleft);CHKERRQ(ierr);
+  stash->nstreamfrom = 0;
+  stash->nmax        = 0;
+  stash->n           = 0;
+  stash->reallocs    = -1;
+  stash->nprocessed  = 0;
+  ierr = PetscMatStashSpaceDestroy(&stash->space_head);CHKERRQ(ierr);
+  stash->space = 0;
+  PetscFunctionReturn(0);
+}
+
+static PetscErrorCode MatStashScatterDestroy_Stream(MatStash *stash)
+{
+  PetscErrorCode ierr;
+  PetscInt       i;
+
+  PetscFunctionBegin;
+  ierr = MPI_Waitall(stash->nstreamreqs,stash->streamreqs,MPI_STATUSES_IGNORE);CHKERRQ(ierr);
+  for (i=0; i<stash->nstreambufs; i++) {ierr = PetscFree(stash->streambufs[i]);CHKERRQ(ierr);}
+  ierr = PetscFree(stash->streambufs);CHKERRQ(ierr);
+  ierr = PetscFree(stash->streamreqs);CHKERRQ(ierr);
+  ierr = PetscFree(stash->streamrecvbuf);CHKERRQ(ierr);
+  ierr = PetscFree2(stash->streamsent,stash->streamrecvd);CHKERRQ(ierr);
+  ierr = MatStashScatterDestroy_BTS(stash);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
 #endif
+
+/*
+   MatStashStreamFlush_Private - With -matstash_stream <n>, sends the stash to the owning processes once it holds n
+   blocks and merges the values other processes have already sent to us; otherwise does nothing.
+
+   Input Parameters:
+   mat    - the matrix, its MatSetValues() implementation is used to merge received values
+   stash  - the stash
+   owners - the ownership ranges, indexed like the rows in the stash
+*/
+PetscErrorCode MatStashStreamFlush_Private(Mat mat,MatStash *stash,PetscInt owners[])
+{
+  PetscFunctionBegin;
+#if !defined(PETSC_HAVE_MPIUNI)
+  if (stash->stream) {
+    PetscErrorCode ierr = MatStashStreamFlush_Stream(mat,stash,owners);CHKERRQ(ierr);
+  }
+#endif
+  PetscFunctionReturn(0);
+}
@@ -1112,6 +1112,16 @@ int main(int argc, char **argv)
       -ksp_type gmres -ksp_rtol 1.0e-5 -ksp_error_if_not_converged \
       -pc_type patch -pc_patch_partition_of_unity 0 -pc_patch_construct_dim 0 -pc_patch_construct_type vanka \
         -sub_ksp_type preonly -sub_pc_type lu
+  # Vanka solver, dense inverses on patches of several sizes applied in batches
+  test:
+    suffix: 2d_quad_q2_q1_vanka_add_dense_inverse
+    requires: double !complex
+    filter: sed -e "s/linear solver iterations=[0-9][0-9][0-9]*""/linear solver iterations=489/g"
+    args: -run_type full -bc_type dirichlet -simplex 0 -dm_refine 0 -interpolate 1 -vel_petscspace_degree 2 -pres_petscspace_degree 1 -petscds_jac_pre 0 \
+      -snes_rtol 1.0e-4 -snes_error_if_not_converged -snes_view -snes_monitor -snes_converged_reason \
+      -ksp_type gmres -ksp_rtol 1.0e-5 -ksp_error_if_not_converged \
+      -pc_type patch -pc_patch_partition_of_unity 0 -pc_patch_construct_dim 0 -pc_patch_construct_type vanka \
+        -pc_patch_dense_inverse -pc_patch_sub_mat_type seqdense
   test:
     suffix: 2d_quad_q2_q1_vanka_add_unity
     requires: double !complex
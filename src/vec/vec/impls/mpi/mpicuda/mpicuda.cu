@@ -276,6 +276,7 @@ PetscErrorCode VecBindToCPU_MPICUDA(Vec V,PetscBool pin)
     ierr = VecCUDACopyFromGPU(V);CHKERRQ(ierr);
     V->offloadmask = PETSC_OFFLOAD_CPU; /* since the CPU code will likely change values in the vector */
     V->ops->dotnorm2               = NULL;
+    V->ops->axpydotnorm2           = NULL;
     V->ops->waxpy                  = VecWAXPY_Seq;
     V->ops->dot                    = VecDot_MPI;
     V->ops->mdot                   = VecMDot_MPI;
@@ -307,6 +308,7 @@ PetscErrorCode VecBindToCPU_MPICUDA(Vec V,PetscBool pin)
     V->ops->getarraywrite          = NULL;
   } else {
     V->ops->dotnorm2               = VecDotNorm2_MPICUDA;
+    V->ops->axpydotnorm2           = NULL;
     V->ops->waxpy                  = VecWAXPY_SeqCUDA;
     V->ops->duplicate              = VecDuplicate_MPICUDA;
     V->ops->dot                    = VecDot_MPICUDA;
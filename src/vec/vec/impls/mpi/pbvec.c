@@ -29,6 +29,21 @@ PetscErrorCode VecTDot_MPI(Vec xin,Vec yin,PetscScalar *z)
   PetscFunctionReturn(0);
 }
 
+PetscErrorCode VecAXPYDotNorm2_MPI(Vec yin,PetscScalar alpha,Vec xin,Vec zin,PetscScalar *dp,PetscReal *nm)
+{
+  PetscScalar    work[2],sum[2];
+  PetscErrorCode ierr;
+
+  PetscFunctionBegin;
+  work[0] = 0.0;
+  ierr    = VecAXPYDotNorm2_Seq(yin,alpha,xin,zin,work,nm);CHKERRQ(ierr);
+  work[1] = *nm;
+  ierr    = MPIU_Allreduce(work,sum,2,MPIU_SCALAR,MPIU_SUM,PetscObjectComm((PetscObject)yin));CHKERRQ(ierr);
+  if (zin) *dp = sum[0];
+  *nm     = PetscRealPart(sum[1]);
+  PetscFunctionReturn(0);
+}
+
 extern PetscErrorCode VecView_MPI_Draw(Vec,PetscViewer);
 
 static PetscErrorCode VecPlaceArray_MPI(Vec vin,const PetscScalar *a)
@@ -481,7 +496,15 @@ static struct _VecOps DvOps = { VecDuplicate_MPI, /* 1 */
                                 VecStrideSubSetGather_Default,
                                 VecStrideSubSetScatter_Default,
                                 0,
-                                0
+                                0,
+                                0,
+                                0,
+                                0,
+                                0,
+                                0,
+                                0,
+                                0,
+                                VecAXPYDotNorm2_MPI
 };
 
 /*
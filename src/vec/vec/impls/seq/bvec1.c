@@ -86,6 +86,46 @@ PetscErrorCode VecAXPY_Seq(Vec yin,PetscScalar alpha,Vec xin)
   PetscFunctionReturn(0);
 }
 
+/*
+   The inner product and the norm are accumulated from the updated entries while they are still in registers, so x, y and z are
+   each read once and y written once, instead of the four sweeps over y of VecAXPY(), VecDot() and VecNorm().
+*/
+PetscErrorCode VecAXPYDotNorm2_Seq(Vec yin,PetscScalar alpha,Vec xin,Vec zin,PetscScalar *dp,PetscReal *nm)
+{
+  PetscErrorCode    ierr;
+  PetscInt          n = yin->map->n,i;
+  const PetscScalar *xx,*zz;
+  PetscScalar       *yy,dpx = 0.0,yi;
+  PetscReal         nmx = 0.0;
+
+  PetscFunctionBegin;
+  ierr = VecGetArrayRead(xin,&xx);CHKERRQ(ierr);
+  ierr = VecGetArray(yin,&yy);CHKERRQ(ierr);
+  if (zin) {
+    ierr = VecGetArrayRead(zin,&zz);CHKERRQ(ierr);
+    for (i=0; i<n; i++) {
+      yi     = yy[i] + alpha*xx[i];
+      yy[i]  = yi;
+      dpx   += yi*PetscConj(zz[i]);
+      nmx   += PetscRealPart(yi*PetscConj(yi));
+    }
+    ierr = VecRestoreArrayRead(zin,&zz);CHKERRQ(ierr);
+    *dp  = dpx;
+    ierr = PetscLogFlops(6.0*n);CHKERRQ(ierr);
+  } else {
+    for (i=0; i<n; i++) {
+      yi     = yy[i] + alpha*xx[i];
+      yy[i]  = yi;
+      nmx   += PetscRealPart(yi*PetscConj(yi));
+    }
+    ierr = PetscLogFlops(4.0*n);CHKERRQ(ierr);
+  }
+  *nm  = nmx;
+  ierr = VecRestoreArrayRead(xin,&xx);CHKERRQ(ierr);
+  ierr = VecRestoreArray(yin,&yy);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
 PetscErrorCode VecAXPBY_Seq(Vec yin,PetscScalar a,PetscScalar b,Vec xin)
 {
   PetscErrorCode    ierr;
@@ -362,6 +362,7 @@ PetscErrorCode VecBindToCPU_SeqCUDA(Vec V,PetscBool pin)
     V->ops->aypx                   = VecAYPX_Seq;
     V->ops->waxpy                  = VecWAXPY_Seq;
     V->ops->dotnorm2               = NULL;
+    V->ops->axpydotnorm2           = NULL;
     V->ops->placearray             = VecPlaceArray_Seq;
     V->ops->replacearray           = VecReplaceArray_Seq;
     V->ops->resetarray             = VecResetArray_Seq;
@@ -395,6 +396,7 @@ PetscErrorCode VecBindToCPU_SeqCUDA(Vec V,PetscBool pin)
     V->ops->aypx                   = VecAYPX_SeqCUDA;
     V->ops->waxpy                  = VecWAXPY_SeqCUDA;
     V->ops->dotnorm2               = VecDotNorm2_SeqCUDA;
+    V->ops->axpydotnorm2           = NULL;
     V->ops->placearray             = VecPlaceArray_SeqCUDA;
     V->ops->replacearray           = VecReplaceArray_SeqCUDA;
     V->ops->resetarray             = VecResetArray_SeqCUDA;
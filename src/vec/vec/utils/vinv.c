@@ -1330,6 +1330,78 @@ PetscErrorCode  VecDotNorm2(Vec s,Vec t,PetscScalar *dp, PetscReal *nm)
   PetscFunctionReturn(0);
 }
 
+/*@
+  VecAXPYDotNorm2 - computes y = alpha x + y together with the inner product of the new y with a third vector and the 2-norm squared of the new y,
+  reading each vector from memory only once
+
+  Collective on Vec
+
+  Input Parameters:
++ y     - the vector that is updated
+. alpha - the scalar
+. x     - the vector that is added
+- z     - the vector for the inner product, or NULL to compute only the norm
+
+  Output Parameters:
++ dp - y'conj(z) of the updated y, not computed if z is NULL
+- nm - y'conj(y) of the updated y
+
+  Level: advanced
+
+  Notes:
+    x and y MUST be different vectors, and so must z and y
+
+    The result is that of VecAXPY() followed by VecDot() and VecNorm(), with a single reduction and a single sweep over the
+    vectors; Krylov methods use it to merge the residual update with the inner products of the next iteration
+
+.seealso:   VecAXPY(), VecDot(), VecNorm(), VecDotNorm2()
+@*/
+PetscErrorCode  VecAXPYDotNorm2(Vec y,PetscScalar alpha,Vec x,Vec z,PetscScalar *dp,PetscReal *nm)
+{
+  PetscErrorCode ierr;
+  PetscReal      norm;
+
+  PetscFunctionBegin;
+  PetscValidHeaderSpecific(y,VEC_CLASSID,1);
+  PetscValidHeaderSpecific(x,VEC_CLASSID,3);
+  PetscValidType(y,1);
+  PetscValidType(x,3);
+  PetscCheckSameTypeAndComm(x,3,y,1);
+  VecCheckSameSize(x,3,y,1);
+  if (z) {
+    PetscValidHeaderSpecific(z,VEC_CLASSID,4);
+    PetscValidType(z,4);
+    PetscCheckSameTypeAndComm(z,4,y,1);
+    VecCheckSameSize(z,4,y,1);
+    PetscValidScalarPointer(dp,5);
+    if (z == y) SETERRQ(PetscObjectComm((PetscObject)y),PETSC_ERR_ARG_IDN,"z and y cannot be the same vector");
+  }
+  PetscValidRealPointer(nm,6);
+  if (x == y) SETERRQ(PetscObjectComm((PetscObject)y),PETSC_ERR_ARG_IDN,"x and y cannot be the same vector");
+  PetscValidLogicalCollectiveScalar(y,alpha,2);
+  ierr = VecSetErrorIfLocked(y,1);CHKERRQ(ierr);
+
+  ierr = VecLockReadPush(x);CHKERRQ(ierr);
+  if (z) {ierr = VecLockReadPush(z);CHKERRQ(ierr);}
+  ierr = PetscLogEventBegin(VEC_AXPYDotNorm2,x,y,z,0);CHKERRQ(ierr);
+  if (y->ops->axpydotnorm2) {
+    ierr = (*y->ops->axpydotnorm2)(y,alpha,x,z,dp,nm);CHKERRQ(ierr);
+  } else {
+    ierr = (*y->ops->axpy)(y,alpha,x);CHKERRQ(ierr);
+    ierr = PetscObjectStateIncrease((PetscObject)y);CHKERRQ(ierr);
+    if (z) {ierr = VecDotBegin(y,z,dp);CHKERRQ(ierr);}
+    ierr = VecNormBegin(y,NORM_2,&norm);CHKERRQ(ierr);
+    if (z) {ierr = VecDotEnd(y,z,dp);CHKERRQ(ierr);}
+    ierr = VecNormEnd(y,NORM_2,&norm);CHKERRQ(ierr);
+    *nm  = norm*norm;
+  }
+  ierr = PetscLogEventEnd(VEC_AXPYDotNorm2,x,y,z,0);CHKERRQ(ierr);
+  if (z) {ierr = VecLockReadPop(z);CHKERRQ(ierr);}
+  ierr = VecLockReadPop(x);CHKERRQ(ierr);
+  ierr = PetscObjectStateIncrease((PetscObject)y);CHKERRQ(ierr);
+  PetscFunctionReturn(0);
+}
+
 /*@
    VecSum - Computes the sum of all the components of a vector.
 